@@ -294,6 +294,7 @@ static VisPalette *act_blursk_palette (VisPluginData *plugin)
 
 static void act_blursk_render (VisPluginData *plugin, VisVideo *video, VisAudio *audio)
 {
+    static const VisAudioChannelId stereo_channels[] = { VISUAL_AUDIO_CHANNEL_ID_LEFT, VISUAL_AUDIO_CHANNEL_ID_RIGHT };
     BlurskPrivate *priv = visual_plugin_get_private (plugin);
 
     int16_t tpcm[512];
@@ -301,9 +302,7 @@ static void act_blursk_render (VisPluginData *plugin, VisVideo *video, VisAudio
 
         priv->video = video;
 
-        visual_audio_get_sample_mixed_simple (audio, priv->pcmbuf, 2,
-                        VISUAL_AUDIO_CHANNEL_LEFT,
-                        VISUAL_AUDIO_CHANNEL_RIGHT);
+        visual_audio_get_sample_mixed_channels (audio, priv->pcmbuf, stereo_channels, NULL, 2, TRUE);
 
         pcm = visual_buffer_get_data(priv->pcmbuf);
 
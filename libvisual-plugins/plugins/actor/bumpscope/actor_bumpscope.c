@@ -219,12 +219,11 @@ static VisPalette *act_bumpscope_palette (VisPluginData *plugin)
 
 static void act_bumpscope_render (VisPluginData *plugin, VisVideo *video, VisAudio *audio)
 {
+	static const VisAudioChannelId stereo_channels[] = { VISUAL_AUDIO_CHANNEL_ID_LEFT, VISUAL_AUDIO_CHANNEL_ID_RIGHT };
 	BumpscopePrivate *priv = visual_plugin_get_private (plugin);
 	priv->video = video;
 
-	visual_audio_get_sample_mixed_simple (audio, priv->pcmbuf, 2,
-			VISUAL_AUDIO_CHANNEL_LEFT,
-			VISUAL_AUDIO_CHANNEL_RIGHT);
+	visual_audio_get_sample_mixed_channels (audio, priv->pcmbuf, stereo_channels, NULL, 2, TRUE);
 
 	__bumpscope_render_pcm (priv, visual_buffer_get_data (priv->pcmbuf));
 
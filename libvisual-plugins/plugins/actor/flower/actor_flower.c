@@ -198,6 +198,7 @@ static VisPalette *lv_flower_palette (VisPluginData *plugin)
 
 static void lv_flower_render (VisPluginData *plugin, VisVideo *video, VisAudio *audio)
 {
+	static const VisAudioChannelId stereo_channels[] = { VISUAL_AUDIO_CHANNEL_ID_LEFT, VISUAL_AUDIO_CHANNEL_ID_RIGHT };
 	FlowerPrivate *priv = visual_plugin_get_private (plugin);
 	VisBuffer *pcmbuf;
 	VisBuffer *freqbuf;
@@ -214,9 +215,7 @@ static void lv_flower_render (VisPluginData *plugin, VisVideo *video, VisAudio *
 	visual_buffer_set_data_pair (pcmbuf, pcm, sizeof (pcm));
 	visual_buffer_set_data_pair (freqbuf, freqnorm, sizeof (freqnorm));
 
-	visual_audio_get_sample_mixed_simple (audio, pcmbuf, 2,
-			VISUAL_AUDIO_CHANNEL_LEFT,
-			VISUAL_AUDIO_CHANNEL_RIGHT);
+	visual_audio_get_sample_mixed_channels (audio, pcmbuf, stereo_channels, NULL, 2, TRUE);
 
 	visual_audio_get_spectrum_for_sample (freqbuf, pcmbuf, TRUE);
 
@@ -231,12 +231,11 @@ static VisPalette *act_jakdaw_palette (VisPluginData *plugin)
 
 static void act_jakdaw_render (VisPluginData *plugin, VisVideo *video, VisAudio *audio)
 {
+	static const VisAudioChannelId stereo_channels[] = { VISUAL_AUDIO_CHANNEL_ID_LEFT, VISUAL_AUDIO_CHANNEL_ID_RIGHT };
 	JakdawPrivate *priv = visual_plugin_get_private (plugin);
 	uint32_t *vscr = visual_video_get_pixels (video);
 
-	visual_audio_get_sample_mixed_simple (audio, priv->pcmbuf, 2,
-			VISUAL_AUDIO_CHANNEL_LEFT,
-			VISUAL_AUDIO_CHANNEL_RIGHT);
+	visual_audio_get_sample_mixed_channels (audio, priv->pcmbuf, stereo_channels, NULL, 2, TRUE);
 
 	visual_audio_get_spectrum_for_sample (priv->freqbuf, priv->pcmbuf, TRUE);
 
@@ -29,6 +29,10 @@ VISUAL_PLUGIN_API_VERSION_VALIDATOR
 #define BARS_DEFAULT 25
 /** default space between bars in pixels */
 #define BARS_DEFAULT_SPACE 0
+/** number of samples analyzed per frame */
+#define PCM_SIZE 512
+/** size of spectrum reduced to bars */
+#define SPECTRUM_SIZE (PCM_SIZE / 2)
 
 
 /* helper macro */
@@ -42,6 +46,7 @@ typedef struct
 	int width, height;
 	VisBuffer *pcm_buffer;
 	VisBuffer *freq_buffer;
+	float *bands;
 } AnalyzerPrivate;
 
 static int         lv_analyzer_init        (VisPluginData *plugin);
@@ -105,8 +110,9 @@ static int lv_analyzer_init (VisPluginData *plugin)
 	priv->bar_space = BARS_DEFAULT_SPACE;
 
 	/* allocate buffers */
-	priv->pcm_buffer = visual_buffer_new_allocate (priv->bars*2 * sizeof (float));
-	priv->freq_buffer = visual_buffer_new_allocate (priv->bars * sizeof (float));
+	priv->pcm_buffer = visual_buffer_new_allocate (PCM_SIZE * sizeof (float));
+	priv->freq_buffer = visual_buffer_new_allocate (SPECTRUM_SIZE * sizeof (float));
+	priv->bands = visual_mem_new0 (float, priv->bars);
 		
 	/* allocate space for palette */
 	priv->pal = visual_palette_new (256);
@@ -140,6 +146,7 @@ static void lv_analyzer_cleanup (VisPluginData *plugin)
 
 	visual_buffer_unref (priv->freq_buffer);
 	visual_buffer_unref (priv->pcm_buffer);
+	visual_mem_free (priv->bands);
 		
 	visual_palette_free (priv->pal);
 
@@ -211,8 +218,8 @@ static void _change_bars(VisPluginData *plugin,
 		priv->bars = integer;
 
 		/* adapt buffer size */
-		visual_buffer_set_size(priv->pcm_buffer, priv->bars*2 * sizeof (float));
-		visual_buffer_set_size(priv->freq_buffer, priv->bars * sizeof (float));
+		visual_mem_free (priv->bands);
+		priv->bands = visual_mem_new0 (float, priv->bars);
         return;
     }
     /* reset to previous value */
@@ -358,8 +365,12 @@ static void lv_analyzer_render (VisPluginData *plugin, VisVideo *video, VisAudio
 
 	float *freq = (float *) visual_buffer_get_data (priv->freq_buffer);
 
+	/* spread bars over the spectrum on a logarithmic frequency scale */
+	visual_dft_reduce_bands (priv->bands, priv->bars, freq, SPECTRUM_SIZE,
+			VISUAL_DFT_BAND_SCALE_LOG, VISUAL_DFT_BAND_REDUCTION_MAX);
+
 	for(int i = 0; i < priv->bars; i++) {
-		draw_bar (video, x, width, freq[i]);
+		draw_bar (video, x, width, priv->bands[i]);
 		x += width + priv->bar_space;
 	}
 }
@@ -42,10 +42,13 @@
 #include <libvisual/lv_actor.h>
 #include <libvisual/lv_input.h>
 #include <libvisual/lv_audio.h>
+#include <libvisual/lv_audio_analysis.h>
 #include <libvisual/lv_fourier.h>
+#include <libvisual/lv_stft.h>
 #include <libvisual/lv_palette.h>
 #include <libvisual/lv_plugin.h>
 #include <libvisual/lv_video.h>
+#include <libvisual/lv_video_pool.h>
 #include <libvisual/lv_libvisual.h>
 #include <libvisual/lv_songinfo.h>
 #include <libvisual/lv_morph.h>
@@ -32,12 +32,12 @@ namespace LV {
   {
   public:
 
-      VisPluginData* plugin;
-      VideoPtr       video;
-      VideoPtr       to_scale;
-      VideoPtr       to_convert;
-      SongInfo       songcompare;
-      VisVideoDepth  run_depth;
+      VisPluginData*      plugin;
+      VideoPtr            video;
+      VideoPtr            to_transform;
+      SongInfo            songcompare;
+      VisVideoDepth       run_depth;
+      VisVideoScaleMethod scale_method;
 
       Impl ();
       ~Impl ();
@@ -48,8 +48,9 @@ namespace LV {
   };
 
   Actor::Impl::Impl ()
-      : plugin      (nullptr)
-      , songcompare {SONG_INFO_TYPE_NULL}
+      : plugin       (nullptr)
+      , songcompare  {SONG_INFO_TYPE_NULL}
+      , scale_method (VISUAL_VIDEO_SCALE_NEAREST)
   {
       // nothing
   }
@@ -162,8 +163,7 @@ namespace LV {
 
       // Configure proxy videos to convert rendering
 
-      m_impl->to_scale.reset ();
-      m_impl->to_convert.reset ();
+      m_impl->to_transform.reset ();
 
       visual_log (VISUAL_LOG_DEBUG, "Setting up any necessary video conversions..");
 
@@ -173,16 +173,17 @@ namespace LV {
               visual_log (VISUAL_LOG_DEBUG, "Setting up depth conversion: %s -> %s",
                           visual_video_depth_name (m_impl->run_depth),
                           visual_video_depth_name (output_depth));
-
-              m_impl->to_convert = Video::create (run_width, run_height, m_impl->run_depth);
           }
 
           // Configure any necessary scaling
           if (run_width != output_width || run_height != output_height) {
               visual_log (VISUAL_LOG_DEBUG, "Setting up scaling: (%dx%d) -> (%dx%d)",
                           run_width, run_height, output_width, output_height);
+          }
 
-              m_impl->to_scale = Video::create (run_width, run_height, output_depth);
+          // Scaling and depth conversion are done together from a single proxy video
+          if (m_impl->run_depth != output_depth || run_width != output_width || run_height != output_height) {
+              m_impl->to_transform = Video::create (run_width, run_height, m_impl->run_depth);
           }
       } else {
           visual_log (VISUAL_LOG_DEBUG, "Conversions skipped in OpenGL rendering mode");
@@ -214,6 +215,16 @@ namespace LV {
       m_impl->video = video;
   }
 
+  void Actor::set_scale_method (VisVideoScaleMethod method)
+  {
+      m_impl->scale_method = method;
+  }
+
+  VisVideoScaleMethod Actor::get_scale_method () const
+  {
+      return m_impl->scale_method;
+  }
+
   void Actor::run (Audio const& audio)
   {
       visual_return_if_fail (m_impl->video);
@@ -241,53 +252,42 @@ namespace LV {
       // Get plugin to process all events
       visual_plugin_events_pump (m_impl->plugin);
 
-      auto const& video      = m_impl->video;
-      auto const& to_convert = m_impl->to_convert;
-      auto const& to_scale   = m_impl->to_scale;
+      auto const& video        = m_impl->video;
+      auto const& to_transform = m_impl->to_transform;
 
       if (video->get_depth () != VISUAL_VIDEO_DEPTH_GL) {
           auto palette = get_palette ();
 
-          if (to_convert) {
-              // Have depth conversion
+          if (to_transform) {
+              // Have scaling and/or depth conversion
 
               // Setup any palette
               if (palette) {
-                  to_convert->set_palette (*palette);
+                  to_transform->set_palette (*palette);
               }
 
               // Render first
-              actor_plugin->render (m_impl->plugin, to_convert.get (), const_cast<Audio*> (&audio));
+              actor_plugin->render (m_impl->plugin, to_transform.get (), const_cast<Audio*> (&audio));
 
-              if (to_scale) {
-                  // Convert depth, then scale
-                  to_scale->convert_depth (to_convert);
-                  video->scale (to_scale, VISUAL_VIDEO_SCALE_NEAREST);
-              }
-              else {
+              if (to_transform->get_width () == video->get_width () && to_transform->get_height () == video->get_height ()) {
                   // Convert depth only
-                  video->convert_depth (to_convert);
+                  video->convert_depth (to_transform);
+              } else {
+                  // Scale, converting depth on the way
+                  video->scale_depth (to_transform, m_impl->scale_method);
               }
           } else {
-              // No depth conversion
-
-              if (to_scale) {
-                  // Setup any palette
-                  if (palette) {
-                      to_scale->set_palette (*palette);
-                  }
+              // Setup any palette
+              if (palette) {
+                  video->set_palette (*palette);
+              }
 
-                  // Render, then scale
-                  actor_plugin->render (m_impl->plugin, to_scale.get (), const_cast<Audio*> (&audio));
-                  video->scale (to_scale, VISUAL_VIDEO_SCALE_NEAREST);
-              } else {
-                  // Setup any palette
-                  if (palette) {
-                      video->set_palette (*palette);
-                  }
+              // Render directly to video target
+              actor_plugin->render (m_impl->plugin, video.get (), const_cast<Audio*> (&audio));
 
-                  // Render directly to video target
-                  actor_plugin->render (m_impl->plugin, video.get (), const_cast<Audio*> (&audio));
+              // Unless the actor marks the areas it renders, assume it redrew everything
+              if (!(visual_plugin_get_info (plugin)->flags & VISUAL_PLUGIN_FLAG_DIRTY_RECTS)) {
+                  video->mark_dirty ();
               }
           }
       } else {
@@ -134,6 +134,22 @@ namespace LV
 
       VideoPtr const& get_video ();
 
+      /**
+       * Sets the method used to scale renders to the size of the video target.
+       *
+       * @note Defaults to VISUAL_VIDEO_SCALE_NEAREST.
+       *
+       * @param method Scaling method
+       */
+      void set_scale_method (VisVideoScaleMethod method);
+
+      /**
+       * Returns the method used to scale renders to the size of the video target.
+       *
+       * @return Scaling method
+       */
+      VisVideoScaleMethod get_scale_method () const;
+
       /**
        * Runs this actor.
        *
@@ -254,6 +270,9 @@ LV_API VisVideoAttrOptions *visual_actor_get_video_attribute_options (VisActor *
 LV_API void      visual_actor_set_video (VisActor *actor, VisVideo *video);
 LV_API VisVideo *visual_actor_get_video (VisActor *actor);
 
+LV_API void                visual_actor_set_scale_method (VisActor *actor, VisVideoScaleMethod method);
+LV_API VisVideoScaleMethod visual_actor_get_scale_method (VisActor *actor);
+
 LV_API int visual_actor_video_negotiate (VisActor *actor, VisVideoDepth run_depth, int noevent, int forced);
 
 LV_END_DECLS
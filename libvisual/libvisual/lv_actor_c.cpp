@@ -220,6 +220,20 @@ VisVideo *visual_actor_get_video (VisActor *self)
     return self->get_video ().get ();
 }
 
+void visual_actor_set_scale_method (VisActor *self, VisVideoScaleMethod method)
+{
+    visual_return_if_fail (self != nullptr);
+
+    self->set_scale_method (method);
+}
+
+VisVideoScaleMethod visual_actor_get_scale_method (VisActor *self)
+{
+    visual_return_val_if_fail (self != nullptr, VISUAL_VIDEO_SCALE_NEAREST);
+
+    return self->get_scale_method ();
+}
+
 int visual_actor_video_negotiate (VisActor *self, VisVideoDepth run_depth, int noevent, int forced)
 {
     visual_return_val_if_fail (self != nullptr, FALSE);
@@ -23,14 +23,21 @@
 
 #include "config.h"
 #include "lv_audio.h"
+#include "lv_audio_analysis.h"
 #include "private/lv_audio_convert.hpp"
+#include "private/lv_audio_resample.hpp"
 #include "private/lv_audio_stream.hpp"
 #include "lv_common.h"
 #include "lv_fourier.h"
 #include "lv_math.h"
 #include "lv_time.h"
 #include "lv_util.hpp"
+#include "lv_aligned_allocator.hpp"
 #include <cstdarg>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -40,27 +47,167 @@ namespace LV {
 
   typedef std::unique_ptr<AudioChannel> AudioChannelPtr;
 
+  namespace {
+
+    // Reusable DFT and input storage for computing spectra of a given size
+    struct SpectrumWorkspace
+    {
+        std::size_t spectrum_size;
+        std::size_t sample_count;
+        DFT         dft;
+
+        // Grown on first use
+        std::vector<float, AlignedAllocator<float, 64>> samples;
+
+        SpectrumWorkspace (std::size_t spectrum_size_, std::size_t sample_count_)
+            : spectrum_size (spectrum_size_)
+            , sample_count  (sample_count_)
+            , dft           (spectrum_size_, sample_count_)
+        {}
+    };
+
+    typedef std::vector<std::unique_ptr<SpectrumWorkspace>> SpectrumWorkspaceList;
+
+    // Maximum number of workspaces kept in a list. The least recently created is dropped to make room.
+    std::size_t const max_spectrum_workspaces = 8;
+
+    SpectrumWorkspace& get_spectrum_workspace (SpectrumWorkspaceList& workspaces,
+                                               std::size_t            spectrum_size,
+                                               std::size_t            sample_count)
+    {
+        for (auto& workspace : workspaces) {
+            if (workspace->spectrum_size == spectrum_size && workspace->sample_count == sample_count)
+                return *workspace;
+        }
+
+        if (workspaces.size () == max_spectrum_workspaces) {
+            workspaces.erase (workspaces.begin ());
+        }
+
+        workspaces.emplace_back (new SpectrumWorkspace (spectrum_size, sample_count));
+
+        return *workspaces.back ();
+    }
+
+    // Workspaces for spectra of samples supplied by the caller, kept per thread as there is no Audio object to hold
+    // them
+    SpectrumWorkspaceList& get_thread_spectrum_workspaces ()
+    {
+        thread_local SpectrumWorkspaceList workspaces;
+        return workspaces;
+    }
+
+  } // anonymous
+
   class Audio::Impl
   {
   public:
 
       typedef std::unordered_map<std::string, AudioChannelPtr> ChannelList;
 
+      typedef std::vector<AudioChannel*> ChannelIdList;
+
+      typedef std::vector<float, AlignedAllocator<float, 64>> SampleVector;
+
+      // Spectrum computed within an input generation
+      struct SpectrumCacheEntry
+      {
+          std::string  channel_name;
+          std::size_t  sample_count;
+          std::size_t  spectrum_size;
+          bool         normalised;
+          float        multiplier;
+          uint64_t     generation;
+          SampleVector spectrum;
+
+          bool matches (std::string const& channel_name, std::size_t sample_count, std::size_t spectrum_size,
+                        bool normalised, float multiplier) const;
+      };
+
+      typedef std::vector<SpectrumCacheEntry> SpectrumCache;
+
+      // Sampling rate of stored samples
+      VisAudioSampleRateType sample_rate;
+
+      // Guards the channel lists, as channels are created on input while other threads look them up
+      mutable std::mutex channels_mutex;
+
       ChannelList channels;
 
-      void upload_to_channel (std::string const& name, BufferConstPtr const& samples, Time const& timestamp);
+      // Channels indexed by handle
+      ChannelIdList channels_by_id;
+
+      // Conversion scratch space, reused across uploads
+      SampleVector input_samples1;
+      SampleVector input_samples2;
+      SampleVector resampled_samples;
+
+      // Incremented after every input
+      std::atomic<uint64_t> generation;
+
+      // Guards the spectrum cache and workspaces, as get_spectrum() may be called from several threads
+      std::mutex spectrum_mutex;
+
+      SpectrumCache spectrum_cache;
+
+      // DFTs and input storage for get_spectrum(), reused across calls
+      SpectrumWorkspaceList spectrum_workspaces;
+
+      // Guards the analysis and its workspace, as get_analysis() may be called from several threads
+      std::mutex analysis_mutex;
+
+      // Analysis of the stereo downmix, and the number of left channel samples stored before and since its last
+      // update
+      std::unique_ptr<AudioAnalysis> analysis;
+      std::atomic<uint64_t>          samples_written;
+      uint64_t                       samples_analysed;
+      SampleVector                   analysis_samples;
+
+      Impl ();
+
+      void upload_to_channel (std::string const& name, float const* samples, std::size_t count,
+                              VisAudioSampleRateType rate, Time const& timestamp);
+
+      void count_written (AudioChannel* channel, std::size_t count);
 
       AudioChannel* get_channel (std::string const& name) const;
+
+      AudioChannel* get_channel (VisAudioChannelId id) const;
+
+      AudioChannel* add_channel (std::string const& name);
+
+      void clear_channels ();
+
+      bool mix_channel (float* dest, std::size_t count, AudioChannel* channel, float gain);
+
+      void mix_channels (float* dest, std::size_t count, VisAudioChannelId const* channel_ids, float const* gains,
+                         unsigned int channels, float factor);
+
+      std::size_t get_mixable_count (VisAudioChannelId const* channel_ids, unsigned int channels) const;
+
+      bool lookup_spectrum (float* spectrum, std::size_t spectrum_size, std::size_t sample_count,
+                            std::string const& channel_name, bool normalised, float multiplier,
+                            uint64_t generation) const;
+
+      void store_spectrum (float const* spectrum, std::size_t spectrum_size, std::size_t sample_count,
+                           std::string const& channel_name, bool normalised, float multiplier,
+                           uint64_t generation);
+
+      static void reserve_samples (SampleVector& samples, std::size_t count);
   };
 
   class AudioChannel
   {
   public:
 
-      std::string name;
-      AudioStream stream;
+      std::string       name;
+      VisAudioChannelId id;
+      AudioStream       stream;
+
+      // Converts input to the stream's sampling rate
+      std::unique_ptr<AudioResampler> resampler;
 
-      explicit AudioChannel (std::string const& name);
+      AudioChannel (std::string const& name, unsigned int sample_rate);
 
       ~AudioChannel ();
 
@@ -68,43 +215,271 @@ namespace LV {
       AudioChannel (AudioChannel const&) = delete;
       AudioChannel& operator= (AudioChannel const&) = delete;
 
-      void add_samples (BufferConstPtr const& samples, Time const& timestamp);
+      void add_samples (float const* samples, std::size_t count, Time const& timestamp);
   };
 
   namespace {
 
-    void sample_buffer_mix (BufferPtr const& dest, BufferPtr const& src, float multiplier)
+    // Process-wide table of channel name handles
+    class ChannelIdTable
     {
-        visual_return_if_fail (dest->get_size () == src->get_size ());
+    public:
+
+        ChannelIdTable ()
+        {
+            // Predefined handles
+            ids[VISUAL_AUDIO_CHANNEL_LEFT]  = VISUAL_AUDIO_CHANNEL_ID_LEFT;
+            ids[VISUAL_AUDIO_CHANNEL_RIGHT] = VISUAL_AUDIO_CHANNEL_ID_RIGHT;
+        }
+
+        VisAudioChannelId get_id (std::string const& name)
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+
+            auto entry = ids.find (name);
+            if (entry != ids.end ())
+                return entry->second;
 
-        auto dbuf = static_cast<float*> (dest->get_data ());
-        auto const sbuf = static_cast<float const*> (src->get_data ());
+            VisAudioChannelId id = ids.size ();
+            ids.emplace (name, id);
 
-        std::size_t scnt = dest->get_size () / sizeof (float);
+            return id;
+        }
 
-        for (unsigned int i = 0; i < scnt; i++)
-            dbuf[i] += sbuf[i] * multiplier;
+    private:
+
+        std::mutex mutex;
+        std::unordered_map<std::string, VisAudioChannelId> ids;
+    };
+
+    ChannelIdTable& get_channel_id_table ()
+    {
+        static ChannelIdTable table;
+        return table;
     }
 
+    VisAudioChannelId const analysis_channel_ids[] = { VISUAL_AUDIO_CHANNEL_ID_LEFT, VISUAL_AUDIO_CHANNEL_ID_RIGHT };
+
+    float const analysis_channel_gains[] = { 0.5f, 0.5f };
+
+    // Maximum number of samples analysed per update. Older samples are skipped.
+    std::size_t const max_analysis_count = 16384;
+
   } // anonymous
 
-  void Audio::Impl::upload_to_channel (std::string const& name, BufferConstPtr const& samples, Time const& timestamp)
+  Audio::Impl::Impl ()
+      : sample_rate      (VISUAL_AUDIO_SAMPLE_RATE_44100)
+      , generation       (0)
+      , samples_written  (0)
+      , samples_analysed (0)
+  {
+      // empty
+  }
+
+  bool Audio::Impl::SpectrumCacheEntry::matches (std::string const& channel_name_,
+                                                 std::size_t        sample_count_,
+                                                 std::size_t        spectrum_size_,
+                                                 bool               normalised_,
+                                                 float              multiplier_) const
+  {
+      return sample_count  == sample_count_
+          && spectrum_size == spectrum_size_
+          && normalised    == normalised_
+          && multiplier    == multiplier_
+          && channel_name  == channel_name_;
+  }
+
+  bool Audio::Impl::lookup_spectrum (float*             spectrum,
+                                     std::size_t        spectrum_size,
+                                     std::size_t        sample_count,
+                                     std::string const& channel_name,
+                                     bool               normalised,
+                                     float              multiplier,
+                                     uint64_t           generation) const
+  {
+      for (auto const& entry : spectrum_cache) {
+          if (entry.generation == generation &&
+              entry.matches (channel_name, sample_count, spectrum_size, normalised, multiplier)) {
+              std::copy (entry.spectrum.begin (), entry.spectrum.begin () + spectrum_size, spectrum);
+              return true;
+          }
+      }
+
+      return false;
+  }
+
+  void Audio::Impl::store_spectrum (float const*       spectrum,
+                                    std::size_t        spectrum_size,
+                                    std::size_t        sample_count,
+                                    std::string const& channel_name,
+                                    bool               normalised,
+                                    float              multiplier,
+                                    uint64_t           generation)
+  {
+      // Reuse an entry with the same key, or failing that, any entry from an older generation
+      SpectrumCacheEntry* slot = nullptr;
+
+      for (auto& entry : spectrum_cache) {
+          if (entry.matches (channel_name, sample_count, spectrum_size, normalised, multiplier)) {
+              slot = &entry;
+              break;
+          }
+
+          if (!slot && entry.generation != generation) {
+              slot = &entry;
+          }
+      }
+
+      if (!slot) {
+          spectrum_cache.emplace_back ();
+          slot = &spectrum_cache.back ();
+      }
+
+      slot->channel_name  = channel_name;
+      slot->sample_count  = sample_count;
+      slot->spectrum_size = spectrum_size;
+      slot->normalised    = normalised;
+      slot->multiplier    = multiplier;
+      slot->generation    = generation;
+
+      reserve_samples (slot->spectrum, spectrum_size);
+      std::copy (spectrum, spectrum + spectrum_size, slot->spectrum.begin ());
+  }
+
+  void Audio::Impl::upload_to_channel (std::string const&     name,
+                                       float const*           samples,
+                                       std::size_t            count,
+                                       VisAudioSampleRateType rate,
+                                       Time const&            timestamp)
+  {
+      auto channel = get_channel (name);
+
+      if (!channel) {
+          channel = add_channel (name);
+      }
+
+      unsigned int output_rate = visual_audio_sample_rate_get_length (sample_rate);
+      unsigned int input_rate = visual_audio_sample_rate_get_length (rate);
+
+      // Samples of unspecified rate are assumed to be at the stream's rate
+      if (input_rate == 0 || input_rate == output_rate) {
+          channel->resampler.reset ();
+          channel->add_samples (samples, count, timestamp);
+          count_written (channel, count);
+          return;
+      }
+
+      if (!channel->resampler || channel->resampler->get_input_rate () != input_rate) {
+          channel->resampler.reset (new AudioResampler (input_rate, output_rate));
+      }
+
+      reserve_samples (resampled_samples, channel->resampler->get_max_output_count (count));
+
+      auto resampled_count = channel->resampler->process (resampled_samples.data (), samples, count);
+
+      channel->add_samples (resampled_samples.data (), resampled_count, timestamp);
+      count_written (channel, resampled_count);
+  }
+
+  void Audio::Impl::count_written (AudioChannel* channel, std::size_t count)
   {
-      if (!get_channel (name)) {
-          channels[name] = make_unique<AudioChannel> (name);
+      if (channel->id == VISUAL_AUDIO_CHANNEL_ID_LEFT) {
+          samples_written.fetch_add (count, std::memory_order_release);
       }
+  }
 
-      channels[name]->add_samples (samples, timestamp);
+  void Audio::Impl::reserve_samples (SampleVector& samples, std::size_t count)
+  {
+      // Only ever grow, so that steady-state uploads do not allocate
+      if (samples.size () < count) {
+          samples.resize (count);
+      }
   }
 
   AudioChannel* Audio::Impl::get_channel (std::string const& name) const
   {
+      std::lock_guard<std::mutex> lock (channels_mutex);
+
       auto entry = channels.find (name);
       return entry != channels.end () ? entry->second.get () : nullptr;
   }
 
-  AudioChannel::AudioChannel (std::string const& name_)
-      : name (name_)
+  AudioChannel* Audio::Impl::get_channel (VisAudioChannelId id) const
+  {
+      std::lock_guard<std::mutex> lock (channels_mutex);
+
+      return id < channels_by_id.size () ? channels_by_id[id] : nullptr;
+  }
+
+  AudioChannel* Audio::Impl::add_channel (std::string const& name)
+  {
+      // Allocate the stream outside the lock, so that lookups are never held up by it
+      auto channel = new AudioChannel (name, visual_audio_sample_rate_get_length (sample_rate));
+
+      std::lock_guard<std::mutex> lock (channels_mutex);
+
+      channels[name] = AudioChannelPtr (channel);
+
+      if (channels_by_id.size () <= channel->id) {
+          channels_by_id.resize (channel->id + 1, nullptr);
+      }
+
+      channels_by_id[channel->id] = channel;
+
+      return channel;
+  }
+
+  void Audio::Impl::clear_channels ()
+  {
+      std::lock_guard<std::mutex> lock (channels_mutex);
+
+      channels_by_id.clear ();
+      channels.clear ();
+  }
+
+  bool Audio::Impl::mix_channel (float* dest, std::size_t count, AudioChannel* channel, float gain)
+  {
+      if (!channel || count == 0)
+          return true;
+
+      return channel->stream.mix (dest, count, gain);
+  }
+
+  void Audio::Impl::mix_channels (float* dest, std::size_t count, VisAudioChannelId const* channel_ids,
+                                  float const* gains, unsigned int channels, float factor)
+  {
+      // Start over if any channel was overwritten while being mixed
+      for (bool complete = false; !complete; ) {
+          std::fill (dest, dest + count, 0.0f);
+
+          complete = true;
+
+          for (unsigned int i = 0; i < channels; i++) {
+              auto channel = get_channel (channel_ids[i]);
+              auto gain    = gains ? gains[i] * factor : factor;
+
+              complete = mix_channel (dest, count, channel, gain) && complete;
+          }
+      }
+  }
+
+  std::size_t Audio::Impl::get_mixable_count (VisAudioChannelId const* channel_ids, unsigned int channels) const
+  {
+      // Missing channels hold no samples
+      std::size_t count = std::numeric_limits<std::size_t>::max ();
+
+      for (unsigned int i = 0; i < channels; i++) {
+          auto channel = get_channel (channel_ids[i]);
+          count = std::min (count, channel ? channel->stream.get_size () / sizeof (float) : 0);
+      }
+
+      return count;
+  }
+
+  AudioChannel::AudioChannel (std::string const& name_, unsigned int sample_rate)
+      : name   (name_)
+      , id     (Audio::get_channel_id (name_))
+      , stream (sample_rate)
   {}
 
   AudioChannel::~AudioChannel ()
@@ -112,9 +487,9 @@ namespace LV {
       // empty
   }
 
-  void AudioChannel::add_samples (BufferConstPtr const& samples, Time const& timestamp)
+  void AudioChannel::add_samples (float const* samples, std::size_t count, Time const& timestamp)
   {
-      stream.write (samples, timestamp);
+      stream.write (samples, count, timestamp);
   }
 
   Audio::Audio ()
@@ -154,6 +529,18 @@ namespace LV {
       return true;
   }
 
+  bool Audio::get_sample (BufferPtr const& buffer, std::string const& channel_name, Time const& end_time)
+  {
+      auto channel = m_impl->get_channel (channel_name);
+
+      if (!channel || channel->stream.read_window (buffer, end_time, buffer->get_size () / sizeof (float)) == 0) {
+          buffer->fill (0);
+          return false;
+      }
+
+      return true;
+  }
+
   void Audio::get_sample_mixed_simple (BufferPtr const& buffer, unsigned int channels, ...)
   {
       va_list args;
@@ -167,21 +554,26 @@ namespace LV {
   {
       visual_return_if_fail (channels > 0);
 
-      std::vector<std::string> channel_ids (channels);
-
-      for (unsigned int i = 0; i < channels; i++)
-          channel_ids[i] = va_arg (args, const char *);
+      auto dest  = static_cast<float*> (buffer->get_data ());
+      auto count = buffer->get_size () / sizeof (float);
 
       float factor = 1.0 / channels;
 
-      auto channel_samples = Buffer::create (buffer->get_size ());
-      buffer->fill (0);
+      // Start over if any channel was overwritten while being mixed
+      for (bool complete = false; !complete; ) {
+          std::fill (dest, dest + count, 0.0f);
 
-      // The mixing loop
-      for (unsigned int i = 0; i < channels; i++) {
-          if (get_sample (channel_samples, channel_ids[i])) {
-              sample_buffer_mix (buffer, channel_samples, factor);
+          va_list names;
+          va_copy (names, args);
+
+          complete = true;
+
+          for (unsigned int i = 0; i < channels; i++) {
+              auto channel = m_impl->get_channel (va_arg (names, const char *));
+              complete = m_impl->mix_channel (dest, count, channel, factor) && complete;
           }
+
+          va_end (names);
       }
   }
 
@@ -198,56 +590,170 @@ namespace LV {
   {
       visual_return_if_fail (channels > 0);
 
-      std::vector<std::string> channel_ids (channels);
-      for (unsigned int i = 0; i < channels; i++) {
-          channel_ids[i] = va_arg (args, const char *);
+      auto dest  = static_cast<float*> (buffer->get_data ());
+      auto count = buffer->get_size () / sizeof (float);
+
+      float factor = divide ? (1.0 / channels) : 1.0;
+
+      // Start over if any channel was overwritten while being mixed
+      for (bool complete = false; !complete; ) {
+          std::fill (dest, dest + count, 0.0f);
+
+          // Channel names are followed by their weights
+          va_list names, weights;
+          va_copy (names, args);
+          va_copy (weights, args);
+
+          for (unsigned int i = 0; i < channels; i++)
+              va_arg (weights, const char *);
+
+          complete = true;
+
+          for (unsigned int i = 0; i < channels; i++) {
+              auto channel = m_impl->get_channel (va_arg (names, const char *));
+              auto gain    = va_arg (weights, double) * factor;
+
+              complete = m_impl->mix_channel (dest, count, channel, gain) && complete;
+          }
+
+          va_end (weights);
+          va_end (names);
       }
+  }
+
+  void Audio::get_sample_mixed (BufferPtr const& buffer, VisAudioChannelId const* channel_ids, float const* gains,
+                                unsigned int channels, bool divide)
+  {
+      visual_return_if_fail (channel_ids != nullptr);
+      visual_return_if_fail (channels > 0);
 
-      std::vector<double> channel_factors (channels);
-      for (unsigned int i = 0; i < channels; i++)
-          channel_factors[i] = va_arg (args, double);
+      auto dest  = static_cast<float*> (buffer->get_data ());
+      auto count = buffer->get_size () / sizeof (float);
 
       float factor = divide ? (1.0 / channels) : 1.0;
 
-      auto channel_samples = Buffer::create (buffer->get_size ());
-      buffer->fill (0);
+      m_impl->mix_channels (dest, count, channel_ids, gains, channels, factor);
+  }
 
-      // The mixing loop
-      for (unsigned int i = 0; i < channels; i++) {
-          if (get_sample (channel_samples, channel_ids[i])) {
-              sample_buffer_mix (buffer, channel_samples, channel_factors[i] * factor);
+  void Audio::set_sample_rate (VisAudioSampleRateType rate)
+  {
+      visual_return_if_fail (rate > VISUAL_AUDIO_SAMPLE_RATE_NONE && rate < VISUAL_AUDIO_SAMPLE_RATE_LAST);
+
+      if (rate == m_impl->sample_rate)
+          return;
+
+      // Stored samples are discarded
+      m_impl->sample_rate = rate;
+      m_impl->clear_channels ();
+
+      std::lock_guard<std::mutex> lock (m_impl->analysis_mutex);
+
+      m_impl->analysis.reset ();
+      m_impl->samples_analysed = m_impl->samples_written.load (std::memory_order_acquire);
+
+      m_impl->generation.fetch_add (1, std::memory_order_release);
+  }
+
+  VisAudioSampleRateType Audio::get_sample_rate () const
+  {
+      return m_impl->sample_rate;
+  }
+
+  VisAudioChannelId Audio::get_channel_id (std::string const& channel_name)
+  {
+      return get_channel_id_table ().get_id (channel_name);
+  }
+
+  AudioAnalysis const& Audio::get_analysis ()
+  {
+      std::lock_guard<std::mutex> lock (m_impl->analysis_mutex);
+
+      if (!m_impl->analysis) {
+          m_impl->analysis.reset (new AudioAnalysis (visual_audio_sample_rate_get_length (m_impl->sample_rate)));
+      }
+
+      auto written = m_impl->samples_written.load (std::memory_order_acquire);
+
+      if (written != m_impl->samples_analysed) {
+          auto count = std::size_t (std::min<uint64_t> (written - m_impl->samples_analysed, max_analysis_count));
+
+          // Samples may have expired from the streams since they were written. Mixing more than the streams hold
+          // would pad the downmix with silence and trigger false onsets.
+          count = std::min (count, m_impl->get_mixable_count (analysis_channel_ids, 2));
+
+          if (count > 0) {
+              Impl::reserve_samples (m_impl->analysis_samples, count);
+
+              m_impl->mix_channels (m_impl->analysis_samples.data (), count,
+                                    analysis_channel_ids, analysis_channel_gains, 2, 1.0f);
+
+              m_impl->analysis->process (m_impl->analysis_samples.data (), count);
           }
+
+          m_impl->samples_analysed = written;
       }
+
+      return *m_impl->analysis;
   }
 
   void Audio::get_spectrum (BufferPtr const& buffer, std::size_t samplelen, std::string const& channel_name, bool normalised)
   {
-      auto sample = Buffer::create (samplelen);
-
-      if (get_sample (sample, channel_name))
-          get_spectrum_for_sample (buffer, sample, normalised);
-      else
-          buffer->fill (0);
+      get_spectrum (buffer, samplelen, channel_name, normalised, 1.0f);
   }
 
   void Audio::get_spectrum (BufferPtr const& buffer, std::size_t samplelen, std::string const& channel_name, bool normalised, float multiplier)
   {
-      get_spectrum (buffer, samplelen, channel_name, normalised);
-
       auto data = static_cast<float*> (buffer->get_data ());
       std::size_t datasize = buffer->get_size () / sizeof (float);
 
-      visual_math_simd_mul_floats_float (data, data, multiplier, datasize);
+      std::lock_guard<std::mutex> lock (m_impl->spectrum_mutex);
+
+      // Spectra are reused until the next input
+      auto generation = m_impl->generation.load (std::memory_order_acquire);
+
+      if (m_impl->lookup_spectrum (data, datasize, samplelen, channel_name, normalised, multiplier, generation))
+          return;
+
+      // NOTE: samplelen has always been taken as a size in bytes, as it used to size a temporary sample Buffer
+      auto sample_count = samplelen / sizeof (float);
+      auto channel      = m_impl->get_channel (channel_name);
+
+      if (!channel || sample_count == 0) {
+          buffer->fill (0);
+          return;
+      }
+
+      auto& workspace = get_spectrum_workspace (m_impl->spectrum_workspaces, datasize, sample_count);
+      auto& samples   = workspace.samples;
+
+      if (samples.size () < sample_count) {
+          samples.resize (sample_count);
+      }
+
+      // Pad with silence if the channel holds fewer samples
+      auto read_count = channel->stream.read (samples.data (), sample_count);
+      std::fill (samples.begin () + read_count, samples.begin () + sample_count, 0.0f);
+
+      workspace.dft.perform (data, samples.data ());
+
+      if (normalised)
+          DFT::log_scale_standard (data, data, datasize);
+
+      if (multiplier != 1.0f)
+          visual_math_simd_mul_floats_float (data, data, multiplier, datasize);
+
+      m_impl->store_spectrum (data, datasize, samplelen, channel_name, normalised, multiplier, generation);
   }
 
   void Audio::get_spectrum_for_sample (BufferPtr const& buffer, BufferConstPtr const& sample, bool normalised)
   {
-      DFT dft (buffer->get_size () / sizeof (float),
-               sample->get_size () / sizeof (float));
+      auto& workspace = get_spectrum_workspace (get_thread_spectrum_workspaces (),
+                                                buffer->get_size () / sizeof (float),
+                                                sample->get_size () / sizeof (float));
 
       // Fourier analyze the pcm data
-      dft.perform (static_cast<float*> (buffer->get_data ()),
-                   static_cast<float*> (sample->get_data ()));
+      workspace.dft.perform (static_cast<float*> (buffer->get_data ()),
+                             static_cast<float*> (sample->get_data ()));
 
       if (normalised)
           normalise_spectrum (buffer);
@@ -279,22 +785,23 @@ namespace LV {
 
       auto sample_count = buffer->get_size () / visual_audio_sample_format_get_size (format);
 
-      auto converted_buffer = Buffer::create (sample_count * sizeof (float));
-
-      AudioConvert::convert_samples (converted_buffer,
-                                     VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT,
-                                     buffer,
-                                     format);
-
       switch (channeltype) {
           case VISUAL_AUDIO_SAMPLE_CHANNEL_STEREO: {
-              auto samples1 = Buffer::create (sample_count/2 * sizeof (float));
-              auto samples2 = Buffer::create (sample_count/2 * sizeof (float));
+              auto frame_count = sample_count / 2;
+
+              Impl::reserve_samples (m_impl->input_samples1, frame_count);
+              Impl::reserve_samples (m_impl->input_samples2, frame_count);
 
-              AudioConvert::deinterleave_stereo_samples (samples1, samples2, converted_buffer, VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT);
+              AudioConvert::deinterleave_stereo_to_float (m_impl->input_samples1.data (),
+                                                          m_impl->input_samples2.data (),
+                                                          buffer->get_data (),
+                                                          format,
+                                                          frame_count);
 
-              m_impl->upload_to_channel (VISUAL_AUDIO_CHANNEL_LEFT, samples1, timestamp);
-              m_impl->upload_to_channel (VISUAL_AUDIO_CHANNEL_RIGHT, samples2, timestamp);
+              m_impl->upload_to_channel (VISUAL_AUDIO_CHANNEL_LEFT, m_impl->input_samples1.data (), frame_count, rate, timestamp);
+              m_impl->upload_to_channel (VISUAL_AUDIO_CHANNEL_RIGHT, m_impl->input_samples2.data (), frame_count, rate, timestamp);
+
+              m_impl->generation.fetch_add (1, std::memory_order_release);
 
               return;
           }
@@ -314,14 +821,22 @@ namespace LV {
 
       auto sample_count = buffer->get_size () / visual_audio_sample_format_get_size (format);
 
-      auto converted_buffer = Buffer::create (sample_count * sizeof (float));
+      // Float samples can be written out as is
+      if (format == VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT) {
+          m_impl->upload_to_channel (channel_name, static_cast<float const*> (buffer->get_data ()), sample_count, rate, timestamp);
+      } else {
+          Impl::reserve_samples (m_impl->input_samples1, sample_count);
+
+          AudioConvert::convert_samples (m_impl->input_samples1.data (),
+                                         VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT,
+                                         buffer->get_data (),
+                                         format,
+                                         buffer->get_size ());
 
-      AudioConvert::convert_samples (converted_buffer,
-                                     VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT,
-                                     buffer,
-                                     format);
+          m_impl->upload_to_channel (channel_name, m_impl->input_samples1.data (), sample_count, rate, timestamp);
+      }
 
-      m_impl->upload_to_channel (channel_name, converted_buffer, timestamp);
+      m_impl->generation.fetch_add (1, std::memory_order_release);
   }
 
 } // LV namespace
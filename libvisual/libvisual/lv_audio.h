@@ -25,6 +25,7 @@
 #define _LV_AUDIO_H
 
 #include <libvisual/lv_buffer.h>
+#include <libvisual/lv_time.h>
 
 /**
  * @defgroup VisAudio VisAudio
@@ -34,6 +35,16 @@
 #define VISUAL_AUDIO_CHANNEL_LEFT  "left"
 #define VISUAL_AUDIO_CHANNEL_RIGHT "right"
 
+/**
+ * Handle to a channel name, valid across all VisAudio objects.
+ *
+ * @see visual_audio_get_channel_id()
+ */
+typedef unsigned int VisAudioChannelId;
+
+#define VISUAL_AUDIO_CHANNEL_ID_LEFT  0 /**< Handle to VISUAL_AUDIO_CHANNEL_LEFT */
+#define VISUAL_AUDIO_CHANNEL_ID_RIGHT 1 /**< Handle to VISUAL_AUDIO_CHANNEL_RIGHT */
+
 typedef enum {
     VISUAL_AUDIO_SAMPLE_RATE_NONE = 0,
     VISUAL_AUDIO_SAMPLE_RATE_8000,
@@ -71,10 +82,13 @@ typedef enum {
 
 namespace LV {
 
+  class AudioAnalysis;
+
   /**
    * Multi-channel audio stream class.
    *
-   * @note Samples are stored as 32-bit floating point PCM at 44.1kHz.
+   * @note Samples are stored as 32-bit floating point PCM at a single sampling rate, 44.1kHz unless set otherwise.
+   * Input at other rates is resampled.
    */
   class LV_API Audio
   {
@@ -116,6 +130,23 @@ namespace LV {
        */
       bool get_sample (BufferPtr const& buffer, std::string const& channel_name);
 
+      /**
+       * Retrieves the samples from a channel that were captured up to a given time.
+       *
+       * This is used to align audio with video, e.g. by passing the presentation time of the next frame. Sample
+       * times are derived from the capture timestamps of each input and the sampling rate. If the channel does not
+       * yet hold samples as recent as end_time, the most recent samples are retrieved instead.
+       *
+       * @note Output samples will be truncated to fit the user-supplied buffer.
+       *
+       * @param[out] buffer  buffer to hold the retrieved samples (32-bit floating point PCM)
+       * @param channel_name name of channel
+       * @param end_time     capture time of the sample following the last sample to retrieve
+       *
+       * @return true if successful, false if channel does not exist or holds no samples up to end_time
+       */
+      bool get_sample (BufferPtr const& buffer, std::string const& channel_name, Time const& end_time);
+
       /**
        * Returns samples downmixed by averaging a set of channels.
        *
@@ -143,11 +174,76 @@ namespace LV {
 
       void get_sample_mixed (BufferPtr const& buffer, bool divide, unsigned int channels, va_list args);
 
+      /**
+       * Returns samples downmixed by weighted summing or averaging a set of channels.
+       *
+       * Samples are mixed straight out of each channel's stream, without any intermediate copies or memory
+       * allocation.
+       *
+       * @note Output samples will be truncated to fit the user-supplied buffer.
+       *
+       * @param[out] buffer buffer to hold the mixed samples (32-bit floating point PCM)
+       * @param channel_ids array of channel handles
+       * @param gains       array of respective channel weights, or nullptr to weigh all channels equally
+       * @param channels    number of channels
+       * @param divide      perform averaging
+       */
+      void get_sample_mixed (BufferPtr const& buffer, VisAudioChannelId const* channel_ids, float const* gains,
+                             unsigned int channels, bool divide);
+
+      /**
+       * Sets the sampling rate at which samples are stored.
+       *
+       * All input is resampled to this rate, so that a given number of samples always spans the same duration. A rate
+       * lower than that of the input reduces the cost of analysis.
+       *
+       * @note Changing the rate discards all stored samples.
+       *
+       * @note Channels are destroyed along with their samples, so this must not be called while another thread is
+       * adding or retrieving samples.
+       *
+       * @param rate sampling rate
+       */
+      void set_sample_rate (VisAudioSampleRateType rate);
+
+      /**
+       * Returns the sampling rate at which samples are stored.
+       *
+       * @return sampling rate
+       */
+      VisAudioSampleRateType get_sample_rate () const;
+
+      /**
+       * Returns the handle to a channel name.
+       *
+       * Handles are allocated on first use, and never change for the lifetime of the program.
+       *
+       * @param channel_name name of channel
+       *
+       * @return channel handle
+       */
+      static VisAudioChannelId get_channel_id (std::string const& channel_name);
+
+      /**
+       * Returns the beat and onset analysis of the stereo downmix.
+       *
+       * The analysis is updated with samples added since the last call, at most once per input, so that any number of
+       * plugins can query it every frame at little cost. Updates are serialised, but the returned analysis is updated
+       * in place, so threads sharing an Audio object should copy out what they need before the next call.
+       *
+       * @see AudioAnalysis
+       *
+       * @return analysis
+       */
+      AudioAnalysis const& get_analysis ();
+
       /**
        * Returns the amplitude spectrum of a set of samples from a channel.
        *
        * @note The output spectrum will be truncated to fit the user-supplied buffer.
        *
+       * @note Spectra are cached until the next input. Repeated requests with the same parameters are not recomputed.
+       *
        * @param[out] buffer  buffer to hold the amplitude spectrum (32-bit floats)
        * @param sample_count number of samples to draw from channel
        * @param channel_name name of channel
@@ -222,8 +318,15 @@ LV_API VisAudio *visual_audio_new (void);
 LV_API void visual_audio_free (VisAudio *audio);
 
 LV_API int  visual_audio_get_sample (VisAudio *audio, VisBuffer *buffer, const char *channelid);
+LV_API int  visual_audio_get_sample_at_time (VisAudio *audio, VisBuffer *buffer, const char *channelid, VisTime *end_time);
 LV_API void visual_audio_get_sample_mixed_simple (VisAudio *audio, VisBuffer *buffer, unsigned int channels, ...);
 LV_API void visual_audio_get_sample_mixed (VisAudio *audio, VisBuffer *buffer, int divide, unsigned int channels, ...);
+LV_API void visual_audio_get_sample_mixed_channels (VisAudio *audio, VisBuffer *buffer, const VisAudioChannelId *channel_ids, const float *gains, unsigned int channels, int divide);
+
+LV_API VisAudioChannelId visual_audio_get_channel_id (const char *channel_name);
+
+LV_API void visual_audio_set_sample_rate (VisAudio *audio, VisAudioSampleRateType rate);
+LV_API VisAudioSampleRateType visual_audio_get_sample_rate (VisAudio *audio);
 
 LV_API void visual_audio_get_spectrum (VisAudio *audio, VisBuffer *buffer, int samplelen, const char *channelid, int normalised);
 LV_API void visual_audio_get_spectrum_multiplied (VisAudio *audio, VisBuffer *buffer, int samplelen, const char *channelid, int normalised, float multiplier);
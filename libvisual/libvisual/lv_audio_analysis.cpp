@@ -0,0 +1,425 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_audio_analysis.h"
+#include "lv_common.h"
+#include "lv_fourier.h"
+#include "lv_math.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace LV {
+
+  namespace {
+
+    unsigned int const frame_size    = 1024;
+    unsigned int const hop_size      = frame_size / 2;
+    unsigned int const spectrum_size = frame_size / 2 + 1;
+
+    unsigned int const band_count = VISUAL_AUDIO_ANALYSIS_BAND_COUNT;
+
+    // Upper edges of all but the last band (Hz)
+    float const band_edges[band_count - 1] = { 150.0f, 400.0f, 1000.0f, 2500.0f, 6000.0f };
+
+    // Spectral magnitudes are compressed with log (1 + k * x) before computing the flux, so that quiet and loud
+    // passages produce comparable onsets
+    float const flux_compression = 1000.0f;
+
+    // An onset is a spectral flux above onset_ratio times its average over the last onset_average_time seconds, plus
+    // onset_floor. Onsets are at least min_onset_interval seconds apart.
+    double const onset_average_time = 0.5;
+    float  const onset_ratio        = 1.5f;
+    float  const onset_floor        = 0.01f;
+    double const min_onset_interval = 0.1;
+
+    // A band onset is a band energy above band_onset_ratio times its moving average, which has a time constant of
+    // band_average_time seconds
+    double const band_average_time = 1.0;
+    float  const band_onset_ratio  = 1.5f;
+
+    // Tempo is estimated over the last tempo_history_time seconds, preferring tempi near preferred_tempo
+    double const tempo_history_time = 6.0;
+    float  const min_tempo          = 60.0f;
+    float  const max_tempo          = 180.0f;
+    float  const preferred_tempo    = 120.0f;
+
+  } // anonymous namespace
+
+  class AudioAnalysis::Impl
+  {
+  public:
+
+      unsigned int sample_rate;
+      double       hop_time;
+
+      DFT dft;
+
+      // Samples of the frame being filled
+      std::vector<float> frame;
+      unsigned int       frame_fill;
+
+      std::vector<float> spectrum;
+      std::vector<float> compressed;
+      std::vector<float> prev_compressed;
+
+      unsigned int band_start[band_count + 1];
+      float        band_energy[band_count];
+      float        band_average[band_count];
+      unsigned int band_onset_age[band_count];
+      bool         band_onset[band_count];
+
+      float        flux;
+      bool         onset;
+      unsigned int onset_age;
+      unsigned int min_onset_age;
+
+      // Ring of past spectral flux values
+      std::vector<float> flux_history;
+      unsigned int       flux_history_pos;
+      unsigned int       flux_history_count;
+      unsigned int       onset_average_count;
+
+      std::vector<float> tempo_work;
+      float              tempo;
+      float              tempo_confidence;
+
+      uint64_t frame_count;
+
+      explicit Impl (unsigned int sample_rate);
+
+      void reset ();
+
+      void analyse_frame ();
+
+      void estimate_tempo ();
+  };
+
+  AudioAnalysis::Impl::Impl (unsigned int sample_rate_)
+      : sample_rate     (sample_rate_)
+      , hop_time        (double (hop_size) / sample_rate)
+      , dft             (spectrum_size, frame_size, VISUAL_DFT_WINDOW_HANN)
+      , frame           (frame_size)
+      , spectrum        (spectrum_size)
+      , compressed      (spectrum_size)
+      , prev_compressed (spectrum_size)
+      , min_onset_age   (std::ceil (min_onset_interval / hop_time))
+      , flux_history    (std::ceil (tempo_history_time / hop_time))
+      , onset_average_count (std::ceil (onset_average_time / hop_time))
+  {
+      // Map band edges to spectrum bins
+      double bins_per_hz = double (frame_size) / sample_rate;
+
+      band_start[0] = 0;
+
+      for (unsigned int i = 0; i < band_count - 1; i++) {
+          band_start[i + 1] = std::min (spectrum_size, (unsigned int) (band_edges[i] * bins_per_hz + 0.5));
+      }
+
+      band_start[band_count] = spectrum_size;
+
+      reset ();
+  }
+
+  void AudioAnalysis::Impl::reset ()
+  {
+      frame_fill = 0;
+
+      std::fill (prev_compressed.begin (), prev_compressed.end (), 0.0f);
+
+      for (unsigned int i = 0; i < band_count; i++) {
+          band_energy[i]    = 0.0f;
+          band_average[i]   = 0.0f;
+          band_onset_age[i] = min_onset_age;
+          band_onset[i]     = false;
+      }
+
+      flux      = 0.0f;
+      onset     = false;
+      onset_age = min_onset_age;
+
+      flux_history_pos   = 0;
+      flux_history_count = 0;
+
+      tempo            = 0.0f;
+      tempo_confidence = 0.0f;
+
+      frame_count = 0;
+  }
+
+  void AudioAnalysis::Impl::analyse_frame ()
+  {
+      dft.perform (spectrum.data (), frame.data ());
+
+      // Spectral flux, i.e. the summed increase in compressed magnitude across bins
+      for (unsigned int i = 0; i < spectrum_size; i++) {
+          compressed[i] = 1.0f + flux_compression * spectrum[i];
+      }
+
+      visual_math_simd_log_floats (compressed.data (), compressed.data (), spectrum_size);
+
+      float flux_sum = 0.0f;
+
+      for (unsigned int i = 0; i < spectrum_size; i++) {
+          flux_sum += std::max (0.0f, compressed[i] - prev_compressed[i]);
+      }
+
+      std::swap (compressed, prev_compressed);
+
+      // The first frame has no predecessor to compare against
+      flux = frame_count > 0 ? flux_sum / spectrum_size : 0.0f;
+
+      // Compare against the average of recent values
+      unsigned int average_count = std::min (onset_average_count, flux_history_count);
+
+      float flux_average = 0.0f;
+
+      for (unsigned int i = 1; i <= average_count; i++) {
+          flux_average += flux_history[(flux_history_pos + flux_history.size () - i) % flux_history.size ()];
+      }
+
+      if (average_count > 0) {
+          flux_average /= average_count;
+      }
+
+      onset_age++;
+
+      if (flux > onset_ratio * flux_average + onset_floor && onset_age >= min_onset_age) {
+          onset     = true;
+          onset_age = 0;
+      }
+
+      flux_history[flux_history_pos] = flux;
+      flux_history_pos = (flux_history_pos + 1) % flux_history.size ();
+      flux_history_count = std::min<unsigned int> (flux_history_count + 1, flux_history.size ());
+
+      // Band energies
+      float alpha = hop_time / band_average_time;
+
+      for (unsigned int band = 0; band < band_count; band++) {
+          unsigned int start = band_start[band];
+          unsigned int end   = band_start[band + 1];
+
+          float energy = 0.0f;
+
+          for (unsigned int i = start; i < end; i++) {
+              energy += spectrum[i] * spectrum[i];
+          }
+
+          energy = end > start ? energy / (end - start) : 0.0f;
+
+          band_energy[band] = energy;
+
+          if (frame_count == 0) {
+              band_average[band] = energy;
+          }
+
+          band_onset_age[band]++;
+
+          if (energy > band_onset_ratio * band_average[band] && band_onset_age[band] >= min_onset_age) {
+              band_onset[band]     = true;
+              band_onset_age[band] = 0;
+          }
+
+          band_average[band] += (energy - band_average[band]) * alpha;
+      }
+
+      frame_count++;
+  }
+
+  void AudioAnalysis::Impl::estimate_tempo ()
+  {
+      unsigned int min_lag = std::floor (60.0 / (max_tempo * hop_time));
+      unsigned int max_lag = std::ceil  (60.0 / (min_tempo * hop_time));
+
+      // Require a few periods of the slowest tempo
+      unsigned int count = flux_history_count;
+
+      if (count < 2 * max_lag + 1) {
+          tempo = 0.0f;
+          tempo_confidence = 0.0f;
+          return;
+      }
+
+      // Unroll the ring into chronological order, without its mean
+      tempo_work.resize (count);
+
+      unsigned int start = (flux_history_pos + flux_history.size () - count) % flux_history.size ();
+
+      float mean = 0.0f;
+
+      for (unsigned int i = 0; i < count; i++) {
+          tempo_work[i] = flux_history[(start + i) % flux_history.size ()];
+          mean += tempo_work[i];
+      }
+
+      mean /= count;
+
+      for (unsigned int i = 0; i < count; i++) {
+          tempo_work[i] -= mean;
+      }
+
+      auto autocorrelation = [&] (unsigned int lag) {
+          float sum = 0.0f;
+
+          for (unsigned int i = 0; i + lag < count; i++) {
+              sum += tempo_work[i] * tempo_work[i + lag];
+          }
+
+          return sum / (count - lag);
+      };
+
+      float energy = autocorrelation (0);
+
+      if (energy <= 0.0f) {
+          tempo = 0.0f;
+          tempo_confidence = 0.0f;
+          return;
+      }
+
+      // Pick the strongest periodicity, weighted by a log-Gaussian preference around preferred_tempo to avoid
+      // doubling or halving the tempo
+      unsigned int best_lag    = 0;
+      float        best_score  = 0.0f;
+      float        best_value  = 0.0f;
+
+      for (unsigned int lag = min_lag; lag <= max_lag; lag++) {
+          float value  = autocorrelation (lag);
+          float octave = std::log2 (60.0f / (lag * hop_time) / preferred_tempo);
+          float score  = value * std::exp (-0.5f * octave * octave);
+
+          if (score > best_score) {
+              best_lag   = lag;
+              best_score = score;
+              best_value = value;
+          }
+      }
+
+      if (best_lag == 0) {
+          tempo = 0.0f;
+          tempo_confidence = 0.0f;
+          return;
+      }
+
+      // Refine the lag by fitting a parabola through the neighbouring values
+      float lag = best_lag;
+
+      float prev = autocorrelation (best_lag - 1);
+      float next = autocorrelation (best_lag + 1);
+      float curvature = prev - 2 * best_value + next;
+
+      if (curvature < 0.0f) {
+          lag += 0.5f * (prev - next) / curvature;
+      }
+
+      tempo = std::min (max_tempo, std::max (min_tempo, float (60.0 / (lag * hop_time))));
+      tempo_confidence = std::min (1.0f, best_value / energy);
+  }
+
+  AudioAnalysis::AudioAnalysis (unsigned int sample_rate)
+      : m_impl (new Impl (sample_rate))
+  {
+      // empty
+  }
+
+  AudioAnalysis::~AudioAnalysis ()
+  {
+      // empty
+  }
+
+  unsigned int AudioAnalysis::get_sample_rate () const
+  {
+      return m_impl->sample_rate;
+  }
+
+  void AudioAnalysis::process (float const* samples, std::size_t count)
+  {
+      visual_return_if_fail (samples != nullptr || count == 0);
+
+      m_impl->onset = false;
+      std::fill (m_impl->band_onset, m_impl->band_onset + band_count, false);
+
+      auto frame_count = m_impl->frame_count;
+
+      while (count > 0) {
+          auto& frame = m_impl->frame;
+          auto& fill  = m_impl->frame_fill;
+
+          std::size_t chunk = std::min (count, std::size_t (frame_size - fill));
+
+          std::copy (samples, samples + chunk, frame.begin () + fill);
+          fill    += chunk;
+          samples += chunk;
+          count   -= chunk;
+
+          if (fill == frame_size) {
+              m_impl->analyse_frame ();
+
+              // Slide by a hop
+              std::copy (frame.begin () + hop_size, frame.end (), frame.begin ());
+              fill = frame_size - hop_size;
+          }
+      }
+
+      if (m_impl->frame_count != frame_count) {
+          m_impl->estimate_tempo ();
+      }
+  }
+
+  void AudioAnalysis::reset ()
+  {
+      m_impl->reset ();
+  }
+
+  float AudioAnalysis::get_spectral_flux () const
+  {
+      return m_impl->flux;
+  }
+
+  float AudioAnalysis::get_band_energy (unsigned int band) const
+  {
+      visual_return_val_if_fail (band < band_count, 0.0f);
+
+      return m_impl->band_energy[band];
+  }
+
+  bool AudioAnalysis::is_onset () const
+  {
+      return m_impl->onset;
+  }
+
+  bool AudioAnalysis::is_band_onset (unsigned int band) const
+  {
+      visual_return_val_if_fail (band < band_count, false);
+
+      return m_impl->band_onset[band];
+  }
+
+  float AudioAnalysis::get_tempo () const
+  {
+      return m_impl->tempo;
+  }
+
+  float AudioAnalysis::get_tempo_confidence () const
+  {
+      return m_impl->tempo_confidence;
+  }
+
+} // LV namespace
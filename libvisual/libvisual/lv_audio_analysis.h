@@ -0,0 +1,169 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _LV_AUDIO_ANALYSIS_H
+#define _LV_AUDIO_ANALYSIS_H
+
+#include <libvisual/lv_audio.h>
+
+/**
+ * @defgroup VisAudioAnalysis VisAudioAnalysis
+ * @{
+ */
+
+/**
+ * Number of frequency bands tracked by VisAudioAnalysis.
+ *
+ * Band edges are at 150Hz, 400Hz, 1kHz, 2.5kHz and 6kHz.
+ */
+#define VISUAL_AUDIO_ANALYSIS_BAND_COUNT 6
+
+#ifdef __cplusplus
+
+#include <memory>
+
+namespace LV {
+
+  /**
+   * Beat and onset analysis of an audio signal.
+   *
+   * Samples are analysed in frames of 1024 samples, overlapping by half. For each frame, the analysis computes the
+   * spectral flux and the energy of each of a set of frequency bands, and detects onsets by comparing them against
+   * their recent averages. The tempo is estimated from the periodicity of the spectral flux over the last few
+   * seconds.
+   *
+   * @see Audio::get_analysis()
+   */
+  class LV_API AudioAnalysis
+  {
+  public:
+
+      /**
+       * Creates an analysis.
+       *
+       * @param sample_rate sampling rate of the input
+       */
+      explicit AudioAnalysis (unsigned int sample_rate);
+
+      AudioAnalysis (AudioAnalysis const&) = delete;
+
+      /**
+       * Destructor
+       */
+      ~AudioAnalysis ();
+
+      AudioAnalysis& operator= (AudioAnalysis const&) = delete;
+
+      /**
+       * Returns the sampling rate of the input.
+       */
+      unsigned int get_sample_rate () const;
+
+      /**
+       * Analyses a block of samples, continuing from the previous block.
+       *
+       * Results reflect the frames completed within the block. Onsets are reported if they occurred in any of these
+       * frames.
+       *
+       * @param samples array of samples
+       * @param count   number of samples
+       */
+      void process (float const* samples, std::size_t count);
+
+      /**
+       * Discards all analysis state.
+       */
+      void reset ();
+
+      /**
+       * Returns the spectral flux of the most recent frame.
+       *
+       * Spectral flux measures the increase in spectral magnitude from the previous frame, and peaks at note onsets.
+       */
+      float get_spectral_flux () const;
+
+      /**
+       * Returns the energy of a frequency band in the most recent frame.
+       *
+       * @param band band index, less than VISUAL_AUDIO_ANALYSIS_BAND_COUNT
+       */
+      float get_band_energy (unsigned int band) const;
+
+      /**
+       * Returns whether an onset was detected in the last processed block.
+       */
+      bool is_onset () const;
+
+      /**
+       * Returns whether the energy of a frequency band rose sharply in the last processed block.
+       *
+       * @param band band index, less than VISUAL_AUDIO_ANALYSIS_BAND_COUNT
+       */
+      bool is_band_onset (unsigned int band) const;
+
+      /**
+       * Returns the estimated tempo.
+       *
+       * @return tempo in beats per minute, within [60, 180], or 0 if there is no estimate yet
+       */
+      float get_tempo () const;
+
+      /**
+       * Returns the confidence in the estimated tempo.
+       *
+       * @return confidence in [0, 1]
+       */
+      float get_tempo_confidence () const;
+
+  private:
+
+      class Impl;
+
+      const std::unique_ptr<Impl> m_impl;
+  };
+
+} // LV namespace
+
+#endif /* __cplusplus */
+
+#ifdef __cplusplus
+typedef LV::AudioAnalysis VisAudioAnalysis;
+#else
+typedef struct _VisAudioAnalysis VisAudioAnalysis;
+struct _VisAudioAnalysis;
+#endif
+
+LV_BEGIN_DECLS
+
+LV_API const VisAudioAnalysis *visual_audio_get_analysis (VisAudio *audio);
+
+LV_API float visual_audio_analysis_get_spectral_flux    (const VisAudioAnalysis *analysis);
+LV_API float visual_audio_analysis_get_band_energy      (const VisAudioAnalysis *analysis, unsigned int band);
+LV_API int   visual_audio_analysis_is_onset             (const VisAudioAnalysis *analysis);
+LV_API int   visual_audio_analysis_is_band_onset        (const VisAudioAnalysis *analysis, unsigned int band);
+LV_API float visual_audio_analysis_get_tempo            (const VisAudioAnalysis *analysis);
+LV_API float visual_audio_analysis_get_tempo_confidence (const VisAudioAnalysis *analysis);
+
+LV_END_DECLS
+
+/**
+ * @}
+ */
+
+#endif /* _LV_AUDIO_ANALYSIS_H */
@@ -0,0 +1,71 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_audio_analysis.h"
+#include "lv_common.h"
+
+const VisAudioAnalysis *visual_audio_get_analysis (VisAudio *audio)
+{
+    visual_return_val_if_fail (audio != nullptr, nullptr);
+
+    return &audio->get_analysis ();
+}
+
+float visual_audio_analysis_get_spectral_flux (const VisAudioAnalysis *self)
+{
+    visual_return_val_if_fail (self != nullptr, 0.0f);
+
+    return self->get_spectral_flux ();
+}
+
+float visual_audio_analysis_get_band_energy (const VisAudioAnalysis *self, unsigned int band)
+{
+    visual_return_val_if_fail (self != nullptr, 0.0f);
+
+    return self->get_band_energy (band);
+}
+
+int visual_audio_analysis_is_onset (const VisAudioAnalysis *self)
+{
+    visual_return_val_if_fail (self != nullptr, FALSE);
+
+    return self->is_onset ();
+}
+
+int visual_audio_analysis_is_band_onset (const VisAudioAnalysis *self, unsigned int band)
+{
+    visual_return_val_if_fail (self != nullptr, FALSE);
+
+    return self->is_band_onset (band);
+}
+
+float visual_audio_analysis_get_tempo (const VisAudioAnalysis *self)
+{
+    visual_return_val_if_fail (self != nullptr, 0.0f);
+
+    return self->get_tempo ();
+}
+
+float visual_audio_analysis_get_tempo_confidence (const VisAudioAnalysis *self)
+{
+    visual_return_val_if_fail (self != nullptr, 0.0f);
+
+    return self->get_tempo_confidence ();
+}
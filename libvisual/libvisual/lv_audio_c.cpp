@@ -45,6 +45,15 @@ int visual_audio_get_sample (VisAudio *self, VisBuffer *buffer, const char *chan
     return self->get_sample (LV::BufferPtr (buffer), channel_name);
 }
 
+int visual_audio_get_sample_at_time (VisAudio *self, VisBuffer *buffer, const char *channel_name, VisTime *end_time)
+{
+    visual_return_val_if_fail (self     != nullptr, FALSE);
+    visual_return_val_if_fail (buffer   != nullptr, FALSE);
+    visual_return_val_if_fail (end_time != nullptr, FALSE);
+
+    return self->get_sample (LV::BufferPtr (buffer), channel_name, *end_time);
+}
+
 void visual_audio_get_sample_mixed_simple (VisAudio *self, VisBuffer *buffer, unsigned int channels, ...)
 {
     visual_return_if_fail (self   != nullptr);
@@ -69,6 +78,34 @@ void visual_audio_get_sample_mixed (VisAudio *self, VisBuffer *buffer, int divid
     va_end (args);
 }
 
+void visual_audio_get_sample_mixed_channels (VisAudio *self, VisBuffer *buffer, const VisAudioChannelId *channel_ids, const float *gains, unsigned int channels, int divide)
+{
+    visual_return_if_fail (self        != nullptr);
+    visual_return_if_fail (buffer      != nullptr);
+    visual_return_if_fail (channel_ids != nullptr);
+
+    self->get_sample_mixed (LV::BufferPtr (buffer), channel_ids, gains, channels, divide);
+}
+
+VisAudioChannelId visual_audio_get_channel_id (const char *channel_name)
+{
+    return LV::Audio::get_channel_id (channel_name);
+}
+
+void visual_audio_set_sample_rate (VisAudio *self, VisAudioSampleRateType rate)
+{
+    visual_return_if_fail (self != nullptr);
+
+    self->set_sample_rate (rate);
+}
+
+VisAudioSampleRateType visual_audio_get_sample_rate (VisAudio *self)
+{
+    visual_return_val_if_fail (self != nullptr, VISUAL_AUDIO_SAMPLE_RATE_NONE);
+
+    return self->get_sample_rate ();
+}
+
 void visual_audio_get_spectrum (VisAudio *self, VisBuffer *buffer, int samplelen, const char *channel_name, int normalised)
 {
     visual_return_if_fail (self   != nullptr);
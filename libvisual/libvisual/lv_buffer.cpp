@@ -34,11 +34,13 @@ namespace LV {
       void*       data;
       std::size_t size;
       bool        is_owner;
+      ReleaseFunc release;
 
       Impl ()
           : data (0)
           , size (0)
           , is_owner (false)
+          , release (nullptr)
       {}
 
       ~Impl ()
@@ -48,9 +50,7 @@ namespace LV {
 
       void wrap (void* data_, std::size_t size_, bool own)
       {
-          if (is_owner) {
-              visual_mem_free (data);
-          }
+          release_data ();
 
           data = data_;
           size = size_;
@@ -59,25 +59,44 @@ namespace LV {
 
       void allocate (std::size_t size_)
       {
-          if (is_owner) {
-              visual_mem_free (data);
-          }
+          release_data ();
 
           data = visual_mem_malloc0 (size_);
           size = size_;
           is_owner = true;
       }
 
+      void adopt (void* data_, std::size_t size_, ReleaseFunc release_)
+      {
+          release_data ();
+
+          data = data_;
+          size = size_;
+          is_owner = true;
+          release = release_;
+      }
+
       void free ()
       {
-          if (is_owner) {
-              visual_mem_free (data);
-          }
+          release_data ();
 
           data = 0;
           size = 0;
           is_owner = false;
       }
+
+      void release_data ()
+      {
+          if (is_owner) {
+              if (release) {
+                  release (data);
+              } else {
+                  visual_mem_free (data);
+              }
+          }
+
+          release = nullptr;
+      }
   };
 
   Buffer::Buffer ()
@@ -139,6 +158,11 @@ namespace LV {
       m_impl->allocate (size);
   }
 
+  void Buffer::adopt (void* data, std::size_t size, ReleaseFunc release)
+  {
+      m_impl->adopt (data, size, release);
+  }
+
   void* Buffer::get_data () const
   {
       return m_impl->data;
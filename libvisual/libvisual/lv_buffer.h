@@ -51,6 +51,9 @@ namespace LV {
   {
   public:
 
+      //! Function that releases a memory block owned by a Buffer
+      typedef void (*ReleaseFunc) (void* data);
+
       Buffer (Buffer const&) = delete;
 
       Buffer& operator= (Buffer const&) = delete;
@@ -125,6 +128,15 @@ namespace LV {
        */
       void allocate (std::size_t size);
 
+      /**
+       * Takes ownership of a memory block, releasing it with a given function instead of visual_mem_free().
+       *
+       * @param data    Pointer to memory block
+       * @param size    Size of memory block
+       * @param release Function to release the memory block with
+       */
+      void adopt (void* data, std::size_t size, ReleaseFunc release);
+
       /**
        * Return the pointer to the managed memory block.
        *
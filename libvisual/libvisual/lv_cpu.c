@@ -82,6 +82,10 @@ typedef struct {
 	int		hasMMX2;
 	int		hasSSE;
 	int		hasSSE2;
+	int		hasSSSE3;
+	int		hasAVX;
+	int		hasAVX2;
+	int		hasAVX512F;
 	int		has3DNow;
 	int		has3DNowExt;
 	int		hasAltiVec;
@@ -92,6 +96,7 @@ typedef struct {
 } VisCPU;
 
 static VisCPU cpu_caps;
+static VisCPU cpu_caps_detected;
 static int cpu_initialized = FALSE;
 
 /* The sigill handlers */
@@ -335,6 +340,41 @@ static void cpuid (unsigned int ax, unsigned int *p)
 }
 #endif
 
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+static void cpuid_count (unsigned int ax, unsigned int cx, unsigned int *p)
+{
+#if defined(VISUAL_ARCH_X86_64)
+	__asm __volatile
+		("xchgq %%rbx, %%rsi\n\t"
+		 "cpuid\n\t"
+		 "xchgq %%rbx, %%rsi"
+		 : "=a" (p[0]), "=S" (p[1]),
+		 "=c" (p[2]), "=d" (p[3])
+		 : "0" (ax), "2" (cx));
+#else
+	__asm __volatile
+		("movl %%ebx, %%esi\n\t"
+		 "cpuid\n\t"
+		 "xchgl %%ebx, %%esi"
+		 : "=a" (p[0]), "=S" (p[1]),
+		 "=c" (p[2]), "=d" (p[3])
+		 : "0" (ax), "2" (cx));
+#endif
+}
+
+static unsigned int xgetbv (unsigned int index)
+{
+	unsigned int eax, edx;
+
+	__asm __volatile
+		(".byte 0x0f, 0x01, 0xd0" /* xgetbv */
+		 : "=a" (eax), "=d" (edx)
+		 : "c" (index));
+
+	return eax;
+}
+#endif
+
 static unsigned int get_number_of_cores (void)
 {
 	/* See: http://stackoverflow.com/questions/150355/programmatically-find-the-number-of-cores-on-a-machine */
@@ -416,6 +456,10 @@ static void print_cpu_info (void)
 	visual_log (VISUAL_LOG_DEBUG, "CPU: MMX2 %d", cpu_caps.hasMMX2);
 	visual_log (VISUAL_LOG_DEBUG, "CPU: SSE %d", cpu_caps.hasSSE);
 	visual_log (VISUAL_LOG_DEBUG, "CPU: SSE2 %d", cpu_caps.hasSSE2);
+	visual_log (VISUAL_LOG_DEBUG, "CPU: SSSE3 %d", cpu_caps.hasSSSE3);
+	visual_log (VISUAL_LOG_DEBUG, "CPU: AVX %d", cpu_caps.hasAVX);
+	visual_log (VISUAL_LOG_DEBUG, "CPU: AVX2 %d", cpu_caps.hasAVX2);
+	visual_log (VISUAL_LOG_DEBUG, "CPU: AVX-512F %d", cpu_caps.hasAVX512F);
 	visual_log (VISUAL_LOG_DEBUG, "CPU: 3DNow %d", cpu_caps.has3DNow);
 	visual_log (VISUAL_LOG_DEBUG, "CPU: 3DNowExt %d", cpu_caps.has3DNowExt);
 #elif defined(VISUAL_ARCH_POWERPC)
@@ -482,11 +526,26 @@ void visual_cpu_initialize ()
 		cpu_caps.hasMMX  = TEST_BIT (regs2[3], 23); /* 0x0800000 */
 		cpu_caps.hasSSE  = TEST_BIT (regs2[3], 25); /* 0x2000000 */
 		cpu_caps.hasSSE2 = TEST_BIT (regs2[3], 26); /* 0x4000000 */
+		cpu_caps.hasSSSE3 = TEST_BIT (regs2[2], 9); /* 0x200 */
 		cpu_caps.hasMMX2 = cpu_caps.hasSSE; /* SSE cpus supports mmxext too */
 
 		cacheline = ((regs2[1] >> 8) & 0xFF) * 8;
 		if (cacheline > 0)
 			cpu_caps.cacheline = cacheline;
+
+		/* AVX requires the OS to save and restore the YMM registers (OSXSAVE + XCR0 bits 1 and 2) */
+		if (TEST_BIT (regs2[2], 28) && TEST_BIT (regs2[2], 27))
+			cpu_caps.hasAVX = (xgetbv (0) & 0x6) == 0x6;
+	}
+
+	if (regs[0] >= 0x00000007 && cpu_caps.hasAVX) {
+		cpuid_count (0x00000007, 0, regs2);
+
+		cpu_caps.hasAVX2 = TEST_BIT (regs2[1], 5); /* 0x20 */
+
+		/* AVX-512 additionally requires the OS to save and restore the opmask and ZMM registers (XCR0 bits 5-7) */
+		if (TEST_BIT (regs2[1], 16)) /* 0x10000 */
+			cpu_caps.hasAVX512F = (xgetbv (0) & 0xe0) == 0xe0;
 	}
 
 	cpuid (0x80000000, regs);
@@ -510,8 +569,13 @@ void visual_cpu_initialize ()
 	if (cpu_caps.hasSSE)
 		check_os_katmai_support ();
 
-	if (!cpu_caps.hasSSE)
+	if (!cpu_caps.hasSSE) {
 		cpu_caps.hasSSE2 = FALSE;
+		cpu_caps.hasSSSE3 = FALSE;
+		cpu_caps.hasAVX  = FALSE;
+		cpu_caps.hasAVX2 = FALSE;
+		cpu_caps.hasAVX512F = FALSE;
+	}
 #endif
 
 #endif /* VISUAL_ARCH_X86 || VISUAL_ARCH_X86_64 */
@@ -522,6 +586,8 @@ void visual_cpu_initialize ()
 
 	print_cpu_info ();
 
+	cpu_caps_detected = cpu_caps;
+
 	cpu_initialized = TRUE;
 }
 
@@ -566,6 +632,34 @@ int visual_cpu_has_sse2 ()
 	return cpu_caps.hasSSE2;
 }
 
+int visual_cpu_has_ssse3 ()
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	return cpu_caps.hasSSSE3;
+}
+
+int visual_cpu_has_avx ()
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	return cpu_caps.hasAVX;
+}
+
+int visual_cpu_has_avx2 ()
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	return cpu_caps.hasAVX2;
+}
+
+int visual_cpu_has_avx512f ()
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	return cpu_caps.hasAVX512F;
+}
+
 int visual_cpu_has_3dnow ()
 {
 	visual_return_val_if_fail (cpu_initialized, FALSE);
@@ -614,3 +708,75 @@ int visual_cpu_has_ldrex_strex (void)
 
 	return cpu_caps.hasLDREX_STREX;
 }
+
+int visual_cpu_set_mmx (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasMMX = enabled && cpu_caps_detected.hasMMX;
+
+	return cpu_caps.hasMMX;
+}
+
+int visual_cpu_set_sse (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasSSE = enabled && cpu_caps_detected.hasSSE;
+
+	return cpu_caps.hasSSE;
+}
+
+int visual_cpu_set_sse2 (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasSSE2 = enabled && cpu_caps_detected.hasSSE2;
+
+	return cpu_caps.hasSSE2;
+}
+
+int visual_cpu_set_ssse3 (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasSSSE3 = enabled && cpu_caps_detected.hasSSSE3;
+
+	return cpu_caps.hasSSSE3;
+}
+
+int visual_cpu_set_avx (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasAVX = enabled && cpu_caps_detected.hasAVX;
+
+	return cpu_caps.hasAVX;
+}
+
+int visual_cpu_set_avx2 (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasAVX2 = enabled && cpu_caps_detected.hasAVX2;
+
+	return cpu_caps.hasAVX2;
+}
+
+int visual_cpu_set_avx512f (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasAVX512F = enabled && cpu_caps_detected.hasAVX512F;
+
+	return cpu_caps.hasAVX512F;
+}
+
+int visual_cpu_set_neon (int enabled)
+{
+	visual_return_val_if_fail (cpu_initialized, FALSE);
+
+	cpu_caps.hasNeon = enabled && cpu_caps_detected.hasNeon;
+
+	return cpu_caps.hasNeon;
+}
@@ -96,6 +96,42 @@ LV_API int visual_cpu_has_sse (void);
  */
 LV_API int visual_cpu_has_sse2 (void);
 
+/**
+ * Returns whether processor supports SSSE3 instructions.
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @return TRUE if SSSE3 is supported, FALSE otherwise
+ */
+LV_API int visual_cpu_has_ssse3 (void);
+
+/**
+ * Returns whether processor and operating system support AVX instructions.
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @return TRUE if AVX is supported, FALSE otherwise
+ */
+LV_API int visual_cpu_has_avx (void);
+
+/**
+ * Returns whether processor and operating system support AVX2 instructions.
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @return TRUE if AVX2 is supported, FALSE otherwise
+ */
+LV_API int visual_cpu_has_avx2 (void);
+
+/**
+ * Returns whether processor and operating system support AVX-512 Foundation instructions.
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @return TRUE if AVX-512F is supported, FALSE otherwise
+ */
+LV_API int visual_cpu_has_avx512f (void);
+
 /**
  * Returns whether processor supports 3DNow!.
  *
@@ -159,6 +195,112 @@ LV_API int visual_cpu_has_neon (void);
  */
 LV_API int visual_cpu_has_ldrex_strex (void);
 
+/**
+ * Enables or disables the use of MMX instructions.
+ *
+ * Libvisual picks SIMD code paths at runtime with visual_cpu_has_mmx() and its siblings. Disabling an extension makes
+ * them report it as unsupported, which is useful for testing and benchmarking the remaining code paths. Extensions
+ * can only be enabled if the processor supports them. Other extensions are not affected.
+ *
+ * @note Only valid for x86 processors. This should not be called while other threads are using Libvisual.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if MMX is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_mmx (int enabled);
+
+/**
+ * Enables or disables the use of SSE instructions.
+ *
+ * @see visual_cpu_set_mmx()
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if SSE is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_sse (int enabled);
+
+/**
+ * Enables or disables the use of SSE2 instructions.
+ *
+ * @see visual_cpu_set_mmx()
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if SSE2 is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_sse2 (int enabled);
+
+/**
+ * Enables or disables the use of SSSE3 instructions.
+ *
+ * @see visual_cpu_set_mmx()
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if SSSE3 is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_ssse3 (int enabled);
+
+/**
+ * Enables or disables the use of AVX instructions.
+ *
+ * @see visual_cpu_set_mmx()
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if AVX is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_avx (int enabled);
+
+/**
+ * Enables or disables the use of AVX2 instructions.
+ *
+ * @see visual_cpu_set_mmx()
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if AVX2 is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_avx2 (int enabled);
+
+/**
+ * Enables or disables the use of AVX-512 Foundation instructions.
+ *
+ * @see visual_cpu_set_mmx()
+ *
+ * @note Only valid for x86 processors.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if AVX-512F is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_avx512f (int enabled);
+
+/**
+ * Enables or disables the use of NEON instructions.
+ *
+ * @see visual_cpu_set_mmx()
+ *
+ * @note Only valid for ARM processors.
+ *
+ * @param enabled TRUE to enable, FALSE to disable
+ *
+ * @return TRUE if NEON is in use, FALSE otherwise
+ */
+LV_API int visual_cpu_set_neon (int enabled);
+
 LV_END_DECLS
 
 /**
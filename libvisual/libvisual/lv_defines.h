@@ -24,6 +24,8 @@
 #ifndef _LV_DEFINES_H
 #define _LV_DEFINES_H
 
+#include <libvisual/lvconfig.h>
+
 #ifdef __cplusplus
 # define LV_C_LINKAGE extern "C"
 #else
@@ -66,6 +68,17 @@
 # define LV_UNLIKELY(x)    (x)
 #endif /* __GNUC__ >= 3 */
 
+/* Per-function instruction set selection, for use with runtime CPU dispatch. Only x86 instruction sets are selected
+ * this way, and other targets reject their names. */
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+# define LV_HAVE_ATTR_TARGET 1
+# define LV_ATTR_TARGET(isa) __attribute__ ((target (isa)))
+#else
+# define LV_ATTR_TARGET(isa) /* no target */
+#endif
+
 /* Compile-time format arguments checking macros */
 
 #if defined __GNUC__
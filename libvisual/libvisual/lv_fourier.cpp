@@ -25,9 +25,11 @@
 #include "lv_fourier.h"
 #include "lv_common.h"
 #include "lv_math.h"
+#include "lv_cpu.h"
+#include "private/lv_fourier_plan.hpp"
+#include "private/lv_fourier_kernels.hpp"
+#include <algorithm>
 #include <cmath>
-#include <vector>
-#include <unordered_map>
 
 // Log scale settings
 #define AMP_LOG_SCALE_THRESHOLD0    0.001f
@@ -35,52 +37,6 @@
 
 namespace LV {
 
-  namespace {
-
-    enum DFTMethod
-    {
-        DFT_METHOD_BRUTE_FORCE,
-        DFT_METHOD_FFT
-    };
-
-    class DFTCache
-    {
-    public:
-
-        class Entry
-        {
-        public:
-
-            std::vector<float> bitrevtable;
-            std::vector<float> sintable;
-            std::vector<float> costable;
-
-            // FIXME: Eliminate this constructor
-            Entry () {}
-
-            Entry (DFTMethod method, unsigned int sample_count);
-
-        private:
-
-            void fft_bitrev_table_init (unsigned int sample_count);
-            void fft_cossin_table_init (unsigned int sample_count);
-            void dft_cossin_table_init (unsigned int sample_count);
-        };
-
-        Entry const& get_entry (DFTMethod method, unsigned int sample_count);
-
-    private:
-
-        typedef std::unordered_map<unsigned int, Entry> Table;
-
-        Table m_cache;
-    };
-
-    DFTCache dft_cache;
-
-  } // anonymous namespace
-
-
   class DFT::Impl
   {
   public:
@@ -88,120 +44,33 @@ namespace LV {
       unsigned int       spectrum_size;
       unsigned int       samples_out;
       DFTMethod          method;
-      std::vector<float> real;
-      std::vector<float> imag;
+      DFTPlanConstPtr    plan;
+      DFTWindowConstPtr  window;
+      DFTPlan::FloatVector real;
+      DFTPlan::FloatVector imag;
 
-      Impl (unsigned int samples_out, unsigned int samples_in);
+      // FFT work arrays
+      DFTPlan::FloatVector fft_real;
+      DFTPlan::FloatVector fft_imag;
+      DFTPlan::FloatVector bluestein_work;
+
+      Impl (unsigned int samples_out, unsigned int samples_in, VisDFTWindow window);
 
       void perform_brute_force (float const* input);
-      void perform_fft_radix2_dit (float const* input);
+      void perform_fft (float* const* outputs, float const* const* inputs, unsigned int count);
 
-      DFTMethod best_method (unsigned int sample_count);
+      void separate_real_spectrum (float const* zr, float const* zi);
+      void write_output (float* output);
   };
 
-
-  namespace {
-
-    DFTCache::Entry const& DFTCache::get_entry (DFTMethod method, unsigned int sample_count)
-    {
-        auto entry = m_cache.find (sample_count);
-        if (entry != m_cache.end ())
-            return entry->second;
-
-        // FIXME: Use emplace() when libstdc++ supports it
-        m_cache[sample_count] = Entry (method, sample_count);
-
-        return m_cache[sample_count];
-    }
-
-    DFTCache::Entry::Entry (DFTMethod method, unsigned int sample_count)
-    {
-        switch (method) {
-            case DFT_METHOD_BRUTE_FORCE:
-                dft_cossin_table_init (sample_count);
-                break;
-
-            case DFT_METHOD_FFT:
-                fft_bitrev_table_init (sample_count);
-                fft_cossin_table_init (sample_count);
-                break;
-        }
-    }
-
-    void DFTCache::Entry::fft_bitrev_table_init (unsigned int sample_count)
-    {
-        bitrevtable.clear ();
-        bitrevtable.reserve (sample_count);
-
-        for (unsigned int i = 0; i < sample_count; i++)
-            bitrevtable.push_back (i);
-
-        unsigned int j = 0;
-
-        for (unsigned int i = 0; i < sample_count; i++) {
-            if (j > i) {
-                std::swap (bitrevtable[i], bitrevtable[j]);
-            }
-
-            unsigned int m = sample_count >> 1;
-
-            while (m >= 1 && j >= m) {
-                j -= m;
-                m >>= 1;
-            }
-
-            j += m;
-        }
-    }
-
-    void DFTCache::Entry::fft_cossin_table_init (unsigned int sample_count)
-    {
-        unsigned int dft_size = 2;
-        unsigned int tab_size = 0;
-
-        while (dft_size <= sample_count) {
-            tab_size++;
-            dft_size <<= 1;
-        }
-
-        sintable.clear ();
-        sintable.reserve (tab_size);
-
-        costable.clear ();
-        costable.reserve (tab_size);
-
-        dft_size = 2;
-
-        while (dft_size <= sample_count) {
-            float theta = -2.0f * VISUAL_MATH_PI / dft_size;
-
-            costable.push_back (std::cos (theta));
-            sintable.push_back (std::sin (theta));
-
-            dft_size <<= 1;
-        }
-    }
-
-    void DFTCache::Entry::dft_cossin_table_init (unsigned int sample_count)
-    {
-        sintable.clear ();
-        sintable.reserve (sample_count);
-
-        costable.clear ();
-        costable.reserve (sample_count);
-
-        for (unsigned int i = 0; i < sample_count; i++) {
-            float theta = (-2.0f * VISUAL_MATH_PI * i) / sample_count;
-
-            costable.push_back (std::cos (theta));
-            sintable.push_back (std::sin (theta));
-        }
-    }
-
-  } // anonymous namespace
-
   DFT::DFT (unsigned int samples_out, unsigned int samples_in)
-      : m_impl (new Impl (samples_out, samples_in))
+      : m_impl (new Impl (samples_out, samples_in, VISUAL_DFT_WINDOW_RECTANGULAR))
+  {
+      // empty
+  }
+
+  DFT::DFT (unsigned int samples_out, unsigned int samples_in, VisDFTWindow window)
+      : m_impl (new Impl (samples_out, samples_in, window))
   {
       // empty
   }
@@ -228,18 +97,33 @@ namespace LV {
       visual_return_if_fail (output != nullptr);
       visual_return_if_fail (input  != nullptr);
 
+      perform_batch (&output, &input, 1);
+  }
+
+  void DFT::perform_batch (float** outputs, float const** inputs, unsigned int count)
+  {
+      visual_return_if_fail (outputs != nullptr);
+      visual_return_if_fail (inputs  != nullptr);
+
+      for (unsigned int i = 0; i < count; i++) {
+          visual_return_if_fail (outputs[i] != nullptr);
+          visual_return_if_fail (inputs[i]  != nullptr);
+      }
+
       switch (m_impl->method) {
           case DFT_METHOD_BRUTE_FORCE:
-              m_impl->perform_brute_force (input);
+              for (unsigned int i = 0; i < count; i++) {
+                  m_impl->perform_brute_force (inputs[i]);
+                  m_impl->write_output (outputs[i]);
+              }
               break;
 
           case DFT_METHOD_FFT:
-              m_impl->perform_fft_radix2_dit (input);
+          case DFT_METHOD_MIXED_RADIX:
+          case DFT_METHOD_BLUESTEIN:
+              m_impl->perform_fft (outputs, inputs, count);
               break;
       }
-
-      visual_math_simd_complex_scaled_norm (output, m_impl->real.data (), m_impl->imag.data (),
-                                            1.0 / m_impl->sample_count, m_impl->samples_out);
   }
 
   void DFT::log_scale (float *output, float const* input, unsigned int size)
@@ -255,7 +139,10 @@ namespace LV {
       visual_return_if_fail (output != nullptr);
       visual_return_if_fail (input  != nullptr);
 
-      return log_scale_custom (output, input, size, AMP_LOG_SCALE_DIVISOR);
+      log_scale_custom (output, input, size, AMP_LOG_SCALE_DIVISOR);
+
+      // Keep results within [0.0, 1.0] despite approximation error near 1.0
+      visual_math_simd_clamp_floats (output, output, 0.0f, 1.0f, size);
   }
 
   void DFT::log_scale_custom (float* output, float const* input, unsigned int size, float log_scale_divisor)
@@ -263,36 +150,67 @@ namespace LV {
       visual_return_if_fail (output != nullptr);
       visual_return_if_fail (input  != nullptr);
 
-      for (unsigned int i = 0; i < size; i++) {
-          if (input[i] > AMP_LOG_SCALE_THRESHOLD0)
-              output[i] = 1.0f + log (input[i]) / log_scale_divisor;
-          else
-              output[i] = 0.0f;
+      visual_math_simd_log_scale_floats (output, input, AMP_LOG_SCALE_THRESHOLD0, 1.0f / log_scale_divisor, size);
+  }
+
+  void DFT::reduce_bands (float*              output,
+                          unsigned int        band_count,
+                          float const*        spectrum,
+                          unsigned int        spectrum_size,
+                          VisDFTBandScale     scale,
+                          VisDFTBandReduction reduction)
+  {
+      visual_return_if_fail (output   != nullptr);
+      visual_return_if_fail (spectrum != nullptr);
+      visual_return_if_fail (spectrum_size > 0);
+
+      auto table = DFTPlanCache::get_band_table (spectrum_size, band_count, scale);
+
+      auto starts = table->starts.data ();
+      auto ends   = table->ends.data ();
+
+      switch (reduction) {
+          case VISUAL_DFT_BAND_REDUCTION_MEAN:
+              for (unsigned int i = 0; i < band_count; i++) {
+                  auto width = ends[i] - starts[i];
+                  output[i] = visual_math_simd_sum_floats (spectrum + starts[i], width) / width;
+              }
+              break;
+
+          case VISUAL_DFT_BAND_REDUCTION_MAX:
+              for (unsigned int i = 0; i < band_count; i++) {
+                  output[i] = visual_math_simd_max_floats (spectrum + starts[i], ends[i] - starts[i]);
+              }
+              break;
       }
   }
 
-  DFT::Impl::Impl (unsigned int samples_out_, unsigned int samples_in_)
+  DFT::Impl::Impl (unsigned int samples_out_, unsigned int samples_in_, VisDFTWindow window_)
       : sample_count  (samples_in_),
 		spectrum_size (sample_count/2 + 1),
         samples_out   (std::min (samples_out_, spectrum_size)),
-        method        (best_method (sample_count)),
-        real          (sample_count),
-        imag          (sample_count)
+        method        (DFTPlan::best_method (sample_count)),
+        plan          (DFTPlanCache::get_plan (method, sample_count)),
+        window        (DFTPlanCache::get_window (window_, sample_count)),
+        real          (spectrum_size),
+        imag          (spectrum_size)
   {
-      // empty
-  }
+      // FFT work arrays are grown to fit batches as needed
+      if (method != DFT_METHOD_BRUTE_FORCE) {
+          fft_real.resize (plan->fft_size);
+          fft_imag.resize (plan->fft_size);
+      }
 
-  DFTMethod DFT::Impl::best_method (unsigned int sample_count)
-  {
-      if (visual_math_is_power_of_2 (sample_count))
-          return DFT_METHOD_FFT;
-      else
-          return DFT_METHOD_BRUTE_FORCE;
+      if (method == DFT_METHOD_BLUESTEIN) {
+          bluestein_work.resize (4 * plan->bluestein_size);
+      }
   }
 
   void DFT::Impl::perform_brute_force (float const* input)
   {
-      DFTCache::Entry const& fcache = dft_cache.get_entry (method, sample_count);
+      DFTPlan const& fcache = *plan;
+
+      float const* coeffs = window ? window->data () : nullptr;
 
       for (unsigned int i = 0; i < spectrum_size; i++) {
           float xr = 0.0f;
@@ -302,8 +220,10 @@ namespace LV {
           float wi = 0.0f;
 
           for (unsigned int j = 0; j < sample_count; j++) {
-              xr += input[j] * wr;
-              xi += input[j] * wi;
+              float x = coeffs ? input[j] * coeffs[j] : input[j];
+
+              xr += x * wr;
+              xi += x * wi;
 
               float wtemp = wr;
 
@@ -316,54 +236,114 @@ namespace LV {
       }
   }
 
-  void DFT::Impl::perform_fft_radix2_dit (float const* input)
+  void DFT::Impl::perform_fft (float* const* outputs, float const* const* inputs, unsigned int count)
   {
-    DFTCache::Entry const& fcache = dft_cache.get_entry (method, sample_count);
+      DFTPlan const& fcache = *plan;
 
-    for (unsigned int i = 0; i < sample_count; i++) {
-        unsigned int idx = fcache.bitrevtable[i];
+      unsigned int fft_size = fcache.fft_size;
 
-        if (idx < sample_count)
-            real[i] = input[idx];
-        else
-            real[i] = 0;
-    }
+      if (fft_real.size () < std::size_t (fft_size) * count) {
+          fft_real.resize (std::size_t (fft_size) * count);
+          fft_imag.resize (std::size_t (fft_size) * count);
+      }
 
-    unsigned int dft_size = 2;
-    unsigned int t = 0;
+      float* zr = fft_real.data ();
+      float* zi = fft_imag.data ();
 
-    while (dft_size <= sample_count) {
-        float wpr = fcache.costable[t];
-        float wpi = fcache.sintable[t];
+      // For even sizes, even and odd samples are packed into the real and imaginary parts
+      unsigned int in_offset = fcache.fft_real_packed ? 1 : 0;
+      unsigned int in_stride = fcache.fft_real_packed ? 2 : 1;
 
-        float wr = 1.0f;
-        float wi = 0.0f;
+      // Window coefficients are laid out like the input, and applied as input is loaded
+      float const* window_real = window ? window->data () : nullptr;
+      float const* window_imag = window && in_offset ? window_real + in_offset : nullptr;
 
-        unsigned int half_dft_size = dft_size >> 1;
+      // Transforms are laid out one after another, and go through each pass together
+      switch (method) {
+          case DFT_METHOD_FFT:
+              for (unsigned int i = 0; i < count; i++) {
+                  fcache.load_fft_input (zr + i * fft_size, zi + i * fft_size,
+                                         inputs[i], in_offset ? inputs[i] + in_offset : nullptr, in_stride,
+                                         window_real, window_imag);
+              }
 
-        for (unsigned int m = 0; m < half_dft_size; m++) {
-            for (unsigned int i = m; i < sample_count; i += dft_size) {
-                unsigned int j = i + half_dft_size;
+              fcache.perform_fft_passes (zr, zi, count);
+              break;
+
+          case DFT_METHOD_MIXED_RADIX:
+              for (unsigned int i = 0; i < count; i++) {
+                  fcache.load_mixed_radix_input (zr + i * fft_size, zi + i * fft_size,
+                                                 inputs[i], in_offset ? inputs[i] + in_offset : nullptr, in_stride,
+                                                 window_real, window_imag);
+              }
+
+              fcache.perform_mixed_radix_passes (zr, zi, count);
+              break;
+
+          case DFT_METHOD_BLUESTEIN: {
+              float* work = bluestein_work.data ();
+              unsigned int work_size = fcache.bluestein_size;
+
+              for (unsigned int i = 0; i < count; i++) {
+                  fcache.perform_bluestein (zr + i * fft_size, zi + i * fft_size,
+                                            inputs[i], in_offset ? inputs[i] + in_offset : nullptr, in_stride,
+                                            window_real, window_imag,
+                                            work, work + work_size, work + 2 * work_size, work + 3 * work_size);
+              }
+              break;
+          }
+
+          default:
+              return;
+      }
+
+      for (unsigned int i = 0; i < count; i++) {
+          separate_real_spectrum (zr + i * fft_size, zi + i * fft_size);
+          write_output (outputs[i]);
+      }
+  }
+
+  void DFT::Impl::separate_real_spectrum (float const* zr, float const* zi)
+  {
+      DFTPlan const& fcache = *plan;
+
+      unsigned int fft_size = fcache.fft_size;
+
+      if (!fcache.fft_real_packed) {
+          std::copy (zr, zr + samples_out, real.begin ());
+          std::copy (zi, zi + samples_out, imag.begin ());
+          return;
+      }
 
-                float tempr = wr * real[j] - wi * imag[j];
-                float tempi = wr * imag[j] + wi * real[j];
+      auto real_post = &FFTKernels::real_post;
 
-                real[j] = real[i] - tempr;
-                imag[j] = imag[i] - tempi;
+      if (visual_cpu_has_avx2 ()) {
+          real_post = &FFTKernels::real_post_avx2;
+      } else if (visual_cpu_has_sse ()) {
+          real_post = &FFTKernels::real_post_sse;
+      }
+
+      // Separate the spectra of the even and odd samples. Bins 0 and fft_size only take real values.
+      real[0] = zr[0] + zi[0];
+      imag[0] = 0.0f;
 
-                real[i] += tempr;
-                imag[i] += tempi;
-            }
+      if (samples_out > fft_size) {
+          real[fft_size] = zr[0] - zi[0];
+          imag[fft_size] = 0.0f;
+      }
 
-            float wtemp;
+      unsigned int end = std::min (samples_out, fft_size);
 
-            wr = (wtemp = wr) * wpr - wi * wpi;
-            wi = wi * wpr + wtemp * wpi;
-        }
+      if (end > 1) {
+          real_post (real.data (), imag.data (), zr, zi,
+                     fcache.fft_post_costable.data (), fcache.fft_post_sintable.data (),
+                     fft_size, 1, end);
+      }
+  }
 
-        dft_size <<= 1;
-        t++;
-    }
+  void DFT::Impl::write_output (float* output)
+  {
+      visual_math_simd_complex_scaled_norm (output, real.data (), imag.data (), 1.0 / sample_count, samples_out);
   }
 
 } // LV namespace
@@ -31,6 +31,35 @@
  * @{
  */
 
+/**
+ * Window functions applied to input samples before transformation.
+ *
+ * Windows reduce spectral leakage at the cost of frequency resolution. All windows except the rectangular window are
+ * scaled to have a mean of 1, so that the amplitudes of sinusoids are comparable across window types.
+ */
+typedef enum {
+    VISUAL_DFT_WINDOW_RECTANGULAR = 0, /**< No windowing */
+    VISUAL_DFT_WINDOW_HANN,            /**< Hann window */
+    VISUAL_DFT_WINDOW_HAMMING,         /**< Hamming window */
+    VISUAL_DFT_WINDOW_BLACKMAN         /**< Blackman window */
+} VisDFTWindow;
+
+/**
+ * Spacing of bands when reducing a spectrum to a smaller number of bands.
+ */
+typedef enum {
+    VISUAL_DFT_BAND_SCALE_LINEAR = 0, /**< Bands of equal width */
+    VISUAL_DFT_BAND_SCALE_LOG         /**< Bands of equal width on a logarithmic frequency scale, excluding DC */
+} VisDFTBandScale;
+
+/**
+ * Reduction applied to the bins of each band.
+ */
+typedef enum {
+    VISUAL_DFT_BAND_REDUCTION_MEAN = 0, /**< Mean of bins */
+    VISUAL_DFT_BAND_REDUCTION_MAX       /**< Largest bin */
+} VisDFTBandReduction;
+
 #ifdef __cplusplus
 
 #include <memory>
@@ -46,8 +75,9 @@ namespace LV {
        * Creates a DFT object used to calculate amplitude spectrums over audio data.
        *
        * @note For optimal performance, use a power-of-2 spectrum
-       * size. The current implementation does not use the Fast
-       * Fourier Transform for non powers of 2.
+       * size. Other sizes are computed with a mixed radix Fast
+       * Fourier Transform if they have no prime factors other than
+       * 2, 3 and 5, and with Bluestein's algorithm otherwise.
        *
        * @note If samples_in is smaller than 2 * samples_out, the input
        * will be padded with zeroes.
@@ -60,6 +90,19 @@ namespace LV {
        */
       DFT (unsigned int samples_out, unsigned int samples_in);
 
+      /**
+       * Creates a DFT object that applies a window function to input samples.
+       *
+       * Windowing is performed as input samples are loaded, at no extra cost.
+       *
+       * @see DFT (unsigned int, unsigned int)
+       *
+       * @param samples_out Size of output spectrum
+       * @param samples_in  Number of input samples
+       * @param window      Window function
+       */
+      DFT (unsigned int samples_out, unsigned int samples_in, VisDFTWindow window);
+
       DFT (DFT const&) = delete;
 
       /**
@@ -94,6 +137,18 @@ namespace LV {
        */
       void perform (float *output, float const* input);
 
+      /**
+       * Performs a DFT over several sets of input samples, such as the channels of an audio signal.
+       *
+       * This is equivalent to calling perform() once for each set, but faster as the sets go through each stage of
+       * the computation together.
+       *
+       * @param outputs Array of count output sample arrays
+       * @param inputs  Array of count input sample arrays with values in [-1.0, 1.0]
+       * @param count   Number of sets
+       */
+      void perform_batch (float** outputs, float const** inputs, unsigned int count);
+
       /**
        * Logarithmically scales an amplitude spectrum.
        *
@@ -110,6 +165,25 @@ namespace LV {
 
       static void log_scale_custom (float* output, float const* input, unsigned int size, float log_scale_divisor);
 
+      /**
+       * Reduces a spectrum to a smaller number of bands, e.g. for the bars of a spectrum analyzer.
+       *
+       * Every band covers at least one bin. Where bands are narrower than a bin, as happens for the lowest bands of a
+       * logarithmic scale, neighbouring bands share bins.
+       *
+       * @note Band edges are computed once per combination of spectrum size, band count and scale, and cached for
+       * the lifetime of the program.
+       *
+       * @param output        array of band_count floats
+       * @param band_count    number of bands
+       * @param spectrum      array of spectrum_size floats
+       * @param spectrum_size spectrum size
+       * @param scale         band spacing
+       * @param reduction     reduction applied to the bins of each band
+       */
+      static void reduce_bands (float* output, unsigned int band_count, float const* spectrum, unsigned int spectrum_size,
+                                VisDFTBandScale scale, VisDFTBandReduction reduction);
+
   private:
 
       class Impl;
@@ -134,14 +208,19 @@ struct _VisDFT;
 LV_BEGIN_DECLS
 
 LV_API VisDFT *visual_dft_new  (unsigned int samples_out, unsigned int samples_in);
+LV_API VisDFT *visual_dft_new_with_window (unsigned int samples_out, unsigned int samples_in, VisDFTWindow window);
 LV_API void    visual_dft_free (VisDFT *dft);
 
 LV_API void visual_dft_perform (VisDFT *dft, float *output, float const *input);
+LV_API void visual_dft_perform_batch (VisDFT *dft, float **outputs, float const **inputs, unsigned int count);
 
 LV_API void visual_dft_log_scale (float *output, float const *input, unsigned int size);
 LV_API void visual_dft_log_scale_standard (float *output, float const *input, unsigned int size);
 LV_API void visual_dft_log_scale_custom (float *output, float const *input, unsigned int size, float log_scale_divisor);
 
+LV_API void visual_dft_reduce_bands (float *output, unsigned int band_count, float const *spectrum, unsigned int spectrum_size,
+                                     VisDFTBandScale scale, VisDFTBandReduction reduction);
+
 LV_END_DECLS
 
 /**
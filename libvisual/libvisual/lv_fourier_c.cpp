@@ -9,6 +9,11 @@ extern "C" {
       return new LV::DFT (samples_out, samples_in);
   }
 
+  VisDFT *visual_dft_new_with_window (unsigned int samples_out, unsigned int samples_in, VisDFTWindow window)
+  {
+      return new LV::DFT (samples_out, samples_in, window);
+  }
+
   void visual_dft_free (VisDFT *dft)
   {
       delete dft;
@@ -21,6 +26,13 @@ extern "C" {
       self->perform (output, input);
   }
 
+  void visual_dft_perform_batch (VisDFT *self, float **outputs, float const **inputs, unsigned int count)
+  {
+      visual_return_if_fail (self != nullptr);
+
+      self->perform_batch (outputs, inputs, count);
+  }
+
   void visual_dft_log_scale (float *output, float const *input, unsigned int size)
   {
       LV::DFT::log_scale (output, input, size);
@@ -36,5 +48,11 @@ extern "C" {
       LV::DFT::log_scale_custom (output, input, size, log_scale_divisor);
   }
 
+  void visual_dft_reduce_bands (float *output, unsigned int band_count, float const *spectrum, unsigned int spectrum_size,
+                                VisDFTBandScale scale, VisDFTBandReduction reduction)
+  {
+      LV::DFT::reduce_bands (output, band_count, spectrum, spectrum_size, scale, reduction);
+  }
+
 } // C extern
 
@@ -33,7 +33,10 @@
 #include "lv_log.h"
 #include "lv_param.h"
 #include "lv_util.h"
+#include "lv_video_pool.h"
 #include "private/lv_time_system.hpp"
+#include "private/lv_fourier_plan.hpp"
+#include "private/lv_worker_pool.hpp"
 
 #include "gettext.h"
 
@@ -135,6 +138,16 @@ namespace LV
       m_impl->rng.set_seed (seed);
   }
 
+  unsigned int System::get_thread_count () const
+  {
+      return WorkerPool::get_thread_count ();
+  }
+
+  void System::set_thread_count (unsigned int count)
+  {
+      WorkerPool::set_thread_count (count);
+  }
+
   System::System (int& argc, char**& argv)
       : m_impl(new Impl)
   {
@@ -154,6 +167,9 @@ namespace LV
       // Initialize high-resolution timer system
       TimeSystem::start ();
 
+      // Plan common DFT sizes ahead of time
+      DFTPlanCache::init ();
+
       // Initialize the plugin registry
       PluginRegistry::init ();
   }
@@ -161,6 +177,9 @@ namespace LV
   System::~System ()
   {
       PluginRegistry::destroy ();
+      WorkerPool::shutdown ();
+      VideoPool::trim ();
+      DFTPlanCache::clear ();
       TimeSystem::shutdown ();
   }
 
@@ -91,6 +91,18 @@ namespace LV {
        */
       void set_rng_seed (RandomSeed seed);
 
+      /**
+       * Returns the number of threads used for data-parallel work such as scaling large videos.
+       */
+      unsigned int get_thread_count () const;
+
+      /**
+       * Sets the number of threads used for data-parallel work, including the calling thread.
+       *
+       * @param count thread count, at most 8, or 0 for one per hardware thread
+       */
+      void set_thread_count (unsigned int count);
+
   private:
 
       class Impl;
@@ -135,6 +147,10 @@ LV_API void visual_set_rng_seed (VisRandomSeed seed);
 
 LV_API VisRandomContext *visual_get_rng (void);
 
+LV_API unsigned int visual_get_thread_count (void);
+
+LV_API void visual_set_thread_count (unsigned int count);
+
 // FIXME: Move this into lv_random.h
 static inline uint32_t visual_rand (void)
 {
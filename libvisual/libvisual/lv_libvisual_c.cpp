@@ -44,4 +44,14 @@ extern "C" {
       return &LV::System::instance()->get_rng ();
   }
 
+  unsigned int visual_get_thread_count (void)
+  {
+      return LV::System::instance()->get_thread_count ();
+  }
+
+  void visual_set_thread_count (unsigned int count)
+  {
+      LV::System::instance()->set_thread_count (count);
+  }
+
 } // extern C
@@ -25,7 +25,377 @@
 #include "lv_math.h"
 #include "lv_common.h"
 #include "lv_math_orc.h"
+#include "lv_cpu.h"
 #include <math.h>
+#include <string.h>
+
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
+
+/* Natural logarithm approximation
+ *
+ * x is split into 2^e * m with m in [sqrt(1/2), sqrt(2)), using integer arithmetic only. ln(m) = ln(1 + f) is then
+ * evaluated with a degree 6 polynomial in f, fitted to minimize the maximum error over the range. */
+
+#define LOG_SQRT_HALF_BITS 0x3f3504f3
+
+static const float log_ln2 = 0.693147180559945309f;
+
+static const float log_poly[6] = {
+     1.000012755393982f,
+    -0.4998506009578705f,
+     0.3322599530220032f,
+    -0.2547237277030945f,
+     0.223288893699646f,
+    -0.14318902790546417f
+};
+
+static inline float log_approx (float x)
+{
+    int32_t ix, e;
+    float   m, f, p;
+
+    memcpy (&ix, &x, sizeof (ix));
+
+    e   = (ix - LOG_SQRT_HALF_BITS) >> 23;
+    ix -= (int32_t) ((uint32_t) e << 23);
+
+    memcpy (&m, &ix, sizeof (m));
+
+    f = m - 1.0f;
+    p = log_poly[5];
+    p = p * f + log_poly[4];
+    p = p * f + log_poly[3];
+    p = p * f + log_poly[2];
+    p = p * f + log_poly[1];
+    p = p * f + log_poly[0];
+
+    return p * f + (float) e * log_ln2;
+}
+
+static visual_size_t log_floats_c (float *dest, const float *src, visual_size_t count)
+{
+    visual_size_t i;
+
+    for (i = 0; i < count; i++) {
+        dest[i] = log_approx (src[i]);
+    }
+
+    return count;
+}
+
+static visual_size_t log_scale_floats_c (float *dest, const float *src, float threshold, float k, visual_size_t count)
+{
+    visual_size_t i;
+
+    for (i = 0; i < count; i++) {
+        dest[i] = src[i] > threshold ? 1.0f + k * log_approx (src[i]) : 0.0f;
+    }
+
+    return count;
+}
+
+static visual_size_t clamp_floats_c (float *dest, const float *src, float min, float max, visual_size_t count)
+{
+    visual_size_t i;
+
+    for (i = 0; i < count; i++) {
+        float x = src[i];
+        dest[i] = x < min ? min : (x > max ? max : x);
+    }
+
+    return count;
+}
+
+static visual_size_t mix_floats_c (float *dest, const float *src, float k, visual_size_t count)
+{
+    visual_size_t i;
+
+    for (i = 0; i < count; i++) {
+        dest[i] += src[i] * k;
+    }
+
+    return count;
+}
+
+static visual_size_t sum_floats_c (float *sum, const float *src, visual_size_t count)
+{
+    visual_size_t i;
+    float x = *sum;
+
+    for (i = 0; i < count; i++) {
+        x += src[i];
+    }
+
+    *sum = x;
+
+    return count;
+}
+
+static visual_size_t max_floats_c (float *max, const float *src, visual_size_t count)
+{
+    visual_size_t i;
+    float x = *max;
+
+    for (i = 0; i < count; i++) {
+        x = src[i] > x ? src[i] : x;
+    }
+
+    *max = x;
+
+    return count;
+}
+
+#if defined(LV_HAVE_X86_SIMD)
+
+LV_ATTR_TARGET ("sse2")
+static inline __m128 log_approx_sse2 (__m128 x)
+{
+    __m128i ix = _mm_castps_si128 (x);
+    __m128i e  = _mm_srai_epi32 (_mm_sub_epi32 (ix, _mm_set1_epi32 (LOG_SQRT_HALF_BITS)), 23);
+    __m128  m  = _mm_castsi128_ps (_mm_sub_epi32 (ix, _mm_slli_epi32 (e, 23)));
+    __m128  f  = _mm_sub_ps (m, _mm_set1_ps (1.0f));
+
+    __m128 p = _mm_set1_ps (log_poly[5]);
+    p = _mm_add_ps (_mm_mul_ps (p, f), _mm_set1_ps (log_poly[4]));
+    p = _mm_add_ps (_mm_mul_ps (p, f), _mm_set1_ps (log_poly[3]));
+    p = _mm_add_ps (_mm_mul_ps (p, f), _mm_set1_ps (log_poly[2]));
+    p = _mm_add_ps (_mm_mul_ps (p, f), _mm_set1_ps (log_poly[1]));
+    p = _mm_add_ps (_mm_mul_ps (p, f), _mm_set1_ps (log_poly[0]));
+
+    return _mm_add_ps (_mm_mul_ps (p, f), _mm_mul_ps (_mm_cvtepi32_ps (e), _mm_set1_ps (log_ln2)));
+}
+
+LV_ATTR_TARGET ("sse2")
+static visual_size_t log_floats_sse2 (float *dest, const float *src, visual_size_t count)
+{
+    visual_size_t n = count & ~(visual_size_t) 3;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 4) {
+        _mm_storeu_ps (dest + i, log_approx_sse2 (_mm_loadu_ps (src + i)));
+    }
+
+    return n;
+}
+
+LV_ATTR_TARGET ("sse2")
+static visual_size_t log_scale_floats_sse2 (float *dest, const float *src, float threshold, float k, visual_size_t count)
+{
+    __m128 const vthreshold = _mm_set1_ps (threshold);
+    __m128 const vk         = _mm_set1_ps (k);
+    __m128 const one        = _mm_set1_ps (1.0f);
+
+    visual_size_t n = count & ~(visual_size_t) 3;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 4) {
+        __m128 x    = _mm_loadu_ps (src + i);
+        __m128 mask = _mm_cmpgt_ps (x, vthreshold);
+        __m128 y    = _mm_add_ps (one, _mm_mul_ps (vk, log_approx_sse2 (x)));
+
+        _mm_storeu_ps (dest + i, _mm_and_ps (mask, y));
+    }
+
+    return n;
+}
+
+LV_ATTR_TARGET ("sse2")
+static visual_size_t clamp_floats_sse2 (float *dest, const float *src, float min, float max, visual_size_t count)
+{
+    __m128 const vmin = _mm_set1_ps (min);
+    __m128 const vmax = _mm_set1_ps (max);
+
+    visual_size_t n = count & ~(visual_size_t) 3;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 4) {
+        _mm_storeu_ps (dest + i, _mm_min_ps (_mm_max_ps (_mm_loadu_ps (src + i), vmin), vmax));
+    }
+
+    return n;
+}
+
+LV_ATTR_TARGET ("sse2")
+static visual_size_t mix_floats_sse2 (float *dest, const float *src, float k, visual_size_t count)
+{
+    __m128 const vk = _mm_set1_ps (k);
+
+    visual_size_t n = count & ~(visual_size_t) 3;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 4) {
+        _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i), _mm_mul_ps (_mm_loadu_ps (src + i), vk)));
+    }
+
+    return n;
+}
+
+LV_ATTR_TARGET ("sse2")
+static inline float hsum_sse2 (__m128 x)
+{
+    x = _mm_add_ps (x, _mm_movehl_ps (x, x));
+    x = _mm_add_ss (x, _mm_shuffle_ps (x, x, 1));
+
+    return _mm_cvtss_f32 (x);
+}
+
+LV_ATTR_TARGET ("sse2")
+static inline float hmax_sse2 (__m128 x)
+{
+    x = _mm_max_ps (x, _mm_movehl_ps (x, x));
+    x = _mm_max_ss (x, _mm_shuffle_ps (x, x, 1));
+
+    return _mm_cvtss_f32 (x);
+}
+
+LV_ATTR_TARGET ("sse2")
+static visual_size_t sum_floats_sse2 (float *sum, const float *src, visual_size_t count)
+{
+    __m128 acc0 = _mm_setzero_ps ();
+    __m128 acc1 = _mm_setzero_ps ();
+
+    visual_size_t n = count & ~(visual_size_t) 7;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps (acc0, _mm_loadu_ps (src + i));
+        acc1 = _mm_add_ps (acc1, _mm_loadu_ps (src + i + 4));
+    }
+
+    *sum += hsum_sse2 (_mm_add_ps (acc0, acc1));
+
+    return n;
+}
+
+LV_ATTR_TARGET ("sse2")
+static visual_size_t max_floats_sse2 (float *max, const float *src, visual_size_t count)
+{
+    __m128 acc = _mm_set1_ps (*max);
+
+    visual_size_t n = count & ~(visual_size_t) 3;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 4) {
+        acc = _mm_max_ps (acc, _mm_loadu_ps (src + i));
+    }
+
+    *max = hmax_sse2 (acc);
+
+    return n;
+}
+
+LV_ATTR_TARGET ("avx2")
+static inline __m256 log_approx_avx2 (__m256 x)
+{
+    __m256i ix = _mm256_castps_si256 (x);
+    __m256i e  = _mm256_srai_epi32 (_mm256_sub_epi32 (ix, _mm256_set1_epi32 (LOG_SQRT_HALF_BITS)), 23);
+    __m256  m  = _mm256_castsi256_ps (_mm256_sub_epi32 (ix, _mm256_slli_epi32 (e, 23)));
+    __m256  f  = _mm256_sub_ps (m, _mm256_set1_ps (1.0f));
+
+    __m256 p = _mm256_set1_ps (log_poly[5]);
+    p = _mm256_add_ps (_mm256_mul_ps (p, f), _mm256_set1_ps (log_poly[4]));
+    p = _mm256_add_ps (_mm256_mul_ps (p, f), _mm256_set1_ps (log_poly[3]));
+    p = _mm256_add_ps (_mm256_mul_ps (p, f), _mm256_set1_ps (log_poly[2]));
+    p = _mm256_add_ps (_mm256_mul_ps (p, f), _mm256_set1_ps (log_poly[1]));
+    p = _mm256_add_ps (_mm256_mul_ps (p, f), _mm256_set1_ps (log_poly[0]));
+
+    return _mm256_add_ps (_mm256_mul_ps (p, f), _mm256_mul_ps (_mm256_cvtepi32_ps (e), _mm256_set1_ps (log_ln2)));
+}
+
+LV_ATTR_TARGET ("avx2")
+static visual_size_t log_floats_avx2 (float *dest, const float *src, visual_size_t count)
+{
+    visual_size_t n = count & ~(visual_size_t) 7;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 8) {
+        _mm256_storeu_ps (dest + i, log_approx_avx2 (_mm256_loadu_ps (src + i)));
+    }
+
+    return n;
+}
+
+LV_ATTR_TARGET ("avx2")
+static visual_size_t log_scale_floats_avx2 (float *dest, const float *src, float threshold, float k, visual_size_t count)
+{
+    __m256 const vthreshold = _mm256_set1_ps (threshold);
+    __m256 const vk         = _mm256_set1_ps (k);
+    __m256 const one        = _mm256_set1_ps (1.0f);
+
+    visual_size_t n = count & ~(visual_size_t) 7;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 8) {
+        __m256 x    = _mm256_loadu_ps (src + i);
+        __m256 mask = _mm256_cmp_ps (x, vthreshold, _CMP_GT_OQ);
+        __m256 y    = _mm256_add_ps (one, _mm256_mul_ps (vk, log_approx_avx2 (x)));
+
+        _mm256_storeu_ps (dest + i, _mm256_and_ps (mask, y));
+    }
+
+    return n;
+}
+
+LV_ATTR_TARGET ("avx2")
+static visual_size_t mix_floats_avx2 (float *dest, const float *src, float k, visual_size_t count)
+{
+    __m256 const vk = _mm256_set1_ps (k);
+
+    visual_size_t n = count & ~(visual_size_t) 7;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 8) {
+        _mm256_storeu_ps (dest + i, _mm256_add_ps (_mm256_loadu_ps (dest + i), _mm256_mul_ps (_mm256_loadu_ps (src + i), vk)));
+    }
+
+    return n;
+}
+
+LV_ATTR_TARGET ("avx2")
+static visual_size_t sum_floats_avx2 (float *sum, const float *src, visual_size_t count)
+{
+    __m256 acc0 = _mm256_setzero_ps ();
+    __m256 acc1 = _mm256_setzero_ps ();
+
+    visual_size_t n = count & ~(visual_size_t) 15;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 16) {
+        acc0 = _mm256_add_ps (acc0, _mm256_loadu_ps (src + i));
+        acc1 = _mm256_add_ps (acc1, _mm256_loadu_ps (src + i + 8));
+    }
+
+    acc0 = _mm256_add_ps (acc0, acc1);
+
+    *sum += hsum_sse2 (_mm_add_ps (_mm256_castps256_ps128 (acc0), _mm256_extractf128_ps (acc0, 1)));
+
+    return n;
+}
+
+LV_ATTR_TARGET ("avx2")
+static visual_size_t max_floats_avx2 (float *max, const float *src, visual_size_t count)
+{
+    __m256 acc = _mm256_set1_ps (*max);
+
+    visual_size_t n = count & ~(visual_size_t) 7;
+    visual_size_t i;
+
+    for (i = 0; i < n; i += 8) {
+        acc = _mm256_max_ps (acc, _mm256_loadu_ps (src + i));
+    }
+
+    *max = hmax_sse2 (_mm_max_ps (_mm256_castps256_ps128 (acc), _mm256_extractf128_ps (acc, 1)));
+
+    return n;
+}
+
+#endif /* LV_HAVE_X86_SIMD */
 
 int visual_math_is_power_of_2 (int n)
 {
@@ -107,3 +477,102 @@ void visual_math_simd_complex_scaled_norm (float *LV_RESTRICT dest, const float
 {
     simd_complex_scaled_norm (dest, real, imag, k, (int) count);
 }
+
+void visual_math_simd_log_floats (float *dest, const float *src, visual_size_t count)
+{
+    visual_size_t done = 0;
+
+#if defined(LV_HAVE_X86_SIMD)
+    if (visual_cpu_has_avx2 ()) {
+        done = log_floats_avx2 (dest, src, count);
+    } else if (visual_cpu_has_sse2 ()) {
+        done = log_floats_sse2 (dest, src, count);
+    }
+#endif
+
+    log_floats_c (dest + done, src + done, count - done);
+}
+
+void visual_math_simd_log_scale_floats (float *dest, const float *src, float threshold, float k, visual_size_t count)
+{
+    visual_size_t done = 0;
+
+#if defined(LV_HAVE_X86_SIMD)
+    if (visual_cpu_has_avx2 ()) {
+        done = log_scale_floats_avx2 (dest, src, threshold, k, count);
+    } else if (visual_cpu_has_sse2 ()) {
+        done = log_scale_floats_sse2 (dest, src, threshold, k, count);
+    }
+#endif
+
+    log_scale_floats_c (dest + done, src + done, threshold, k, count - done);
+}
+
+void visual_math_simd_clamp_floats (float *dest, const float *src, float min, float max, visual_size_t count)
+{
+    visual_size_t done = 0;
+
+#if defined(LV_HAVE_X86_SIMD)
+    if (visual_cpu_has_sse2 ()) {
+        done = clamp_floats_sse2 (dest, src, min, max, count);
+    }
+#endif
+
+    clamp_floats_c (dest + done, src + done, min, max, count - done);
+}
+
+void visual_math_simd_mix_floats (float *LV_RESTRICT dest, const float *LV_RESTRICT src, float k, visual_size_t count)
+{
+    visual_size_t done = 0;
+
+#if defined(LV_HAVE_X86_SIMD)
+    if (visual_cpu_has_avx2 ()) {
+        done = mix_floats_avx2 (dest, src, k, count);
+    } else if (visual_cpu_has_sse2 ()) {
+        done = mix_floats_sse2 (dest, src, k, count);
+    }
+#endif
+
+    mix_floats_c (dest + done, src + done, k, count - done);
+}
+
+float visual_math_simd_sum_floats (const float *src, visual_size_t count)
+{
+    visual_size_t done = 0;
+    float sum = 0.0f;
+
+#if defined(LV_HAVE_X86_SIMD)
+    if (visual_cpu_has_avx2 ()) {
+        done = sum_floats_avx2 (&sum, src, count);
+    } else if (visual_cpu_has_sse2 ()) {
+        done = sum_floats_sse2 (&sum, src, count);
+    }
+#endif
+
+    sum_floats_c (&sum, src + done, count - done);
+
+    return sum;
+}
+
+float visual_math_simd_max_floats (const float *src, visual_size_t count)
+{
+    visual_size_t done = 0;
+    float max;
+
+    if (count == 0)
+        return 0.0f;
+
+    max = src[0];
+
+#if defined(LV_HAVE_X86_SIMD)
+    if (visual_cpu_has_avx2 ()) {
+        done = max_floats_avx2 (&max, src, count);
+    } else if (visual_cpu_has_sse2 ()) {
+        done = max_floats_sse2 (&max, src, count);
+    }
+#endif
+
+    max_floats_c (&max, src + done, count - done);
+
+    return max;
+}
@@ -196,6 +196,85 @@ LV_API void visual_math_simd_complex_norm (float *LV_RESTRICT dest, const float
  */
 LV_API void visual_math_simd_complex_scaled_norm (float *LV_RESTRICT dest, const float *LV_RESTRICT real, const float *LV_RESTRICT imag, float k, visual_size_t count);
 
+/**
+ * Calculates the natural logarithm of each float element in the input array, using SIMD instructions on supported
+ * CPUs.
+ *
+ * The logarithm is approximated with a polynomial over the mantissa. The absolute error is below 2e-6 for inputs in
+ * [1e-3, 1e3], and the relative error is below 1e-6 for all other positive normal inputs. Results for zero,
+ * negative, denormal, infinite and NaN inputs are undefined.
+ *
+ * @note Destination and source may be the same.
+ *
+ * @param dest  array to hold the results in
+ * @param src   array of positive floats
+ * @param count number of elements
+ */
+LV_API void visual_math_simd_log_floats (float *dest, const float *src, visual_size_t count);
+
+/**
+ * Logarithmically scales an array of floats, using SIMD instructions on supported CPUs.
+ *
+ * Each element x above threshold is mapped to 1 + k * log(x), and every other element to 0. The logarithm is
+ * approximated as in visual_math_simd_log_floats().
+ *
+ * @note Destination and source may be the same.
+ *
+ * @param dest      array to hold the results in
+ * @param src       array of floats
+ * @param threshold smallest value to scale, must be positive
+ * @param k         logarithm multiplicand
+ * @param count     number of elements
+ */
+LV_API void visual_math_simd_log_scale_floats (float *dest, const float *src, float threshold, float k, visual_size_t count);
+
+/**
+ * Clamps each float element in the input array to a range, using SIMD instructions on supported CPUs.
+ *
+ * @note Destination and source may be the same.
+ *
+ * @param dest  array to hold the results in
+ * @param src   array of floats
+ * @param min   lower bound
+ * @param max   upper bound
+ * @param count number of elements
+ */
+LV_API void visual_math_simd_clamp_floats (float *dest, const float *src, float min, float max, visual_size_t count);
+
+/**
+ * Adds an array of floats multiplied by a constant to another, using SIMD instructions on supported CPUs.
+ *
+ * Each destination element x is replaced with x + k * y, where y is the corresponding source element.
+ *
+ * @param dest  array of floats to add to
+ * @param src   array of floats to scale
+ * @param k     constant multiplicand
+ * @param count number of elements
+ */
+LV_API void visual_math_simd_mix_floats (float *LV_RESTRICT dest, const float *LV_RESTRICT src, float k, visual_size_t count);
+
+/**
+ * Sums an array of floats, using SIMD instructions on supported CPUs.
+ *
+ * @note Elements are summed in a different order depending on the CPU, so results may differ in rounding.
+ *
+ * @param src   array of floats
+ * @param count number of elements
+ *
+ * @return sum of elements
+ */
+LV_API float visual_math_simd_sum_floats (const float *src, visual_size_t count);
+
+/**
+ * Finds the largest element of an array of floats, using SIMD instructions on supported CPUs.
+ *
+ * @param src   array of floats
+ * @param count number of elements
+ *
+ * @return largest element, or 0 if count is 0
+ */
+LV_API float visual_math_simd_max_floats (const float *src, visual_size_t count);
+
 LV_END_DECLS
 
 /**
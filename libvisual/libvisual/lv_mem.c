@@ -28,6 +28,21 @@
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
+
+/* Copies and fills at least this large bypass the cache with streaming stores. Smaller ones are left to the C
+ * library, or use ordinary vector stores where it has no equivalent. The thresholds are where streaming starts to
+ * beat memcpy(), memset() and ordinary stores in tools/benchmarks/mem_bench. */
+#define MEM_COPY_STREAM_THRESHOLD  (2 * 1024 * 1024)
+#define MEM_SET_STREAM_THRESHOLD   (16 * 1024 * 1024)
+#define MEM_FILL_STREAM_THRESHOLD  (4 * 1024 * 1024)
+
 /* Standard C fallbacks */
 static void *mem_copy_c (void *dest, const void *src, visual_size_t n);
 static void *mem_set8_c (void *dest, int c, visual_size_t n);
@@ -37,24 +52,14 @@ static void *mem_copy_pitch_c (void *dest, const void *src, int pitch1, int pitc
 
 
 /* x86 SIMD optimized versions */
-#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
-static void *mem_copy_3dnow (void *dest, const void *src, visual_size_t n);
-static void *mem_copy_mmx (void *dest, const void *src, visual_size_t n);
-static void *mem_copy_mmx2 (void *dest, const void *src, visual_size_t n);
+#if defined(LV_HAVE_X86_SIMD)
+static void *mem_copy_simd (void *dest, const void *src, visual_size_t n);
+static void *mem_copy_pitch_simd (void *dest, const void *src, int pitch1, int pitch2, int width, int rows);
 
-static void *mem_copy_pitch_mmx (void *dest, const void *src, int pitch1, int pitch2, int width, int rows);
-static void *mem_copy_pitch_mmx2 (void *dest, const void *src, int pitch1, int pitch2, int width, int rows);
-static void *mem_copy_pitch_3dnow (void *dest, const void *src, int pitch1, int pitch2, int width, int rows);
-
-static void *mem_set8_mmx (void *dest, int c, visual_size_t n);
-static void *mem_set8_mmx2 (void *dest, int c, visual_size_t n);
-
-static void *mem_set16_mmx (void *dest, int c, visual_size_t n);
-static void *mem_set16_mmx2 (void *dest, int c, visual_size_t n);
-
-static void *mem_set32_mmx (void *dest, int c, visual_size_t n);
-static void *mem_set32_mmx2 (void *dest, int c, visual_size_t n);
-#endif /* VISUAL_ARCH_X86 || VISUAL_ARCH_X86_64 */
+static void *mem_set8_simd (void *dest, int c, visual_size_t n);
+static void *mem_set16_simd (void *dest, int c, visual_size_t n);
+static void *mem_set32_simd (void *dest, int c, visual_size_t n);
+#endif /* LV_HAVE_X86_SIMD */
 
 
 /* Optimal performance functions set by visual_mem_initialize(). */
@@ -68,9 +73,6 @@ VisMemSet32Func visual_mem_set32 = mem_set32_c;
 
 void visual_mem_initialize ()
 {
-	/* Arranged from slow to fast, so the slower version gets overloaded
-	 * every time */
-
 	visual_mem_copy = mem_copy_c;
 	visual_mem_copy_pitch = mem_copy_pitch_c;
 
@@ -78,34 +80,20 @@ void visual_mem_initialize ()
 	visual_mem_set16 = mem_set16_c;
 	visual_mem_set32 = mem_set32_c;
 
-#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
-
-	if (visual_cpu_has_mmx ()) {
-		visual_mem_copy = mem_copy_mmx;
-		visual_mem_copy_pitch = mem_copy_pitch_mmx;
-
-		visual_mem_set = mem_set8_mmx;
-		visual_mem_set16 = mem_set16_mmx;
-		visual_mem_set32 = mem_set32_mmx;
-	}
+#if defined(LV_HAVE_X86_SIMD)
 
-	/* The k6-II and k6-III don't have mmx2, but of course can use the prefetch
-	 * facility that 3dnow provides. */
-	if (visual_cpu_has_3dnow ()) {
-		visual_mem_copy = mem_copy_3dnow;
-		visual_mem_copy_pitch = mem_copy_pitch_3dnow;
-	}
-
-	if (visual_cpu_has_mmx2 ()) {
-		visual_mem_copy = mem_copy_mmx2;
-		visual_mem_copy_pitch = mem_copy_pitch_mmx2;
+	/* The SIMD versions choose between SSE2, AVX2 and AVX-512 on every call, so that the visual_cpu_set_*()
+	 * functions take effect immediately */
+	if (visual_cpu_has_sse2 ()) {
+		visual_mem_copy = mem_copy_simd;
+		visual_mem_copy_pitch = mem_copy_pitch_simd;
 
-		visual_mem_set = mem_set8_mmx2;
-		visual_mem_set16 = mem_set16_mmx2;
-		visual_mem_set32 = mem_set32_mmx2;
+		visual_mem_set = mem_set8_simd;
+		visual_mem_set16 = mem_set16_simd;
+		visual_mem_set32 = mem_set32_simd;
 	}
 
-#endif /* VISUAL_ARCH_X86 || VISUAL_ARCH_X86_64 */
+#endif /* LV_HAVE_X86_SIMD */
 }
 
 void *visual_mem_malloc (visual_size_t nbytes)
@@ -166,7 +154,7 @@ static void *mem_set16_c (void *dest, int c, visual_size_t n)
 	uint16_t *dc = dest;
 	uint32_t setflag32 =
 		(c & 0xffff) |
-		((c << 16) & 0xffff0000);
+		(((uint32_t) c << 16) & 0xffff0000);
 	uint16_t setflag16 = c & 0xffff;
 
 	while (n >= 2) {
@@ -213,693 +201,326 @@ static void *mem_copy_pitch_c (void *dest, const void *src, int pitch1, int pitc
 }
 
 
-#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#if defined(LV_HAVE_X86_SIMD)
 
-static void *mem_copy_mmx (void *dest, const void *src, visual_size_t n)
-{
-	uint32_t *d = dest;
-	const uint32_t *s = src;
-	uint8_t *dc = dest;
-	const uint8_t *sc = src;
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t movq (%0), %%mm0"
-			 "\n\t movq 8(%0), %%mm1"
-			 "\n\t movq 16(%0), %%mm2"
-			 "\n\t movq 24(%0), %%mm3"
-			 "\n\t movq 32(%0), %%mm4"
-			 "\n\t movq 40(%0), %%mm5"
-			 "\n\t movq 48(%0), %%mm6"
-			 "\n\t movq 56(%0), %%mm7"
-			 "\n\t movq %%mm0, (%1)"
-			 "\n\t movq %%mm1, 8(%1)"
-			 "\n\t movq %%mm2, 16(%1)"
-			 "\n\t movq %%mm3, 24(%1)"
-			 "\n\t movq %%mm4, 32(%1)"
-			 "\n\t movq %%mm5, 40(%1)"
-			 "\n\t movq %%mm6, 48(%1)"
-			 "\n\t movq %%mm7, 56(%1)"
-			 :: "r" (s), "r" (d) : "memory");
-
-		d += 16;
-		s += 16;
-
-		n -= 64;
-	}
+/* Streaming stores are only used on whole cache lines. Bytes before and after them are written with ordinary stores,
+ * as mixing the two in one cache line is slow. */
+
+#define MEM_LINE_SIZE 64
 
-	__asm __volatile
-		("\n\t emms");
+typedef struct {
+	visual_size_t size;
+	void (*copy_lines) (uint8_t *d, const uint8_t *s, visual_size_t lines);
+	void (*fill_lines) (uint8_t *d, uint32_t pattern, visual_size_t lines);
+	void (*fill) (uint8_t *d, uint32_t pattern, visual_size_t n);
+} MemKernels;
 
-	while (n >= 4) {
-		*d++ = *s++;
-		n -= 4;
+/* The fill kernels need n >= one vector. The first and last vectors are written with unaligned stores, which aligns
+ * the destination for the loop in between. These overlap bytes the loop writes, but with the same values. */
+
+LV_ATTR_TARGET ("sse2")
+static void mem_copy_lines_sse2 (uint8_t *d, const uint8_t *s, visual_size_t lines)
+{
+	for (; lines > 0; lines--) {
+		__m128i x0 = _mm_loadu_si128 ((const __m128i *) s);
+		__m128i x1 = _mm_loadu_si128 ((const __m128i *) (s + 16));
+		__m128i x2 = _mm_loadu_si128 ((const __m128i *) (s + 32));
+		__m128i x3 = _mm_loadu_si128 ((const __m128i *) (s + 48));
+
+		_mm_stream_si128 ((__m128i *) d, x0);
+		_mm_stream_si128 ((__m128i *) (d + 16), x1);
+		_mm_stream_si128 ((__m128i *) (d + 32), x2);
+		_mm_stream_si128 ((__m128i *) (d + 48), x3);
+
+		d += MEM_LINE_SIZE;
+		s += MEM_LINE_SIZE;
 	}
+}
 
-	dc = (uint8_t *) d;
-	sc = (const uint8_t *) s;
+LV_ATTR_TARGET ("sse2")
+static void mem_fill_lines_sse2 (uint8_t *d, uint32_t pattern, visual_size_t lines)
+{
+	__m128i v = _mm_set1_epi32 (pattern);
 
-	while (n--)
-		*dc++ = *sc++;
+	for (; lines > 0; lines--) {
+		_mm_stream_si128 ((__m128i *) d, v);
+		_mm_stream_si128 ((__m128i *) (d + 16), v);
+		_mm_stream_si128 ((__m128i *) (d + 32), v);
+		_mm_stream_si128 ((__m128i *) (d + 48), v);
 
-	return dest;
+		d += MEM_LINE_SIZE;
+	}
 }
 
-static void *mem_copy_mmx2 (void *dest, const void *src, visual_size_t n)
+LV_ATTR_TARGET ("sse2")
+static void mem_fill_sse2 (uint8_t *d, uint32_t pattern, visual_size_t n)
 {
-	uint32_t *d = dest;
-	const uint32_t *s = src;
-	uint8_t *dc = dest;
-	const uint8_t *sc = src;
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t prefetchnta 256(%0)"
-			 "\n\t prefetchnta 320(%0)"
-			 "\n\t movq (%0), %%mm0"
-			 "\n\t movq 8(%0), %%mm1"
-			 "\n\t movq 16(%0), %%mm2"
-			 "\n\t movq 24(%0), %%mm3"
-			 "\n\t movq 32(%0), %%mm4"
-			 "\n\t movq 40(%0), %%mm5"
-			 "\n\t movq 48(%0), %%mm6"
-			 "\n\t movq 56(%0), %%mm7"
-			 "\n\t movntq %%mm0, (%1)"
-			 "\n\t movntq %%mm1, 8(%1)"
-			 "\n\t movntq %%mm2, 16(%1)"
-			 "\n\t movntq %%mm3, 24(%1)"
-			 "\n\t movntq %%mm4, 32(%1)"
-			 "\n\t movntq %%mm5, 40(%1)"
-			 "\n\t movntq %%mm6, 48(%1)"
-			 "\n\t movntq %%mm7, 56(%1)"
-			 :: "r" (s), "r" (d) : "memory");
-
-		d += 16;
-		s += 16;
-
-		n -= 64;
-	}
+	uint8_t *end = d + n;
+	__m128i v = _mm_set1_epi32 (pattern);
 
-	__asm __volatile
-		("\n\t emms");
+	_mm_storeu_si128 ((__m128i *) d, v);
+	d += 16 - ((uintptr_t) d & 15);
 
-	while (n >= 4) {
-		*d++ = *s++;
-		n -= 4;
+	for (; end - d >= 64; d += 64) {
+		_mm_store_si128 ((__m128i *) d, v);
+		_mm_store_si128 ((__m128i *) (d + 16), v);
+		_mm_store_si128 ((__m128i *) (d + 32), v);
+		_mm_store_si128 ((__m128i *) (d + 48), v);
 	}
 
-	dc = (uint8_t *) d;
-	sc = (const uint8_t *) s;
-
-	while (n--)
-		*dc++ = *sc++;
+	for (; end - d >= 16; d += 16)
+		_mm_store_si128 ((__m128i *) d, v);
 
-	return dest;
+	_mm_storeu_si128 ((__m128i *) (end - 16), v);
 }
 
-static void *mem_copy_3dnow (void *dest, const void *src, visual_size_t n)
+LV_ATTR_TARGET ("avx2")
+static void mem_copy_lines_avx2 (uint8_t *d, const uint8_t *s, visual_size_t lines)
 {
-	uint32_t *d = dest;
-	const uint32_t *s = src;
-	uint8_t *dc = dest;
-	const uint8_t *sc = src;
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t prefetch 256(%0)"
-			 "\n\t prefetch 320(%0)"
-			 "\n\t movq (%0), %%mm0"
-			 "\n\t movq 8(%0), %%mm1"
-			 "\n\t movq 16(%0), %%mm2"
-			 "\n\t movq 24(%0), %%mm3"
-			 "\n\t movq 32(%0), %%mm4"
-			 "\n\t movq 40(%0), %%mm5"
-			 "\n\t movq 48(%0), %%mm6"
-			 "\n\t movq 56(%0), %%mm7"
-			 "\n\t movq %%mm0, (%1)"
-			 "\n\t movq %%mm1, 8(%1)"
-			 "\n\t movq %%mm2, 16(%1)"
-			 "\n\t movq %%mm3, 24(%1)"
-			 "\n\t movq %%mm4, 32(%1)"
-			 "\n\t movq %%mm5, 40(%1)"
-			 "\n\t movq %%mm6, 48(%1)"
-			 "\n\t movq %%mm7, 56(%1)"
-			 :: "r" (s), "r" (d) : "memory");
-
-		d += 16;
-		s += 16;
-
-		n -= 64;
-	}
+	for (; lines > 0; lines--) {
+		__m256i x0 = _mm256_loadu_si256 ((const __m256i *) s);
+		__m256i x1 = _mm256_loadu_si256 ((const __m256i *) (s + 32));
 
-	__asm __volatile
-		("\n\t emms");
+		_mm256_stream_si256 ((__m256i *) d, x0);
+		_mm256_stream_si256 ((__m256i *) (d + 32), x1);
 
-	while (n >= 4) {
-		*d++ = *s++;
-		n -= 4;
+		d += MEM_LINE_SIZE;
+		s += MEM_LINE_SIZE;
 	}
+}
 
-	dc = (uint8_t *) d;
-	sc = (const uint8_t *) s;
+LV_ATTR_TARGET ("avx2")
+static void mem_fill_lines_avx2 (uint8_t *d, uint32_t pattern, visual_size_t lines)
+{
+	__m256i v = _mm256_set1_epi32 (pattern);
 
-	while (n--)
-		*dc++ = *sc++;
+	for (; lines > 0; lines--) {
+		_mm256_stream_si256 ((__m256i *) d, v);
+		_mm256_stream_si256 ((__m256i *) (d + 32), v);
 
-	return dest;
+		d += MEM_LINE_SIZE;
+	}
 }
 
-
-static void *mem_copy_pitch_mmx (void *dest, const void *src, int pitch1, int pitch2, int width, int rows)
+LV_ATTR_TARGET ("avx2")
+static void mem_fill_avx2 (uint8_t *d, uint32_t pattern, visual_size_t n)
 {
-	uint32_t *d = dest;
-	const uint32_t *s = src;
-	int i;
+	uint8_t *end = d + n;
+	__m256i v = _mm256_set1_epi32 (pattern);
 
-	for (i = 0; i < rows; i++) {
-		uint32_t *inner_d;
-		const uint32_t *inner_s;
-		uint8_t *inner_dc = (uint8_t*) d;
-		const uint8_t *inner_sc = (const uint8_t*) s;
-		int n = width;
+	_mm256_storeu_si256 ((__m256i *) d, v);
+	d += 32 - ((uintptr_t) d & 31);
 
-                while (!VISUAL_ALIGNED(inner_dc, 4) && n > 4) {
-			*inner_dc++ = *inner_sc++;
-			n--;
-		}
+	for (; end - d >= 128; d += 128) {
+		_mm256_store_si256 ((__m256i *) d, v);
+		_mm256_store_si256 ((__m256i *) (d + 32), v);
+		_mm256_store_si256 ((__m256i *) (d + 64), v);
+		_mm256_store_si256 ((__m256i *) (d + 96), v);
+	}
 
-		inner_d = (uint32_t*) inner_dc;
-		inner_s = (const uint32_t*) inner_sc;
+	for (; end - d >= 32; d += 32)
+		_mm256_store_si256 ((__m256i *) d, v);
 
-#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
-		while (n >= 64) {
-			__asm __volatile
-				("\n\t movq (%0), %%mm0"
-				 "\n\t movq 8(%0), %%mm1"
-				 "\n\t movq 16(%0), %%mm2"
-				 "\n\t movq 24(%0), %%mm3"
-				 "\n\t movq 32(%0), %%mm4"
-				 "\n\t movq 40(%0), %%mm5"
-				 "\n\t movq 48(%0), %%mm6"
-				 "\n\t movq 56(%0), %%mm7"
-				 "\n\t movq %%mm0, (%1)"
-				 "\n\t movq %%mm1, 8(%1)"
-				 "\n\t movq %%mm2, 16(%1)"
-				 "\n\t movq %%mm3, 24(%1)"
-				 "\n\t movq %%mm4, 32(%1)"
-				 "\n\t movq %%mm5, 40(%1)"
-				 "\n\t movq %%mm6, 48(%1)"
-				 "\n\t movq %%mm7, 56(%1)"
-				 :: "r" (inner_s), "r" (inner_d) : "memory");
-
-			inner_d += 16;
-			inner_s += 16;
-
-			n -= 64;
-		}
-
-		__asm __volatile
-			("\n\t emms");
-#endif /* VISUAL_ARCH_X86 */
-
-		while (n >= 4) {
-			*inner_d++ = *inner_s++;
-			n -= 4;
-		}
-
-		inner_dc = (uint8_t*) inner_d;
-		inner_sc = (const uint8_t*) inner_s;
-
-		while (n--)
-			*inner_dc++ = *inner_sc++;
-
-		d = (uint32_t*)((uint8_t*) d + pitch1);
-		s = (const uint32_t*)((const uint8_t*) s + pitch2);
-	}
+	_mm256_storeu_si256 ((__m256i *) (end - 32), v);
+}
 
-	return dest;
+LV_ATTR_TARGET ("avx512f")
+static void mem_copy_lines_avx512f (uint8_t *d, const uint8_t *s, visual_size_t lines)
+{
+	for (; lines > 0; lines--) {
+		_mm512_stream_si512 ((__m512i *) d, _mm512_loadu_si512 (s));
+
+		d += MEM_LINE_SIZE;
+		s += MEM_LINE_SIZE;
+	}
 }
 
-static void *mem_copy_pitch_mmx2 (void *dest, const void *src, int pitch1, int pitch2, int width, int rows)
+LV_ATTR_TARGET ("avx512f")
+static void mem_fill_lines_avx512f (uint8_t *d, uint32_t pattern, visual_size_t lines)
 {
-	uint32_t *d = dest;
-	const uint32_t *s = src;
-	int i;
+	__m512i v = _mm512_set1_epi32 (pattern);
 
-	for (i = 0; i < rows; i++) {
-		uint32_t *inner_d;
-		const uint32_t *inner_s;
-		uint8_t *inner_dc = (uint8_t*) d;
-		const uint8_t *inner_sc = (const uint8_t*) s;
-		int n = width;
+	for (; lines > 0; lines--) {
+		_mm512_stream_si512 ((__m512i *) d, v);
+
+		d += MEM_LINE_SIZE;
+	}
+}
 
-                while (!VISUAL_ALIGNED(inner_dc, 4) && n > 4) {
-			*inner_dc++ = *inner_sc++;
-			n--;
-		}
+LV_ATTR_TARGET ("avx512f")
+static void mem_fill_avx512f (uint8_t *d, uint32_t pattern, visual_size_t n)
+{
+	uint8_t *end = d + n;
+	__m512i v = _mm512_set1_epi32 (pattern);
 
-		inner_d = (uint32_t*) inner_dc;
-		inner_s = (const uint32_t*) inner_sc;
+	_mm512_storeu_si512 (d, v);
+	d += 64 - ((uintptr_t) d & 63);
 
-#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
-		while (n >= 64) {
-			__asm __volatile
-				("\n\t prefetchnta 256(%0)"
-				 "\n\t prefetchnta 320(%0)"
-				 "\n\t movq (%0), %%mm0"
-				 "\n\t movq 8(%0), %%mm1"
-				 "\n\t movq 16(%0), %%mm2"
-				 "\n\t movq 24(%0), %%mm3"
-				 "\n\t movq 32(%0), %%mm4"
-				 "\n\t movq 40(%0), %%mm5"
-				 "\n\t movq 48(%0), %%mm6"
-				 "\n\t movq 56(%0), %%mm7"
-				 "\n\t movntq %%mm0, (%1)"
-				 "\n\t movntq %%mm1, 8(%1)"
-				 "\n\t movntq %%mm2, 16(%1)"
-				 "\n\t movntq %%mm3, 24(%1)"
-				 "\n\t movntq %%mm4, 32(%1)"
-				 "\n\t movntq %%mm5, 40(%1)"
-				 "\n\t movntq %%mm6, 48(%1)"
-				 "\n\t movntq %%mm7, 56(%1)"
-				 :: "r" (inner_s), "r" (inner_d) : "memory");
-
-			inner_d += 16;
-			inner_s += 16;
-
-			n -= 64;
-		}
-
-		__asm __volatile
-			("\n\t emms");
-#endif /* VISUAL_ARCH_X86 */
-
-		while (n >= 4) {
-			*inner_d++ = *inner_s++;
-			n -= 4;
-		}
-
-		inner_dc = (uint8_t*) inner_d;
-		inner_sc = (const uint8_t*) inner_s;
-
-		while (n--)
-			*inner_dc++ = *inner_sc++;
-
-		d = (uint32_t*)((uint8_t*) d + pitch1);
-		s = (const uint32_t*)((const uint8_t*) s + pitch2);
+	for (; end - d >= 256; d += 256) {
+		_mm512_store_si512 (d, v);
+		_mm512_store_si512 (d + 64, v);
+		_mm512_store_si512 (d + 128, v);
+		_mm512_store_si512 (d + 192, v);
 	}
 
-	return dest;
+	for (; end - d >= 64; d += 64)
+		_mm512_store_si512 (d, v);
+
+	_mm512_storeu_si512 (end - 64, v);
 }
 
-static void *mem_copy_pitch_3dnow (void *dest, const void *src, int pitch1, int pitch2, int width, int rows)
+/* Returns the kernels of the widest vector extension in use, or NULL if there are none */
+static const MemKernels *mem_kernels (void)
 {
-	uint32_t *d = dest;
-	const uint32_t *s = src;
-	int i;
+	static const MemKernels kernels_avx512f = { 64, mem_copy_lines_avx512f, mem_fill_lines_avx512f, mem_fill_avx512f };
+	static const MemKernels kernels_avx2    = { 32, mem_copy_lines_avx2,    mem_fill_lines_avx2,    mem_fill_avx2    };
+	static const MemKernels kernels_sse2    = { 16, mem_copy_lines_sse2,    mem_fill_lines_sse2,    mem_fill_sse2    };
 
-	for (i = 0; i < rows; i++) {
-		uint32_t *inner_d;
-		const uint32_t *inner_s;
-		uint8_t *inner_dc = (uint8_t*) d;
-		const uint8_t *inner_sc = (const uint8_t*) s;
-		int n = width;
-
-                while (!VISUAL_ALIGNED(inner_dc, 4) && n > 4) {
-			*inner_dc++ = *inner_sc++;
-			n--;
-		}
+	if (visual_cpu_has_avx512f ())
+		return &kernels_avx512f;
 
-		inner_d = (uint32_t*) inner_dc;
-		inner_s = (const uint32_t*) inner_sc;
+	if (visual_cpu_has_avx2 ())
+		return &kernels_avx2;
 
-#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
-		while (n >= 64) {
-			__asm __volatile
-				("\n\t prefetch 256(%0)"
-				 "\n\t prefetch 320(%0)"
-				 "\n\t movq (%0), %%mm0"
-				 "\n\t movq 8(%0), %%mm1"
-				 "\n\t movq 16(%0), %%mm2"
-				 "\n\t movq 24(%0), %%mm3"
-				 "\n\t movq 32(%0), %%mm4"
-				 "\n\t movq 40(%0), %%mm5"
-				 "\n\t movq 48(%0), %%mm6"
-				 "\n\t movq 56(%0), %%mm7"
-				 "\n\t movq %%mm0, (%1)"
-				 "\n\t movq %%mm1, 8(%1)"
-				 "\n\t movq %%mm2, 16(%1)"
-				 "\n\t movq %%mm3, 24(%1)"
-				 "\n\t movq %%mm4, 32(%1)"
-				 "\n\t movq %%mm5, 40(%1)"
-				 "\n\t movq %%mm6, 48(%1)"
-				 "\n\t movq %%mm7, 56(%1)"
-				 :: "r" (inner_s), "r" (inner_d) : "memory");
-
-			inner_d += 16;
-			inner_s += 16;
-
-			n -= 64;
-		}
-
-		__asm __volatile
-			("\n\t emms");
-#endif /* VISUAL_ARCH_X86 */
-
-		while (n >= 4) {
-			*inner_d++ = *inner_s++;
-			n -= 4;
-		}
-
-		inner_dc = (uint8_t*) inner_d;
-		inner_sc = (const uint8_t*) inner_s;
-
-		while (n--)
-			*inner_dc++ = *inner_sc++;
-
-		d = (uint32_t*)((uint8_t*) d + pitch1);
-		s = (const uint32_t*)((const uint8_t*) s + pitch2);
-	}
+	if (visual_cpu_has_sse2 ())
+		return &kernels_sse2;
 
-	return dest;
+	return NULL;
 }
 
-static void *mem_set8_mmx (void *dest, int c, visual_size_t n)
+static void mem_copy_stream (const MemKernels *kernels, uint8_t *d, const uint8_t *s, visual_size_t n)
 {
-	uint32_t *d = dest;
-	uint8_t *dc = dest;
-	uint32_t setflag32 =
-		(c & 0xff) |
-		((c << 8) & 0xff00) |
-		((c << 16) & 0xff0000) |
-		((c << 24) & 0xff000000);
-	uint8_t setflag8 = c & 0xff;
-
-	__asm __volatile
-		("\n\t movd (%0), %%mm0"
-		 "\n\t movd (%0), %%mm1"
-		 "\n\t psllq $32, %%mm1"
-		 "\n\t por %%mm1, %%mm0"
-		 "\n\t movq %%mm0, %%mm2"
-		 "\n\t movq %%mm0, %%mm1"
-		 "\n\t movq %%mm2, %%mm3"
-		 "\n\t movq %%mm1, %%mm4"
-		 "\n\t movq %%mm0, %%mm5"
-		 "\n\t movq %%mm2, %%mm6"
-		 "\n\t movq %%mm1, %%mm7"
-		 :: "r" (&setflag32) : "memory");
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t movq %%mm0, (%0)"
-			 "\n\t movq %%mm1, 8(%0)"
-			 "\n\t movq %%mm2, 16(%0)"
-			 "\n\t movq %%mm3, 24(%0)"
-			 "\n\t movq %%mm4, 32(%0)"
-			 "\n\t movq %%mm5, 40(%0)"
-			 "\n\t movq %%mm6, 48(%0)"
-			 "\n\t movq %%mm7, 56(%0)"
-			 :: "r" (d) : "memory");
-
-		d += 16;
-
-		n -= 64;
-	}
-
-	__asm __volatile
-		("\n\t emms");
+	visual_size_t head = (visual_size_t) -(uintptr_t) d & (MEM_LINE_SIZE - 1);
+	visual_size_t body;
 
-	while (n >= 4) {
-		*d++ = setflag32;
-		n -= 4;
+	if (n < head + MEM_LINE_SIZE) {
+		memcpy (d, s, n);
+		return;
 	}
 
-	dc = (uint8_t *) d;
-
-	while (n--)
-		*dc++ = setflag8;
+	body = (n - head) & ~(visual_size_t) (MEM_LINE_SIZE - 1);
 
-	return dest;
+	memcpy (d, s, head);
+	kernels->copy_lines (d + head, s + head, body / MEM_LINE_SIZE);
+	memcpy (d + head + body, s + head + body, n - head - body);
 }
 
-static void *mem_set8_mmx2 (void *dest, int c, visual_size_t n)
+/* Fills n bytes at d with a 32-bit pattern. d must be aligned to the element size the pattern repeats. */
+static void mem_fill_stream (const MemKernels *kernels, uint8_t *d, uint32_t pattern, visual_size_t n)
 {
-	uint32_t *d = dest;
-	uint8_t *dc = dest;
-	uint32_t setflag32 =
-		(c & 0xff) |
-		((c << 8) & 0xff00) |
-		((c << 16) & 0xff0000) |
-		((c << 24) & 0xff000000);
-	uint8_t setflag8 = c & 0xff;
-
-	__asm __volatile
-		("\n\t movd (%0), %%mm0"
-		 "\n\t movd (%0), %%mm1"
-		 "\n\t psllq $32, %%mm1"
-		 "\n\t por %%mm1, %%mm0"
-		 "\n\t movq %%mm0, %%mm2"
-		 "\n\t movq %%mm0, %%mm1"
-		 "\n\t movq %%mm2, %%mm3"
-		 "\n\t movq %%mm1, %%mm4"
-		 "\n\t movq %%mm0, %%mm5"
-		 "\n\t movq %%mm2, %%mm6"
-		 "\n\t movq %%mm1, %%mm7"
-		 :: "r" (&setflag32) : "memory");
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t movntq %%mm0, (%0)"
-			 "\n\t movntq %%mm1, 8(%0)"
-			 "\n\t movntq %%mm2, 16(%0)"
-			 "\n\t movntq %%mm3, 24(%0)"
-			 "\n\t movntq %%mm4, 32(%0)"
-			 "\n\t movntq %%mm5, 40(%0)"
-			 "\n\t movntq %%mm6, 48(%0)"
-			 "\n\t movntq %%mm7, 56(%0)"
-			 :: "r" (d) : "memory");
-
-		d += 16;
-
-		n -= 64;
+	const uint8_t *pattern_bytes = (const uint8_t *) &pattern;
+	visual_size_t head = (visual_size_t) -(uintptr_t) d & (MEM_LINE_SIZE - 1);
+	visual_size_t body;
+	visual_size_t i;
+
+	if (n < head + MEM_LINE_SIZE) {
+		kernels->fill (d, pattern, n);
+		return;
 	}
 
-	__asm __volatile
-		("\n\t emms");
+	body = (n - head) & ~(visual_size_t) (MEM_LINE_SIZE - 1);
 
-	while (n >= 4) {
-		*d++ = setflag32;
-		n -= 4;
-	}
+	for (i = 0; i < head; i++)
+		d[i] = pattern_bytes[i & 3];
 
-	dc = (uint8_t *) d;
+	kernels->fill_lines (d + head, pattern, body / MEM_LINE_SIZE);
 
-	while (n--)
-		*dc++ = setflag8;
+	for (i = head + body; i < n; i++)
+		d[i] = pattern_bytes[i & 3];
+}
+
+LV_ATTR_TARGET ("sse2")
+static void *mem_copy_simd (void *dest, const void *src, visual_size_t n)
+{
+	const MemKernels *kernels = mem_kernels ();
+
+	if (!kernels || n < MEM_COPY_STREAM_THRESHOLD)
+		return memcpy (dest, src, n);
+
+	mem_copy_stream (kernels, dest, src, n);
+	_mm_sfence ();
 
 	return dest;
 }
 
-static void *mem_set16_mmx (void *dest, int c, visual_size_t n)
+LV_ATTR_TARGET ("sse2")
+static void *mem_copy_pitch_simd (void *dest, const void *src, int pitch1, int pitch2, int width, int rows)
 {
-	uint32_t *d = dest;
-	uint16_t *dc = dest;
-	uint32_t setflag32 =
-		(c & 0xffff) |
-		((c << 16) & 0xffff0000);
-	uint16_t setflag16 = c & 0xffff;
+	const MemKernels *kernels = mem_kernels ();
+	uint8_t *d = dest;
+	const uint8_t *s = src;
+	int i;
 
-	__asm __volatile
-		("\n\t movd (%0), %%mm0"
-		 "\n\t movd (%0), %%mm1"
-		 "\n\t psllq $32, %%mm1"
-		 "\n\t por %%mm1, %%mm0"
-		 "\n\t movq %%mm0, %%mm2"
-		 "\n\t movq %%mm0, %%mm1"
-		 "\n\t movq %%mm2, %%mm3"
-		 "\n\t movq %%mm1, %%mm4"
-		 "\n\t movq %%mm0, %%mm5"
-		 "\n\t movq %%mm2, %%mm6"
-		 "\n\t movq %%mm1, %%mm7"
-		 :: "r" (&setflag32) : "memory");
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t movq %%mm0, (%0)"
-			 "\n\t movq %%mm1, 8(%0)"
-			 "\n\t movq %%mm2, 16(%0)"
-			 "\n\t movq %%mm3, 24(%0)"
-			 "\n\t movq %%mm4, 32(%0)"
-			 "\n\t movq %%mm5, 40(%0)"
-			 "\n\t movq %%mm6, 48(%0)"
-			 "\n\t movq %%mm7, 56(%0)"
-			 :: "r" (d) : "memory");
-
-		d += 16;
-
-		n -= 32;
-	}
+	if (!kernels || rows <= 0 || (visual_size_t) width * rows < MEM_COPY_STREAM_THRESHOLD)
+		return mem_copy_pitch_c (dest, src, pitch1, pitch2, width, rows);
 
-	__asm __volatile
-		("\n\t emms");
+	for (i = 0; i < rows; i++) {
+		mem_copy_stream (kernels, d, s, width);
 
-	while (n >= 2) {
-		*d++ = setflag32;
-		n -= 2;
+		d += pitch1;
+		s += pitch2;
 	}
 
-	dc = (uint16_t *) d;
-
-	while (n--)
-		*dc++ = setflag16;
+	_mm_sfence ();
 
 	return dest;
 }
 
-static void *mem_set16_mmx2 (void *dest, int c, visual_size_t n)
+LV_ATTR_TARGET ("sse2")
+static void *mem_set8_simd (void *dest, int c, visual_size_t n)
 {
-	uint32_t *d = dest;
-	uint16_t *dc = dest;
-	uint32_t setflag32 =
-		(c & 0xffff) |
-		((c << 16) & 0xffff0000);
-	uint16_t setflag16 = c & 0xffff;
-
-	__asm __volatile
-		("\n\t movd (%0), %%mm0"
-		 "\n\t movd (%0), %%mm1"
-		 "\n\t psllq $32, %%mm1"
-		 "\n\t por %%mm1, %%mm0"
-		 "\n\t movq %%mm0, %%mm2"
-		 "\n\t movq %%mm0, %%mm1"
-		 "\n\t movq %%mm2, %%mm3"
-		 "\n\t movq %%mm1, %%mm4"
-		 "\n\t movq %%mm0, %%mm5"
-		 "\n\t movq %%mm2, %%mm6"
-		 "\n\t movq %%mm1, %%mm7"
-		 :: "r" (&setflag32) : "memory");
-
-	while (n >= 32) {
-		__asm __volatile
-			("\n\t movntq %%mm0, (%0)"
-			 "\n\t movntq %%mm1, 8(%0)"
-			 "\n\t movntq %%mm2, 16(%0)"
-			 "\n\t movntq %%mm3, 24(%0)"
-			 "\n\t movntq %%mm4, 32(%0)"
-			 "\n\t movntq %%mm5, 40(%0)"
-			 "\n\t movntq %%mm6, 48(%0)"
-			 "\n\t movntq %%mm7, 56(%0)"
-			 :: "r" (d) : "memory");
-
-		d += 16;
-
-		n -= 32;
-	}
+	const MemKernels *kernels = mem_kernels ();
 
-	__asm __volatile
-		("\n\t emms");
+	if (!kernels || n < MEM_SET_STREAM_THRESHOLD)
+		return memset (dest, c, n);
 
-	while (n >= 2) {
-		*d++ = setflag32;
-		n -= 2;
-	}
-
-	dc = (uint16_t *) d;
-
-	while (n--)
-		*dc++ = setflag16;
+	mem_fill_stream (kernels, dest, (c & 0xff) * 0x01010101u, n);
+	_mm_sfence ();
 
 	return dest;
 }
 
-static void *mem_set32_mmx (void *dest, int c, visual_size_t n)
+LV_ATTR_TARGET ("sse2")
+static void *mem_set16_simd (void *dest, int c, visual_size_t n)
 {
-	uint32_t *d = dest;
-	uint32_t setflag32 = c;
-
-	__asm __volatile
-		("\n\t movd (%0), %%mm0"
-		 "\n\t movd (%0), %%mm1"
-		 "\n\t psllq $32, %%mm1"
-		 "\n\t por %%mm1, %%mm0"
-		 "\n\t movq %%mm0, %%mm2"
-		 "\n\t movq %%mm0, %%mm1"
-		 "\n\t movq %%mm2, %%mm3"
-		 "\n\t movq %%mm1, %%mm4"
-		 "\n\t movq %%mm0, %%mm5"
-		 "\n\t movq %%mm2, %%mm6"
-		 "\n\t movq %%mm1, %%mm7"
-		 :: "r" (&setflag32) : "memory");
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t movq %%mm0, (%0)"
-			 "\n\t movq %%mm1, 8(%0)"
-			 "\n\t movq %%mm2, 16(%0)"
-			 "\n\t movq %%mm3, 24(%0)"
-			 "\n\t movq %%mm4, 32(%0)"
-			 "\n\t movq %%mm5, 40(%0)"
-			 "\n\t movq %%mm6, 48(%0)"
-			 "\n\t movq %%mm7, 56(%0)"
-			 :: "r" (d) : "memory");
-
-		d += 16;
-
-		n -= 16;
+	const MemKernels *kernels = mem_kernels ();
+	uint32_t pattern = (c & 0xffff) * 0x00010001u;
+	visual_size_t size = n * 2;
+
+	/* Unlike memset(), these fills have no C library equivalent. Ordinary vector stores are used below the
+	 * threshold. */
+	if (!kernels || size < kernels->size || !VISUAL_ALIGNED (dest, 2))
+		return mem_set16_c (dest, c, n);
+
+	if (size < MEM_FILL_STREAM_THRESHOLD) {
+		kernels->fill (dest, pattern, size);
+		return dest;
 	}
 
-	__asm __volatile
-		("\n\t emms");
-
-	while (n--)
-		*d++ = setflag32;
+	mem_fill_stream (kernels, dest, pattern, size);
+	_mm_sfence ();
 
 	return dest;
 }
 
-static void *mem_set32_mmx2 (void *dest, int c, visual_size_t n)
+LV_ATTR_TARGET ("sse2")
+static void *mem_set32_simd (void *dest, int c, visual_size_t n)
 {
-	uint32_t *d = dest;
-	uint32_t setflag32 = c;
+	const MemKernels *kernels = mem_kernels ();
+	visual_size_t size = n * 4;
 
-	__asm __volatile
-		("\n\t movd (%0), %%mm0"
-		 "\n\t movd (%0), %%mm1"
-		 "\n\t psllq $32, %%mm1"
-		 "\n\t por %%mm1, %%mm0"
-		 "\n\t movq %%mm0, %%mm2"
-		 "\n\t movq %%mm0, %%mm1"
-		 "\n\t movq %%mm2, %%mm3"
-		 "\n\t movq %%mm1, %%mm4"
-		 "\n\t movq %%mm0, %%mm5"
-		 "\n\t movq %%mm2, %%mm6"
-		 "\n\t movq %%mm1, %%mm7"
-		 :: "r" (&setflag32) : "memory");
-
-	while (n >= 64) {
-		__asm __volatile
-			("\n\t movntq %%mm0, (%0)"
-			 "\n\t movntq %%mm1, 8(%0)"
-			 "\n\t movntq %%mm2, 16(%0)"
-			 "\n\t movntq %%mm3, 24(%0)"
-			 "\n\t movntq %%mm4, 32(%0)"
-			 "\n\t movntq %%mm5, 40(%0)"
-			 "\n\t movntq %%mm6, 48(%0)"
-			 "\n\t movntq %%mm7, 56(%0)"
-			 :: "r" (d) : "memory");
-
-		d += 16;
-
-		n -= 16;
-	}
+	if (!kernels || size < kernels->size || !VISUAL_ALIGNED (dest, 4))
+		return mem_set32_c (dest, c, n);
 
-	__asm __volatile
-		("\n\t emms");
+	if (size < MEM_FILL_STREAM_THRESHOLD) {
+		kernels->fill (dest, c, size);
+		return dest;
+	}
 
-	while (n--)
-		*d++ = setflag32;
+	mem_fill_stream (kernels, dest, c, size);
+	_mm_sfence ();
 
 	return dest;
 }
 
-#endif /* VISUAL_ARCH_X86 || VISUAL_ARCH_X86_64 */
+#endif /* LV_HAVE_X86_SIMD */
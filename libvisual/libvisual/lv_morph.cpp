@@ -180,6 +180,7 @@ namespace LV {
       morph_plugin->apply (m_impl->plugin, m_impl->progress, const_cast<Audio*> (&audio), m_impl->dest.get (), src1.get (), src2.get ());
 
       m_impl->dest->set_palette (*get_palette ());
+      m_impl->dest->mark_dirty ();
 
       // Update morph progression
 
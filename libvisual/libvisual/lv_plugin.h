@@ -49,8 +49,9 @@
 
 /** Plugin flags */
 typedef enum {
-	VISUAL_PLUGIN_FLAG_NONE      = 0,   /**< Used to indicate the absence of special flags */
-	VISUAL_PLUGIN_FLAG_REENTRANT = 1    /**< Indicate that plugin is safe for multiple instantiation */
+	VISUAL_PLUGIN_FLAG_NONE        = 0,   /**< Used to indicate the absence of special flags */
+	VISUAL_PLUGIN_FLAG_REENTRANT   = 1,   /**< Indicate that plugin is safe for multiple instantiation */
+	VISUAL_PLUGIN_FLAG_DIRTY_RECTS = 2    /**< Indicate that actor marks the areas it renders with visual_video_mark_dirty() */
 } VisPluginFlags;
 
 /** Plugin type */
@@ -0,0 +1,251 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_stft.h"
+#include "lv_common.h"
+#include <algorithm>
+#include <vector>
+
+namespace LV {
+
+  namespace {
+
+    // Maximum number of windows transformed together
+    unsigned int const max_batch_size = 8;
+
+  } // anonymous namespace
+
+  class STFT::Impl
+  {
+  public:
+
+      unsigned int spectrum_size;
+      unsigned int window_size;
+      unsigned int hop_size;
+      unsigned int history_size;
+      unsigned int batch_size;
+
+      DFT dft;
+
+      // Samples not yet consumed, with room for a batch of windows
+      std::vector<float> input;
+      std::size_t        input_fill;
+
+      // Ring of the most recent spectra
+      std::vector<float> history;
+      uint64_t           spectrum_count;
+
+      std::vector<float*>       batch_outputs;
+      std::vector<float const*> batch_inputs;
+
+      Impl (unsigned int spectrum_size, unsigned int window_size, unsigned int hop_size, VisDFTWindow window,
+            unsigned int history_size);
+
+      float* get_history_slot (uint64_t index)
+      {
+          return &history[(index % history_size) * spectrum_size];
+      }
+
+      float const* get_history_slot (uint64_t index) const
+      {
+          return &history[(index % history_size) * spectrum_size];
+      }
+
+      unsigned int transform_windows ();
+  };
+
+  STFT::Impl::Impl (unsigned int spectrum_size_,
+                    unsigned int window_size_,
+                    unsigned int hop_size_,
+                    VisDFTWindow window,
+                    unsigned int history_size_)
+      : spectrum_size  (std::min (spectrum_size_, window_size_ / 2 + 1))
+      , window_size    (window_size_)
+      , hop_size       (std::max (1u, std::min (hop_size_, window_size_)))
+      , history_size   (std::max (1u, history_size_))
+      , batch_size     (std::min (max_batch_size, history_size))
+      , dft            (spectrum_size, window_size, window)
+      , input          (window_size + hop_size * (batch_size - 1))
+      , input_fill     (0)
+      , history        (std::size_t (history_size) * spectrum_size, 0.0f)
+      , spectrum_count (0)
+      , batch_outputs  (batch_size)
+      , batch_inputs   (batch_size)
+  {
+      // empty
+  }
+
+  unsigned int STFT::Impl::transform_windows ()
+  {
+      if (input_fill < window_size)
+          return 0;
+
+      // The input buffer never holds more than a batch
+      unsigned int count = (input_fill - window_size) / hop_size + 1;
+
+      for (unsigned int i = 0; i < count; i++) {
+          batch_inputs[i]  = input.data () + i * hop_size;
+          batch_outputs[i] = get_history_slot (spectrum_count + i);
+      }
+
+      dft.perform_batch (batch_outputs.data (), batch_inputs.data (), count);
+
+      spectrum_count += count;
+
+      // Keep the samples shared with the next window
+      std::size_t consumed = std::size_t (count) * hop_size;
+
+      std::copy (input.begin () + consumed, input.begin () + input_fill, input.begin ());
+      input_fill -= consumed;
+
+      return count;
+  }
+
+  STFT::STFT (unsigned int spectrum_size,
+              unsigned int window_size,
+              unsigned int hop_size,
+              VisDFTWindow window,
+              unsigned int history_size)
+      : m_impl (new Impl (spectrum_size, window_size, hop_size, window, history_size))
+  {
+      // empty
+  }
+
+  STFT::STFT (STFT&& rhs)
+      : m_impl {std::move (rhs.m_impl)}
+  {
+      // empty
+  }
+
+  STFT::~STFT ()
+  {
+      // empty
+  }
+
+  STFT& STFT::operator= (STFT&& rhs)
+  {
+      m_impl.swap (rhs.m_impl);
+      return *this;
+  }
+
+  unsigned int STFT::get_spectrum_size () const
+  {
+      return m_impl->spectrum_size;
+  }
+
+  unsigned int STFT::get_window_size () const
+  {
+      return m_impl->window_size;
+  }
+
+  unsigned int STFT::get_hop_size () const
+  {
+      return m_impl->hop_size;
+  }
+
+  unsigned int STFT::get_history_size () const
+  {
+      return m_impl->history_size;
+  }
+
+  unsigned int STFT::process (float const* samples, std::size_t count)
+  {
+      visual_return_val_if_fail (samples != nullptr || count == 0, 0);
+
+      unsigned int spectra = 0;
+
+      while (count > 0) {
+          std::size_t chunk = std::min (count, m_impl->input.size () - m_impl->input_fill);
+
+          std::copy (samples, samples + chunk, m_impl->input.begin () + m_impl->input_fill);
+          m_impl->input_fill += chunk;
+
+          samples += chunk;
+          count   -= chunk;
+
+          spectra += m_impl->transform_windows ();
+      }
+
+      return spectra;
+  }
+
+  uint64_t STFT::get_spectrum_count () const
+  {
+      return m_impl->spectrum_count;
+  }
+
+  bool STFT::get_spectrum (float* output, bool interpolate) const
+  {
+      visual_return_val_if_fail (output != nullptr, false);
+
+      auto spectrum_size = m_impl->spectrum_size;
+      auto count         = m_impl->spectrum_count;
+
+      if (count == 0) {
+          std::fill (output, output + spectrum_size, 0.0f);
+          return false;
+      }
+
+      auto latest = m_impl->get_history_slot (count - 1);
+
+      if (!interpolate || count < 2 || m_impl->history_size < 2) {
+          std::copy (latest, latest + spectrum_size, output);
+          return true;
+      }
+
+      auto previous = m_impl->get_history_slot (count - 2);
+
+      // Samples received towards the next window
+      auto pending = m_impl->input_fill - (m_impl->window_size - m_impl->hop_size);
+
+      float t = float (pending) / m_impl->hop_size;
+
+      for (unsigned int i = 0; i < spectrum_size; i++) {
+          output[i] = previous[i] + (latest[i] - previous[i]) * t;
+      }
+
+      return true;
+  }
+
+  unsigned int STFT::get_spectrogram (float* output, unsigned int count) const
+  {
+      visual_return_val_if_fail (output != nullptr, 0);
+
+      auto spectrum_size = m_impl->spectrum_size;
+
+      count = unsigned (std::min<uint64_t> (std::min (count, m_impl->history_size), m_impl->spectrum_count));
+
+      auto first = m_impl->spectrum_count - count;
+
+      for (unsigned int i = 0; i < count; i++) {
+          auto spectrum = m_impl->get_history_slot (first + i);
+          std::copy (spectrum, spectrum + spectrum_size, output + std::size_t (i) * spectrum_size);
+      }
+
+      return count;
+  }
+
+  void STFT::reset ()
+  {
+      m_impl->input_fill     = 0;
+      m_impl->spectrum_count = 0;
+  }
+
+} // LV namespace
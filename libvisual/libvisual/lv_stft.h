@@ -0,0 +1,179 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _LV_STFT_H
+#define _LV_STFT_H
+
+#include <libvisual/lv_fourier.h>
+
+/**
+ * @defgroup VisSTFT VisSTFT
+ * @{
+ */
+
+#ifdef __cplusplus
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace LV {
+
+  /**
+   * Computes a Short-Time Fourier Transform incrementally over a stream of samples.
+   *
+   * Spectra are computed over overlapping windows that start every hop_size samples, as soon as enough samples have
+   * arrived. At high frame rates, where each frame brings in fewer samples than a window holds, this avoids
+   * transforming the same samples over and over.
+   *
+   * The most recent spectra are kept in a ring, and may be retrieved together as a spectrogram.
+   */
+  class LV_API STFT
+  {
+  public:
+
+      /**
+       * Creates an STFT object.
+       *
+       * @param spectrum_size size of each output spectrum, at most window_size / 2 + 1
+       * @param window_size   number of samples per window
+       * @param hop_size      number of samples between the starts of consecutive windows, at most window_size
+       * @param window        window function
+       * @param history_size  number of spectra kept
+       */
+      STFT (unsigned int spectrum_size,
+            unsigned int window_size,
+            unsigned int hop_size,
+            VisDFTWindow window,
+            unsigned int history_size);
+
+      STFT (STFT const&) = delete;
+
+      /**
+       * Move constructor
+       */
+      STFT (STFT&& rhs);
+
+      /**
+       * Destructor
+       */
+      ~STFT ();
+
+      STFT& operator= (STFT const&) = delete;
+
+      /**
+       * Move assignment operator
+       */
+      STFT& operator= (STFT&& rhs);
+
+      unsigned int get_spectrum_size () const;
+
+      unsigned int get_window_size () const;
+
+      unsigned int get_hop_size () const;
+
+      unsigned int get_history_size () const;
+
+      /**
+       * Adds samples, computing the spectra of all windows completed by them.
+       *
+       * Windows completed within the same call are transformed together as a batch.
+       *
+       * @param samples array of samples
+       * @param count   number of samples
+       *
+       * @return number of spectra computed
+       */
+      unsigned int process (float const* samples, std::size_t count);
+
+      /**
+       * Returns the total number of spectra computed so far.
+       */
+      uint64_t get_spectrum_count () const;
+
+      /**
+       * Retrieves the most recent spectrum.
+       *
+       * With interpolation, the output instead moves smoothly from the spectrum before it towards it, in proportion to
+       * the number of samples since received towards the next hop. This trails the input by up to a hop, but avoids
+       * the output stepping once per hop when rendering at frame rates above sample_rate / hop_size.
+       *
+       * @param output      array of get_spectrum_size() floats
+       * @param interpolate interpolate between the two most recent spectra
+       *
+       * @return false if no spectrum has been computed yet, in which case the output is zeroed
+       */
+      bool get_spectrum (float* output, bool interpolate) const;
+
+      /**
+       * Retrieves the most recent spectra, oldest first.
+       *
+       * Spectra are laid out one after another, each get_spectrum_size() floats long.
+       *
+       * @param output array of count * get_spectrum_size() floats
+       * @param count  number of spectra to retrieve, at most get_history_size()
+       *
+       * @return number of spectra retrieved, which is less than count if fewer have been computed
+       */
+      unsigned int get_spectrogram (float* output, unsigned int count) const;
+
+      /**
+       * Discards all samples and spectra.
+       */
+      void reset ();
+
+  private:
+
+      class Impl;
+
+      std::unique_ptr<Impl> m_impl;
+  };
+
+} // LV namespace
+
+#endif /* __cplusplus */
+
+#ifdef __cplusplus
+typedef ::LV::STFT VisSTFT;
+#else
+typedef struct _VisSTFT VisSTFT;
+struct _VisSTFT;
+#endif
+
+LV_BEGIN_DECLS
+
+LV_API VisSTFT *visual_stft_new  (unsigned int spectrum_size,
+                                  unsigned int window_size,
+                                  unsigned int hop_size,
+                                  VisDFTWindow window,
+                                  unsigned int history_size);
+LV_API void     visual_stft_free (VisSTFT *stft);
+
+LV_API unsigned int visual_stft_process         (VisSTFT *stft, const float *samples, unsigned int count);
+LV_API int          visual_stft_get_spectrum    (VisSTFT *stft, float *output, int interpolate);
+LV_API unsigned int visual_stft_get_spectrogram (VisSTFT *stft, float *output, unsigned int count);
+LV_API void         visual_stft_reset           (VisSTFT *stft);
+
+LV_END_DECLS
+
+/**
+ * @}
+ */
+
+#endif /* _LV_STFT_H */
@@ -0,0 +1,68 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_stft.h"
+#include "lv_common.h"
+
+extern "C" {
+
+  VisSTFT *visual_stft_new (unsigned int spectrum_size,
+                            unsigned int window_size,
+                            unsigned int hop_size,
+                            VisDFTWindow window,
+                            unsigned int history_size)
+  {
+      return new LV::STFT (spectrum_size, window_size, hop_size, window, history_size);
+  }
+
+  void visual_stft_free (VisSTFT *stft)
+  {
+      delete stft;
+  }
+
+  unsigned int visual_stft_process (VisSTFT *self, const float *samples, unsigned int count)
+  {
+      visual_return_val_if_fail (self != nullptr, 0);
+
+      return self->process (samples, count);
+  }
+
+  int visual_stft_get_spectrum (VisSTFT *self, float *output, int interpolate)
+  {
+      visual_return_val_if_fail (self != nullptr, FALSE);
+
+      return self->get_spectrum (output, interpolate);
+  }
+
+  unsigned int visual_stft_get_spectrogram (VisSTFT *self, float *output, unsigned int count)
+  {
+      visual_return_val_if_fail (self != nullptr, 0);
+
+      return self->get_spectrogram (output, count);
+  }
+
+  void visual_stft_reset (VisSTFT *self)
+  {
+      visual_return_if_fail (self != nullptr);
+
+      self->reset ();
+  }
+
+} // C extern
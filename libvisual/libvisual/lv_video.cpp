@@ -26,6 +26,7 @@
 
 #include "config.h"
 #include "lv_video.h"
+#include "lv_video_pool.h"
 #include "lv_color.h"
 #include "lv_common.h"
 #include "lv_cpu.h"
@@ -36,6 +37,8 @@
 #include "private/lv_video_transform.hpp"
 #include "private/lv_video_bmp.hpp"
 #include "private/lv_video_png.hpp"
+#include "private/lv_worker_pool.hpp"
+#include <algorithm>
 #include <fstream>
 
 namespace LV {
@@ -48,6 +51,38 @@ namespace LV {
             || scale_method == VISUAL_VIDEO_SCALE_BILINEAR;
     }
 
+    // Address alignment of pixel buffers
+    std::size_t const buffer_alignment = VISUAL_VIDEO_ALIGNMENT;
+
+    // Dirty rectangle lists longer than this are merged into their bounding rectangle
+    std::size_t const max_dirty_rects = 16;
+
+    // Scales larger than this many destination pixels are split into row bands across the worker pool
+    int const parallel_scale_min_pixels = 1280 * 720;
+
+    // Minimum number of rows per band
+    int const parallel_scale_min_rows = 32;
+
+    // Calls scale_rows (row_begin, row_end) over the rows of a destination, split into bands for large destinations
+    template <typename Func>
+    void scale_in_bands (int width, int height, Func const& scale_rows)
+    {
+        unsigned int band_count = 1;
+
+        if (width * height > parallel_scale_min_pixels) {
+            band_count = std::min<unsigned int> (WorkerPool::get_thread_count (), height / parallel_scale_min_rows);
+        }
+
+        if (band_count <= 1) {
+            scale_rows (0, height);
+            return;
+        }
+
+        WorkerPool::run (band_count, [&] (unsigned int band) {
+            scale_rows (height * band / band_count, height * (band + 1) / band_count);
+        });
+    }
+
   } // anonymous namespace
 
 
@@ -60,6 +95,8 @@ namespace LV {
       , buffer  (Buffer::create ())
       , parent  ()
       , compose_type (VISUAL_VIDEO_COMPOSE_TYPE_NONE)
+      , compose_func (nullptr)
+      , alpha        (255)
   {}
 
   Video::Impl::~Impl ()
@@ -119,6 +156,19 @@ namespace LV {
       return self;
   }
 
+  VideoPtr Video::create_aligned (int width, int height, VisVideoDepth depth)
+  {
+      visual_return_val_if_fail (depth != VISUAL_VIDEO_DEPTH_NONE && depth != VISUAL_VIDEO_DEPTH_GL, nullptr);
+
+      VideoPtr self (new Video, false);
+
+      self->set_depth (depth);
+      self->set_dimension (width, height, aligned_pitch (width * self->m_impl->bpp));
+      self->allocate_buffer ();
+
+      return self;
+  }
+
   VideoPtr Video::create_sub (VideoConstPtr const& src, Rect const& area)
   {
       visual_return_val_if_fail (!area.empty (), nullptr);
@@ -246,7 +296,12 @@ namespace LV {
           return false;
       }
 
-      m_impl->buffer->allocate (get_size ());
+      auto pixels = VideoPool::acquire (get_size (), buffer_alignment);
+      if (!pixels) {
+          return false;
+      }
+
+      m_impl->buffer->adopt (pixels, get_size (), VideoPool::release);
 
       m_impl->pixel_rows.resize (m_impl->height);
       m_impl->precompute_row_table ();
@@ -348,6 +403,13 @@ namespace LV {
       return m_impl->pitch;
   }
 
+  bool Video::is_aligned () const
+  {
+      auto address = reinterpret_cast<uintptr_t> (get_pixels ());
+
+      return address % VISUAL_VIDEO_ALIGNMENT == 0 && m_impl->pitch % VISUAL_VIDEO_ALIGNMENT == 0;
+  }
+
   void Video::set_depth (VisVideoDepth depth)
   {
       m_impl->depth = depth;
@@ -376,6 +438,60 @@ namespace LV {
       return m_impl->pitch * m_impl->height;
   }
 
+  void Video::mark_dirty (Rect const& area)
+  {
+      auto rect = Rect (m_impl->width, m_impl->height).clip (area);
+      if (rect.empty ()) {
+          return;
+      }
+
+      auto& dirty_rects = m_impl->dirty_rects;
+
+      for (auto const& dirty_rect : dirty_rects) {
+          if (dirty_rect.contains (rect)) {
+              return;
+          }
+      }
+
+      dirty_rects.erase (std::remove_if (dirty_rects.begin (), dirty_rects.end (),
+                                         [&] (Rect const& dirty_rect) { return rect.contains (dirty_rect); }),
+                         dirty_rects.end ());
+
+      if (dirty_rects.size () < max_dirty_rects) {
+          dirty_rects.push_back (rect);
+          return;
+      }
+
+      int x1 = rect.x;
+      int y1 = rect.y;
+      int x2 = rect.x + rect.width;
+      int y2 = rect.y + rect.height;
+
+      for (auto const& dirty_rect : dirty_rects) {
+          x1 = std::min (x1, dirty_rect.x);
+          y1 = std::min (y1, dirty_rect.y);
+          x2 = std::max (x2, dirty_rect.x + dirty_rect.width);
+          y2 = std::max (y2, dirty_rect.y + dirty_rect.height);
+      }
+
+      dirty_rects.assign (1, Rect (x1, y1, x2 - x1, y2 - y1));
+  }
+
+  void Video::mark_dirty ()
+  {
+      mark_dirty (Rect (m_impl->width, m_impl->height));
+  }
+
+  std::vector<Rect> const& Video::get_dirty_rects () const
+  {
+      return m_impl->dirty_rects;
+  }
+
+  void Video::clear_dirty ()
+  {
+      m_impl->dirty_rects.clear ();
+  }
+
   BufferPtr Video::get_buffer () const
   {
       return m_impl->buffer;
@@ -408,7 +524,7 @@ namespace LV {
 
   void Video::set_compose_colorkey (Color const& color)
   {
-      m_impl->colorkey->set (0, 0, 0);
+      m_impl->colorkey = color;
   }
 
   void Video::set_compose_surface (uint8_t alpha)
@@ -495,12 +611,7 @@ namespace LV {
 
       auto ssrc = create_sub (src, srect);
 
-      auto svid = create ();
-      svid->set_attrs (drect.width,
-                       drect.height,
-                       src->m_impl->bpp * drect.width,
-                       src->m_impl->depth);
-      svid->allocate_buffer ();
+      auto svid = create_aligned (drect.width, drect.height, src->m_impl->depth);
 
       svid->scale (ssrc, scale_method);
 
@@ -534,7 +645,7 @@ namespace LV {
 
       /* We're not the same depth, converting */
       if (m_impl->depth != src->m_impl->depth) {
-          transform = create (src->m_impl->width, src->m_impl->height, m_impl->depth);
+          transform = create_aligned (src->m_impl->width, src->m_impl->height, m_impl->depth);
           transform->convert_depth (src);
       }
 
@@ -566,21 +677,23 @@ namespace LV {
 
       /* Call blitter */
       compose_func (dregion.get (), sregion.get ());
+
+      mark_dirty (trect);
   }
 
   void Video::fill_alpha (uint8_t alpha)
   {
       visual_return_if_fail (m_impl->depth == VISUAL_VIDEO_DEPTH_32BIT);
 
-      auto vidbuf = static_cast<uint8_t *> (get_pixels ()) + 3;
-
       /* FIXME byte order sensitive */
       for (int y = 0; y < m_impl->height; y++) {
-          for (int x = 0; x < m_impl->width; x++)
-              *(vidbuf += m_impl->bpp) = alpha;
+          auto vidbuf = static_cast<uint8_t*> (m_impl->pixel_rows[y]) + 3;
 
-          vidbuf += m_impl->pitch - (m_impl->width * m_impl->bpp);
+          for (int x = 0; x < m_impl->width; x++, vidbuf += m_impl->bpp)
+              *vidbuf = alpha;
       }
+
+      mark_dirty ();
   }
 
   void Video::fill_alpha (uint8_t alpha, Rect const& area)
@@ -589,6 +702,8 @@ namespace LV {
 
       auto rvid = create_sub (this, area);
       rvid->fill_alpha (alpha);
+
+      mark_dirty (area);
   }
 
   void Video::fill_color (Color const& color)
@@ -596,32 +711,37 @@ namespace LV {
       switch (m_impl->depth) {
           case VISUAL_VIDEO_DEPTH_8BIT:
               VideoFill::fill_color_index8 (*this, color);
-              return;
+              break;
 
           case VISUAL_VIDEO_DEPTH_16BIT:
               VideoFill::fill_color_rgb16 (*this, color);
-              return;
+              break;
 
           case VISUAL_VIDEO_DEPTH_24BIT:
               VideoFill::fill_color_rgb24 (*this, color);
-              return;
+              break;
 
           case VISUAL_VIDEO_DEPTH_32BIT:
               VideoFill::fill_color_argb32 (*this, color);
-              return;
+              break;
 
           default:
               return;
       }
+
+      mark_dirty ();
   }
 
   void Video::fill_color (Color const& color, Rect const& area)
   {
-      if (m_impl->extents.intersects (area))
+      auto rect = Rect (m_impl->width, m_impl->height).clip (area);
+      if (rect.empty ())
           return;
 
-      auto svid = create_sub (VideoPtr (this), area);
+      auto svid = create_sub (VideoPtr (this), rect);
       svid->fill_color (color);
+
+      mark_dirty (rect);
   }
 
 
@@ -629,6 +749,8 @@ namespace LV {
   {
       visual_return_if_fail (compare_attrs (src));
 
+      mark_dirty ();
+
       switch (m_impl->depth) {
           case VISUAL_VIDEO_DEPTH_16BIT:
               VideoConvert::flip_pixel_bytes_color16 (*this, *src);
@@ -657,19 +779,21 @@ namespace LV {
 
           case VISUAL_VIDEO_ROTATE_90:
               VideoTransform::rotate_90 (*this, *src);
-              return;
+              break;
 
           case VISUAL_VIDEO_ROTATE_180:
               VideoTransform::rotate_180 (*this, *src);
-              return;
+              break;
 
           case VISUAL_VIDEO_ROTATE_270:
               VideoTransform::rotate_270 (*this, *src);
-              return;
+              break;
 
           default:
               return;
       }
+
+      mark_dirty ();
   }
 
   void Video::mirror (VideoConstPtr const& src, VisVideoMirrorOrient orient)
@@ -683,15 +807,17 @@ namespace LV {
 
           case VISUAL_VIDEO_MIRROR_X:
               VideoTransform::mirror_x (*this, *src);
-              return;
+              break;
 
           case VISUAL_VIDEO_MIRROR_Y:
               VideoTransform::mirror_y (*this, *src);
-              return;
+              break;
 
           default:
               return;
       }
+
+      mark_dirty ();
   }
 
   void Video::convert_depth (VideoConstPtr const& src)
@@ -706,6 +832,8 @@ namespace LV {
           visual_return_if_fail (src->m_impl->palette.size () == 256);
       }
 
+      mark_dirty ();
+
       if (src->m_impl->depth == VISUAL_VIDEO_DEPTH_8BIT) {
 
           switch (m_impl->depth) {
@@ -804,58 +932,61 @@ namespace LV {
           return;
       }
 
-      switch (m_impl->depth) {
-          case VISUAL_VIDEO_DEPTH_8BIT:
-              if (method == VISUAL_VIDEO_SCALE_NEAREST)
-                  VideoTransform::scale_nearest_color8 (*this, *src);
-              else if (method == VISUAL_VIDEO_SCALE_BILINEAR)
-                  VideoTransform::scale_bilinear_color8 (*this, *src);
+      auto scale_rows = VideoTransform::get_scaler (m_impl->depth, method);
 
-              break;
+      if (!scale_rows) {
+          visual_log (VISUAL_LOG_ERROR, "Invalid depth passed to the scaler");
+          return;
+      }
 
-          case VISUAL_VIDEO_DEPTH_16BIT:
-              if (method == VISUAL_VIDEO_SCALE_NEAREST)
-                  VideoTransform::scale_nearest_color16 (*this, *src);
-              else if (method == VISUAL_VIDEO_SCALE_BILINEAR)
-                  VideoTransform::scale_bilinear_color16 (*this, *src);
+      mark_dirty ();
 
-              break;
+      scale_in_bands (m_impl->width, m_impl->height, [&] (int row_begin, int row_end) {
+          scale_rows (*this, *src, row_begin, row_end);
+      });
+  }
 
-          case VISUAL_VIDEO_DEPTH_24BIT:
-              if (method == VISUAL_VIDEO_SCALE_NEAREST)
-                  VideoTransform::scale_nearest_color24 (*this, *src);
-              else if (method == VISUAL_VIDEO_SCALE_BILINEAR)
-                  VideoTransform::scale_bilinear_color24 (*this, *src);
+  void Video::scale_depth (VideoConstPtr const& src, VisVideoScaleMethod scale_method)
+  {
+      visual_return_if_fail (is_valid_scale_method (scale_method));
 
-              break;
+      if (m_impl->depth == src->m_impl->depth) {
+          scale (src, scale_method);
+          return;
+      }
 
-          case VISUAL_VIDEO_DEPTH_32BIT:
-              if (method == VISUAL_VIDEO_SCALE_NEAREST)
-                  VideoTransform::scale_nearest_color32 (*this, *src);
-              else if (method == VISUAL_VIDEO_SCALE_BILINEAR) {
-                  VideoTransform::scale_bilinear_color32 (*this, *src);
-              }
+      if (m_impl->width == src->m_impl->width && m_impl->height == src->m_impl->height
+          && scale_method == VISUAL_VIDEO_SCALE_NEAREST) {
+          convert_depth (src);
+          return;
+      }
 
-              break;
+      // Conversions to indexed colour build up a palette, so they are done in one piece
+      if (m_impl->depth == VISUAL_VIDEO_DEPTH_8BIT) {
+          auto converted = create_aligned (src->m_impl->width, src->m_impl->height, m_impl->depth);
+          converted->convert_depth (src);
 
-          default:
-              visual_log (VISUAL_LOG_ERROR, "Invalid depth passed to the scaler");
-              break;
+          scale (converted, scale_method);
+          set_palette (converted->get_palette ());
+          return;
       }
-  }
 
-  void Video::scale_depth (VideoConstPtr const& src, VisVideoScaleMethod scale_method)
-  {
-      if (m_impl->depth != src->m_impl->depth) {
-          auto dtransform = create ();
-          dtransform->set_attrs (m_impl->width, m_impl->height, m_impl->width * m_impl->bpp, m_impl->depth);
-          dtransform->allocate_buffer ();
-          dtransform->convert_depth (src);
+      if (src->m_impl->depth == VISUAL_VIDEO_DEPTH_8BIT) {
+          visual_return_if_fail (src->m_impl->palette.size () == 256);
+      }
 
-          scale (dtransform, scale_method);
-      } else {
-          scale (src, scale_method);
+      auto scale_rows = VideoTransform::get_scaler (m_impl->depth, scale_method);
+
+      if (!scale_rows) {
+          visual_log (VISUAL_LOG_ERROR, "Invalid depth passed to the scaler");
+          return;
       }
+
+      mark_dirty ();
+
+      scale_in_bands (m_impl->width, m_impl->height, [&] (int row_begin, int row_end) {
+          VideoTransform::scale_depth (*this, *src, scale_rows, row_begin, row_end);
+      });
   }
 
 } // LV namespace
@@ -38,6 +38,12 @@
  * @{
  */
 
+/**
+ * Address alignment of allocated pixel buffers, and the row alignment of aligned videos, in bytes. This is a cache
+ * line, and a multiple of the widest SIMD register (AVX-512).
+ */
+#define VISUAL_VIDEO_ALIGNMENT 64
+
 /* NOTE: The depth find helper code in lv_actor depends on an arrangment from low to high */
 /**
  * Enumerate that defines video depths for use within plugins, libvisual functions, etc.
@@ -121,6 +127,7 @@ struct _VisVideoAttrOptions {
 #include <libvisual/lv_intrusive_ptr.hpp>
 #include <iosfwd>
 #include <memory>
+#include <vector>
 
 namespace LV {
 
@@ -152,6 +159,22 @@ namespace LV {
        */
       static VideoPtr create (int width, int height, VisVideoDepth depth);
 
+      /**
+       * Creates a new Video object with an aligned buffer.
+       *
+       * Rows are padded to a multiple of VISUAL_VIDEO_ALIGNMENT bytes, so that every row starts on a cache line and
+       * can be processed with aligned SIMD loads and stores.
+       *
+       * @note The pitch will generally be larger than width * bytes per pixel.
+       *
+       * @param width  width in pixels
+       * @param height height in pixels
+       * @param depth  colour depth
+       *
+       * @see is_aligned()
+       */
+      static VideoPtr create_aligned (int width, int height, VisVideoDepth depth);
+
       static VideoPtr wrap (void* buffer, bool owner, int width, int height, VisVideoDepth depth, int pitch = 0);
 
       static VideoPtr create_sub (VideoConstPtr const& src, Rect const& srect);
@@ -223,6 +246,13 @@ namespace LV {
        */
       int get_pitch () const;
 
+      /**
+       * Checks if the pixel buffer and pitch are both multiples of VISUAL_VIDEO_ALIGNMENT.
+       *
+       * @return true if every row is aligned, false otherwise
+       */
+      bool is_aligned () const;
+
       /**
        * Returns the byte size of each pixel.
        *
@@ -293,6 +323,38 @@ namespace LV {
        */
       bool compare_attrs_ignore_pitch (VideoConstPtr const& src) const;
 
+      /**
+       * Marks an area as changed.
+       *
+       * Drawing operations of Video mark the areas they change. Code that writes to the pixel buffer directly should
+       * mark them as well, so that displays can update only the changed areas.
+       *
+       * @note Areas changed through a sub-video are not marked on its parent.
+       *
+       * @param area area in pixels, clipped to the video
+       */
+      void mark_dirty (Rect const& area);
+
+      /**
+       * Marks the entire video as changed.
+       */
+      void mark_dirty ();
+
+      /**
+       * Returns the areas changed since the last call to clear_dirty().
+       *
+       * Areas contained in others are left out, and the list is merged into a single bounding rectangle if it grows
+       * too long.
+       *
+       * @return list of changed areas
+       */
+      std::vector<Rect> const& get_dirty_rects () const;
+
+      /**
+       * Clears the list of changed areas.
+       */
+      void clear_dirty ();
+
       /**
        * Returns the size of the pixel buffer
        *
@@ -436,6 +498,9 @@ namespace LV {
       /**
        * Scales a video and performs a depth conversion where necessary.
        *
+       * Scaling and conversion are done in a single pass over the source, without an intermediate video of the full
+       * source size. The result is the same as that of convert_depth() followed by scale().
+       *
        * @see scale
        *
        * @param src    source Video
@@ -489,6 +554,7 @@ LV_BEGIN_DECLS
 
 LV_API VisVideo *visual_video_new (void);
 LV_API VisVideo *visual_video_new_with_buffer (int width, int height, VisVideoDepth depth);
+LV_API VisVideo *visual_video_new_aligned     (int width, int height, VisVideoDepth depth);
 LV_API VisVideo *visual_video_new_wrap_buffer (void *buffer, int owner, int width, int height, VisVideoDepth depth, int pitch);
 LV_API VisVideo *visual_video_load_from_file  (const char *path);
 
@@ -514,6 +580,7 @@ LV_API int visual_video_get_height (VisVideo *video);
 
 LV_API void visual_video_set_pitch (VisVideo *video, int pitch);
 LV_API int  visual_video_get_pitch (VisVideo *video);
+LV_API int  visual_video_is_aligned (VisVideo *video);
 
 LV_API void          visual_video_set_depth (VisVideo *video, VisVideoDepth depth);
 LV_API VisVideoDepth visual_video_get_depth (VisVideo *video);
@@ -522,6 +589,11 @@ LV_API int visual_video_get_bpp (VisVideo *video);
 
 LV_API visual_size_t visual_video_get_size (VisVideo *video);
 
+LV_API void                visual_video_mark_dirty      (VisVideo *video, VisRectangle *area);
+LV_API void                visual_video_mark_dirty_all  (VisVideo *video);
+LV_API const VisRectangle *visual_video_get_dirty_rects (VisVideo *video, unsigned int *count);
+LV_API void                visual_video_clear_dirty     (VisVideo *video);
+
 LV_API void *visual_video_get_pixels    (VisVideo *video);
 LV_API void *visual_video_get_pixel_ptr (VisVideo *video, int x, int y);
 
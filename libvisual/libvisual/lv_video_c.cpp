@@ -48,6 +48,16 @@ VisVideo *visual_video_new_with_buffer (int width, int height, VisVideoDepth dep
     return self.get ();
 }
 
+VisVideo *visual_video_new_aligned (int width, int height, VisVideoDepth depth)
+{
+    auto self = LV::Video::create_aligned (width, height, depth);
+    if (self) {
+        LV::intrusive_ptr_add_ref (self.get ());
+    }
+
+    return self.get ();
+}
+
 VisVideo *visual_video_new_wrap_buffer (void *buffer, int owner, int width, int height, VisVideoDepth depth, int pitch)
 {
     auto self = LV::Video::wrap (buffer, owner, width, height, depth, pitch);
@@ -164,6 +174,13 @@ int visual_video_get_pitch (VisVideo *self)
     return self->get_pitch ();
 }
 
+int visual_video_is_aligned (VisVideo *self)
+{
+    visual_return_val_if_fail (self != nullptr, FALSE);
+
+    return self->is_aligned ();
+}
+
 void visual_video_set_depth (VisVideo *self, VisVideoDepth depth)
 {
     visual_return_if_fail (self != nullptr);
@@ -199,6 +216,40 @@ visual_size_t visual_video_get_size (VisVideo *self)
     return self->get_size ();
 }
 
+void visual_video_mark_dirty (VisVideo *self, VisRectangle *area)
+{
+    visual_return_if_fail (self != nullptr);
+    visual_return_if_fail (area != nullptr);
+
+    self->mark_dirty (*area);
+}
+
+void visual_video_mark_dirty_all (VisVideo *self)
+{
+    visual_return_if_fail (self != nullptr);
+
+    self->mark_dirty ();
+}
+
+const VisRectangle *visual_video_get_dirty_rects (VisVideo *self, unsigned int *count)
+{
+    visual_return_val_if_fail (self != nullptr, nullptr);
+    visual_return_val_if_fail (count != nullptr, nullptr);
+
+    auto const& rects = self->get_dirty_rects ();
+
+    *count = rects.size ();
+
+    return rects.data ();
+}
+
+void visual_video_clear_dirty (VisVideo *self)
+{
+    visual_return_if_fail (self != nullptr);
+
+    self->clear_dirty ();
+}
+
 void *visual_video_get_pixels (VisVideo *self)
 {
     visual_return_val_if_fail (self != nullptr, nullptr);
@@ -0,0 +1,246 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_video_pool.h"
+#include "lv_common.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace LV {
+
+  namespace {
+
+    // Buffer sizes are rounded up to a multiple of this
+    std::size_t const size_class_granularity = 4096;
+
+    std::size_t const default_max_size      = 128 * 1024 * 1024;
+    long const        default_max_idle_secs = 10;
+
+    struct Block
+    {
+        void*       data;
+        std::size_t size;
+        std::size_t alignment;
+        Time        release_time;
+    };
+
+    struct PoolStore
+    {
+        std::mutex mutex;
+
+        // Cached blocks, least recently released first
+        std::vector<Block> cached;
+        std::size_t        cached_size;
+
+        // Blocks handed out, by address
+        std::unordered_map<void*, Block> in_use;
+
+        std::size_t       max_size;
+        Time              max_idle_time;
+        VisVideoPoolStats stats;
+
+        PoolStore ()
+            : cached_size   (0)
+            , max_size      (default_max_size)
+            , max_idle_time (default_max_idle_secs)
+            , stats         ()
+        {}
+
+        void free_oldest ()
+        {
+            auto const& block = cached.front ();
+
+            visual_mem_free_aligned (block.data);
+            cached_size -= block.size;
+            stats.trimmed++;
+
+            cached.erase (cached.begin ());
+        }
+
+        void trim (std::size_t size_limit)
+        {
+            while (cached_size > size_limit) {
+                free_oldest ();
+            }
+        }
+
+        void trim_idle (Time const& now)
+        {
+            while (!cached.empty () && now - cached.front ().release_time > max_idle_time) {
+                free_oldest ();
+            }
+        }
+    };
+
+    // Never destroyed, as Buffers may release their blocks during static destruction
+    PoolStore& pool_store ()
+    {
+        static auto store = new PoolStore;
+        return *store;
+    }
+
+  } // anonymous namespace
+
+  void* VideoPool::acquire (std::size_t size, std::size_t alignment)
+  {
+      visual_return_val_if_fail (size > 0, nullptr);
+
+      auto& store = pool_store ();
+
+      std::size_t class_size = (size + size_class_granularity - 1) / size_class_granularity * size_class_granularity;
+
+      void* data = nullptr;
+
+      {
+          std::lock_guard<std::mutex> lock (store.mutex);
+
+          store.trim_idle (Time::now ());
+
+          // Prefer the most recently released block, as it is the most likely to still be in cache
+          for (auto block = store.cached.rbegin (); block != store.cached.rend (); ++block) {
+              if (block->size == class_size && block->alignment == alignment) {
+                  data = block->data;
+                  store.cached_size -= class_size;
+                  store.cached.erase (std::next (block).base ());
+                  break;
+              }
+          }
+
+          if (data) {
+              store.stats.hits++;
+          } else {
+              store.stats.misses++;
+          }
+      }
+
+      if (!data) {
+          data = visual_mem_malloc_aligned (class_size, alignment);
+          if (!data) {
+              visual_log (VISUAL_LOG_ERROR, "Cannot get %" VISUAL_SIZE_T_FORMAT " bytes of memory", class_size);
+              return nullptr;
+          }
+      }
+
+      visual_mem_set (data, 0, size);
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      store.in_use[data] = Block { data, class_size, alignment, Time () };
+
+      return data;
+  }
+
+  void VideoPool::release (void* data)
+  {
+      if (!data) {
+          return;
+      }
+
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      auto entry = store.in_use.find (data);
+      visual_return_if_fail (entry != store.in_use.end ());
+
+      auto block = entry->second;
+      store.in_use.erase (entry);
+
+      block.release_time = Time::now ();
+
+      store.cached.push_back (block);
+      store.cached_size += block.size;
+
+      store.trim_idle (block.release_time);
+      store.trim (store.max_size);
+  }
+
+  void VideoPool::set_max_size (std::size_t size)
+  {
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      store.max_size = size;
+      store.trim (size);
+  }
+
+  std::size_t VideoPool::get_max_size ()
+  {
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      return store.max_size;
+  }
+
+  void VideoPool::set_max_idle_time (Time const& time)
+  {
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      store.max_idle_time = time;
+  }
+
+  Time VideoPool::get_max_idle_time ()
+  {
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      return store.max_idle_time;
+  }
+
+  void VideoPool::trim (std::size_t max_size)
+  {
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      store.trim (max_size);
+  }
+
+  VisVideoPoolStats VideoPool::get_stats ()
+  {
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      auto stats = store.stats;
+      stats.cached_count = store.cached.size ();
+      stats.cached_size  = store.cached_size;
+
+      return stats;
+  }
+
+  void VideoPool::reset_stats ()
+  {
+      auto& store = pool_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      store.stats.hits    = 0;
+      store.stats.misses  = 0;
+      store.stats.trimmed = 0;
+  }
+
+} // LV namespace
@@ -0,0 +1,147 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _LV_VIDEO_POOL_H
+#define _LV_VIDEO_POOL_H
+
+#include <libvisual/lvconfig.h>
+#include <libvisual/lv_defines.h>
+#include <libvisual/lv_types.h>
+#include <libvisual/lv_time.h>
+
+/**
+ * @defgroup VisVideoPool VisVideoPool
+ * @{
+ */
+
+/**
+ * Video buffer pool statistics.
+ */
+typedef struct {
+	uint64_t      hits;          /**< Number of buffers reused from the pool. */
+	uint64_t      misses;        /**< Number of buffers newly allocated. */
+	uint64_t      trimmed;       /**< Number of cached buffers freed by the trim policy. */
+	visual_size_t cached_count;  /**< Number of buffers currently cached. */
+	visual_size_t cached_size;   /**< Total size of buffers currently cached, in bytes. */
+} VisVideoPoolStats;
+
+#ifdef __cplusplus
+
+namespace LV {
+
+  //! Process-wide pool of Video pixel buffers.
+  //!
+  //! Video::allocate_buffer() takes its buffers from the pool, and they return to it when their Buffer releases them,
+  //! so that repeatedly freeing and reallocating frames of the same size does not go back to the system allocator.
+  //! Buffers are cached by size class (the size rounded up to a multiple of 4 KiB) and alignment, and are handed out
+  //! zeroed.
+  //!
+  //! Cached buffers are trimmed when they have gone unused for longer than the maximum idle time (10 seconds by
+  //! default). Once the total exceeds the maximum size (128 MiB by default), the least recently released are trimmed
+  //! first.
+  //!
+  //! All member functions are thread-safe.
+  //!
+  class LV_API VideoPool
+  {
+  public:
+
+      /**
+       * Returns a zeroed memory block, reusing a cached one if possible.
+       *
+       * @param size      size in bytes
+       * @param alignment address alignment
+       *
+       * @return pointer to memory block, or nullptr on failure
+       */
+      static void* acquire (std::size_t size, std::size_t alignment);
+
+      /**
+       * Returns a memory block obtained from acquire() to the pool.
+       *
+       * @param data pointer to memory block, may be nullptr
+       */
+      static void release (void* data);
+
+      /**
+       * Sets the maximum total size of cached buffers.
+       *
+       * @param size size in bytes
+       */
+      static void set_max_size (std::size_t size);
+
+      /**
+       * Returns the maximum total size of cached buffers.
+       */
+      static std::size_t get_max_size ();
+
+      /**
+       * Sets how long a cached buffer may go unused before it is freed.
+       *
+       * @param time maximum idle time
+       */
+      static void set_max_idle_time (Time const& time);
+
+      /**
+       * Returns how long a cached buffer may go unused before it is freed.
+       */
+      static Time get_max_idle_time ();
+
+      /**
+       * Frees cached buffers, least recently released first, until their total size is within a limit.
+       *
+       * @param max_size size limit in bytes
+       */
+      static void trim (std::size_t max_size = 0);
+
+      /**
+       * Returns the pool statistics.
+       */
+      static VisVideoPoolStats get_stats ();
+
+      /**
+       * Resets the hit, miss and trim counts.
+       */
+      static void reset_stats ();
+  };
+
+} // LV namespace
+
+#endif /* __cplusplus */
+
+LV_BEGIN_DECLS
+
+LV_API void          visual_video_pool_set_max_size (visual_size_t size);
+LV_API visual_size_t visual_video_pool_get_max_size (void);
+
+LV_API void visual_video_pool_set_max_idle_time (VisTime *time);
+LV_API void visual_video_pool_get_max_idle_time (VisTime *time);
+
+LV_API void visual_video_pool_trim (visual_size_t max_size);
+
+LV_API void visual_video_pool_get_stats   (VisVideoPoolStats *stats);
+LV_API void visual_video_pool_reset_stats (void);
+
+LV_END_DECLS
+
+/**
+ * @}
+ */
+
+#endif /* _LV_VIDEO_POOL_H */
@@ -0,0 +1,67 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_video_pool.h"
+#include "lv_common.h"
+
+extern "C" {
+
+  void visual_video_pool_set_max_size (visual_size_t size)
+  {
+      LV::VideoPool::set_max_size (size);
+  }
+
+  visual_size_t visual_video_pool_get_max_size ()
+  {
+      return LV::VideoPool::get_max_size ();
+  }
+
+  void visual_video_pool_set_max_idle_time (VisTime *time)
+  {
+      visual_return_if_fail (time != nullptr);
+
+      LV::VideoPool::set_max_idle_time (*time);
+  }
+
+  void visual_video_pool_get_max_idle_time (VisTime *time)
+  {
+      visual_return_if_fail (time != nullptr);
+
+      *time = LV::VideoPool::get_max_idle_time ();
+  }
+
+  void visual_video_pool_trim (visual_size_t max_size)
+  {
+      LV::VideoPool::trim (max_size);
+  }
+
+  void visual_video_pool_get_stats (VisVideoPoolStats *stats)
+  {
+      visual_return_if_fail (stats != nullptr);
+
+      *stats = LV::VideoPool::get_stats ();
+  }
+
+  void visual_video_pool_reset_stats ()
+  {
+      LV::VideoPool::reset_stats ();
+  }
+
+} // C extern
@@ -23,6 +23,7 @@
 #include "lv_audio_convert.hpp"
 #include "lv_audio.h"
 #include "lv_mem.h"
+#include "lv_cpu.h"
 #include <type_traits>
 #include <limits>
 
@@ -118,7 +119,7 @@ namespace {
   typename std::enable_if<std::is_integral<S>::value>::type
   inline convert_sample_array (float* dst, S const* src, std::size_t count)
   {
-      float a = 1.0 / (half_range<S> () + 1);
+      float a = 1.0 / (double (half_range<S> ()) + 1);
       float b = -zero<S>() * a;
 
       S const* src_end = src + count;
@@ -323,6 +324,49 @@ namespace {
       }
   }
 
+  // int->float conversion with stereo deinterleaving
+  template <typename S>
+  typename std::enable_if<std::is_integral<S>::value>::type
+  inline deinterleave_stereo_to_float_array (float* dest1, float* dest2, S const* src, std::size_t count)
+  {
+      float a = 1.0 / (double (half_range<S> ()) + 1);
+      float b = -zero<S>() * a;
+
+      auto src_end = src + count * 2;
+
+      while (src != src_end) {
+          *dest1 = src[0] * a + b;
+          *dest2 = src[1] * a + b;
+
+          dest1++;
+          dest2++;
+          src += 2;
+      }
+  }
+
+  inline void deinterleave_stereo_to_float_array (float* dest1, float* dest2, float const* src, std::size_t count)
+  {
+      deinterleave_stereo_sample_array (dest1, dest2, src, count * 2);
+  }
+
+  template <typename S>
+  void deinterleave_stereo_to_float (float* dest1, float* dest2, void const* src, std::size_t count)
+  {
+      deinterleave_stereo_to_float_array (dest1, dest2, static_cast<S const*> (src), count);
+  }
+
+  typedef void (*DeinterleaveStereoToFloatFunc)(float*, float*, void const*, std::size_t);
+
+  DeinterleaveStereoToFloatFunc const deinterleave_stereo_to_float_func_table[] = {
+      deinterleave_stereo_to_float<uint8_t>,
+      deinterleave_stereo_to_float<int8_t>,
+      deinterleave_stereo_to_float<uint16_t>,
+      deinterleave_stereo_to_float<int16_t>,
+      deinterleave_stereo_to_float<uint32_t>,
+      deinterleave_stereo_to_float<int32_t>,
+      deinterleave_stereo_to_float<float>
+  };
+
   template <typename T>
   void deinterleave_stereo (void* dest1, void* dest2, void const* src, std::size_t size)
   {
@@ -360,6 +404,18 @@ namespace LV {
         convert_func_table[i][j] (dbuf, sbuf, size);
     }
 
+  void AudioConvert::convert_samples (void*                    dest,
+                                      VisAudioSampleFormatType dest_format,
+                                      void const*              src,
+                                      VisAudioSampleFormatType src_format,
+                                      std::size_t              size)
+  {
+      int i = int (dest_format) - 1;
+      int j = int (src_format)  - 1;
+
+      convert_func_table[i][j] (dest, src, size);
+  }
+
   void AudioConvert::deinterleave_stereo_samples (BufferPtr const&         dest1,
                                                   BufferPtr const&         dest2,
                                                   BufferConstPtr const&    src,
@@ -375,4 +431,61 @@ namespace LV {
       deinterleave_stereo_func_table[i] (dbuf1, dbuf2, sbuf, size);
   }
 
+  void AudioConvert::deinterleave_stereo_to_float (float*                   dest1,
+                                                   float*                   dest2,
+                                                   void const*              src,
+                                                   VisAudioSampleFormatType format,
+                                                   std::size_t              frame_count)
+  {
+      std::size_t done = 0;
+
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+      if (visual_cpu_has_avx2 ()) {
+          switch (format) {
+              case VISUAL_AUDIO_SAMPLE_FORMAT_U8:
+                  done = deinterleave_stereo_u8_to_float_avx2 (dest1, dest2, static_cast<uint8_t const*> (src), frame_count);
+                  break;
+              case VISUAL_AUDIO_SAMPLE_FORMAT_S16:
+                  done = deinterleave_stereo_s16_to_float_avx2 (dest1, dest2, static_cast<int16_t const*> (src), frame_count);
+                  break;
+              case VISUAL_AUDIO_SAMPLE_FORMAT_S32:
+                  done = deinterleave_stereo_s32_to_float_avx2 (dest1, dest2, static_cast<int32_t const*> (src), frame_count);
+                  break;
+              case VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT:
+                  done = deinterleave_stereo_float_to_float_avx2 (dest1, dest2, static_cast<float const*> (src), frame_count);
+                  break;
+              default:
+                  break;
+          }
+      } else if (visual_cpu_has_sse2 ()) {
+          switch (format) {
+              case VISUAL_AUDIO_SAMPLE_FORMAT_U8:
+                  done = deinterleave_stereo_u8_to_float_sse2 (dest1, dest2, static_cast<uint8_t const*> (src), frame_count);
+                  break;
+              case VISUAL_AUDIO_SAMPLE_FORMAT_S16:
+                  done = deinterleave_stereo_s16_to_float_sse2 (dest1, dest2, static_cast<int16_t const*> (src), frame_count);
+                  break;
+              case VISUAL_AUDIO_SAMPLE_FORMAT_S32:
+                  done = deinterleave_stereo_s32_to_float_sse2 (dest1, dest2, static_cast<int32_t const*> (src), frame_count);
+                  break;
+              case VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT:
+                  done = deinterleave_stereo_float_to_float_sse2 (dest1, dest2, static_cast<float const*> (src), frame_count);
+                  break;
+              default:
+                  break;
+          }
+      }
+#endif
+
+      // Convert the remaining frames
+      if (done < frame_count) {
+          auto sample_size = visual_audio_sample_format_get_size (format);
+
+          deinterleave_stereo_to_float_func_table[int (format) - 1] (dest1 + done,
+                                                                     dest2 + done,
+                                                                     static_cast<uint8_t const*> (src) + done * 2 * sample_size,
+                                                                     frame_count - done);
+      }
+  }
+
 } // LV namespace
@@ -35,10 +35,43 @@ namespace LV {
                                    BufferConstPtr const&    src,
                                    VisAudioSampleFormatType src_format);
 
+      static void convert_samples (void*                    dest,
+                                   VisAudioSampleFormatType dest_format,
+                                   void const*              src,
+                                   VisAudioSampleFormatType src_format,
+                                   std::size_t              size);
+
       static void deinterleave_stereo_samples (BufferPtr const&         dest1,
                                                BufferPtr const&         dest2,
                                                BufferConstPtr const&    src,
                                                VisAudioSampleFormatType format);
+
+      /**
+       * Converts interleaved stereo samples to float and deinterleaves them in a single pass.
+       *
+       * @param dest1       destination array of left channel samples
+       * @param dest2       destination array of right channel samples
+       * @param src         interleaved samples
+       * @param format      format of the interleaved samples
+       * @param frame_count number of sample frames (pairs of samples)
+       */
+      static void deinterleave_stereo_to_float (float*                   dest1,
+                                                float*                   dest2,
+                                                void const*              src,
+                                                VisAudioSampleFormatType format,
+                                                std::size_t              frame_count);
+
+      // SIMD kernels. Each returns the number of frames processed, which is a multiple of its vector width.
+
+      static std::size_t deinterleave_stereo_u8_to_float_sse2    (float* dest1, float* dest2, uint8_t const* src, std::size_t count);
+      static std::size_t deinterleave_stereo_s16_to_float_sse2   (float* dest1, float* dest2, int16_t const* src, std::size_t count);
+      static std::size_t deinterleave_stereo_s32_to_float_sse2   (float* dest1, float* dest2, int32_t const* src, std::size_t count);
+      static std::size_t deinterleave_stereo_float_to_float_sse2 (float* dest1, float* dest2, float const* src, std::size_t count);
+
+      static std::size_t deinterleave_stereo_u8_to_float_avx2    (float* dest1, float* dest2, uint8_t const* src, std::size_t count);
+      static std::size_t deinterleave_stereo_s16_to_float_avx2   (float* dest1, float* dest2, int16_t const* src, std::size_t count);
+      static std::size_t deinterleave_stereo_s32_to_float_avx2   (float* dest1, float* dest2, int32_t const* src, std::size_t count);
+      static std::size_t deinterleave_stereo_float_to_float_avx2 (float* dest1, float* dest2, float const* src, std::size_t count);
   };
 
 } // LV namespace
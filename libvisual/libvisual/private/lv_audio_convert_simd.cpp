@@ -0,0 +1,284 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_audio_convert.hpp"
+#include "lv_common.h"
+
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
+
+namespace LV {
+
+  // SSE2 kernels
+
+#if defined(LV_HAVE_X86_SIMD)
+  namespace {
+
+    LV_ATTR_TARGET ("sse2")
+    std::size_t deinterleave_u8_sse2 (float* dest1, float* dest2, uint8_t const* src, std::size_t count)
+    {
+        __m128 const  a    = _mm_set1_ps (1.0f / 128);
+        __m128 const  b    = _mm_set1_ps (-1.0f);
+        __m128i const mask = _mm_set1_epi32 (0xffff);
+        __m128i const zero = _mm_setzero_si128 ();
+
+        std::size_t n = count & ~std::size_t (7);
+
+        for (std::size_t i = 0; i < n; i += 8) {
+            __m128i x  = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 2));
+            __m128i lo = _mm_unpacklo_epi8 (x, zero);
+            __m128i hi = _mm_unpackhi_epi8 (x, zero);
+
+            _mm_storeu_ps (dest1 + i,     _mm_add_ps (_mm_mul_ps (_mm_cvtepi32_ps (_mm_and_si128 (lo, mask)), a), b));
+            _mm_storeu_ps (dest1 + i + 4, _mm_add_ps (_mm_mul_ps (_mm_cvtepi32_ps (_mm_and_si128 (hi, mask)), a), b));
+            _mm_storeu_ps (dest2 + i,     _mm_add_ps (_mm_mul_ps (_mm_cvtepi32_ps (_mm_srli_epi32 (lo, 16)), a), b));
+            _mm_storeu_ps (dest2 + i + 4, _mm_add_ps (_mm_mul_ps (_mm_cvtepi32_ps (_mm_srli_epi32 (hi, 16)), a), b));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("sse2")
+    std::size_t deinterleave_s16_sse2 (float* dest1, float* dest2, int16_t const* src, std::size_t count)
+    {
+        __m128 const a = _mm_set1_ps (1.0f / 32768);
+
+        std::size_t n = count & ~std::size_t (3);
+
+        for (std::size_t i = 0; i < n; i += 4) {
+            // Each 32-bit lane holds a frame, with the left sample in the lower half
+            __m128i x = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 2));
+            __m128i l = _mm_srai_epi32 (_mm_slli_epi32 (x, 16), 16);
+            __m128i r = _mm_srai_epi32 (x, 16);
+
+            _mm_storeu_ps (dest1 + i, _mm_mul_ps (_mm_cvtepi32_ps (l), a));
+            _mm_storeu_ps (dest2 + i, _mm_mul_ps (_mm_cvtepi32_ps (r), a));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("sse2")
+    std::size_t deinterleave_s32_sse2 (float* dest1, float* dest2, int32_t const* src, std::size_t count)
+    {
+        __m128 const a = _mm_set1_ps (1.0f / 2147483648.0f);
+
+        std::size_t n = count & ~std::size_t (3);
+
+        for (std::size_t i = 0; i < n; i += 4) {
+            __m128 x0 = _mm_castsi128_ps (_mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 2)));
+            __m128 x1 = _mm_castsi128_ps (_mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 2 + 4)));
+
+            __m128i l = _mm_castps_si128 (_mm_shuffle_ps (x0, x1, _MM_SHUFFLE (2, 0, 2, 0)));
+            __m128i r = _mm_castps_si128 (_mm_shuffle_ps (x0, x1, _MM_SHUFFLE (3, 1, 3, 1)));
+
+            _mm_storeu_ps (dest1 + i, _mm_mul_ps (_mm_cvtepi32_ps (l), a));
+            _mm_storeu_ps (dest2 + i, _mm_mul_ps (_mm_cvtepi32_ps (r), a));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("sse2")
+    std::size_t deinterleave_float_sse2 (float* dest1, float* dest2, float const* src, std::size_t count)
+    {
+        std::size_t n = count & ~std::size_t (3);
+
+        for (std::size_t i = 0; i < n; i += 4) {
+            __m128 x0 = _mm_loadu_ps (src + i * 2);
+            __m128 x1 = _mm_loadu_ps (src + i * 2 + 4);
+
+            _mm_storeu_ps (dest1 + i, _mm_shuffle_ps (x0, x1, _MM_SHUFFLE (2, 0, 2, 0)));
+            _mm_storeu_ps (dest2 + i, _mm_shuffle_ps (x0, x1, _MM_SHUFFLE (3, 1, 3, 1)));
+        }
+
+        return n;
+    }
+
+    // AVX2 kernels
+
+    LV_ATTR_TARGET ("avx2")
+    std::size_t deinterleave_u8_avx2 (float* dest1, float* dest2, uint8_t const* src, std::size_t count)
+    {
+        __m256 const  a    = _mm256_set1_ps (1.0f / 128);
+        __m256 const  b    = _mm256_set1_ps (-1.0f);
+        __m256i const mask = _mm256_set1_epi32 (0xffff);
+
+        std::size_t n = count & ~std::size_t (7);
+
+        for (std::size_t i = 0; i < n; i += 8) {
+            __m256i x = _mm256_cvtepu8_epi16 (_mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 2)));
+
+            _mm256_storeu_ps (dest1 + i, _mm256_add_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_and_si256 (x, mask)), a), b));
+            _mm256_storeu_ps (dest2 + i, _mm256_add_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_srli_epi32 (x, 16)), a), b));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    std::size_t deinterleave_s16_avx2 (float* dest1, float* dest2, int16_t const* src, std::size_t count)
+    {
+        __m256 const a = _mm256_set1_ps (1.0f / 32768);
+
+        std::size_t n = count & ~std::size_t (7);
+
+        for (std::size_t i = 0; i < n; i += 8) {
+            __m256i x = _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i * 2));
+            __m256i l = _mm256_srai_epi32 (_mm256_slli_epi32 (x, 16), 16);
+            __m256i r = _mm256_srai_epi32 (x, 16);
+
+            _mm256_storeu_ps (dest1 + i, _mm256_mul_ps (_mm256_cvtepi32_ps (l), a));
+            _mm256_storeu_ps (dest2 + i, _mm256_mul_ps (_mm256_cvtepi32_ps (r), a));
+        }
+
+        return n;
+    }
+
+    // Splits 8 interleaved frames into the even (left) and odd (right) elements, in order
+    LV_ATTR_TARGET ("avx2")
+    inline void deinterleave_8_avx2 (__m256& l, __m256& r, __m256 x0, __m256 x1)
+    {
+        // In-lane shuffles produce [0 1 4 5 | 2 3 6 7], which is fixed up by swapping the middle 64-bit quarters
+        l = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (_mm256_shuffle_ps (x0, x1, _MM_SHUFFLE (2, 0, 2, 0))),
+                                                     _MM_SHUFFLE (3, 1, 2, 0)));
+        r = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (_mm256_shuffle_ps (x0, x1, _MM_SHUFFLE (3, 1, 3, 1))),
+                                                     _MM_SHUFFLE (3, 1, 2, 0)));
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    std::size_t deinterleave_s32_avx2 (float* dest1, float* dest2, int32_t const* src, std::size_t count)
+    {
+        __m256 const a = _mm256_set1_ps (1.0f / 2147483648.0f);
+
+        std::size_t n = count & ~std::size_t (7);
+
+        for (std::size_t i = 0; i < n; i += 8) {
+            __m256 l, r;
+
+            deinterleave_8_avx2 (l, r,
+                                 _mm256_castsi256_ps (_mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i * 2))),
+                                 _mm256_castsi256_ps (_mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i * 2 + 8))));
+
+            _mm256_storeu_ps (dest1 + i, _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_castps_si256 (l)), a));
+            _mm256_storeu_ps (dest2 + i, _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_castps_si256 (r)), a));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    std::size_t deinterleave_float_avx2 (float* dest1, float* dest2, float const* src, std::size_t count)
+    {
+        std::size_t n = count & ~std::size_t (7);
+
+        for (std::size_t i = 0; i < n; i += 8) {
+            __m256 l, r;
+
+            deinterleave_8_avx2 (l, r, _mm256_loadu_ps (src + i * 2), _mm256_loadu_ps (src + i * 2 + 8));
+
+            _mm256_storeu_ps (dest1 + i, l);
+            _mm256_storeu_ps (dest2 + i, r);
+        }
+
+        return n;
+    }
+
+  } // anonymous namespace
+#endif
+
+  std::size_t AudioConvert::deinterleave_stereo_u8_to_float_sse2 (float* dest1, float* dest2, uint8_t const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_u8_sse2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioConvert::deinterleave_stereo_s16_to_float_sse2 (float* dest1, float* dest2, int16_t const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_s16_sse2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioConvert::deinterleave_stereo_s32_to_float_sse2 (float* dest1, float* dest2, int32_t const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_s32_sse2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioConvert::deinterleave_stereo_float_to_float_sse2 (float* dest1, float* dest2, float const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_float_sse2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioConvert::deinterleave_stereo_u8_to_float_avx2 (float* dest1, float* dest2, uint8_t const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_u8_avx2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioConvert::deinterleave_stereo_s16_to_float_avx2 (float* dest1, float* dest2, int16_t const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_s16_avx2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioConvert::deinterleave_stereo_s32_to_float_avx2 (float* dest1, float* dest2, int32_t const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_s32_avx2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioConvert::deinterleave_stereo_float_to_float_avx2 (float* dest1, float* dest2, float const* src, std::size_t count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return deinterleave_float_avx2 (dest1, dest2, src, count);
+#else
+      return 0;
+#endif
+  }
+
+} // LV namespace
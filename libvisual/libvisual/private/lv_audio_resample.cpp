@@ -0,0 +1,264 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "private/lv_audio_resample.hpp"
+#include "lv_common.h"
+#include "lv_cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+namespace LV {
+
+  namespace {
+
+    typedef std::pair<unsigned int, unsigned int>                 FilterKey;
+    typedef std::map<FilterKey, AudioResampleFilterConstPtr>      FilterTable;
+
+    double const pi = 3.141592653589793238462643383279502884;
+
+    // Filter half-width in input samples when upsampling. This is widened in proportion to the rate ratio when
+    // downsampling.
+    unsigned int const filter_half_width = 16;
+
+    // Passband edge, as a fraction of the lower of the two Nyquist frequencies
+    double const filter_rolloff = 0.85;
+
+    struct FilterStore
+    {
+        std::mutex  mutex;
+        FilterTable filters;
+    };
+
+    FilterStore& filter_store ()
+    {
+        static FilterStore store;
+        return store;
+    }
+
+    unsigned int gcd (unsigned int a, unsigned int b)
+    {
+        while (b != 0) {
+            auto r = a % b;
+            a = b;
+            b = r;
+        }
+
+        return a;
+    }
+
+  } // anonymous namespace
+
+  class AudioResampler::Impl
+  {
+  public:
+
+      AudioResampleFilterConstPtr filter;
+
+      unsigned int input_rate;
+      unsigned int output_rate;
+
+      // Samples retained from previous blocks, followed by the current block
+      AudioResampleFilter::FloatVector work;
+      std::size_t history;
+
+      // Start of the next output's filter window in work, and its filter phase
+      std::size_t  pos;
+      unsigned int phase;
+
+      Impl (unsigned int input_rate, unsigned int output_rate);
+  };
+
+  AudioResampleFilter::AudioResampleFilter (unsigned int input_rate, unsigned int output_rate)
+  {
+      auto divisor = gcd (input_rate, output_rate);
+
+      up   = output_rate / divisor;
+      down = input_rate  / divisor;
+
+      pos_step   = down / up;
+      phase_step = down % up;
+
+      auto scale = std::max (1.0, double (down) / up);
+      taps = (unsigned int) std::ceil (2 * filter_half_width * scale / 16) * 16;
+
+      // Windowed sinc prototype, at the upsampled rate
+      unsigned int length = taps * up;
+
+      double cutoff = filter_rolloff * 0.5 / std::max (up, down);
+      double center = (length - 1) / 2.0;
+
+      std::vector<double> prototype (length);
+
+      for (unsigned int k = 0; k < length; k++) {
+          double x = 2 * cutoff * (k - center);
+          double sinc = x != 0.0 ? std::sin (pi * x) / (pi * x) : 1.0;
+
+          double t = 2 * pi * k / (length - 1);
+          double window = 0.42 - 0.5 * std::cos (t) + 0.08 * std::cos (2 * t);
+
+          prototype[k] = sinc * window;
+      }
+
+      // Split into phases. Each phase is normalized to unit gain so that a constant signal stays constant.
+      coeffs.resize (std::size_t (up) * taps);
+
+      for (unsigned int p = 0; p < up; p++) {
+          float* phase_coeffs = coeffs.data () + std::size_t (p) * taps;
+
+          double sum = 0.0;
+          for (unsigned int j = 0; j < taps; j++) {
+              sum += prototype[p + (taps - 1 - j) * up];
+          }
+
+          for (unsigned int j = 0; j < taps; j++) {
+              phase_coeffs[j] = prototype[p + (taps - 1 - j) * up] / sum;
+          }
+      }
+  }
+
+  AudioResampleFilterConstPtr AudioResampleFilter::get (unsigned int input_rate, unsigned int output_rate)
+  {
+      auto& store = filter_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      auto& filter = store.filters[FilterKey (input_rate, output_rate)];
+
+      if (!filter) {
+          filter = std::make_shared<AudioResampleFilter> (input_rate, output_rate);
+      }
+
+      return filter;
+  }
+
+  AudioResampler::Impl::Impl (unsigned int input_rate_, unsigned int output_rate_)
+      : filter      (AudioResampleFilter::get (input_rate_, output_rate_))
+      , input_rate  (input_rate_)
+      , output_rate (output_rate_)
+      , work        (filter->taps - 1, 0.0f)
+      , history     (filter->taps - 1)
+      , pos         (0)
+      , phase       (0)
+  {
+      // empty
+  }
+
+  AudioResampler::AudioResampler (unsigned int input_rate, unsigned int output_rate)
+      : m_impl (new Impl (input_rate, output_rate))
+  {
+      // empty
+  }
+
+  AudioResampler::~AudioResampler ()
+  {
+      // empty
+  }
+
+  unsigned int AudioResampler::get_input_rate () const
+  {
+      return m_impl->input_rate;
+  }
+
+  unsigned int AudioResampler::get_output_rate () const
+  {
+      return m_impl->output_rate;
+  }
+
+  std::size_t AudioResampler::get_max_output_count (std::size_t count) const
+  {
+      auto const& filter = *m_impl->filter;
+
+      return count * filter.up / filter.down + 2;
+  }
+
+  std::size_t AudioResampler::process (float* output, float const* input, std::size_t count)
+  {
+      auto& work = m_impl->work;
+      auto const& filter = *m_impl->filter;
+
+      // Append the block to the samples retained from before
+      std::size_t total = m_impl->history + count;
+
+      if (work.size () < total) {
+          work.resize (total);
+      }
+
+      std::copy (input, input + count, work.begin () + m_impl->history);
+
+      auto& pos   = m_impl->pos;
+      auto& phase = m_impl->phase;
+
+      std::size_t output_count = 0;
+
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+      if (visual_cpu_has_avx2 ()) {
+          output_count = filter_avx2 (output, work.data (), total, filter, pos, phase);
+      } else if (visual_cpu_has_sse2 ()) {
+          output_count = filter_sse2 (output, work.data (), total, filter, pos, phase);
+      }
+#endif
+
+      // Finish up if no SIMD kernel was available
+      output_count += filter_c (output + output_count, work.data (), total, filter, pos, phase);
+
+      // Retain the samples still needed by the next output
+      std::copy (work.begin () + pos, work.begin () + total, work.begin ());
+      m_impl->history = total - pos;
+      pos = 0;
+
+      return output_count;
+  }
+
+  std::size_t AudioResampler::filter_c (float*                     output,
+                                        float const*               input,
+                                        std::size_t                count,
+                                        AudioResampleFilter const& filter,
+                                        std::size_t&               pos,
+                                        unsigned int&              phase)
+  {
+      std::size_t n = 0;
+
+      while (pos + filter.taps <= count) {
+          auto coeffs  = filter.coeffs.data () + std::size_t (phase) * filter.taps;
+          auto samples = input + pos;
+
+          float sum = 0.0f;
+          for (unsigned int j = 0; j < filter.taps; j++) {
+              sum += coeffs[j] * samples[j];
+          }
+
+          output[n++] = sum;
+
+          pos   += filter.pos_step;
+          phase += filter.phase_step;
+
+          if (phase >= filter.up) {
+              phase -= filter.up;
+              pos++;
+          }
+      }
+
+      return n;
+  }
+
+} // LV namespace
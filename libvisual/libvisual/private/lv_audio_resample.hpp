@@ -0,0 +1,114 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _LV_AUDIO_RESAMPLE_HPP
+#define _LV_AUDIO_RESAMPLE_HPP
+
+#include "lvconfig.h"
+#include "lv_defines.h"
+#include "lv_aligned_allocator.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace LV {
+
+  //! Polyphase filter bank for converting between two sampling rates.
+  //!
+  //! The rate ratio is reduced to up/down. Input is conceptually upsampled by a factor of up, low-pass filtered and
+  //! then downsampled by a factor of down. Only the filter taps that line up with input samples are evaluated, so each
+  //! output sample is a dot product of taps input samples with one of up phases of the filter.
+  //!
+  struct AudioResampleFilter
+  {
+      typedef std::vector<float, AlignedAllocator<float, 32>> FloatVector;
+
+      unsigned int up;
+      unsigned int down;
+
+      //! Input position and filter phase increments between output samples (down / up and down % up)
+      unsigned int pos_step;
+      unsigned int phase_step;
+
+      //! Number of taps per phase, a multiple of 16
+      unsigned int taps;
+
+      //! Filter phases, each laid out in the order of the input samples it is applied to
+      FloatVector coeffs;
+
+      AudioResampleFilter (unsigned int input_rate, unsigned int output_rate);
+
+      //! Returns a cached filter bank for a pair of sampling rates
+      static std::shared_ptr<AudioResampleFilter const> get (unsigned int input_rate, unsigned int output_rate);
+  };
+
+  typedef std::shared_ptr<AudioResampleFilter const> AudioResampleFilterConstPtr;
+
+  //! Streaming sampling rate converter for a single channel.
+  class AudioResampler
+  {
+  public:
+
+      AudioResampler (unsigned int input_rate, unsigned int output_rate);
+
+      AudioResampler (AudioResampler const&) = delete;
+
+      ~AudioResampler ();
+
+      AudioResampler& operator= (AudioResampler const&) = delete;
+
+      unsigned int get_input_rate () const;
+
+      unsigned int get_output_rate () const;
+
+      /**
+       * Returns the maximum number of samples produced by a call to process().
+       *
+       * @param count number of input samples
+       */
+      std::size_t get_max_output_count (std::size_t count) const;
+
+      /**
+       * Resamples a block of samples, continuing from the previous block.
+       *
+       * @param output array to hold at least get_max_output_count(count) samples
+       * @param input  input samples
+       * @param count  number of input samples
+       *
+       * @return number of output samples
+       */
+      std::size_t process (float* output, float const* input, std::size_t count);
+
+      // SIMD kernels. Each computes output samples while the filter fits within the input, starting with the given
+      // input position and filter phase, and updates both as it goes. Returns the number of output samples.
+
+      static std::size_t filter_c    (float* output, float const* input, std::size_t count, AudioResampleFilter const& filter, std::size_t& pos, unsigned int& phase);
+      static std::size_t filter_sse2 (float* output, float const* input, std::size_t count, AudioResampleFilter const& filter, std::size_t& pos, unsigned int& phase);
+      static std::size_t filter_avx2 (float* output, float const* input, std::size_t count, AudioResampleFilter const& filter, std::size_t& pos, unsigned int& phase);
+
+  private:
+
+      class Impl;
+
+      const std::unique_ptr<Impl> m_impl;
+  };
+
+} // LV namespace
+
+#endif // _LV_AUDIO_RESAMPLE_HPP
@@ -0,0 +1,152 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "private/lv_audio_resample.hpp"
+#include "lv_common.h"
+
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
+
+namespace LV {
+
+  // Filter taps are a multiple of 16 and each phase is 32-byte aligned, so the kernels need no scalar tails and may use
+  // aligned loads for coefficients.
+
+#if defined(LV_HAVE_X86_SIMD)
+  namespace {
+
+    LV_ATTR_TARGET ("sse2")
+    std::size_t resample_sse2 (float*                     output,
+                               float const*               input,
+                               std::size_t                count,
+                               AudioResampleFilter const& filter,
+                               std::size_t&               pos,
+                               unsigned int&              phase)
+    {
+        std::size_t n = 0;
+
+        while (pos + filter.taps <= count) {
+            auto coeffs  = filter.coeffs.data () + std::size_t (phase) * filter.taps;
+            auto samples = input + pos;
+
+            __m128 sum0 = _mm_setzero_ps ();
+            __m128 sum1 = _mm_setzero_ps ();
+
+            for (unsigned int j = 0; j < filter.taps; j += 8) {
+                sum0 = _mm_add_ps (sum0, _mm_mul_ps (_mm_load_ps (coeffs + j),     _mm_loadu_ps (samples + j)));
+                sum1 = _mm_add_ps (sum1, _mm_mul_ps (_mm_load_ps (coeffs + j + 4), _mm_loadu_ps (samples + j + 4)));
+            }
+
+            __m128 sum = _mm_add_ps (sum0, sum1);
+            sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+            sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 0x55));
+
+            output[n++] = _mm_cvtss_f32 (sum);
+
+            pos   += filter.pos_step;
+            phase += filter.phase_step;
+
+            if (phase >= filter.up) {
+                phase -= filter.up;
+                pos++;
+            }
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    std::size_t resample_avx2 (float*                     output,
+                               float const*               input,
+                               std::size_t                count,
+                               AudioResampleFilter const& filter,
+                               std::size_t&               pos,
+                               unsigned int&              phase)
+    {
+        std::size_t n = 0;
+
+        while (pos + filter.taps <= count) {
+            auto coeffs  = filter.coeffs.data () + std::size_t (phase) * filter.taps;
+            auto samples = input + pos;
+
+            __m256 sum0 = _mm256_setzero_ps ();
+            __m256 sum1 = _mm256_setzero_ps ();
+
+            for (unsigned int j = 0; j < filter.taps; j += 16) {
+                sum0 = _mm256_add_ps (sum0, _mm256_mul_ps (_mm256_load_ps (coeffs + j),     _mm256_loadu_ps (samples + j)));
+                sum1 = _mm256_add_ps (sum1, _mm256_mul_ps (_mm256_load_ps (coeffs + j + 8), _mm256_loadu_ps (samples + j + 8)));
+            }
+
+            __m256 sum = _mm256_add_ps (sum0, sum1);
+            __m128 sum4 = _mm_add_ps (_mm256_castps256_ps128 (sum), _mm256_extractf128_ps (sum, 1));
+            sum4 = _mm_add_ps (sum4, _mm_movehl_ps (sum4, sum4));
+            sum4 = _mm_add_ss (sum4, _mm_shuffle_ps (sum4, sum4, 0x55));
+
+            output[n++] = _mm_cvtss_f32 (sum4);
+
+            pos   += filter.pos_step;
+            phase += filter.phase_step;
+
+            if (phase >= filter.up) {
+                phase -= filter.up;
+                pos++;
+            }
+        }
+
+        return n;
+    }
+
+  } // anonymous namespace
+#endif
+
+  std::size_t AudioResampler::filter_sse2 (float*                     output,
+                                           float const*               input,
+                                           std::size_t                count,
+                                           AudioResampleFilter const& filter,
+                                           std::size_t&               pos,
+                                           unsigned int&              phase)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return resample_sse2 (output, input, count, filter, pos, phase);
+#else
+      return 0;
+#endif
+  }
+
+  std::size_t AudioResampler::filter_avx2 (float*                     output,
+                                           float const*               input,
+                                           std::size_t                count,
+                                           AudioResampleFilter const& filter,
+                                           std::size_t&               pos,
+                                           unsigned int&              phase)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return resample_avx2 (output, input, count, filter, pos, phase);
+#else
+      return 0;
+#endif
+  }
+
+} // LV namespace
@@ -24,8 +24,12 @@
 #include "config.h"
 #include "private/lv_audio_stream.hpp"
 #include "lv_common.h"
+#include "lv_aligned_allocator.hpp"
+#include "lv_math.h"
 
-#include <list>
+#include <atomic>
+#include <cmath>
+#include <vector>
 
 namespace LV {
 
@@ -33,48 +37,201 @@ namespace LV {
 
     uint64_t max_lifetime = VISUAL_USECS_PER_SEC;
 
+    // Sample ring capacity. Must be a power of 2, and large enough to hold max_lifetime worth of samples at the
+    // highest supported rate (96kHz).
+    std::size_t const sample_capacity = 1 << 17;
+
+    // Block ring capacity. Must be a power of 2.
+    std::size_t const block_capacity = 1 << 10;
+
+    std::size_t const cache_line_size = 64;
+
   } // anonymous namespace
 
   class AudioStream::Impl
   {
   public:
 
-      struct Fragment
+      // Contiguous run of samples uploaded together. Block i spans [blocks[i-1].end, blocks[i].end) in the sample
+      // stream.
+      struct Block
       {
-          BufferConstPtr buffer;
-          Time           timestamp;
+          Time     timestamp;
+          uint64_t end;
       };
 
-      typedef std::list<Fragment> FragmentList;
+      typedef std::vector<float, AlignedAllocator<float, cache_line_size>> SampleRing;
+      typedef std::vector<Block> BlockRing;
+
+      unsigned int sample_rate;
+      SampleRing   samples;
+      BlockRing    blocks;
+
+      // Stream positions are monotonically increasing sample counts. They are only ever modified by the producer.
+      //
+      // The producer first advances write_reserve past the region it is about to overwrite, then stores the samples
+      // and finally publishes them by advancing write_pos. The consumer uses write_reserve to detect whether samples
+      // were overwritten while it was copying them out.
+      std::atomic<uint64_t> start_pos;
+      std::atomic<uint64_t> write_pos;
+      std::atomic<uint64_t> write_reserve;
+
+      // Block ring indices. Blocks in [first_block, next_block) hold live samples. Only the producer reads
+      // first_block, while the consumer may look up older blocks up to block_capacity back from next_block.
+      uint64_t              first_block;
+      std::atomic<uint64_t> next_block;
+
+      explicit Impl (unsigned int sample_rate);
 
-      FragmentList fragments;
-      std::size_t  size;
+      void remove_stale_blocks (Time const& time);
 
-      Impl ();
+      void remove_oldest_block ();
 
-      void remove_stale_fragments (Time const& time);
+      void copy_in (uint64_t pos, float const* src, std::size_t count);
+
+      void copy_out (float* dest, uint64_t pos, std::size_t count) const;
+
+      void mix_out (float* dest, uint64_t pos, std::size_t count, float gain) const;
+
+      bool get_read_range (uint64_t& read_start, std::size_t& read_count, std::size_t count) const;
+
+      bool is_intact (uint64_t read_start) const;
+
+      uint64_t get_position_at (Time const& time) const;
   };
 
-  AudioStream::Impl::Impl ()
-      : size { 0 }
+  AudioStream::Impl::Impl (unsigned int sample_rate_)
+      : sample_rate   (sample_rate_)
+      , samples       (sample_capacity, 0.0f)
+      , blocks        (block_capacity)
+      , start_pos     (0)
+      , write_pos     (0)
+      , write_reserve (0)
+      , first_block   (0)
+      , next_block    (0)
   {
       // empty
   }
 
-  void AudioStream::Impl::remove_stale_fragments (Time const& time)
+  void AudioStream::Impl::remove_stale_blocks (Time const& time)
   {
-      fragments.remove_if ([&] (Fragment const& fragment) -> bool {
-          if ((time - fragment.timestamp).to_usecs () > max_lifetime) {
-              size -= fragment.buffer->get_size ();
-              return true;
-          }
+      while (first_block != next_block) {
+          auto const& block = blocks[first_block & (block_capacity - 1)];
+
+          if ((time - block.timestamp).to_usecs () <= max_lifetime)
+              break;
 
+          remove_oldest_block ();
+      }
+  }
+
+  void AudioStream::Impl::remove_oldest_block ()
+  {
+      auto const& block = blocks[first_block & (block_capacity - 1)];
+
+      if (block.end > start_pos.load (std::memory_order_relaxed))
+          start_pos.store (block.end, std::memory_order_release);
+
+      first_block++;
+  }
+
+  void AudioStream::Impl::copy_in (uint64_t pos, float const* src, std::size_t count)
+  {
+      std::size_t offset = pos & (sample_capacity - 1);
+      std::size_t count1 = std::min (count, sample_capacity - offset);
+
+      visual_mem_copy (&samples[offset], src, count1 * sizeof (float));
+
+      if (count1 < count)
+          visual_mem_copy (&samples[0], src + count1, (count - count1) * sizeof (float));
+  }
+
+  void AudioStream::Impl::copy_out (float* dest, uint64_t pos, std::size_t count) const
+  {
+      std::size_t offset = pos & (sample_capacity - 1);
+      std::size_t count1 = std::min (count, sample_capacity - offset);
+
+      visual_mem_copy (dest, &samples[offset], count1 * sizeof (float));
+
+      if (count1 < count)
+          visual_mem_copy (dest + count1, &samples[0], (count - count1) * sizeof (float));
+  }
+
+  void AudioStream::Impl::mix_out (float* dest, uint64_t pos, std::size_t count, float gain) const
+  {
+      std::size_t offset = pos & (sample_capacity - 1);
+      std::size_t count1 = std::min (count, sample_capacity - offset);
+
+      visual_math_simd_mix_floats (dest, &samples[offset], gain, count1);
+
+      if (count1 < count)
+          visual_math_simd_mix_floats (dest + count1, &samples[0], gain, count - count1);
+  }
+
+  bool AudioStream::Impl::get_read_range (uint64_t& read_start, std::size_t& read_count, std::size_t count) const
+  {
+      auto end   = write_pos.load (std::memory_order_acquire);
+      auto start = start_pos.load (std::memory_order_acquire);
+
+      // Producer raced ahead between the two loads
+      if (start > end)
           return false;
-      });
+
+      read_count = std::size_t (std::min (uint64_t (count), end - start));
+      read_start = end - read_count;
+
+      return true;
   }
 
-  AudioStream::AudioStream ()
-      : m_impl (new Impl)
+  bool AudioStream::Impl::is_intact (uint64_t read_start) const
+  {
+      // Check if the producer has since started overwriting what was read
+      std::atomic_thread_fence (std::memory_order_acquire);
+
+      return write_reserve.load (std::memory_order_relaxed) - read_start <= sample_capacity;
+  }
+
+  uint64_t AudioStream::Impl::get_position_at (Time const& time) const
+  {
+      for (;;) {
+          auto last = next_block.load (std::memory_order_acquire);
+
+          if (last == 0)
+              return 0;
+
+          // The entry of block last - block_capacity is the next to be overwritten, and may be mid-write
+          auto first = last >= block_capacity ? last - block_capacity + 1 : 0;
+
+          // Find the oldest block that ends at or after the given time. Failing that, the newest block is used to
+          // extrapolate.
+          auto index = last - 1;
+          auto block = blocks[index & (block_capacity - 1)];
+
+          while (index > first) {
+              auto const& prev = blocks[(index - 1) & (block_capacity - 1)];
+
+              if (prev.timestamp < time)
+                  break;
+
+              block = prev;
+              index--;
+          }
+
+          // Check if the producer has since reused the block entry
+          std::atomic_thread_fence (std::memory_order_acquire);
+
+          if (next_block.load (std::memory_order_relaxed) - index >= block_capacity)
+              continue;
+
+          // Blocks are timestamped as of their last sample
+          auto offset = int64_t (std::floor ((block.timestamp - time).to_secs () * sample_rate + 0.5));
+
+          return offset < 0 || uint64_t (offset) < block.end ? block.end - offset : 0;
+      }
+  }
+
+  AudioStream::AudioStream (unsigned int sample_rate)
+      : m_impl (new Impl (sample_rate))
   {
       // empty
   }
@@ -84,82 +241,157 @@ namespace LV {
       // empty
   }
 
+  unsigned int AudioStream::get_sample_rate () const
+  {
+      return m_impl->sample_rate;
+  }
+
   std::size_t AudioStream::get_size () const
   {
-      return m_impl->size;
+      auto end   = m_impl->write_pos.load (std::memory_order_acquire);
+      auto start = m_impl->start_pos.load (std::memory_order_acquire);
+
+      return start < end ? (end - start) * sizeof (float) : 0;
   }
 
   void AudioStream::write (BufferConstPtr const& buffer, Time const& timestamp)
   {
-      // Invalidate stale fragments
-      m_impl->remove_stale_fragments (Time::now ());
+      write (static_cast<float const*> (buffer->get_data ()),
+             buffer->get_size () / sizeof (float),
+             timestamp);
+  }
+
+  void AudioStream::write (float const* samples, std::size_t count, Time const& timestamp)
+  {
+      if (count == 0)
+          return;
+
+      // Invalidate stale blocks
+      m_impl->remove_stale_blocks (timestamp);
+
+      // Keep only the most recent samples if the block is too large to fit in the ring
+      if (count > sample_capacity) {
+          samples += count - sample_capacity;
+          count = sample_capacity;
+      }
+
+      // Make room for a new block record
+      if (m_impl->next_block - m_impl->first_block == block_capacity) {
+          m_impl->remove_oldest_block ();
+      }
+
+      auto pos = m_impl->write_pos.load (std::memory_order_relaxed);
+      auto end = pos + count;
+
+      // Retire samples that are about to be overwritten
+      if (end - m_impl->start_pos.load (std::memory_order_relaxed) > sample_capacity) {
+          m_impl->start_pos.store (end - sample_capacity, std::memory_order_release);
+
+          while (m_impl->first_block != m_impl->next_block &&
+                 m_impl->blocks[m_impl->first_block & (block_capacity - 1)].end <= end - sample_capacity) {
+              m_impl->first_block++;
+          }
+      }
+
+      m_impl->write_reserve.store (end, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_release);
+
+      m_impl->copy_in (pos, samples, count);
+
+      auto block = m_impl->next_block.load (std::memory_order_relaxed);
+
+      m_impl->blocks[block & (block_capacity - 1)] = { timestamp, end };
+      m_impl->next_block.store (block + 1, std::memory_order_release);
 
-      // Add fragment to list
-      m_impl->fragments.push_back ({ buffer, timestamp });
-      m_impl->size += buffer->get_size ();
+      m_impl->write_pos.store (end, std::memory_order_release);
   }
 
   std::size_t AudioStream::read (BufferPtr const& buffer, std::size_t nbytes)
   {
       visual_return_val_if_fail (nbytes > 0, 0);
 
-      // Return if there are no fragments
-      if (m_impl->fragments.empty ()) {
-          return 0;
-      }
-
       // Truncate if read buffer is too small
       nbytes = std::min (nbytes, buffer->get_size ());
 
-      std::size_t size = 0;
-      std::size_t offset = 0;
+      return read (static_cast<float*> (buffer->get_data ()), nbytes / sizeof (float)) * sizeof (float);
+  }
 
-      auto last_fragment = m_impl->fragments.rbegin ();
+  std::size_t AudioStream::read (float* samples, std::size_t count)
+  {
+      visual_return_val_if_fail (count > 0, 0);
 
-      auto fragment = last_fragment;
+      for (;;) {
+          uint64_t    read_start;
+          std::size_t read_count;
 
-      // Find the oldest fragment to read from
-      if (nbytes <= m_impl->size) {
-          while (fragment != m_impl->fragments.rend ()) {
-              size += fragment->buffer->get_size ();
-              if (size >= nbytes) {
-                  offset = size - nbytes;
-                  break;
-              }
-              ++fragment;
-          }
-      } else {
-          fragment = m_impl->fragments.rend (); --fragment;
-          nbytes = m_impl->size;
+          if (!m_impl->get_read_range (read_start, read_count, count))
+              continue;
+
+          if (read_count == 0)
+              return 0;
+
+          m_impl->copy_out (samples, read_start, read_count);
+
+          if (m_impl->is_intact (read_start))
+              return read_count;
       }
+  }
 
-      std::size_t write_offset = 0;
+  std::size_t AudioStream::read_window (float* samples, std::size_t count, Time const& end_time)
+  {
+      visual_return_val_if_fail (count > 0, 0);
 
-      // Copy out a portion of the first fragment if its data is only partially needed
-      if (offset > 0) {
-          std::size_t size = fragment->buffer->get_size () - offset;
-          buffer->put (fragment->buffer->get_data (offset), size, write_offset);
+      for (;;) {
+          auto end_pos = m_impl->get_position_at (end_time);
 
-          // Finish if this is the only fragment
-          if (fragment == last_fragment) {
-              return nbytes;
-          }
+          auto end   = m_impl->write_pos.load (std::memory_order_acquire);
+          auto start = m_impl->start_pos.load (std::memory_order_acquire);
+
+          // Producer raced ahead between the two loads, try again
+          if (start > end)
+              continue;
+
+          // Samples beyond the most recent have yet to arrive, and samples before the oldest are gone
+          end_pos = std::min (end_pos, end);
 
-          write_offset += size;
-          --fragment;
+          if (end_pos <= start)
+              return 0;
+
+          auto read_count = std::size_t (std::min (uint64_t (count), end_pos - start));
+          auto read_start = end_pos - read_count;
+
+          m_impl->copy_out (samples, read_start, read_count);
+
+          if (m_impl->is_intact (read_start))
+              return read_count;
       }
+  }
 
-      // Copy out data in the remaining fragments
-      while (fragment != last_fragment) {
-          buffer->put (fragment->buffer, write_offset);
-          write_offset += fragment->buffer->get_size ();
-          --fragment;
+  std::size_t AudioStream::read_window (BufferPtr const& buffer, Time const& end_time, std::size_t nsamples)
+  {
+      visual_return_val_if_fail (nsamples > 0, 0);
+
+      // Truncate if read buffer is too small
+      nsamples = std::min (nsamples, buffer->get_size () / sizeof (float));
+
+      return read_window (static_cast<float*> (buffer->get_data ()), nsamples, end_time);
+  }
+
+  bool AudioStream::mix (float* samples, std::size_t count, float gain)
+  {
+      uint64_t    read_start;
+      std::size_t read_count;
+
+      while (!m_impl->get_read_range (read_start, read_count, count)) {
+          // try again
       }
 
-      // Copy out data in the last fragment
-      buffer->put (fragment->buffer, write_offset);
+      if (read_count == 0)
+          return true;
+
+      m_impl->mix_out (samples, read_start, read_count, gain);
 
-      return nbytes;
+      return m_impl->is_intact (read_start);
   }
 
 } // LV namespace
@@ -33,11 +33,21 @@
 
 namespace LV {
 
+  //! Single-channel stream of 32-bit floating point samples.
+  //!
+  //! Samples are held in a fixed-capacity ring buffer. A single producer thread may write to the stream while a single
+  //! consumer thread reads from it, without locking and without any memory allocation after construction.
+  //!
   class AudioStream
   {
   public:
 
-      AudioStream ();
+      /**
+       * Creates a stream.
+       *
+       * @param sample_rate sampling rate of the samples written to the stream
+       */
+      explicit AudioStream (unsigned int sample_rate);
 
       AudioStream (AudioStream const&) = delete;
 
@@ -45,12 +55,71 @@ namespace LV {
 
       AudioStream& operator= (AudioStream const&) = delete;
 
+      /**
+       * Returns the sampling rate.
+       */
+      unsigned int get_sample_rate () const;
+
+      /**
+       * Returns the number of bytes available for reading.
+       */
       std::size_t get_size () const;
 
+      /**
+       * Appends a block of samples to the stream.
+       *
+       * @note Blocks older than a second relative to the new block's timestamp are discarded.
+       *
+       * @param buffer    buffer of samples
+       * @param timestamp time of capture, taken as the time just after the last sample in the block
+       */
       void write (BufferConstPtr const& buffer, Time const& timestamp);
 
+      void write (float const* samples, std::size_t count, Time const& timestamp);
+
+      /**
+       * Reads the most recent samples in the stream.
+       *
+       * @param buffer buffer to hold the samples
+       * @param nbytes number of bytes to read
+       *
+       * @return number of bytes read
+       */
       std::size_t read (BufferPtr const& buffer, std::size_t nbytes);
 
+      std::size_t read (float* samples, std::size_t count);
+
+      /**
+       * Reads the samples captured up to a given time.
+       *
+       * Sample times are derived from block timestamps and the sampling rate. If the stream does not yet hold
+       * samples as recent as end_time, the most recent samples are read instead.
+       *
+       * @param buffer   buffer to hold the samples
+       * @param end_time capture time of the sample following the last sample to read
+       * @param nsamples number of samples to read
+       *
+       * @return number of samples read
+       */
+      std::size_t read_window (BufferPtr const& buffer, Time const& end_time, std::size_t nsamples);
+
+      std::size_t read_window (float* samples, std::size_t count, Time const& end_time);
+
+      /**
+       * Adds the most recent samples in the stream, multiplied by a gain, to an array.
+       *
+       * Samples are read directly out of the stream's storage. If fewer than count samples are available, they are
+       * added to the start of the array.
+       *
+       * @param samples array of samples to add to
+       * @param count   number of samples to mix
+       * @param gain    sample multiplier
+       *
+       * @return false if the samples were overwritten by the producer while being mixed, in which case the contents
+       *         of the array are undefined and need to be recomputed
+       */
+      bool mix (float* samples, std::size_t count, float gain);
+
   private:
 
       class Impl;
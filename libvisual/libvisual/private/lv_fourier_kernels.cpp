@@ -0,0 +1,246 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "private/lv_fourier_kernels.hpp"
+
+namespace LV {
+
+  namespace {
+
+    // Butterflies for mixed radix passes. Each computes a small DFT over inputs already multiplied by twiddle
+    // factors, in place.
+
+    inline void butterfly2 (float* xr, float* xi)
+    {
+        float yr = xr[0] - xr[1];
+        float yi = xi[0] - xi[1];
+
+        xr[0] += xr[1];
+        xi[0] += xi[1];
+        xr[1] = yr;
+        xi[1] = yi;
+    }
+
+    inline void butterfly3 (float* xr, float* xi)
+    {
+        float const s = 0.866025403784438647f;  // sin (2 pi / 3)
+
+        float tr = xr[1] + xr[2];
+        float ti = xi[1] + xi[2];
+        float dr = xr[1] - xr[2];
+        float di = xi[1] - xi[2];
+
+        float ar = xr[0] - 0.5f * tr;
+        float ai = xi[0] - 0.5f * ti;
+
+        xr[0] += tr;
+        xi[0] += ti;
+        xr[1] = ar + s * di;
+        xi[1] = ai - s * dr;
+        xr[2] = ar - s * di;
+        xi[2] = ai + s * dr;
+    }
+
+    inline void butterfly4 (float* xr, float* xi)
+    {
+        float t0r = xr[0] + xr[2];
+        float t0i = xi[0] + xi[2];
+        float t1r = xr[0] - xr[2];
+        float t1i = xi[0] - xi[2];
+        float t2r = xr[1] + xr[3];
+        float t2i = xi[1] + xi[3];
+        float t3r = xr[1] - xr[3];
+        float t3i = xi[1] - xi[3];
+
+        xr[0] = t0r + t2r;
+        xi[0] = t0i + t2i;
+        xr[2] = t0r - t2r;
+        xi[2] = t0i - t2i;
+
+        // t1 -/+ i * t3
+        xr[1] = t1r + t3i;
+        xi[1] = t1i - t3r;
+        xr[3] = t1r - t3i;
+        xi[3] = t1i + t3r;
+    }
+
+    inline void butterfly5 (float* xr, float* xi)
+    {
+        float const c1 =  0.309016994374947424f;  // cos (2 pi / 5)
+        float const c2 = -0.809016994374947424f;  // cos (4 pi / 5)
+        float const s1 =  0.951056516295153572f;  // sin (2 pi / 5)
+        float const s2 =  0.587785252292473129f;  // sin (4 pi / 5)
+
+        float t1r = xr[1] + xr[4];
+        float t1i = xi[1] + xi[4];
+        float t2r = xr[2] + xr[3];
+        float t2i = xi[2] + xi[3];
+        float d1r = xr[1] - xr[4];
+        float d1i = xi[1] - xi[4];
+        float d2r = xr[2] - xr[3];
+        float d2i = xi[2] - xi[3];
+
+        float a1r = xr[0] + c1 * t1r + c2 * t2r;
+        float a1i = xi[0] + c1 * t1i + c2 * t2i;
+        float a2r = xr[0] + c2 * t1r + c1 * t2r;
+        float a2i = xi[0] + c2 * t1i + c1 * t2i;
+
+        float u1r = s1 * d1r + s2 * d2r;
+        float u1i = s1 * d1i + s2 * d2i;
+        float u2r = s2 * d1r - s1 * d2r;
+        float u2i = s2 * d1i - s1 * d2i;
+
+        xr[0] += t1r + t2r;
+        xi[0] += t1i + t2i;
+
+        // a -/+ i * u
+        xr[1] = a1r + u1i;
+        xi[1] = a1i - u1r;
+        xr[4] = a1r - u1i;
+        xi[4] = a1i + u1r;
+        xr[2] = a2r + u2i;
+        xi[2] = a2i - u2r;
+        xr[3] = a2r - u2i;
+        xi[3] = a2i + u2r;
+    }
+
+  } // anonymous namespace
+
+  void FFTKernels::radix4_pass (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles)
+  {
+      auto w1r = twiddles;
+      auto w1i = twiddles + span;
+      auto w2r = twiddles + span * 2;
+      auto w2i = twiddles + span * 3;
+      auto w3r = twiddles + span * 4;
+      auto w3i = twiddles + span * 5;
+
+      for (unsigned int j = 0; j < size; j += span * 4) {
+          auto r0 = re + j;
+          auto r1 = r0 + span;
+          auto r2 = r1 + span;
+          auto r3 = r2 + span;
+
+          auto i0 = im + j;
+          auto i1 = i0 + span;
+          auto i2 = i1 + span;
+          auto i3 = i2 + span;
+
+          for (unsigned int m = 0; m < span; m++) {
+              float a1r = w1r[m] * r1[m] - w1i[m] * i1[m];
+              float a1i = w1r[m] * i1[m] + w1i[m] * r1[m];
+              float a2r = w2r[m] * r2[m] - w2i[m] * i2[m];
+              float a2i = w2r[m] * i2[m] + w2i[m] * r2[m];
+              float a3r = w3r[m] * r3[m] - w3i[m] * i3[m];
+              float a3i = w3r[m] * i3[m] + w3i[m] * r3[m];
+
+              float b0r = r0[m] + a1r;
+              float b0i = i0[m] + a1i;
+              float b1r = r0[m] - a1r;
+              float b1i = i0[m] - a1i;
+              float b2r = a2r + a3r;
+              float b2i = a2i + a3i;
+              float b3r = a2r - a3r;
+              float b3i = a2i - a3i;
+
+              r0[m] = b0r + b2r;
+              i0[m] = b0i + b2i;
+              r2[m] = b0r - b2r;
+              i2[m] = b0i - b2i;
+
+              // b1 -/+ i * b3
+              r1[m] = b1r + b3i;
+              i1[m] = b1i - b3r;
+              r3[m] = b1r - b3i;
+              i3[m] = b1i + b3r;
+          }
+      }
+  }
+
+  void FFTKernels::radix2_pass (float* re, float* im, unsigned int size)
+  {
+      for (unsigned int i = 0; i < size; i += 2) {
+          float tr = re[i + 1];
+          float ti = im[i + 1];
+
+          re[i + 1] = re[i] - tr;
+          im[i + 1] = im[i] - ti;
+          re[i] += tr;
+          im[i] += ti;
+      }
+  }
+
+  void FFTKernels::mixed_radix_pass (float* re, float* im, unsigned int size, unsigned int radix, unsigned int span,
+                                     float const* twiddles)
+  {
+      float xr[5];
+      float xi[5];
+
+      for (unsigned int j = 0; j < size; j += span * radix) {
+          for (unsigned int m = 0; m < span; m++) {
+              xr[0] = re[j + m];
+              xi[0] = im[j + m];
+
+              for (unsigned int q = 1; q < radix; q++) {
+                  float wr = twiddles[(2 * q - 2) * span + m];
+                  float wi = twiddles[(2 * q - 1) * span + m];
+                  float ar = re[j + q * span + m];
+                  float ai = im[j + q * span + m];
+
+                  xr[q] = wr * ar - wi * ai;
+                  xi[q] = wr * ai + wi * ar;
+              }
+
+              switch (radix) {
+                  case 2: butterfly2 (xr, xi); break;
+                  case 3: butterfly3 (xr, xi); break;
+                  case 4: butterfly4 (xr, xi); break;
+                  case 5: butterfly5 (xr, xi); break;
+              }
+
+              for (unsigned int q = 0; q < radix; q++) {
+                  re[j + q * span + m] = xr[q];
+                  im[j + q * span + m] = xi[q];
+              }
+          }
+      }
+  }
+
+  void FFTKernels::real_post (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                              unsigned int size, unsigned int begin, unsigned int end)
+  {
+      for (unsigned int k = begin; k < end; k++) {
+          float ar = zr[k];
+          float ai = zi[k];
+          float cr = zr[size - k];
+          float ci = zi[size - k];
+
+          // Spectra of the even (e) and odd (o) samples
+          float er = 0.5f * (ar + cr);
+          float ei = 0.5f * (ai - ci);
+          float or_ = 0.5f * (ai + ci);
+          float oi = 0.5f * (cr - ar);
+
+          xr[k] = er + wr[k] * or_ - wi[k] * oi;
+          xi[k] = ei + wr[k] * oi + wi[k] * or_;
+      }
+  }
+
+} // LV namespace
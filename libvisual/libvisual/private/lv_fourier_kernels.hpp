@@ -0,0 +1,99 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _LV_FOURIER_KERNELS_HPP
+#define _LV_FOURIER_KERNELS_HPP
+
+#include "lvconfig.h"
+#include "lv_defines.h"
+
+namespace LV {
+
+  //! FFT building blocks operating on complex numbers stored as separate arrays of real and imaginary parts.
+  //!
+  //! Each operation has a portable implementation and variants for SSE and AVX2. The SIMD variants fall back to
+  //! the portable implementation where the data is too small to fill a vector.
+  //!
+  class FFTKernels
+  {
+  public:
+
+      /**
+       * Performs a radix-4 decimation-in-time pass in place.
+       *
+       * @param re       real parts
+       * @param im       imaginary parts
+       * @param size     number of points
+       * @param span     quarter of the butterfly size
+       * @param twiddles twiddle factors for the pass (6 * span floats, see DFTPlan)
+       */
+      static void radix4_pass      (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles);
+      static void radix4_pass_sse  (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles);
+      static void radix4_pass_avx2 (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles);
+
+      /**
+       * Performs a radix-2 decimation-in-time pass with butterflies spanning 2 points, in place.
+       *
+       * @param re   real parts
+       * @param im   imaginary parts
+       * @param size number of points
+       */
+      static void radix2_pass      (float* re, float* im, unsigned int size);
+      static void radix2_pass_sse  (float* re, float* im, unsigned int size);
+
+      /**
+       * Performs a mixed radix decimation-in-time pass in place.
+       *
+       * @param re       real parts
+       * @param im       imaginary parts
+       * @param size     number of points
+       * @param radix    radix (2, 3, 4 or 5)
+       * @param span     butterfly size divided by radix
+       * @param twiddles twiddle factors for the pass (2 * (radix - 1) * span floats, see DFTPlan)
+       */
+      static void mixed_radix_pass (float* re, float* im, unsigned int size, unsigned int radix, unsigned int span,
+                                    float const* twiddles);
+
+      /**
+       * Computes bins [begin, end) of the spectrum of 2 * size real samples from the complex FFT of size points,
+       * whose real and imaginary parts hold the even and odd samples respectively.
+       *
+       * @note begin must be at least 1 and end at most size.
+       *
+       * @param xr    real parts of the output spectrum
+       * @param xi    imaginary parts of the output spectrum
+       * @param zr    real parts of the complex FFT
+       * @param zi    imaginary parts of the complex FFT
+       * @param wr    real parts of exp (-2 pi i k / (2 * size))
+       * @param wi    imaginary parts of exp (-2 pi i k / (2 * size))
+       * @param size  size of complex FFT
+       * @param begin first bin
+       * @param end   one past the last bin
+       */
+      static void real_post      (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                                  unsigned int size, unsigned int begin, unsigned int end);
+      static void real_post_sse  (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                                  unsigned int size, unsigned int begin, unsigned int end);
+      static void real_post_avx2 (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                                  unsigned int size, unsigned int begin, unsigned int end);
+  };
+
+} // LV namespace
+
+#endif // _LV_FOURIER_KERNELS_HPP
@@ -0,0 +1,402 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_fourier_kernels.hpp"
+
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
+
+namespace LV {
+
+  // SSE kernels
+
+#if defined(LV_HAVE_X86_SIMD)
+  namespace {
+
+    // Radix-4 butterfly over inputs already multiplied by twiddle factors
+    LV_ATTR_TARGET ("sse")
+    inline void butterfly4_sse (__m128& x0r, __m128& x0i, __m128& x1r, __m128& x1i,
+                                __m128& x2r, __m128& x2i, __m128& x3r, __m128& x3i)
+    {
+        __m128 b0r = _mm_add_ps (x0r, x1r), b0i = _mm_add_ps (x0i, x1i);
+        __m128 b1r = _mm_sub_ps (x0r, x1r), b1i = _mm_sub_ps (x0i, x1i);
+        __m128 b2r = _mm_add_ps (x2r, x3r), b2i = _mm_add_ps (x2i, x3i);
+        __m128 b3r = _mm_sub_ps (x2r, x3r), b3i = _mm_sub_ps (x2i, x3i);
+
+        x0r = _mm_add_ps (b0r, b2r);
+        x0i = _mm_add_ps (b0i, b2i);
+        x2r = _mm_sub_ps (b0r, b2r);
+        x2i = _mm_sub_ps (b0i, b2i);
+        x1r = _mm_add_ps (b1r, b3i);
+        x1i = _mm_sub_ps (b1i, b3r);
+        x3r = _mm_sub_ps (b1r, b3i);
+        x3i = _mm_add_ps (b1i, b3r);
+    }
+
+    LV_ATTR_TARGET ("sse")
+    inline void twiddle_sse (__m128& xr, __m128& xi, __m128 wr, __m128 wi)
+    {
+        __m128 yr = _mm_sub_ps (_mm_mul_ps (wr, xr), _mm_mul_ps (wi, xi));
+        xi = _mm_add_ps (_mm_mul_ps (wr, xi), _mm_mul_ps (wi, xr));
+        xr = yr;
+    }
+
+    // Radix-4 pass with span 1. Butterflies are transposed so that each vector holds one input from 4 of them.
+    LV_ATTR_TARGET ("sse")
+    unsigned int radix4_span1_sse (float* re, float* im, unsigned int size)
+    {
+        unsigned int n = size & ~15U;
+
+        for (unsigned int j = 0; j < n; j += 16) {
+            __m128 x0r = _mm_load_ps (re + j),     x0i = _mm_load_ps (im + j);
+            __m128 x1r = _mm_load_ps (re + j + 4), x1i = _mm_load_ps (im + j + 4);
+            __m128 x2r = _mm_load_ps (re + j + 8), x2i = _mm_load_ps (im + j + 8);
+            __m128 x3r = _mm_load_ps (re + j + 12), x3i = _mm_load_ps (im + j + 12);
+
+            _MM_TRANSPOSE4_PS (x0r, x1r, x2r, x3r);
+            _MM_TRANSPOSE4_PS (x0i, x1i, x2i, x3i);
+
+            butterfly4_sse (x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i);
+
+            _MM_TRANSPOSE4_PS (x0r, x1r, x2r, x3r);
+            _MM_TRANSPOSE4_PS (x0i, x1i, x2i, x3i);
+
+            _mm_store_ps (re + j,      x0r); _mm_store_ps (im + j,      x0i);
+            _mm_store_ps (re + j + 4,  x1r); _mm_store_ps (im + j + 4,  x1i);
+            _mm_store_ps (re + j + 8,  x2r); _mm_store_ps (im + j + 8,  x2i);
+            _mm_store_ps (re + j + 12, x3r); _mm_store_ps (im + j + 12, x3i);
+        }
+
+        return n;
+    }
+
+    // Radix-4 pass with span 2. Each vector holds one input from 2 butterflies.
+    LV_ATTR_TARGET ("sse")
+    unsigned int radix4_span2_sse (float* re, float* im, unsigned int size, float const* twiddles)
+    {
+        __m128 const w1r = _mm_setr_ps (twiddles[0],  twiddles[1],  twiddles[0],  twiddles[1]);
+        __m128 const w1i = _mm_setr_ps (twiddles[2],  twiddles[3],  twiddles[2],  twiddles[3]);
+        __m128 const w2r = _mm_setr_ps (twiddles[4],  twiddles[5],  twiddles[4],  twiddles[5]);
+        __m128 const w2i = _mm_setr_ps (twiddles[6],  twiddles[7],  twiddles[6],  twiddles[7]);
+        __m128 const w3r = _mm_setr_ps (twiddles[8],  twiddles[9],  twiddles[8],  twiddles[9]);
+        __m128 const w3i = _mm_setr_ps (twiddles[10], twiddles[11], twiddles[10], twiddles[11]);
+
+        unsigned int n = size & ~15U;
+
+        for (unsigned int j = 0; j < n; j += 16) {
+            __m128 v0r = _mm_load_ps (re + j),      v0i = _mm_load_ps (im + j);
+            __m128 v1r = _mm_load_ps (re + j + 4),  v1i = _mm_load_ps (im + j + 4);
+            __m128 v2r = _mm_load_ps (re + j + 8),  v2i = _mm_load_ps (im + j + 8);
+            __m128 v3r = _mm_load_ps (re + j + 12), v3i = _mm_load_ps (im + j + 12);
+
+            __m128 x0r = _mm_movelh_ps (v0r, v2r), x0i = _mm_movelh_ps (v0i, v2i);
+            __m128 x1r = _mm_movehl_ps (v2r, v0r), x1i = _mm_movehl_ps (v2i, v0i);
+            __m128 x2r = _mm_movelh_ps (v1r, v3r), x2i = _mm_movelh_ps (v1i, v3i);
+            __m128 x3r = _mm_movehl_ps (v3r, v1r), x3i = _mm_movehl_ps (v3i, v1i);
+
+            twiddle_sse (x1r, x1i, w1r, w1i);
+            twiddle_sse (x2r, x2i, w2r, w2i);
+            twiddle_sse (x3r, x3i, w3r, w3i);
+
+            butterfly4_sse (x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i);
+
+            _mm_store_ps (re + j,      _mm_movelh_ps (x0r, x1r)); _mm_store_ps (im + j,      _mm_movelh_ps (x0i, x1i));
+            _mm_store_ps (re + j + 4,  _mm_movelh_ps (x2r, x3r)); _mm_store_ps (im + j + 4,  _mm_movelh_ps (x2i, x3i));
+            _mm_store_ps (re + j + 8,  _mm_movehl_ps (x1r, x0r)); _mm_store_ps (im + j + 8,  _mm_movehl_ps (x1i, x0i));
+            _mm_store_ps (re + j + 12, _mm_movehl_ps (x3r, x2r)); _mm_store_ps (im + j + 12, _mm_movehl_ps (x3i, x2i));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("sse")
+    void radix2_sse (float* re, float* im, unsigned int size)
+    {
+        unsigned int n = size & ~7U;
+
+        for (unsigned int i = 0; i < n; i += 8) {
+            __m128 ar = _mm_load_ps (re + i), br = _mm_load_ps (re + i + 4);
+            __m128 ai = _mm_load_ps (im + i), bi = _mm_load_ps (im + i + 4);
+
+            __m128 er = _mm_shuffle_ps (ar, br, _MM_SHUFFLE (2, 0, 2, 0));
+            __m128 ei = _mm_shuffle_ps (ai, bi, _MM_SHUFFLE (2, 0, 2, 0));
+            __m128 or_ = _mm_shuffle_ps (ar, br, _MM_SHUFFLE (3, 1, 3, 1));
+            __m128 oi = _mm_shuffle_ps (ai, bi, _MM_SHUFFLE (3, 1, 3, 1));
+
+            __m128 sr = _mm_add_ps (er, or_), si = _mm_add_ps (ei, oi);
+            __m128 dr = _mm_sub_ps (er, or_), di = _mm_sub_ps (ei, oi);
+
+            _mm_store_ps (re + i,     _mm_unpacklo_ps (sr, dr));
+            _mm_store_ps (re + i + 4, _mm_unpackhi_ps (sr, dr));
+            _mm_store_ps (im + i,     _mm_unpacklo_ps (si, di));
+            _mm_store_ps (im + i + 4, _mm_unpackhi_ps (si, di));
+        }
+
+        FFTKernels::radix2_pass (re + n, im + n, size - n);
+    }
+
+    LV_ATTR_TARGET ("sse")
+    void radix4_sse (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles)
+    {
+        if (span < 4) {
+            unsigned int n = (span == 1) ? radix4_span1_sse (re, im, size)
+                                         : radix4_span2_sse (re, im, size, twiddles);
+
+            FFTKernels::radix4_pass (re + n, im + n, size - n, span, twiddles);
+            return;
+        }
+
+        auto w1r = twiddles;
+        auto w1i = twiddles + span;
+        auto w2r = twiddles + span * 2;
+        auto w2i = twiddles + span * 3;
+        auto w3r = twiddles + span * 4;
+        auto w3i = twiddles + span * 5;
+
+        for (unsigned int j = 0; j < size; j += span * 4) {
+            auto r0 = re + j;
+            auto r1 = r0 + span;
+            auto r2 = r1 + span;
+            auto r3 = r2 + span;
+
+            auto i0 = im + j;
+            auto i1 = i0 + span;
+            auto i2 = i1 + span;
+            auto i3 = i2 + span;
+
+            for (unsigned int m = 0; m < span; m += 4) {
+                __m128 x1r = _mm_load_ps (r1 + m), x1i = _mm_load_ps (i1 + m);
+                __m128 x2r = _mm_load_ps (r2 + m), x2i = _mm_load_ps (i2 + m);
+                __m128 x3r = _mm_load_ps (r3 + m), x3i = _mm_load_ps (i3 + m);
+
+                __m128 t1r = _mm_load_ps (w1r + m), t1i = _mm_load_ps (w1i + m);
+                __m128 t2r = _mm_load_ps (w2r + m), t2i = _mm_load_ps (w2i + m);
+                __m128 t3r = _mm_load_ps (w3r + m), t3i = _mm_load_ps (w3i + m);
+
+                __m128 a1r = _mm_sub_ps (_mm_mul_ps (t1r, x1r), _mm_mul_ps (t1i, x1i));
+                __m128 a1i = _mm_add_ps (_mm_mul_ps (t1r, x1i), _mm_mul_ps (t1i, x1r));
+                __m128 a2r = _mm_sub_ps (_mm_mul_ps (t2r, x2r), _mm_mul_ps (t2i, x2i));
+                __m128 a2i = _mm_add_ps (_mm_mul_ps (t2r, x2i), _mm_mul_ps (t2i, x2r));
+                __m128 a3r = _mm_sub_ps (_mm_mul_ps (t3r, x3r), _mm_mul_ps (t3i, x3i));
+                __m128 a3i = _mm_add_ps (_mm_mul_ps (t3r, x3i), _mm_mul_ps (t3i, x3r));
+
+                __m128 x0r = _mm_load_ps (r0 + m), x0i = _mm_load_ps (i0 + m);
+
+                __m128 b0r = _mm_add_ps (x0r, a1r), b0i = _mm_add_ps (x0i, a1i);
+                __m128 b1r = _mm_sub_ps (x0r, a1r), b1i = _mm_sub_ps (x0i, a1i);
+                __m128 b2r = _mm_add_ps (a2r, a3r), b2i = _mm_add_ps (a2i, a3i);
+                __m128 b3r = _mm_sub_ps (a2r, a3r), b3i = _mm_sub_ps (a2i, a3i);
+
+                _mm_store_ps (r0 + m, _mm_add_ps (b0r, b2r));
+                _mm_store_ps (i0 + m, _mm_add_ps (b0i, b2i));
+                _mm_store_ps (r2 + m, _mm_sub_ps (b0r, b2r));
+                _mm_store_ps (i2 + m, _mm_sub_ps (b0i, b2i));
+                _mm_store_ps (r1 + m, _mm_add_ps (b1r, b3i));
+                _mm_store_ps (i1 + m, _mm_sub_ps (b1i, b3r));
+                _mm_store_ps (r3 + m, _mm_sub_ps (b1r, b3i));
+                _mm_store_ps (i3 + m, _mm_add_ps (b1i, b3r));
+            }
+        }
+    }
+
+    LV_ATTR_TARGET ("sse")
+    void real_post_pass_sse (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                             unsigned int size, unsigned int begin, unsigned int end)
+    {
+        __m128 const half = _mm_set1_ps (0.5f);
+
+        unsigned int k = begin;
+
+        for (; k + 4 <= end; k += 4) {
+            __m128 ar = _mm_loadu_ps (zr + k);
+            __m128 ai = _mm_loadu_ps (zi + k);
+
+            // Z[size - k - 3] .. Z[size - k], reversed
+            __m128 cr = _mm_loadu_ps (zr + size - k - 3);
+            __m128 ci = _mm_loadu_ps (zi + size - k - 3);
+            cr = _mm_shuffle_ps (cr, cr, _MM_SHUFFLE (0, 1, 2, 3));
+            ci = _mm_shuffle_ps (ci, ci, _MM_SHUFFLE (0, 1, 2, 3));
+
+            __m128 er = _mm_mul_ps (half, _mm_add_ps (ar, cr));
+            __m128 ei = _mm_mul_ps (half, _mm_sub_ps (ai, ci));
+            __m128 or_ = _mm_mul_ps (half, _mm_add_ps (ai, ci));
+            __m128 oi = _mm_mul_ps (half, _mm_sub_ps (cr, ar));
+
+            __m128 tr = _mm_loadu_ps (wr + k);
+            __m128 ti = _mm_loadu_ps (wi + k);
+
+            _mm_storeu_ps (xr + k, _mm_add_ps (er, _mm_sub_ps (_mm_mul_ps (tr, or_), _mm_mul_ps (ti, oi))));
+            _mm_storeu_ps (xi + k, _mm_add_ps (ei, _mm_add_ps (_mm_mul_ps (tr, oi), _mm_mul_ps (ti, or_))));
+        }
+
+        FFTKernels::real_post (xr, xi, zr, zi, wr, wi, size, k, end);
+    }
+
+    // AVX2 kernels
+
+    LV_ATTR_TARGET ("avx2")
+    void radix4_avx2 (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles)
+    {
+        if (span < 8) {
+            radix4_sse (re, im, size, span, twiddles);
+            return;
+        }
+
+        auto w1r = twiddles;
+        auto w1i = twiddles + span;
+        auto w2r = twiddles + span * 2;
+        auto w2i = twiddles + span * 3;
+        auto w3r = twiddles + span * 4;
+        auto w3i = twiddles + span * 5;
+
+        for (unsigned int j = 0; j < size; j += span * 4) {
+            auto r0 = re + j;
+            auto r1 = r0 + span;
+            auto r2 = r1 + span;
+            auto r3 = r2 + span;
+
+            auto i0 = im + j;
+            auto i1 = i0 + span;
+            auto i2 = i1 + span;
+            auto i3 = i2 + span;
+
+            for (unsigned int m = 0; m < span; m += 8) {
+                __m256 x1r = _mm256_load_ps (r1 + m), x1i = _mm256_load_ps (i1 + m);
+                __m256 x2r = _mm256_load_ps (r2 + m), x2i = _mm256_load_ps (i2 + m);
+                __m256 x3r = _mm256_load_ps (r3 + m), x3i = _mm256_load_ps (i3 + m);
+
+                __m256 t1r = _mm256_load_ps (w1r + m), t1i = _mm256_load_ps (w1i + m);
+                __m256 t2r = _mm256_load_ps (w2r + m), t2i = _mm256_load_ps (w2i + m);
+                __m256 t3r = _mm256_load_ps (w3r + m), t3i = _mm256_load_ps (w3i + m);
+
+                __m256 a1r = _mm256_sub_ps (_mm256_mul_ps (t1r, x1r), _mm256_mul_ps (t1i, x1i));
+                __m256 a1i = _mm256_add_ps (_mm256_mul_ps (t1r, x1i), _mm256_mul_ps (t1i, x1r));
+                __m256 a2r = _mm256_sub_ps (_mm256_mul_ps (t2r, x2r), _mm256_mul_ps (t2i, x2i));
+                __m256 a2i = _mm256_add_ps (_mm256_mul_ps (t2r, x2i), _mm256_mul_ps (t2i, x2r));
+                __m256 a3r = _mm256_sub_ps (_mm256_mul_ps (t3r, x3r), _mm256_mul_ps (t3i, x3i));
+                __m256 a3i = _mm256_add_ps (_mm256_mul_ps (t3r, x3i), _mm256_mul_ps (t3i, x3r));
+
+                __m256 x0r = _mm256_load_ps (r0 + m), x0i = _mm256_load_ps (i0 + m);
+
+                __m256 b0r = _mm256_add_ps (x0r, a1r), b0i = _mm256_add_ps (x0i, a1i);
+                __m256 b1r = _mm256_sub_ps (x0r, a1r), b1i = _mm256_sub_ps (x0i, a1i);
+                __m256 b2r = _mm256_add_ps (a2r, a3r), b2i = _mm256_add_ps (a2i, a3i);
+                __m256 b3r = _mm256_sub_ps (a2r, a3r), b3i = _mm256_sub_ps (a2i, a3i);
+
+                _mm256_store_ps (r0 + m, _mm256_add_ps (b0r, b2r));
+                _mm256_store_ps (i0 + m, _mm256_add_ps (b0i, b2i));
+                _mm256_store_ps (r2 + m, _mm256_sub_ps (b0r, b2r));
+                _mm256_store_ps (i2 + m, _mm256_sub_ps (b0i, b2i));
+                _mm256_store_ps (r1 + m, _mm256_add_ps (b1r, b3i));
+                _mm256_store_ps (i1 + m, _mm256_sub_ps (b1i, b3r));
+                _mm256_store_ps (r3 + m, _mm256_sub_ps (b1r, b3i));
+                _mm256_store_ps (i3 + m, _mm256_add_ps (b1i, b3r));
+            }
+        }
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    void real_post_pass_avx2 (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                              unsigned int size, unsigned int begin, unsigned int end)
+    {
+        __m256  const half    = _mm256_set1_ps (0.5f);
+        __m256i const reverse = _mm256_set_epi32 (0, 1, 2, 3, 4, 5, 6, 7);
+
+        unsigned int k = begin;
+
+        for (; k + 8 <= end; k += 8) {
+            __m256 ar = _mm256_loadu_ps (zr + k);
+            __m256 ai = _mm256_loadu_ps (zi + k);
+
+            // Z[size - k - 7] .. Z[size - k], reversed
+            __m256 cr = _mm256_permutevar8x32_ps (_mm256_loadu_ps (zr + size - k - 7), reverse);
+            __m256 ci = _mm256_permutevar8x32_ps (_mm256_loadu_ps (zi + size - k - 7), reverse);
+
+            __m256 er = _mm256_mul_ps (half, _mm256_add_ps (ar, cr));
+            __m256 ei = _mm256_mul_ps (half, _mm256_sub_ps (ai, ci));
+            __m256 or_ = _mm256_mul_ps (half, _mm256_add_ps (ai, ci));
+            __m256 oi = _mm256_mul_ps (half, _mm256_sub_ps (cr, ar));
+
+            __m256 tr = _mm256_loadu_ps (wr + k);
+            __m256 ti = _mm256_loadu_ps (wi + k);
+
+            _mm256_storeu_ps (xr + k, _mm256_add_ps (er, _mm256_sub_ps (_mm256_mul_ps (tr, or_), _mm256_mul_ps (ti, oi))));
+            _mm256_storeu_ps (xi + k, _mm256_add_ps (ei, _mm256_add_ps (_mm256_mul_ps (tr, oi), _mm256_mul_ps (ti, or_))));
+        }
+
+        real_post_pass_sse (xr, xi, zr, zi, wr, wi, size, k, end);
+    }
+
+  } // anonymous namespace
+#endif
+
+  void FFTKernels::radix2_pass_sse (float* re, float* im, unsigned int size)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      radix2_sse (re, im, size);
+#else
+      radix2_pass (re, im, size);
+#endif
+  }
+
+  void FFTKernels::radix4_pass_sse (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      radix4_sse (re, im, size, span, twiddles);
+#else
+      radix4_pass (re, im, size, span, twiddles);
+#endif
+  }
+
+  void FFTKernels::real_post_sse (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                                  unsigned int size, unsigned int begin, unsigned int end)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      real_post_pass_sse (xr, xi, zr, zi, wr, wi, size, begin, end);
+#else
+      real_post (xr, xi, zr, zi, wr, wi, size, begin, end);
+#endif
+  }
+
+  void FFTKernels::radix4_pass_avx2 (float* re, float* im, unsigned int size, unsigned int span, float const* twiddles)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      radix4_avx2 (re, im, size, span, twiddles);
+#else
+      radix4_pass (re, im, size, span, twiddles);
+#endif
+  }
+
+  void FFTKernels::real_post_avx2 (float* xr, float* xi, float const* zr, float const* zi, float const* wr, float const* wi,
+                                   unsigned int size, unsigned int begin, unsigned int end)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      real_post_pass_avx2 (xr, xi, zr, zi, wr, wi, size, begin, end);
+#else
+      real_post (xr, xi, zr, zi, wr, wi, size, begin, end);
+#endif
+  }
+
+} // LV namespace
@@ -0,0 +1,564 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "private/lv_fourier_plan.hpp"
+#include "private/lv_fourier_kernels.hpp"
+#include "lv_common.h"
+#include "lv_math.h"
+#include "lv_cpu.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace LV {
+
+  namespace {
+
+    typedef std::pair<DFTMethod, unsigned int> PlanKey;
+    typedef std::map<PlanKey, DFTPlanConstPtr> PlanTable;
+
+    typedef std::pair<VisDFTWindow, unsigned int>  WindowKey;
+    typedef std::map<WindowKey, DFTWindowConstPtr> WindowTable;
+
+    typedef std::tuple<unsigned int, unsigned int, VisDFTBandScale> BandTableKey;
+    typedef std::map<BandTableKey, DFTBandTableConstPtr>            BandTableTable;
+
+    double const pi = 3.141592653589793238462643383279502884;
+
+    // FFT sizes planned at initialization
+    unsigned int const common_fft_sizes[] = { 256, 512, 1024, 2048 };
+
+    struct PlanStore
+    {
+        std::mutex  mutex;
+        PlanTable      plans;
+        WindowTable    windows;
+        BandTableTable band_tables;
+    };
+
+    PlanStore& plan_store ()
+    {
+        static PlanStore store;
+        return store;
+    }
+
+    // Mixed radix FFT radices, in order of preference
+    unsigned int const mixed_radices[] = { 4, 2, 3, 5 };
+
+    bool is_mixed_radix_size (unsigned int size)
+    {
+        for (auto radix : { 2U, 3U, 5U }) {
+            while (size % radix == 0)
+                size /= radix;
+        }
+
+        return size == 1;
+    }
+
+    void permute_input (float* real, float* imag, float const* in_real, float const* in_imag, unsigned int in_stride,
+                        float const* window_real, float const* window_imag, std::vector<unsigned int> const& table)
+    {
+        unsigned int size = table.size ();
+
+        if (window_real) {
+            for (unsigned int i = 0; i < size; i++) {
+                unsigned int idx = table[i] * in_stride;
+
+                real[i] = in_real[idx] * window_real[idx];
+                imag[i] = in_imag ? in_imag[idx] * window_imag[idx] : 0.0f;
+            }
+        } else {
+            for (unsigned int i = 0; i < size; i++) {
+                unsigned int idx = table[i] * in_stride;
+
+                real[i] = in_real[idx];
+                imag[i] = in_imag ? in_imag[idx] : 0.0f;
+            }
+        }
+    }
+
+    // Periodic generalized cosine window, a0 - a1 cos (2 pi n / N) + a2 cos (4 pi n / N), scaled to unit mean
+    DFTWindowConstPtr make_cosine_window (unsigned int size, double a0, double a1, double a2)
+    {
+        auto window = std::make_shared<DFTPlan::FloatVector> (size);
+
+        for (unsigned int n = 0; n < size; n++) {
+            double theta = 2.0 * pi * n / size;
+            (*window)[n] = (a0 - a1 * std::cos (theta) + a2 * std::cos (2.0 * theta)) / a0;
+        }
+
+        return window;
+    }
+
+    DFTWindowConstPtr make_window (VisDFTWindow window, unsigned int size)
+    {
+        switch (window) {
+            case VISUAL_DFT_WINDOW_HANN:
+                return make_cosine_window (size, 0.5, 0.5, 0.0);
+            case VISUAL_DFT_WINDOW_HAMMING:
+                return make_cosine_window (size, 0.54, 0.46, 0.0);
+            case VISUAL_DFT_WINDOW_BLACKMAN:
+                return make_cosine_window (size, 0.42, 0.5, 0.08);
+            default:
+                return nullptr;
+        }
+    }
+
+  } // anonymous namespace
+
+  DFTPlan::DFTPlan (DFTMethod method_, unsigned int sample_count_)
+      : method          (method_)
+      , sample_count    (sample_count_)
+      , fft_size        (sample_count % 2 == 0 ? sample_count / 2 : sample_count)
+      , fft_real_packed (sample_count % 2 == 0)
+      , fft_radix2_pass (false)
+      , bluestein_size  (0)
+  {
+      switch (method) {
+          case DFT_METHOD_BRUTE_FORCE:
+              dft_cossin_table_init ();
+              break;
+
+          case DFT_METHOD_FFT:
+              fft_bitrev_table_init (fft_size);
+              fft_twiddle_table_init (fft_size);
+              fft_post_table_init ();
+              break;
+
+          case DFT_METHOD_MIXED_RADIX:
+              mixed_radix_table_init ();
+              fft_post_table_init ();
+              break;
+
+          case DFT_METHOD_BLUESTEIN:
+              bluestein_table_init ();
+              fft_post_table_init ();
+              break;
+      }
+  }
+
+  DFTMethod DFTPlan::best_method (unsigned int sample_count)
+  {
+      if (sample_count < 2)
+          return DFT_METHOD_BRUTE_FORCE;
+
+      if (visual_math_is_power_of_2 (sample_count))
+          return DFT_METHOD_FFT;
+
+      if (is_mixed_radix_size (sample_count))
+          return DFT_METHOD_MIXED_RADIX;
+
+      return DFT_METHOD_BLUESTEIN;
+  }
+
+  void DFTPlan::load_fft_input (float* real, float* imag, float const* in_real, float const* in_imag, unsigned int in_stride,
+                                float const* window_real, float const* window_imag) const
+  {
+      permute_input (real, imag, in_real, in_imag, in_stride, window_real, window_imag, bitrevtable);
+  }
+
+  void DFTPlan::perform_fft_passes (float* real, float* imag, unsigned int count) const
+  {
+      auto radix2_pass = &FFTKernels::radix2_pass;
+      auto radix4_pass = &FFTKernels::radix4_pass;
+
+      if (visual_cpu_has_avx2 ()) {
+          radix2_pass = &FFTKernels::radix2_pass_sse;
+          radix4_pass = &FFTKernels::radix4_pass_avx2;
+      } else if (visual_cpu_has_sse ()) {
+          radix2_pass = &FFTKernels::radix2_pass_sse;
+          radix4_pass = &FFTKernels::radix4_pass_sse;
+      }
+
+      // Butterflies never straddle transforms, so a batch of transforms can go through each pass as a single array
+      unsigned int size = bitrevtable.size () * count;
+
+      if (fft_radix2_pass) {
+          radix2_pass (real, imag, size);
+      }
+
+      for (auto const& pass : fft_passes) {
+          radix4_pass (real, imag, size, pass.span, fft_twiddles.data () + pass.twiddle_offset);
+      }
+  }
+
+  void DFTPlan::load_mixed_radix_input (float* real, float* imag, float const* in_real, float const* in_imag, unsigned int in_stride,
+                                        float const* window_real, float const* window_imag) const
+  {
+      permute_input (real, imag, in_real, in_imag, in_stride, window_real, window_imag, digitrevtable);
+  }
+
+  void DFTPlan::perform_mixed_radix_passes (float* real, float* imag, unsigned int count) const
+  {
+      unsigned int size = digitrevtable.size () * count;
+
+      for (auto const& pass : mixed_passes) {
+          FFTKernels::mixed_radix_pass (real, imag, size, pass.radix, pass.span, mixed_twiddles.data () + pass.twiddle_offset);
+      }
+  }
+
+  void DFTPlan::perform_bluestein (float* real, float* imag, float const* in_real, float const* in_imag, unsigned int in_stride,
+                                   float const* window_real, float const* window_imag,
+                                   float* work_real1, float* work_imag1, float* work_real2, float* work_imag2) const
+  {
+      auto chirp_real  = bluestein_chirp_real.data ();
+      auto chirp_imag  = bluestein_chirp_imag.data ();
+      auto kernel_real = bluestein_kernel_real.data ();
+      auto kernel_imag = bluestein_kernel_imag.data ();
+
+      // Window and modulate input by chirp, and zero pad
+      for (unsigned int n = 0; n < fft_size; n++) {
+          float xr = in_real[n * in_stride];
+          float xi = in_imag ? in_imag[n * in_stride] : 0.0f;
+
+          if (window_real) {
+              xr *= window_real[n * in_stride];
+
+              if (in_imag)
+                  xi *= window_imag[n * in_stride];
+          }
+
+          work_real1[n] = xr * chirp_real[n] - xi * chirp_imag[n];
+          work_imag1[n] = xr * chirp_imag[n] + xi * chirp_real[n];
+      }
+
+      std::fill (work_real1 + fft_size, work_real1 + bluestein_size, 0.0f);
+      std::fill (work_imag1 + fft_size, work_imag1 + bluestein_size, 0.0f);
+
+      // Convolve with conjugate chirp
+      load_fft_input (work_real2, work_imag2, work_real1, work_imag1, 1);
+      perform_fft_passes (work_real2, work_imag2, 1);
+
+      for (unsigned int k = 0; k < bluestein_size; k++) {
+          float yr = work_real2[k];
+          float yi = work_imag2[k];
+
+          work_real2[k] = yr * kernel_real[k] - yi * kernel_imag[k];
+          work_imag2[k] = yr * kernel_imag[k] + yi * kernel_real[k];
+      }
+
+      // Inverse FFT, by swapping real and imaginary parts of input and output
+      load_fft_input (work_imag1, work_real1, work_imag2, work_real2, 1);
+      perform_fft_passes (work_imag1, work_real1, 1);
+
+      // Demodulate output by chirp
+      for (unsigned int k = 0; k < fft_size; k++) {
+          real[k] = work_real1[k] * chirp_real[k] - work_imag1[k] * chirp_imag[k];
+          imag[k] = work_real1[k] * chirp_imag[k] + work_imag1[k] * chirp_real[k];
+      }
+  }
+
+  void DFTPlan::fft_bitrev_table_init (unsigned int size)
+  {
+      bitrevtable.clear ();
+      bitrevtable.reserve (size);
+
+      for (unsigned int i = 0; i < size; i++)
+          bitrevtable.push_back (i);
+
+      unsigned int j = 0;
+
+      for (unsigned int i = 0; i < size; i++) {
+          if (j > i) {
+              std::swap (bitrevtable[i], bitrevtable[j]);
+          }
+
+          unsigned int m = size >> 1;
+
+          while (m >= 1 && j >= m) {
+              j -= m;
+              m >>= 1;
+          }
+
+          j += m;
+      }
+  }
+
+  void DFTPlan::fft_twiddle_table_init (unsigned int size)
+  {
+      unsigned int log2_size = 0;
+      while ((1U << log2_size) < size)
+          log2_size++;
+
+      // A radix-2 pass takes care of the odd power of 2 factor, if any
+      fft_radix2_pass = (log2_size % 2) == 1;
+
+      fft_passes.clear ();
+      fft_twiddles.clear ();
+
+      for (unsigned int span = fft_radix2_pass ? 2 : 1; span * 4 <= size; span *= 4) {
+          // Start each pass on a 32-byte boundary for aligned vector loads
+          fft_twiddles.resize ((fft_twiddles.size () + 7) & ~std::size_t (7));
+
+          fft_passes.push_back ({ span, fft_twiddles.size () });
+
+          // Twiddles for the butterfly inputs at offsets span, 2 * span and 3 * span are stored as six consecutive
+          // arrays (real and imaginary parts of each). As inputs are in bit-reversed order, these are
+          // exp (-2 pi i p m / (4 * span)) for p = 2, 1 and 3 respectively.
+          std::size_t offset = fft_twiddles.size ();
+          fft_twiddles.resize (offset + 6 * span);
+
+          for (unsigned int k = 1; k <= 3; k++) {
+              unsigned int power = (k == 1) ? 2 : (k == 2 ? 1 : 3);
+
+              for (unsigned int m = 0; m < span; m++) {
+                  double theta = -2.0 * pi * power * m / (4.0 * span);
+
+                  fft_twiddles[offset + (2 * k - 2) * span + m] = std::cos (theta);
+                  fft_twiddles[offset + (2 * k - 1) * span + m] = std::sin (theta);
+              }
+          }
+      }
+  }
+
+  void DFTPlan::mixed_radix_table_init ()
+  {
+      // Factorize size into radices
+      std::vector<unsigned int> radices;
+
+      unsigned int remaining = fft_size;
+
+      for (auto radix : mixed_radices) {
+          while (remaining % radix == 0) {
+              radices.push_back (radix);
+              remaining /= radix;
+          }
+      }
+
+      // Build the digit reversal permutation. Each pass combines radix sub-FFTs stored in consecutive blocks, each
+      // computed over the input elements with the same index modulo radix.
+      digitrevtable.assign (1, 0);
+
+      for (auto radix : radices) {
+          std::vector<unsigned int> table (digitrevtable.size () * radix);
+
+          for (unsigned int q = 0; q < radix; q++) {
+              for (unsigned int i = 0; i < digitrevtable.size (); i++) {
+                  table[q * digitrevtable.size () + i] = q + radix * digitrevtable[i];
+              }
+          }
+
+          digitrevtable.swap (table);
+      }
+
+      // The permutation above places the first radix innermost, so passes run in the order of radices
+      mixed_passes.clear ();
+      mixed_twiddles.clear ();
+
+      unsigned int span = 1;
+
+      for (auto radix = radices.begin (); radix != radices.end (); ++radix) {
+          mixed_passes.push_back ({ *radix, span, mixed_twiddles.size () });
+
+          // Twiddles for the butterfly input at offset q * span are stored as two consecutive arrays (real and
+          // imaginary parts) of exp (-2 pi i q m / (radix * span)), for q = 1 .. radix - 1.
+          std::size_t offset = mixed_twiddles.size ();
+          mixed_twiddles.resize (offset + 2 * (*radix - 1) * span);
+
+          for (unsigned int q = 1; q < *radix; q++) {
+              for (unsigned int m = 0; m < span; m++) {
+                  double theta = -2.0 * pi * q * m / (double (*radix) * span);
+
+                  mixed_twiddles[offset + (2 * q - 2) * span + m] = std::cos (theta);
+                  mixed_twiddles[offset + (2 * q - 1) * span + m] = std::sin (theta);
+              }
+          }
+
+          span *= *radix;
+      }
+  }
+
+  void DFTPlan::bluestein_table_init ()
+  {
+      // Convolution size must be at least 2 * fft_size - 1 to avoid wraparound
+      bluestein_size = 1;
+      while (bluestein_size < 2 * fft_size - 1)
+          bluestein_size <<= 1;
+
+      fft_bitrev_table_init (bluestein_size);
+      fft_twiddle_table_init (bluestein_size);
+
+      // Chirp is exp (-pi i n^2 / fft_size). n^2 is reduced modulo 2 * fft_size to keep the angle accurate.
+      bluestein_chirp_real.resize (fft_size);
+      bluestein_chirp_imag.resize (fft_size);
+
+      for (unsigned int n = 0; n < fft_size; n++) {
+          auto   n2    = (uint64_t (n) * n) % (2 * uint64_t (fft_size));
+          double theta = -pi * double (n2) / fft_size;
+
+          bluestein_chirp_real[n] = std::cos (theta);
+          bluestein_chirp_imag[n] = std::sin (theta);
+      }
+
+      // Convolution kernel is the FFT of the conjugate chirp, wrapped around, and scaled to normalize the inverse
+      // FFT
+      FloatVector chirp_real (bluestein_size, 0.0f);
+      FloatVector chirp_imag (bluestein_size, 0.0f);
+
+      chirp_real[0] = bluestein_chirp_real[0];
+      chirp_imag[0] = -bluestein_chirp_imag[0];
+
+      for (unsigned int n = 1; n < fft_size; n++) {
+          chirp_real[n] = chirp_real[bluestein_size - n] = bluestein_chirp_real[n];
+          chirp_imag[n] = chirp_imag[bluestein_size - n] = -bluestein_chirp_imag[n];
+      }
+
+      bluestein_kernel_real.resize (bluestein_size);
+      bluestein_kernel_imag.resize (bluestein_size);
+
+      load_fft_input (bluestein_kernel_real.data (), bluestein_kernel_imag.data (),
+                      chirp_real.data (), chirp_imag.data (), 1);
+      perform_fft_passes (bluestein_kernel_real.data (), bluestein_kernel_imag.data (), 1);
+
+      float scale = 1.0f / bluestein_size;
+
+      for (unsigned int k = 0; k < bluestein_size; k++) {
+          bluestein_kernel_real[k] *= scale;
+          bluestein_kernel_imag[k] *= scale;
+      }
+  }
+
+  void DFTPlan::fft_post_table_init ()
+  {
+      if (!fft_real_packed)
+          return;
+
+      fft_post_costable.resize (fft_size + 1);
+      fft_post_sintable.resize (fft_size + 1);
+
+      for (unsigned int k = 0; k <= fft_size; k++) {
+          double theta = -2.0 * pi * k / sample_count;
+
+          fft_post_costable[k] = std::cos (theta);
+          fft_post_sintable[k] = std::sin (theta);
+      }
+  }
+
+  void DFTPlan::dft_cossin_table_init ()
+  {
+      sintable.clear ();
+      sintable.reserve (sample_count);
+
+      costable.clear ();
+      costable.reserve (sample_count);
+
+      for (unsigned int i = 0; i < sample_count; i++) {
+          float theta = (-2.0f * VISUAL_MATH_PI * i) / sample_count;
+
+          costable.push_back (std::cos (theta));
+          sintable.push_back (std::sin (theta));
+      }
+  }
+
+  DFTPlanConstPtr DFTPlanCache::get_plan (DFTMethod method, unsigned int sample_count)
+  {
+      auto& store = plan_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      auto& plan = store.plans[PlanKey (method, sample_count)];
+
+      if (!plan) {
+          plan = std::make_shared<DFTPlan> (method, sample_count);
+      }
+
+      return plan;
+  }
+
+  DFTWindowConstPtr DFTPlanCache::get_window (VisDFTWindow window, unsigned int sample_count)
+  {
+      if (window == VISUAL_DFT_WINDOW_RECTANGULAR)
+          return nullptr;
+
+      auto& store = plan_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      auto& coeffs = store.windows[WindowKey (window, sample_count)];
+
+      if (!coeffs) {
+          coeffs = make_window (window, sample_count);
+      }
+
+      return coeffs;
+  }
+
+  DFTBandTableConstPtr DFTPlanCache::get_band_table (unsigned int spectrum_size, unsigned int band_count,
+                                                     VisDFTBandScale scale)
+  {
+      auto& store = plan_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      auto& table = store.band_tables[BandTableKey (spectrum_size, band_count, scale)];
+
+      if (!table) {
+          table = std::make_shared<DFTBandTable> (spectrum_size, band_count, scale);
+      }
+
+      return table;
+  }
+
+  DFTBandTable::DFTBandTable (unsigned int spectrum_size, unsigned int band_count, VisDFTBandScale scale)
+      : starts (band_count)
+      , ends   (band_count)
+  {
+      // Log scales start above DC, which has no place on them
+      bool log_scale = scale == VISUAL_DFT_BAND_SCALE_LOG && spectrum_size > 1;
+
+      double low  = log_scale ? 1.0 : 0.0;
+      double high = spectrum_size;
+
+      auto edge = [=] (unsigned int band) {
+          double t = double (band) / band_count;
+          return log_scale ? low * std::pow (high / low, t) : low + (high - low) * t;
+      };
+
+      for (unsigned int i = 0; i < band_count; i++) {
+          auto start = std::min (unsigned (edge (i)), spectrum_size - 1);
+          auto end   = std::min (unsigned (edge (i + 1)), spectrum_size);
+
+          starts[i] = start;
+          ends[i]   = std::max (end, start + 1);
+      }
+  }
+
+  void DFTPlanCache::init ()
+  {
+      for (auto sample_count : common_fft_sizes) {
+          get_plan (DFT_METHOD_FFT, sample_count);
+      }
+  }
+
+  void DFTPlanCache::clear ()
+  {
+      auto& store = plan_store ();
+
+      std::lock_guard<std::mutex> lock (store.mutex);
+
+      store.plans.clear ();
+      store.windows.clear ();
+      store.band_tables.clear ();
+  }
+
+} // LV namespace
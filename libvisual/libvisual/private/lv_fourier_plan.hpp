@@ -0,0 +1,251 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _LV_FOURIER_PLAN_HPP
+#define _LV_FOURIER_PLAN_HPP
+
+#include "lvconfig.h"
+#include "lv_defines.h"
+#include "lv_fourier.h"
+#include "lv_aligned_allocator.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace LV {
+
+  enum DFTMethod
+  {
+      DFT_METHOD_BRUTE_FORCE,
+      DFT_METHOD_FFT,
+      DFT_METHOD_MIXED_RADIX,
+      DFT_METHOD_BLUESTEIN
+  };
+
+  //! Precomputed tables for computing DFTs of a given method and size.
+  //!
+  //! Plans are immutable once created, and may be shared freely between threads.
+  //!
+  //! FFT methods compute the DFT of N real samples via a complex FFT. For even N, the complex FFT is N/2 points over
+  //! the samples packed as complex numbers, followed by a post-processing pass that separates the spectra of the even
+  //! and odd samples. For odd N, it is N points over the samples taken as is.
+  //!
+  //! - DFT_METHOD_FFT handles powers of 2. The complex FFT is decimated in time, with an optional leading radix-2
+  //!   pass followed by radix-4 passes.
+  //!
+  //! - DFT_METHOD_MIXED_RADIX handles sizes with no prime factors other than 2, 3 and 5, using radix-2, 3, 4 and 5
+  //!   passes.
+  //!
+  //! - DFT_METHOD_BLUESTEIN handles any other size, expressing the complex FFT as a convolution that is computed
+  //!   with power-of-2 FFTs.
+  //!
+  class DFTPlan
+  {
+  public:
+
+      typedef std::vector<float, AlignedAllocator<float, 64>> FloatVector;
+
+      //! Radix-4 pass over butterflies spanning 4 * span points
+      struct FFTPass
+      {
+          unsigned int span;
+          std::size_t  twiddle_offset;
+      };
+
+      //! Mixed radix pass over butterflies spanning radix * span points
+      struct MixedRadixPass
+      {
+          unsigned int radix;
+          unsigned int span;
+          std::size_t  twiddle_offset;
+      };
+
+      DFTMethod    method;
+      unsigned int sample_count;
+
+      // Size of complex FFT, and whether samples are packed into it in pairs
+      unsigned int fft_size;
+      bool         fft_real_packed;
+
+      // Brute force DFT tables
+      std::vector<float> sintable;
+      std::vector<float> costable;
+
+      // Power-of-2 FFT tables (of bluestein_size points for Bluestein plans)
+      std::vector<unsigned int> bitrevtable;
+      bool                      fft_radix2_pass;
+      std::vector<FFTPass>      fft_passes;
+      FloatVector               fft_twiddles;
+
+      // Mixed radix FFT tables
+      std::vector<unsigned int>   digitrevtable;
+      std::vector<MixedRadixPass> mixed_passes;
+      FloatVector                 mixed_twiddles;
+
+      // Bluestein tables
+      unsigned int bluestein_size;
+      FloatVector  bluestein_chirp_real;
+      FloatVector  bluestein_chirp_imag;
+      FloatVector  bluestein_kernel_real;
+      FloatVector  bluestein_kernel_imag;
+
+      // Post-processing tables for packed real samples
+      FloatVector  fft_post_costable;
+      FloatVector  fft_post_sintable;
+
+      DFTPlan (DFTMethod method, unsigned int sample_count);
+
+      DFTPlan (DFTPlan const&) = delete;
+
+      DFTPlan& operator= (DFTPlan const&) = delete;
+
+      /**
+       * Loads input into the order expected by the power-of-2 complex FFT passes, optionally applying a window.
+       *
+       * @param real        real parts of output
+       * @param imag        imaginary parts of output
+       * @param in_real     real parts of input
+       * @param in_imag     imaginary parts of input, or nullptr if all zero
+       * @param in_stride   distance between consecutive input elements
+       * @param window_real window coefficients for real parts of input, laid out as in_real, or nullptr if none
+       * @param window_imag window coefficients for imaginary parts of input, laid out as in_imag, or nullptr if none
+       */
+      void load_fft_input (float* real, float* imag, float const* in_real, float const* in_imag, unsigned int in_stride,
+                           float const* window_real = nullptr, float const* window_imag = nullptr) const;
+
+      /**
+       * Performs the passes of the power-of-2 complex FFT in place, over a batch of consecutive transforms.
+       *
+       * @param real  real parts
+       * @param imag  imaginary parts
+       * @param count number of transforms
+       */
+      void perform_fft_passes (float* real, float* imag, unsigned int count) const;
+
+      /**
+       * Loads input into the order expected by the mixed radix complex FFT passes.
+       *
+       * @see load_fft_input()
+       */
+      void load_mixed_radix_input (float* real, float* imag, float const* in_real, float const* in_imag, unsigned int in_stride,
+                                   float const* window_real = nullptr, float const* window_imag = nullptr) const;
+
+      /**
+       * Performs the passes of the mixed radix complex FFT in place, over a batch of consecutive transforms.
+       *
+       * @see perform_fft_passes()
+       */
+      void perform_mixed_radix_passes (float* real, float* imag, unsigned int count) const;
+
+      /**
+       * Performs the Bluestein complex FFT described by the plan.
+       *
+       * @note Work arrays must each hold bluestein_size floats.
+       *
+       * @see load_fft_input()
+       */
+      void perform_bluestein (float* real, float* imag, float const* in_real, float const* in_imag, unsigned int in_stride,
+                              float const* window_real, float const* window_imag,
+                              float* work_real1, float* work_imag1, float* work_real2, float* work_imag2) const;
+
+      /**
+       * Returns the best method for computing a DFT of a given size.
+       */
+      static DFTMethod best_method (unsigned int sample_count);
+
+  private:
+
+      void fft_bitrev_table_init (unsigned int size);
+      void fft_twiddle_table_init (unsigned int size);
+      void fft_post_table_init ();
+      void mixed_radix_table_init ();
+      void bluestein_table_init ();
+      void dft_cossin_table_init ();
+  };
+
+  typedef std::shared_ptr<DFTPlan const> DFTPlanConstPtr;
+
+  //! Window function coefficients for a given window type and size
+  typedef std::shared_ptr<DFTPlan::FloatVector const> DFTWindowConstPtr;
+
+  //! Bins [starts[i], ends[i]) covered by band i when reducing a spectrum to bands
+  struct DFTBandTable
+  {
+      std::vector<unsigned int> starts;
+      std::vector<unsigned int> ends;
+
+      DFTBandTable (unsigned int spectrum_size, unsigned int band_count, VisDFTBandScale scale);
+  };
+
+  typedef std::shared_ptr<DFTBandTable const> DFTBandTableConstPtr;
+
+  //! Process-wide cache of DFT plans, keyed by method and size, of window function coefficients, and of band tables.
+  //!
+  //! All member functions are thread-safe. Lookups are meant to be made once per DFT object; the returned plan can
+  //! then be used without any further locking.
+  //!
+  class DFTPlanCache
+  {
+  public:
+
+      /**
+       * Returns the plan for a given method and size, creating it if necessary.
+       *
+       * @param method       DFT method
+       * @param sample_count DFT size
+       *
+       * @return plan
+       */
+      static DFTPlanConstPtr get_plan (DFTMethod method, unsigned int sample_count);
+
+      /**
+       * Returns the coefficients of a window function of a given size, creating them if necessary.
+       *
+       * @param window       window function
+       * @param sample_count window size
+       *
+       * @return coefficients, or nullptr for the rectangular window
+       */
+      static DFTWindowConstPtr get_window (VisDFTWindow window, unsigned int sample_count);
+
+      /**
+       * Returns the band table for a given spectrum size, band count and scale, creating it if necessary.
+       *
+       * @param spectrum_size spectrum size, at least 1
+       * @param band_count    number of bands
+       * @param scale         band spacing
+       *
+       * @return band table
+       */
+      static DFTBandTableConstPtr get_band_table (unsigned int spectrum_size, unsigned int band_count, VisDFTBandScale scale);
+
+      /**
+       * Creates plans for commonly used FFT sizes ahead of time.
+       */
+      static void init ();
+
+      /**
+       * Releases all cached plans, windows and band tables. Those still in use by DFT objects remain valid.
+       */
+      static void clear ();
+  };
+
+} // LV namespace
+
+#endif // _LV_FOURIER_PLAN_HPP
@@ -41,6 +41,95 @@ typedef struct {
 
 namespace LV {
 
+  namespace {
+
+    typedef int (*OverlayRowFunc) (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params);
+
+    // Returns the fastest supported row kernel, or nullptr if there is none
+    OverlayRowFunc select_row_func (OverlayRowFunc avx2, OverlayRowFunc sse2)
+    {
+        if (visual_cpu_has_avx2 ()) {
+            return avx2;
+        } else if (visual_cpu_has_sse2 ()) {
+            return sse2;
+        }
+
+        return nullptr;
+    }
+
+    // Blends a colour component of a source pixel into a destination pixel with a surface alpha. The SIMD kernels
+    // compute the same as (alpha * s + (256 - alpha) * d) >> 8.
+    inline int blend (int s, int d, int alpha)
+    {
+        return (alpha * (s - d) >> 8) + d;
+    }
+
+    int overlay_rgb16_row_c (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        auto destr = reinterpret_cast<rgb16_t*> (dst);
+        auto srcr  = reinterpret_cast<rgb16_t const*> (src);
+
+        for (int i = 0; i < count; i++) {
+            if (params.use_colorkey && *reinterpret_cast<uint16_t const*> (&srcr[i]) == params.colorkey)
+                continue;
+
+            if (params.use_alpha) {
+                destr[i].r = blend (srcr[i].r, destr[i].r, params.alpha);
+                destr[i].g = blend (srcr[i].g, destr[i].g, params.alpha);
+                destr[i].b = blend (srcr[i].b, destr[i].b, params.alpha);
+            } else {
+                destr[i] = srcr[i];
+            }
+        }
+
+        return count;
+    }
+
+    int overlay_rgb24_row_c (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        uint8_t b = params.colorkey;
+        uint8_t g = params.colorkey >> 8;
+        uint8_t r = params.colorkey >> 16;
+
+        for (int i = 0; i < count; i++, dst += 3, src += 3) {
+            if (params.use_colorkey && src[0] == b && src[1] == g && src[2] == r)
+                continue;
+
+            if (params.use_alpha) {
+                dst[0] = blend (src[0], dst[0], params.alpha);
+                dst[1] = blend (src[1], dst[1], params.alpha);
+                dst[2] = blend (src[2], dst[2], params.alpha);
+            } else {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+        }
+
+        return count;
+    }
+
+    // Colour keys match on the RGB channels, leaving out alpha
+    int overlay_argb32_row_c (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        for (int i = 0; i < count; i++, dst += 4, src += 4) {
+            if (params.use_colorkey && ((*reinterpret_cast<uint32_t const*> (src) ^ params.colorkey) & 0xffffff) == 0)
+                continue;
+
+            if (params.use_alpha) {
+                dst[0] = blend (src[0], dst[0], params.alpha);
+                dst[1] = blend (src[1], dst[1], params.alpha);
+                dst[2] = blend (src[2], dst[2], params.alpha);
+            } else {
+                *reinterpret_cast<uint32_t*> (dst) = *reinterpret_cast<uint32_t const*> (src);
+            }
+        }
+
+        return count;
+    }
+
+  } // anonymous namespace
+
   void VideoBlit::blit_overlay_noalpha (Video* dest, Video* src)
   {
       auto destbuf = static_cast<uint8_t*> (dest->get_pixels ());
@@ -53,12 +142,8 @@ namespace LV {
           return;
       }
 
-      for (int y = 0; y < src->m_impl->height; y++) {
-          visual_mem_copy (destbuf, srcbuf, src->m_impl->width * src->m_impl->bpp);
-
-          destbuf += dest->m_impl->pitch;
-          srcbuf += src->m_impl->pitch;
-      }
+      visual_mem_copy_pitch (destbuf, srcbuf, dest->m_impl->pitch, src->m_impl->pitch,
+                             src->m_impl->width * src->m_impl->bpp, src->m_impl->height);
   }
 
   void VideoBlit::blit_overlay_alphasrc (Video* dest, Video* src)
@@ -90,246 +175,125 @@ namespace LV {
 
   void VideoBlit::blit_overlay_colorkey (Video* dest, Video* src)
   {
-      unsigned int pixel_count = dest->m_impl->width * dest->m_impl->height;
-
       if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_8BIT) {
-          auto destbuf = static_cast<uint8_t*> (dest->get_pixels ());
-          auto srcbuf = static_cast<uint8_t const*> (src->get_pixels ());
-
-          auto& palette = src->m_impl->palette;
+          auto const& palette = src->m_impl->palette;
 
-          if (!palette.empty ()) {
+          if (palette.empty ()) {
               blit_overlay_noalpha (dest, src);
               return;
           }
 
-          int index = palette.find_color (*src->m_impl->colorkey);
-
-          for (unsigned int i = 0; i < pixel_count; i++) {
-              if (*srcbuf != index)
-                  *destbuf = *srcbuf;
-
-              destbuf++;
-              srcbuf++;
-          }
-
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_16BIT) {
-          auto destbuf = static_cast<uint16_t*> (dest->get_pixels ());
-          auto srcbuf  = static_cast<uint16_t const*> (src->get_pixels ());
-
-          uint16_t color = src->m_impl->colorkey->to_uint16 ();
-
-          for (unsigned int i = 0; i < pixel_count; i++) {
-              if (color != *srcbuf)
-                  *destbuf = *srcbuf;
-
-              destbuf++;
-              srcbuf++;
-          }
-
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_24BIT) {
-          auto destbuf = static_cast<uint8_t*> (dest->get_pixels ());
-          auto srcbuf  = static_cast<uint8_t const*> (src->get_pixels ());
+          int index = palette.find_color (src->m_impl->colorkey);
 
-          uint8_t r = src->m_impl->colorkey->r;
-          uint8_t g = src->m_impl->colorkey->g;
-          uint8_t b = src->m_impl->colorkey->b;
+          for (int y = 0; y < src->m_impl->height; y++) {
+              auto destbuf = static_cast<uint8_t*> (dest->m_impl->pixel_rows[y]);
+              auto srcbuf  = static_cast<uint8_t const*> (src->m_impl->pixel_rows[y]);
 
-          for (unsigned int i = 0; i < pixel_count; i++) {
-              if (b != srcbuf[0] && g != srcbuf[1] && r != srcbuf[2]) {
-                  destbuf[0] = srcbuf[0];
-                  destbuf[1] = srcbuf[1];
-                  destbuf[2] = srcbuf[2];
+              for (int x = 0; x < src->m_impl->width; x++) {
+                  if (srcbuf[x] != index)
+                      destbuf[x] = srcbuf[x];
               }
-
-              destbuf += 3;
-              srcbuf  += 3;
           }
 
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_32BIT) {
-          auto destbuf = static_cast<uint32_t*> (dest->get_pixels ());
-          auto srcbuf  = static_cast<uint32_t const*> (src->get_pixels ());
-
-          uint32_t color = src->m_impl->colorkey->to_uint32 ();
-
-          for (unsigned int i = 0; i < pixel_count; i++) {
-              if (color != *srcbuf)
-                  *destbuf = *srcbuf;
-
-              destbuf++;
-              srcbuf++;
-          }
+          return;
       }
+
+      blit_overlay_rows (dest, src, true, false);
   }
 
   void VideoBlit::blit_overlay_surfacealpha (Video* dest, Video* src)
   {
-      auto destbuf = static_cast<uint8_t*> (dest->get_pixels ());
-      auto srcbuf  = static_cast<uint8_t const*> (src->get_pixels ());
-
-      uint8_t alpha = src->m_impl->alpha;
-
       if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_8BIT) {
+          uint8_t alpha = src->m_impl->alpha;
 
           for (int y = 0; y < src->m_impl->height; y++) {
-              for (int x = 0; x < src->m_impl->width; x++) {
-                  *destbuf = ((alpha * (*srcbuf - *destbuf) >> 8) + *destbuf);
-
-                  destbuf += dest->m_impl->bpp;
-                  srcbuf += src->m_impl->bpp;
-              }
-
-              destbuf += dest->m_impl->pitch - (dest->m_impl->width * dest->m_impl->bpp);
-              srcbuf  += src->m_impl->pitch  - (src->m_impl->width  * src->m_impl->bpp);
-          }
-
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_16BIT) {
-
-          for (int y = 0; y < src->m_impl->height; y++) {
-              auto destr = reinterpret_cast<rgb16_t*> (destbuf);
-              auto srcr  = reinterpret_cast<rgb16_t const*> (srcbuf);
-
-              for (int x = 0; x < src->m_impl->width; x++) {
-                  destr->r = (alpha * (srcr->r - destr->r) >> 8) + destr->r;
-                  destr->g = (alpha * (srcr->g - destr->g) >> 8) + destr->g;
-                  destr->b = (alpha * (srcr->b - destr->b) >> 8) + destr->b;
-
-                  destr++;
-                  srcr++;
-              }
-
-              destbuf += dest->m_impl->pitch;
-              srcbuf += src->m_impl->pitch;
-          }
+              auto destbuf = static_cast<uint8_t*> (dest->m_impl->pixel_rows[y]);
+              auto srcbuf  = static_cast<uint8_t const*> (src->m_impl->pixel_rows[y]);
 
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_24BIT) {
-
-          for (int y = 0; y < src->m_impl->height; y++) {
               for (int x = 0; x < src->m_impl->width; x++) {
-                  destbuf[0] = (alpha * (srcbuf[0] - destbuf[0]) >> 8) + destbuf[0];
-                  destbuf[1] = (alpha * (srcbuf[1] - destbuf[1]) >> 8) + destbuf[1];
-                  destbuf[2] = (alpha * (srcbuf[2] - destbuf[2]) >> 8) + destbuf[2];
-
-                  destbuf += dest->m_impl->bpp;
-                  srcbuf  += src->m_impl->bpp;
+                  destbuf[x] = blend (srcbuf[x], destbuf[x], alpha);
               }
-
-              destbuf += dest->m_impl->pitch - (dest->m_impl->width * dest->m_impl->bpp);
-              srcbuf  += src->m_impl->pitch  - (src->m_impl->width  * src->m_impl->bpp);
           }
 
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_32BIT) {
-
-          for (int y = 0; y < src->m_impl->height; y++) {
-              for (int x = 0; x < src->m_impl->width; x++) {
-                  destbuf[0] = (alpha * (srcbuf[0] - destbuf[0]) >> 8) + destbuf[0];
-                  destbuf[1] = (alpha * (srcbuf[1] - destbuf[1]) >> 8) + destbuf[1];
-                  destbuf[2] = (alpha * (srcbuf[2] - destbuf[2]) >> 8) + destbuf[2];
-
-                  destbuf += dest->m_impl->bpp;
-                  srcbuf  += src->m_impl->bpp;
-              }
-
-              destbuf += dest->m_impl->pitch - (dest->m_impl->width * dest->m_impl->bpp);
-              srcbuf  += src->m_impl->pitch  - (src->m_impl->width  * src->m_impl->bpp);
-          }
+          return;
       }
+
+      blit_overlay_rows (dest, src, false, true);
   }
 
   void VideoBlit::blit_overlay_surfacealphacolorkey (Video* dest, Video* src)
   {
-      auto destbuf = static_cast<uint8_t*> (dest->get_pixels ());
-      auto srcbuf = static_cast<uint8_t const*> (src->get_pixels ());
-
-      uint8_t alpha = src->m_impl->alpha;
-
       if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_8BIT) {
           auto const& palette = src->m_impl->palette;
 
-          if (!palette.empty ()) {
+          if (palette.empty ()) {
               blit_overlay_noalpha (dest, src);
               return;
           }
 
-          int index = palette.find_color (*src->m_impl->colorkey);
+          int index = palette.find_color (src->m_impl->colorkey);
 
-          int dstep = dest->m_impl->pitch - dest->m_impl->width * dest->m_impl->bpp;
-          int sstep = src->m_impl->pitch  - src->m_impl->width  * src->m_impl->bpp;
+          uint8_t alpha = src->m_impl->alpha;
 
           for (int y = 0; y < src->m_impl->height; y++) {
-              for (int x = 0; x < src->m_impl->width; x++) {
-                  if (*srcbuf != index)
-                      *destbuf = ((alpha * (*srcbuf - *destbuf) >> 8) + *destbuf);
+              auto destbuf = static_cast<uint8_t*> (dest->m_impl->pixel_rows[y]);
+              auto srcbuf  = static_cast<uint8_t const*> (src->m_impl->pixel_rows[y]);
 
-                  destbuf += dest->m_impl->bpp;
-                  srcbuf += src->m_impl->bpp;
+              for (int x = 0; x < src->m_impl->width; x++) {
+                  if (srcbuf[x] != index)
+                      destbuf[x] = blend (srcbuf[x], destbuf[x], alpha);
               }
-
-              destbuf += dstep;
-              srcbuf  += sstep;
           }
 
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_16BIT) {
-          uint16_t color = src->m_impl->colorkey->to_uint16 ();
-
-          for (int y = 0; y < src->m_impl->height; y++) {
-              auto destr = reinterpret_cast<rgb16_t*> (destbuf);
-              auto srcr  = reinterpret_cast<rgb16_t const*> (srcbuf);
-
-                  for (int x = 0; x < src->m_impl->width; x++) {
-                      if (color != *((uint16_t *) srcr)) {
-                          destr->r = (alpha * (srcr->r - destr->r) >> 8) + destr->r;
-                          destr->g = (alpha * (srcr->g - destr->g) >> 8) + destr->g;
-                          destr->b = (alpha * (srcr->b - destr->b) >> 8) + destr->b;
-                      }
-
-                      destr++;
-                      srcr++;
-                  }
-
-              destbuf += dest->m_impl->pitch;
-              srcbuf  += src->m_impl->pitch;
-          }
+          return;
+      }
 
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_24BIT) {
-          uint8_t r = src->m_impl->colorkey->r;
-          uint8_t g = src->m_impl->colorkey->g;
-          uint8_t b = src->m_impl->colorkey->b;
+      blit_overlay_rows (dest, src, true, true);
+  }
 
-          for (int y = 0; y < src->m_impl->height; y++) {
-              for (int x = 0; x < src->m_impl->width; x++) {
-                  if (b != srcbuf[0] && g != srcbuf[1] && r != srcbuf[2]) {
-                      destbuf[0] = (alpha * (srcbuf[0] - destbuf[0]) >> 8) + destbuf[0];
-                      destbuf[1] = (alpha * (srcbuf[1] - destbuf[1]) >> 8) + destbuf[1];
-                      destbuf[2] = (alpha * (srcbuf[2] - destbuf[2]) >> 8) + destbuf[2];
-                  }
-
-                  destbuf += dest->m_impl->bpp;
-                  srcbuf += src->m_impl->bpp;
-              }
+  void VideoBlit::blit_overlay_rows (Video* dest, Video* src, bool use_colorkey, bool use_alpha)
+  {
+      OverlayParams params;
+      params.alpha        = src->m_impl->alpha;
+      params.use_colorkey = use_colorkey;
+      params.use_alpha    = use_alpha;
+
+      OverlayRowFunc blit_row_simd;
+      OverlayRowFunc blit_row;
+
+      switch (dest->m_impl->depth) {
+          case VISUAL_VIDEO_DEPTH_16BIT:
+              params.colorkey = src->m_impl->colorkey.to_uint16 ();
+              blit_row_simd   = select_row_func (overlay_rgb16_row_avx2, overlay_rgb16_row_sse2);
+              blit_row        = overlay_rgb16_row_c;
+              break;
+
+          case VISUAL_VIDEO_DEPTH_24BIT:
+              params.colorkey = src->m_impl->colorkey.to_uint32 () & 0xffffff;
+              blit_row_simd   = select_row_func (overlay_rgb24_row_avx2, overlay_rgb24_row_sse2);
+              blit_row        = overlay_rgb24_row_c;
+              break;
+
+          case VISUAL_VIDEO_DEPTH_32BIT:
+              params.colorkey = src->m_impl->colorkey.to_uint32 ();
+              blit_row_simd   = select_row_func (overlay_argb32_row_avx2, overlay_argb32_row_sse2);
+              blit_row        = overlay_argb32_row_c;
+              break;
+
+          default:
+              return;
+      }
 
-              destbuf += dest->m_impl->pitch - (dest->m_impl->width * dest->m_impl->bpp);
-              srcbuf += src->m_impl->pitch - (src->m_impl->width * src->m_impl->bpp);
-          }
+      int bpp   = dest->m_impl->bpp;
+      int width = src->m_impl->width;
 
-      } else if (dest->m_impl->depth == VISUAL_VIDEO_DEPTH_32BIT) {
-          uint32_t color = src->m_impl->colorkey->to_uint32 ();
+      for (int y = 0; y < src->m_impl->height; y++) {
+          auto destbuf = static_cast<uint8_t*> (dest->m_impl->pixel_rows[y]);
+          auto srcbuf  = static_cast<uint8_t const*> (src->m_impl->pixel_rows[y]);
 
-          for (int y = 0; y < src->m_impl->height; y++) {
-              for (int x = 0; x < src->m_impl->width; x++) {
-                  if (color == *reinterpret_cast<uint32_t*> (destbuf)) {
-                      destbuf[0] = (alpha * (srcbuf[0] - destbuf[0]) >> 8) + destbuf[0];
-                      destbuf[1] = (alpha * (srcbuf[1] - destbuf[1]) >> 8) + destbuf[1];
-                      destbuf[2] = (alpha * (srcbuf[2] - destbuf[2]) >> 8) + destbuf[2];
-                  }
-
-                  destbuf += dest->m_impl->bpp;
-                  srcbuf += src->m_impl->bpp;
-              }
+          int done = blit_row_simd ? blit_row_simd (destbuf, srcbuf, width, params) : 0;
 
-              destbuf += dest->m_impl->pitch - (dest->m_impl->width * dest->m_impl->bpp);
-              srcbuf += src->m_impl->pitch - (src->m_impl->width * src->m_impl->bpp);
-          }
+          blit_row (destbuf + done * bpp, srcbuf + done * bpp, width - done, params);
       }
   }
 
@@ -37,6 +37,30 @@ namespace LV {
       static void blit_overlay_surfacealphacolorkey (Video* dest, Video* src);
 
       static void blit_overlay_alphasrc_mmx (Video* dest, Video* src);
+
+      //! Parameters of the colour keyed and surface alpha overlay row kernels
+      struct OverlayParams
+      {
+          uint32_t colorkey;      //!< Colour key in the pixel format of the rows
+          uint8_t  alpha;         //!< Surface alpha
+          bool     use_colorkey;  //!< Whether source pixels equal to the colour key are left out
+          bool     use_alpha;     //!< Whether source pixels are blended with the surface alpha instead of copied
+      };
+
+      // SIMD row kernels. Each returns the number of pixels blitted, leaving the rest of the row to the portable code.
+
+      static int overlay_rgb16_row_sse2  (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params);
+      static int overlay_rgb16_row_avx2  (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params);
+
+      static int overlay_rgb24_row_sse2  (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params);
+      static int overlay_rgb24_row_avx2  (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params);
+
+      static int overlay_argb32_row_sse2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params);
+      static int overlay_argb32_row_avx2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params);
+
+  private:
+
+      static void blit_overlay_rows (Video* dest, Video* src, bool use_colorkey, bool use_alpha);
   };
 }
 
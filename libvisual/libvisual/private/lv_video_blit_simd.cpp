@@ -27,6 +27,18 @@
 #include "lv_video_private.hpp"
 #include "lv_common.h"
 
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
+
+// The overlay kernels produce exactly the same pixels as the portable code. Surface alpha blending computes each
+// colour component as (alpha * s + (256 - alpha) * d) >> 8 in 16-bit lanes, and colour keyed pixels are left out by
+// comparing the source against the key and selecting the destination where they are equal.
+
 namespace LV {
 
   void VideoBlit::blit_overlay_alphasrc_mmx (Video* dest, Video* src)
@@ -72,4 +84,456 @@ namespace LV {
 #endif /* !VISUAL_ARCH_X86 */
   }
 
+  // SSE2 overlay kernels
+
+#if defined(LV_HAVE_X86_SIMD)
+  namespace {
+
+    // Blends 16 bytes with 16-bit source and destination weights, which repeat every 8 bytes
+    LV_ATTR_TARGET ("sse2")
+    inline __m128i blend_bytes_sse2 (__m128i s, __m128i d, __m128i ws, __m128i wd)
+    {
+        __m128i const zero = _mm_setzero_si128 ();
+
+        __m128i lo = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (s, zero), ws),
+                                    _mm_mullo_epi16 (_mm_unpacklo_epi8 (d, zero), wd));
+        __m128i hi = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (s, zero), ws),
+                                    _mm_mullo_epi16 (_mm_unpackhi_epi8 (d, zero), wd));
+
+        return _mm_packus_epi16 (_mm_srli_epi16 (lo, 8), _mm_srli_epi16 (hi, 8));
+    }
+
+    // Blends 8 16-bit pixels field by field
+    LV_ATTR_TARGET ("sse2")
+    inline __m128i blend_rgb16_sse2 (__m128i s, __m128i d, __m128i ws, __m128i wd)
+    {
+        __m128i const mask_5 = _mm_set1_epi16 (0x1f);
+        __m128i const mask_6 = _mm_set1_epi16 (0x3f);
+
+        __m128i sb = _mm_and_si128 (s, mask_5);
+        __m128i db = _mm_and_si128 (d, mask_5);
+        __m128i sg = _mm_and_si128 (_mm_srli_epi16 (s, 5), mask_6);
+        __m128i dg = _mm_and_si128 (_mm_srli_epi16 (d, 5), mask_6);
+        __m128i sr = _mm_srli_epi16 (s, 11);
+        __m128i dr = _mm_srli_epi16 (d, 11);
+
+        __m128i b = _mm_srli_epi16 (_mm_add_epi16 (_mm_mullo_epi16 (sb, ws), _mm_mullo_epi16 (db, wd)), 8);
+        __m128i g = _mm_srli_epi16 (_mm_add_epi16 (_mm_mullo_epi16 (sg, ws), _mm_mullo_epi16 (dg, wd)), 8);
+        __m128i r = _mm_srli_epi16 (_mm_add_epi16 (_mm_mullo_epi16 (sr, ws), _mm_mullo_epi16 (dr, wd)), 8);
+
+        return _mm_or_si128 (b, _mm_or_si128 (_mm_slli_epi16 (g, 5), _mm_slli_epi16 (r, 11)));
+    }
+
+    // Takes d where keep is set, and s elsewhere
+    LV_ATTR_TARGET ("sse2")
+    inline __m128i select_sse2 (__m128i keep, __m128i d, __m128i s)
+    {
+        return _mm_or_si128 (_mm_and_si128 (keep, d), _mm_andnot_si128 (keep, s));
+    }
+
+    // Masks of bytes to keep when overlaying 4 24-bit pixels from a 16-byte load, indexed by which pixels match the
+    // colour key. Bytes 12-15 belong to the next pixels and are always kept.
+    struct Rgb24KeepMasks
+    {
+        alignas (16) uint8_t masks[16][16];
+
+        Rgb24KeepMasks ()
+        {
+            for (int index = 0; index < 16; index++) {
+                for (int i = 0; i < 16; i++) {
+                    masks[index][i] = (i >= 12 || (index >> (i / 3)) & 1) ? 0xff : 0x00;
+                }
+            }
+        }
+    };
+
+    Rgb24KeepMasks const rgb24_keep_masks;
+
+    // Returns a bit for each of the 4 24-bit pixels in bytes 0-11 of s that equal the key
+    LV_ATTR_TARGET ("sse2")
+    inline unsigned int rgb24_key_matches_sse2 (__m128i s, __m128i key)
+    {
+        unsigned int eq = _mm_movemask_epi8 (_mm_cmpeq_epi8 (s, key));
+        unsigned int m  = eq & eq >> 1 & eq >> 2;
+
+        return (m & 1) | (m >> 2 & 2) | (m >> 4 & 4) | (m >> 6 & 8);
+    }
+
+    template <bool use_colorkey, bool use_alpha>
+    LV_ATTR_TARGET ("sse2")
+    inline int overlay_rgb16_sse2 (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        __m128i const key = _mm_set1_epi16 (short (params.colorkey));
+        __m128i const ws  = _mm_set1_epi16 (params.alpha);
+        __m128i const wd  = _mm_set1_epi16 (256 - params.alpha);
+
+        int n = count & ~7;
+
+        for (int i = 0; i < n; i += 8) {
+            auto dp = reinterpret_cast<__m128i*> (dst + i * 2);
+
+            __m128i s = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 2));
+            __m128i d = _mm_loadu_si128 (dp);
+
+            __m128i p = use_alpha ? blend_rgb16_sse2 (s, d, ws, wd) : s;
+
+            if (use_colorkey) {
+                p = select_sse2 (_mm_cmpeq_epi16 (s, key), d, p);
+            }
+
+            _mm_storeu_si128 (dp, p);
+        }
+
+        return n;
+    }
+
+    template <bool use_colorkey, bool use_alpha>
+    LV_ATTR_TARGET ("sse2")
+    inline int overlay_rgb24_sse2 (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        __m128i const ws = _mm_set1_epi16 (params.alpha);
+        __m128i const wd = _mm_set1_epi16 (256 - params.alpha);
+
+        if (!use_colorkey) {
+            // Without a key, pixel boundaries do not matter
+            int n = count & ~15;
+
+            for (int i = 0; i < n * 3; i += 16) {
+                auto dp = reinterpret_cast<__m128i*> (dst + i);
+
+                __m128i s = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i));
+                _mm_storeu_si128 (dp, blend_bytes_sse2 (s, _mm_loadu_si128 (dp), ws, wd));
+            }
+
+            return n;
+        }
+
+        uint8_t b = params.colorkey;
+        uint8_t g = params.colorkey >> 8;
+        uint8_t r = params.colorkey >> 16;
+
+        __m128i const key = _mm_setr_epi8 (b, g, r, b, g, r, b, g, r, b, g, r, 0, 0, 0, 0);
+
+        // Each step loads 16 bytes to overlay 4 pixels
+        int i = 0;
+
+        for (; i + 6 <= count; i += 4) {
+            auto dp = reinterpret_cast<__m128i*> (dst + i * 3);
+
+            __m128i s = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 3));
+
+            unsigned int matches = rgb24_key_matches_sse2 (s, key);
+            if (matches == 0xf) {
+                continue;
+            }
+
+            __m128i d = _mm_loadu_si128 (dp);
+            __m128i p = use_alpha ? blend_bytes_sse2 (s, d, ws, wd) : s;
+
+            __m128i keep = _mm_load_si128 (reinterpret_cast<__m128i const*> (rgb24_keep_masks.masks[matches]));
+
+            _mm_storeu_si128 (dp, select_sse2 (keep, d, p));
+        }
+
+        return i;
+    }
+
+    template <bool use_colorkey, bool use_alpha>
+    LV_ATTR_TARGET ("sse2")
+    inline int overlay_argb32_sse2 (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        // Alpha channels are weighted 0 and 256 to keep the destination alpha
+        uint64_t const a = params.alpha;
+
+        __m128i const rgb_mask = _mm_set1_epi32 (0xffffff);
+        __m128i const key      = _mm_set1_epi32 (params.colorkey & 0xffffff);
+        __m128i const ws       = _mm_set1_epi64x (a | a << 16 | a << 32);
+        __m128i const wd       = _mm_sub_epi16 (_mm_set1_epi16 (256), ws);
+
+        int n = count & ~3;
+
+        for (int i = 0; i < n; i += 4) {
+            auto dp = reinterpret_cast<__m128i*> (dst + i * 4);
+
+            __m128i s = _mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 4));
+            __m128i d = _mm_loadu_si128 (dp);
+
+            __m128i p = use_alpha ? blend_bytes_sse2 (s, d, ws, wd) : s;
+
+            if (use_colorkey) {
+                p = select_sse2 (_mm_cmpeq_epi32 (_mm_and_si128 (s, rgb_mask), key), d, p);
+            }
+
+            _mm_storeu_si128 (dp, p);
+        }
+
+        return n;
+    }
+
+  } // anonymous namespace
+#endif
+
+  int VideoBlit::overlay_rgb16_row_sse2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      if (!params.use_alpha) {
+          return overlay_rgb16_sse2<true, false> (dst, src, count, params);
+      } else if (!params.use_colorkey) {
+          return overlay_rgb16_sse2<false, true> (dst, src, count, params);
+      } else {
+          return overlay_rgb16_sse2<true, true> (dst, src, count, params);
+      }
+#else
+      return 0;
+#endif
+  }
+
+  int VideoBlit::overlay_rgb24_row_sse2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      if (!params.use_alpha) {
+          return overlay_rgb24_sse2<true, false> (dst, src, count, params);
+      } else if (!params.use_colorkey) {
+          return overlay_rgb24_sse2<false, true> (dst, src, count, params);
+      } else {
+          return overlay_rgb24_sse2<true, true> (dst, src, count, params);
+      }
+#else
+      return 0;
+#endif
+  }
+
+  int VideoBlit::overlay_argb32_row_sse2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      if (!params.use_alpha) {
+          return overlay_argb32_sse2<true, false> (dst, src, count, params);
+      } else if (!params.use_colorkey) {
+          return overlay_argb32_sse2<false, true> (dst, src, count, params);
+      } else {
+          return overlay_argb32_sse2<true, true> (dst, src, count, params);
+      }
+#else
+      return 0;
+#endif
+  }
+
+  // AVX2 overlay kernels
+
+#if defined(LV_HAVE_X86_SIMD)
+  namespace {
+
+    LV_ATTR_TARGET ("avx2")
+    inline __m256i blend_bytes_avx2 (__m256i s, __m256i d, __m256i ws, __m256i wd)
+    {
+        __m256i const zero = _mm256_setzero_si256 ();
+
+        // Unpacking and packing both work within 128-bit lanes, so bytes stay in place
+        __m256i lo = _mm256_add_epi16 (_mm256_mullo_epi16 (_mm256_unpacklo_epi8 (s, zero), ws),
+                                       _mm256_mullo_epi16 (_mm256_unpacklo_epi8 (d, zero), wd));
+        __m256i hi = _mm256_add_epi16 (_mm256_mullo_epi16 (_mm256_unpackhi_epi8 (s, zero), ws),
+                                       _mm256_mullo_epi16 (_mm256_unpackhi_epi8 (d, zero), wd));
+
+        return _mm256_packus_epi16 (_mm256_srli_epi16 (lo, 8), _mm256_srli_epi16 (hi, 8));
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    inline __m256i blend_rgb16_avx2 (__m256i s, __m256i d, __m256i ws, __m256i wd)
+    {
+        __m256i const mask_5 = _mm256_set1_epi16 (0x1f);
+        __m256i const mask_6 = _mm256_set1_epi16 (0x3f);
+
+        __m256i sb = _mm256_and_si256 (s, mask_5);
+        __m256i db = _mm256_and_si256 (d, mask_5);
+        __m256i sg = _mm256_and_si256 (_mm256_srli_epi16 (s, 5), mask_6);
+        __m256i dg = _mm256_and_si256 (_mm256_srli_epi16 (d, 5), mask_6);
+        __m256i sr = _mm256_srli_epi16 (s, 11);
+        __m256i dr = _mm256_srli_epi16 (d, 11);
+
+        __m256i b = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_mullo_epi16 (sb, ws), _mm256_mullo_epi16 (db, wd)), 8);
+        __m256i g = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_mullo_epi16 (sg, ws), _mm256_mullo_epi16 (dg, wd)), 8);
+        __m256i r = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_mullo_epi16 (sr, ws), _mm256_mullo_epi16 (dr, wd)), 8);
+
+        return _mm256_or_si256 (b, _mm256_or_si256 (_mm256_slli_epi16 (g, 5), _mm256_slli_epi16 (r, 11)));
+    }
+
+    // Returns the bits of rgb24_key_matches_sse2() for each 128-bit lane, the upper lane's in bits 4-7
+    LV_ATTR_TARGET ("avx2")
+    inline unsigned int rgb24_key_matches_avx2 (__m256i s, __m256i key)
+    {
+        unsigned int eq = _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (s, key));
+        unsigned int m  = eq & eq >> 1 & eq >> 2;
+
+        m = (m & 0x0249) | (m >> 12 & 0x0249 << 4);
+
+        return (m & 0x11) | (m >> 2 & 0x22) | (m >> 4 & 0x44) | (m >> 6 & 0x88);
+    }
+
+    template <bool use_colorkey, bool use_alpha>
+    LV_ATTR_TARGET ("avx2")
+    inline int overlay_rgb16_avx2 (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        __m256i const key = _mm256_set1_epi16 (short (params.colorkey));
+        __m256i const ws  = _mm256_set1_epi16 (params.alpha);
+        __m256i const wd  = _mm256_set1_epi16 (256 - params.alpha);
+
+        int n = count & ~15;
+
+        for (int i = 0; i < n; i += 16) {
+            auto dp = reinterpret_cast<__m256i*> (dst + i * 2);
+
+            __m256i s = _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i * 2));
+            __m256i d = _mm256_loadu_si256 (dp);
+
+            __m256i p = use_alpha ? blend_rgb16_avx2 (s, d, ws, wd) : s;
+
+            if (use_colorkey) {
+                p = _mm256_blendv_epi8 (p, d, _mm256_cmpeq_epi16 (s, key));
+            }
+
+            _mm256_storeu_si256 (dp, p);
+        }
+
+        return n;
+    }
+
+    template <bool use_colorkey, bool use_alpha>
+    LV_ATTR_TARGET ("avx2")
+    inline int overlay_rgb24_avx2 (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        __m256i const ws = _mm256_set1_epi16 (params.alpha);
+        __m256i const wd = _mm256_set1_epi16 (256 - params.alpha);
+
+        if (!use_colorkey) {
+            int n = count & ~31;
+
+            for (int i = 0; i < n * 3; i += 32) {
+                auto dp = reinterpret_cast<__m256i*> (dst + i);
+
+                __m256i s = _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i));
+                _mm256_storeu_si256 (dp, blend_bytes_avx2 (s, _mm256_loadu_si256 (dp), ws, wd));
+            }
+
+            return n;
+        }
+
+        uint8_t b = params.colorkey;
+        uint8_t g = params.colorkey >> 8;
+        uint8_t r = params.colorkey >> 16;
+
+        __m256i const key = _mm256_setr_epi8 (b, g, r, b, g, r, b, g, r, b, g, r, 0, 0, 0, 0,
+                                              b, g, r, b, g, r, b, g, r, b, g, r, 0, 0, 0, 0);
+
+        // Each step overlays 8 pixels, 4 per 128-bit lane loaded from 12 bytes apart. The lower lane is stored first
+        // as its last 4 bytes are the destination bytes the upper lane overwrites.
+        int i = 0;
+
+        for (; i + 10 <= count; i += 8) {
+            auto dp0 = reinterpret_cast<__m128i*> (dst + i * 3);
+            auto dp1 = reinterpret_cast<__m128i*> (dst + i * 3 + 12);
+            auto sp0 = reinterpret_cast<__m128i const*> (src + i * 3);
+            auto sp1 = reinterpret_cast<__m128i const*> (src + i * 3 + 12);
+
+            __m256i s = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 (sp0)), _mm_loadu_si128 (sp1), 1);
+
+            unsigned int matches = rgb24_key_matches_avx2 (s, key);
+            if (matches == 0xff) {
+                continue;
+            }
+
+            __m256i d = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 (dp0)), _mm_loadu_si128 (dp1), 1);
+            __m256i p = use_alpha ? blend_bytes_avx2 (s, d, ws, wd) : s;
+
+            __m256i keep = _mm256_inserti128_si256 (
+                _mm256_castsi128_si256 (_mm_load_si128 (reinterpret_cast<__m128i const*> (rgb24_keep_masks.masks[matches & 0xf]))),
+                _mm_load_si128 (reinterpret_cast<__m128i const*> (rgb24_keep_masks.masks[matches >> 4])), 1);
+
+            p = _mm256_blendv_epi8 (p, d, keep);
+
+            _mm_storeu_si128 (dp0, _mm256_castsi256_si128 (p));
+            _mm_storeu_si128 (dp1, _mm256_extracti128_si256 (p, 1));
+        }
+
+        return i;
+    }
+
+    template <bool use_colorkey, bool use_alpha>
+    LV_ATTR_TARGET ("avx2")
+    inline int overlay_argb32_avx2 (uint8_t* dst, uint8_t const* src, int count, VideoBlit::OverlayParams const& params)
+    {
+        uint64_t const a = params.alpha;
+
+        __m256i const rgb_mask = _mm256_set1_epi32 (0xffffff);
+        __m256i const key      = _mm256_set1_epi32 (params.colorkey & 0xffffff);
+        __m256i const ws       = _mm256_set1_epi64x (a | a << 16 | a << 32);
+        __m256i const wd       = _mm256_sub_epi16 (_mm256_set1_epi16 (256), ws);
+
+        int n = count & ~7;
+
+        for (int i = 0; i < n; i += 8) {
+            auto dp = reinterpret_cast<__m256i*> (dst + i * 4);
+
+            __m256i s = _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i * 4));
+            __m256i d = _mm256_loadu_si256 (dp);
+
+            __m256i p = use_alpha ? blend_bytes_avx2 (s, d, ws, wd) : s;
+
+            if (use_colorkey) {
+                p = _mm256_blendv_epi8 (p, d, _mm256_cmpeq_epi32 (_mm256_and_si256 (s, rgb_mask), key));
+            }
+
+            _mm256_storeu_si256 (dp, p);
+        }
+
+        return n;
+    }
+
+  } // anonymous namespace
+#endif
+
+  int VideoBlit::overlay_rgb16_row_avx2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      if (!params.use_alpha) {
+          return overlay_rgb16_avx2<true, false> (dst, src, count, params);
+      } else if (!params.use_colorkey) {
+          return overlay_rgb16_avx2<false, true> (dst, src, count, params);
+      } else {
+          return overlay_rgb16_avx2<true, true> (dst, src, count, params);
+      }
+#else
+      return 0;
+#endif
+  }
+
+  int VideoBlit::overlay_rgb24_row_avx2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      if (!params.use_alpha) {
+          return overlay_rgb24_avx2<true, false> (dst, src, count, params);
+      } else if (!params.use_colorkey) {
+          return overlay_rgb24_avx2<false, true> (dst, src, count, params);
+      } else {
+          return overlay_rgb24_avx2<true, true> (dst, src, count, params);
+      }
+#else
+      return 0;
+#endif
+  }
+
+  int VideoBlit::overlay_argb32_row_avx2 (uint8_t* dst, uint8_t const* src, int count, OverlayParams const& params)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      if (!params.use_alpha) {
+          return overlay_argb32_avx2<true, false> (dst, src, count, params);
+      } else if (!params.use_colorkey) {
+          return overlay_argb32_avx2<false, true> (dst, src, count, params);
+      } else {
+          return overlay_argb32_avx2<true, true> (dst, src, count, params);
+      }
+#else
+      return 0;
+#endif
+  }
+
 } // LV namespace
@@ -42,33 +42,32 @@ namespace LV {
     #if VISUAL_BIG_ENDIAN == 1
     void flip_byte_order (VideoPtr const& video)
     {
-        auto pixel = static_cast<uint8_t*> (video->get_pixels ());
-        unsigned int pixel_count = video->get_width () * video->get_height ();
+        for (int y = 0; y < video->get_height (); y++) {
+            auto pixel = static_cast<uint8_t*> (video->get_pixel_ptr (0, y));
 
-        for (unsigned int i = 0; i < pixel_count; i++) {
-            pixel[0] = pixel[2];
-            pixel[2] = pixel[0];
-            pixel += 3;
+            for (int x = 0; x < video->get_width (); x++) {
+                pixel[0] = pixel[2];
+                pixel[2] = pixel[0];
+                pixel += 3;
+            }
         }
     }
     #endif // VISUAL_BIG_ENDIAN
 
     bool load_uncompressed (std::istream& fp, VideoPtr const& video, int depth)
     {
-        auto video_pixels = static_cast<uint8_t*> (video->get_pixels ());
-        int video_pitch  = video->get_pitch ();
         int video_height = video->get_height ();
+        int row_size     = video->get_width () * video->get_bpp ();
 
-        int pad = (4 - (video_pitch & 3)) & 3;
-        auto data = video_pixels + video_height * video_pitch;
+        int pad = (4 - (row_size & 3)) & 3;
 
         switch (depth) {
             case 24:
             case 8:
-                while (data > video_pixels) {
-                    data -= video_pitch;
+                for (int y = video_height - 1; y >= 0; y--) {
+                    auto row = static_cast<char*> (video->get_pixel_ptr (0, y));
 
-                    if (!fp.read (reinterpret_cast<char*> (data), video_pitch))
+                    if (!fp.read (row, row_size))
                         goto err;
 
                     if (pad)
@@ -77,11 +76,10 @@ namespace LV {
                 break;
 
             case 4:
-                while (data > video_pixels) {
+                for (int y = video_height - 1; y >= 0; y--) {
                     // Unpack 4 bpp pixels aka 2 pixels per byte
-                    auto col = data - video_pitch;
-                    auto end = reinterpret_cast<uint8_t*> ((intptr_t)data & ~1);
-                    data = col;
+                    auto col = static_cast<uint8_t*> (video->get_pixel_ptr (0, y));
+                    auto end = col + (row_size & ~1);
 
                     while (col < end) {
                         uint8_t p = fp.get ();
@@ -89,7 +87,7 @@ namespace LV {
                         *col++ = p & 0xf;
                     }
 
-                    if (video_pitch & 1)
+                    if (row_size & 1)
                         *col++ = fp.get () >> 4;
 
                     if (pad)
@@ -98,11 +96,10 @@ namespace LV {
                 break;
 
             case 1:
-                while (data > video_pixels) {
+                for (int y = video_height - 1; y >= 0; y--) {
                     /* Unpack 1 bpp pixels aka 8 pixels per byte */
-                    auto col = data - video_pitch;
-                    auto end = reinterpret_cast<uint8_t*> ((intptr_t)data & ~7);
-                    data = col;
+                    auto col = static_cast<uint8_t*> (video->get_pixel_ptr (0, y));
+                    auto end = col + (row_size & ~7);
 
                     while (col < end) {
                         uint8_t p = fp.get ();
@@ -112,9 +109,9 @@ namespace LV {
                         }
                     }
 
-                    if (video_pitch & 7) {
+                    if (row_size & 7) {
                         uint8_t p = fp.get ();
-                        uint8_t count = video_pitch & 7;
+                        uint8_t count = row_size & 7;
                         for (int i = 0; i < count; i++) {
                             *col++ = p >> 7;
                             p <<= 1;
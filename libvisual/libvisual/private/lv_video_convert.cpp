@@ -25,6 +25,7 @@
 #include "lv_video_convert.hpp"
 #include "lv_video_private.hpp"
 #include "lv_common.h"
+#include "lv_cpu.h"
 #include <algorithm>
 #include <array>
 
@@ -50,6 +51,26 @@ struct rgb16_t {
 
 namespace LV {
 
+  namespace {
+
+    typedef int (*ConvertRowFunc) (uint8_t* dst, uint8_t const* src, int count);
+
+    // Returns the fastest supported row kernel, or nullptr if there is none
+    ConvertRowFunc select_row_func (ConvertRowFunc avx2, ConvertRowFunc ssse3, ConvertRowFunc sse2)
+    {
+        if (avx2 && visual_cpu_has_avx2 ()) {
+            return avx2;
+        } else if (ssse3 && visual_cpu_has_ssse3 ()) {
+            return ssse3;
+        } else if (sse2 && visual_cpu_has_sse2 ()) {
+            return sse2;
+        }
+
+        return nullptr;
+    }
+
+  } // anonymous namespace
+
   void VideoConvert::convert_get_smallest (Video& dst, Video const& src, int& width, int& height)
   {
       width  = std::min (dst.m_impl->width,  src.m_impl->width);
@@ -134,14 +155,18 @@ namespace LV {
       int width, height;
       convert_get_smallest (dst, src, width, height);
 
+      bool use_avx2 = visual_cpu_has_avx2 ();
+
       auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
       auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + height * dst.m_impl->pitch;
       auto src_pixel_row     = static_cast<uint8_t const*> (src.get_pixels ());
 
       while (dst_pixel_row != dst_pixel_row_end) {
-          auto dst_pixel     = reinterpret_cast<uint32_t*> (dst_pixel_row);
+          int done = use_avx2 ? index8_to_argb32_row_avx2 (dst_pixel_row, src_pixel_row, colors.data (), width) : 0;
+
+          auto dst_pixel     = reinterpret_cast<uint32_t*> (dst_pixel_row) + done;
           auto dst_pixel_end = reinterpret_cast<uint32_t*> (dst_pixel_row) + width;
-          auto src_pixel     = src_pixel_row;
+          auto src_pixel     = src_pixel_row + done;
 
           while (dst_pixel != dst_pixel_end) {
               *dst_pixel = colors[*src_pixel];
@@ -224,14 +249,18 @@ namespace LV {
       int width, height;
       convert_get_smallest (dst, src, width, height);
 
+      auto convert_row = select_row_func (rgb16_to_argb32_row_avx2, nullptr, rgb16_to_argb32_row_sse2);
+
       auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
       auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + height * dst.m_impl->pitch;
       auto src_pixel_row     = static_cast<uint8_t const*> (src.get_pixels ());
 
       while (dst_pixel_row != dst_pixel_row_end) {
-          auto dst_pixel     = dst_pixel_row;
+          int done = convert_row ? convert_row (dst_pixel_row, src_pixel_row, width) : 0;
+
+          auto dst_pixel     = dst_pixel_row + done * 4;
           auto dst_pixel_end = dst_pixel_row + width * 4;
-          auto src_pixel     = reinterpret_cast<rgb16_t const*> (src_pixel_row);
+          auto src_pixel     = reinterpret_cast<rgb16_t const*> (src_pixel_row) + done;
 
           while (dst_pixel != dst_pixel_end) {
               dst_pixel[0] = src_pixel->b << 3;
@@ -318,14 +347,18 @@ namespace LV {
       int width, height;
       convert_get_smallest (dst, src, width, height);
 
+      auto convert_row = select_row_func (rgb24_to_argb32_row_avx2, rgb24_to_argb32_row_ssse3, nullptr);
+
       auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
       auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + height * dst.m_impl->pitch;
       auto src_pixel_row     = static_cast<uint8_t const*> (src.get_pixels ());
 
       while (dst_pixel_row != dst_pixel_row_end) {
-          auto dst_pixel     = dst_pixel_row;
+          int done = convert_row ? convert_row (dst_pixel_row, src_pixel_row, width) : 0;
+
+          auto dst_pixel     = dst_pixel_row + done * 4;
           auto dst_pixel_end = dst_pixel_row + width * 4;
-          auto src_pixel     = src_pixel_row;
+          auto src_pixel     = src_pixel_row + done * 3;
 
           while (dst_pixel != dst_pixel_end) {
               dst_pixel[0] = src_pixel[0];
@@ -384,14 +417,18 @@ namespace LV {
       int width, height;
       convert_get_smallest (dst, src, width, height);
 
+      auto convert_row = select_row_func (argb32_to_rgb16_row_avx2, argb32_to_rgb16_row_ssse3, nullptr);
+
       auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
       auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + height * dst.m_impl->pitch;
       auto src_pixel_row     = static_cast<uint8_t const*> (src.get_pixels ());
 
       while (dst_pixel_row != dst_pixel_row_end) {
-          auto dst_pixel     = reinterpret_cast<rgb16_t*> (dst_pixel_row);
+          int done = convert_row ? convert_row (dst_pixel_row, src_pixel_row, width) : 0;
+
+          auto dst_pixel     = reinterpret_cast<rgb16_t*> (dst_pixel_row) + done;
           auto dst_pixel_end = reinterpret_cast<rgb16_t*> (dst_pixel_row) + width;
-          auto src_pixel     = src_pixel_row;
+          auto src_pixel     = src_pixel_row + done * 4;
 
           while (dst_pixel != dst_pixel_end) {
               dst_pixel->b = src_pixel[0] >> 3;
@@ -409,17 +446,21 @@ namespace LV {
 
   void VideoConvert::argb32_to_rgb24 (Video& dst, Video const& src)
   {
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ());
-      auto src_pixel_row     = static_cast<uint8_t const*> (src.get_pixels ());
-
       int width, height;
       convert_get_smallest (dst, src, width, height);
 
+      auto convert_row = select_row_func (argb32_to_rgb24_row_avx2, argb32_to_rgb24_row_ssse3, nullptr);
+
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + height * dst.m_impl->pitch;
+      auto src_pixel_row     = static_cast<uint8_t const*> (src.get_pixels ());
+
       while (dst_pixel_row != dst_pixel_row_end) {
-          auto dst_pixel     = dst_pixel_row;
-          auto dst_pixel_end = dst_pixel_row + dst.m_impl->width * 3;
-          auto src_pixel     = src_pixel_row;
+          int done = convert_row ? convert_row (dst_pixel_row, src_pixel_row, width) : 0;
+
+          auto dst_pixel     = dst_pixel_row + done * 3;
+          auto dst_pixel_end = dst_pixel_row + width * 3;
+          auto src_pixel     = src_pixel_row + done * 4;
 
           while (dst_pixel != dst_pixel_end) {
               dst_pixel[0] = src_pixel[0];
@@ -51,6 +51,22 @@ namespace LV {
       static void flip_pixel_bytes_color16 (Video& dst, Video const& src);
       static void flip_pixel_bytes_color24 (Video& dst, Video const& src);
       static void flip_pixel_bytes_color32 (Video& dst, Video const& src);
+
+      // SIMD row kernels. Each returns the number of pixels converted, which is a multiple of its vector width.
+
+      static int index8_to_argb32_row_avx2 (uint8_t* dst, uint8_t const* src, uint32_t const* colors, int count);
+
+      static int rgb16_to_argb32_row_sse2 (uint8_t* dst, uint8_t const* src, int count);
+      static int rgb16_to_argb32_row_avx2 (uint8_t* dst, uint8_t const* src, int count);
+
+      static int rgb24_to_argb32_row_ssse3 (uint8_t* dst, uint8_t const* src, int count);
+      static int rgb24_to_argb32_row_avx2  (uint8_t* dst, uint8_t const* src, int count);
+
+      static int argb32_to_rgb16_row_ssse3 (uint8_t* dst, uint8_t const* src, int count);
+      static int argb32_to_rgb16_row_avx2  (uint8_t* dst, uint8_t const* src, int count);
+
+      static int argb32_to_rgb24_row_ssse3 (uint8_t* dst, uint8_t const* src, int count);
+      static int argb32_to_rgb24_row_avx2  (uint8_t* dst, uint8_t const* src, int count);
   };
 }
 
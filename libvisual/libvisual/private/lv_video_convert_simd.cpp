@@ -0,0 +1,374 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012-2013 Libvisual team
+ *
+ * Authors: Chong Kai Xiong <kaixiong@codeleft.sg>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_video_convert.hpp"
+#include "lv_common.h"
+
+#if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
+
+// The kernels produce exactly the same pixels as the portable converters. 16-bit pixels are laid out as:
+//
+//   bits 11-15: byte 0 >> 3, bits 5-10: byte 1 >> 2, bits 0-4: byte 2 >> 3
+
+namespace LV {
+
+#if defined(LV_HAVE_X86_SIMD)
+  namespace {
+
+    // 8-bit indexed to 32-bit
+
+    LV_ATTR_TARGET ("avx2")
+    int index8_to_argb32_avx2 (uint8_t* dst, uint8_t const* src, uint32_t const* colors, int count)
+    {
+        int n = count & ~7;
+
+        for (int i = 0; i < n; i += 8) {
+            __m256i index = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 (reinterpret_cast<__m128i const*> (src + i)));
+
+            _mm256_storeu_si256 (reinterpret_cast<__m256i*> (dst + i * 4),
+                                 _mm256_i32gather_epi32 (reinterpret_cast<int const*> (colors), index, 4));
+        }
+
+        return n;
+    }
+
+    // 16-bit to 32-bit
+
+    // Expands 8 16-bit pixels into the BG and RA byte pairs of 32-bit pixels
+    LV_ATTR_TARGET ("sse2")
+    inline void unpack_rgb16_sse2 (__m128i& bg, __m128i& ra, __m128i p)
+    {
+        __m128i const mask_f8 = _mm_set1_epi16 (0xf8);
+        __m128i const mask_fc = _mm_set1_epi16 (0xfc);
+
+        __m128i b = _mm_and_si128 (_mm_srli_epi16 (p, 8), mask_f8);
+        __m128i g = _mm_and_si128 (_mm_srli_epi16 (p, 3), mask_fc);
+        __m128i r = _mm_and_si128 (_mm_slli_epi16 (p, 3), mask_f8);
+
+        bg = _mm_or_si128 (b, _mm_slli_epi16 (g, 8));
+        ra = _mm_or_si128 (r, _mm_set1_epi16 (short (0xff00)));
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    inline void unpack_rgb16_avx2 (__m256i& bg, __m256i& ra, __m256i p)
+    {
+        __m256i const mask_f8 = _mm256_set1_epi16 (0xf8);
+        __m256i const mask_fc = _mm256_set1_epi16 (0xfc);
+
+        __m256i b = _mm256_and_si256 (_mm256_srli_epi16 (p, 8), mask_f8);
+        __m256i g = _mm256_and_si256 (_mm256_srli_epi16 (p, 3), mask_fc);
+        __m256i r = _mm256_and_si256 (_mm256_slli_epi16 (p, 3), mask_f8);
+
+        bg = _mm256_or_si256 (b, _mm256_slli_epi16 (g, 8));
+        ra = _mm256_or_si256 (r, _mm256_set1_epi16 (short (0xff00)));
+    }
+
+    LV_ATTR_TARGET ("sse2")
+    int rgb16_to_argb32_sse2 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        int n = count & ~7;
+
+        for (int i = 0; i < n; i += 8) {
+            __m128i bg, ra;
+            unpack_rgb16_sse2 (bg, ra, _mm_loadu_si128 (reinterpret_cast<__m128i const*> (src + i * 2)));
+
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + i * 4),      _mm_unpacklo_epi16 (bg, ra));
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + i * 4 + 16), _mm_unpackhi_epi16 (bg, ra));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    int rgb16_to_argb32_avx2 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        int n = count & ~15;
+
+        for (int i = 0; i < n; i += 16) {
+            __m256i bg, ra;
+            unpack_rgb16_avx2 (bg, ra, _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i * 2)));
+
+            // Unpacking works within 128-bit lanes, yielding pixels 0-3, 8-11 and 4-7, 12-15
+            __m256i lo = _mm256_unpacklo_epi16 (bg, ra);
+            __m256i hi = _mm256_unpackhi_epi16 (bg, ra);
+
+            _mm256_storeu_si256 (reinterpret_cast<__m256i*> (dst + i * 4),      _mm256_permute2x128_si256 (lo, hi, 0x20));
+            _mm256_storeu_si256 (reinterpret_cast<__m256i*> (dst + i * 4 + 32), _mm256_permute2x128_si256 (lo, hi, 0x31));
+        }
+
+        return n;
+    }
+
+    // 24-bit to 32-bit
+
+    LV_ATTR_TARGET ("ssse3")
+    int rgb24_to_argb32_ssse3 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        __m128i const shuffle = _mm_setr_epi8 (0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        __m128i const alpha   = _mm_set1_epi32 (int (0xff000000));
+
+        int n = count & ~15;
+
+        for (int i = 0; i < n; i += 16) {
+            auto s = reinterpret_cast<__m128i const*> (src + i * 3);
+            auto d = reinterpret_cast<__m128i*> (dst + i * 4);
+
+            __m128i s0 = _mm_loadu_si128 (s);
+            __m128i s1 = _mm_loadu_si128 (s + 1);
+            __m128i s2 = _mm_loadu_si128 (s + 2);
+
+            _mm_storeu_si128 (d,     _mm_or_si128 (_mm_shuffle_epi8 (s0, shuffle), alpha));
+            _mm_storeu_si128 (d + 1, _mm_or_si128 (_mm_shuffle_epi8 (_mm_alignr_epi8 (s1, s0, 12), shuffle), alpha));
+            _mm_storeu_si128 (d + 2, _mm_or_si128 (_mm_shuffle_epi8 (_mm_alignr_epi8 (s2, s1, 8), shuffle), alpha));
+            _mm_storeu_si128 (d + 3, _mm_or_si128 (_mm_shuffle_epi8 (_mm_srli_si128 (s2, 4), shuffle), alpha));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    int rgb24_to_argb32_avx2 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        // The upper lane is loaded 4 bytes ahead of its first pixel so no load reads past the last pixel
+        __m256i const shuffle = _mm256_setr_epi8 (0, 1,  2, -1, 3, 4,  5, -1,  6,  7,  8, -1,  9, 10, 11, -1,
+                                                  4, 5,  6, -1, 7, 8,  9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+        __m256i const alpha   = _mm256_set1_epi32 (int (0xff000000));
+
+        int n = count & ~15;
+
+        for (int i = 0; i < n; i += 16) {
+            auto s = src + i * 3;
+            auto d = reinterpret_cast<__m256i*> (dst + i * 4);
+
+            __m256i lo = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 (reinterpret_cast<__m128i const*> (s))),
+                                                  _mm_loadu_si128 (reinterpret_cast<__m128i const*> (s + 8)), 1);
+            __m256i hi = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 (reinterpret_cast<__m128i const*> (s + 24))),
+                                                  _mm_loadu_si128 (reinterpret_cast<__m128i const*> (s + 32)), 1);
+
+            _mm256_storeu_si256 (d,     _mm256_or_si256 (_mm256_shuffle_epi8 (lo, shuffle), alpha));
+            _mm256_storeu_si256 (d + 1, _mm256_or_si256 (_mm256_shuffle_epi8 (hi, shuffle), alpha));
+        }
+
+        return n;
+    }
+
+    // 32-bit to 16-bit
+
+    // Packs each 32-bit pixel into the low 16 bits of its element
+    LV_ATTR_TARGET ("sse2")
+    inline __m128i pack_rgb16_sse2 (__m128i p)
+    {
+        __m128i b = _mm_slli_epi32 (_mm_and_si128 (p, _mm_set1_epi32 (0xf8)), 8);
+        __m128i g = _mm_and_si128 (_mm_srli_epi32 (p, 5), _mm_set1_epi32 (0x7e0));
+        __m128i r = _mm_and_si128 (_mm_srli_epi32 (p, 19), _mm_set1_epi32 (0x1f));
+
+        return _mm_or_si128 (_mm_or_si128 (b, g), r);
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    inline __m256i pack_rgb16_avx2 (__m256i p)
+    {
+        __m256i b = _mm256_slli_epi32 (_mm256_and_si256 (p, _mm256_set1_epi32 (0xf8)), 8);
+        __m256i g = _mm256_and_si256 (_mm256_srli_epi32 (p, 5), _mm256_set1_epi32 (0x7e0));
+        __m256i r = _mm256_and_si256 (_mm256_srli_epi32 (p, 19), _mm256_set1_epi32 (0x1f));
+
+        return _mm256_or_si256 (_mm256_or_si256 (b, g), r);
+    }
+
+    LV_ATTR_TARGET ("ssse3")
+    int argb32_to_rgb16_ssse3 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        __m128i const shuffle = _mm_setr_epi8 (0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+
+        int n = count & ~7;
+
+        for (int i = 0; i < n; i += 8) {
+            auto s = reinterpret_cast<__m128i const*> (src + i * 4);
+
+            __m128i p0 = _mm_shuffle_epi8 (pack_rgb16_sse2 (_mm_loadu_si128 (s)),     shuffle);
+            __m128i p1 = _mm_shuffle_epi8 (pack_rgb16_sse2 (_mm_loadu_si128 (s + 1)), shuffle);
+
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + i * 2), _mm_unpacklo_epi64 (p0, p1));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    int argb32_to_rgb16_avx2 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        int n = count & ~15;
+
+        for (int i = 0; i < n; i += 16) {
+            auto s = reinterpret_cast<__m256i const*> (src + i * 4);
+
+            // Packed values fit in 16 bits, so saturation leaves them intact
+            __m256i p = _mm256_packus_epi32 (pack_rgb16_avx2 (_mm256_loadu_si256 (s)),
+                                             pack_rgb16_avx2 (_mm256_loadu_si256 (s + 1)));
+
+            _mm256_storeu_si256 (reinterpret_cast<__m256i*> (dst + i * 2), _mm256_permute4x64_epi64 (p, 0xd8));
+        }
+
+        return n;
+    }
+
+    // 32-bit to 24-bit
+
+    LV_ATTR_TARGET ("ssse3")
+    int argb32_to_rgb24_ssse3 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        __m128i const shuffle = _mm_setr_epi8 (0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+        int n = count & ~15;
+
+        for (int i = 0; i < n; i += 16) {
+            auto s = reinterpret_cast<__m128i const*> (src + i * 4);
+            auto d = reinterpret_cast<__m128i*> (dst + i * 3);
+
+            __m128i p0 = _mm_shuffle_epi8 (_mm_loadu_si128 (s),     shuffle);
+            __m128i p1 = _mm_shuffle_epi8 (_mm_loadu_si128 (s + 1), shuffle);
+            __m128i p2 = _mm_shuffle_epi8 (_mm_loadu_si128 (s + 2), shuffle);
+            __m128i p3 = _mm_shuffle_epi8 (_mm_loadu_si128 (s + 3), shuffle);
+
+            _mm_storeu_si128 (d,     _mm_or_si128 (p0, _mm_slli_si128 (p1, 12)));
+            _mm_storeu_si128 (d + 1, _mm_or_si128 (_mm_srli_si128 (p1, 4), _mm_slli_si128 (p2, 8)));
+            _mm_storeu_si128 (d + 2, _mm_or_si128 (_mm_srli_si128 (p2, 8), _mm_slli_si128 (p3, 4)));
+        }
+
+        return n;
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    int argb32_to_rgb24_avx2 (uint8_t* dst, uint8_t const* src, int count)
+    {
+        __m256i const shuffle = _mm256_setr_epi8 (0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                  0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+        // Moves the 12 bytes of each lane next to each other
+        __m256i const compact = _mm256_setr_epi32 (0, 1, 2, 4, 5, 6, 3, 7);
+
+        int n = count & ~7;
+
+        for (int i = 0; i < n; i += 8) {
+            __m256i p = _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (src + i * 4));
+            p = _mm256_permutevar8x32_epi32 (_mm256_shuffle_epi8 (p, shuffle), compact);
+
+            auto d = dst + i * 3;
+
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (d), _mm256_castsi256_si128 (p));
+            _mm_storel_epi64 (reinterpret_cast<__m128i*> (d + 16), _mm256_extracti128_si256 (p, 1));
+        }
+
+        return n;
+    }
+
+  } // anonymous namespace
+#endif
+
+  int VideoConvert::index8_to_argb32_row_avx2 (uint8_t* dst, uint8_t const* src, uint32_t const* colors, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return index8_to_argb32_avx2 (dst, src, colors, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::rgb16_to_argb32_row_sse2 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return rgb16_to_argb32_sse2 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::rgb16_to_argb32_row_avx2 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return rgb16_to_argb32_avx2 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::rgb24_to_argb32_row_ssse3 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return rgb24_to_argb32_ssse3 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::rgb24_to_argb32_row_avx2 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return rgb24_to_argb32_avx2 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::argb32_to_rgb16_row_ssse3 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return argb32_to_rgb16_ssse3 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::argb32_to_rgb16_row_avx2 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return argb32_to_rgb16_avx2 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::argb32_to_rgb24_row_ssse3 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return argb32_to_rgb24_ssse3 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+  int VideoConvert::argb32_to_rgb24_row_avx2 (uint8_t* dst, uint8_t const* src, int count)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      return argb32_to_rgb24_avx2 (dst, src, count);
+#else
+      return 0;
+#endif
+  }
+
+} // LV namespace
@@ -50,6 +50,12 @@ namespace LV {
 
       int8_t col = ((color.r + color.g + color.b) / 3);
 
+      // Contiguous rows are filled in one call, so that frame-sized fills can bypass the cache
+      if (video.m_impl->pitch == video.m_impl->width) {
+          visual_mem_set (buf, col, video.m_impl->width * video.m_impl->height);
+          return;
+      }
+
       for (int y = 0; y < video.m_impl->height; y++) {
           visual_mem_set (buf, col, video.m_impl->width);
 
@@ -66,6 +72,11 @@ namespace LV {
       pixel.rgb.g = color.g >> 2;
       pixel.rgb.b = color.b >> 3;
 
+      if (video.m_impl->pitch == video.m_impl->width * 2) {
+          visual_mem_set16 (buf, pixel.value, video.m_impl->width * video.m_impl->height);
+          return;
+      }
+
       for (int y = 0; y < video.m_impl->height; y++) {
           visual_mem_set16 (buf, pixel.value, video.m_impl->width);
 
@@ -132,6 +143,11 @@ namespace LV {
 
       uint32_t col = (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
 
+      if (video.m_impl->pitch == video.m_impl->width * 4) {
+          visual_mem_set32 (buf, col, video.m_impl->width * video.m_impl->height);
+          return;
+      }
+
       for (int y = 0; y < video.m_impl->height; y++) {
           visual_mem_set32 (buf, col, video.m_impl->width);
 
@@ -49,9 +49,11 @@ namespace LV {
       VideoConstPtr      parent;
       Rect               extents;
 
+      std::vector<Rect>  dirty_rects;
+
       VisVideoComposeType compose_type;
       VisVideoComposeFunc compose_func;
-      Color*              colorkey;
+      Color               colorkey;
       uint8_t             alpha;
 
       Impl ();
@@ -62,6 +64,12 @@ namespace LV {
       void precompute_row_table ();
   };
 
+  //! Returns the smallest pitch for a row of the given size that is a multiple of VISUAL_VIDEO_ALIGNMENT.
+  inline int aligned_pitch (int row_size)
+  {
+      return (row_size + VISUAL_VIDEO_ALIGNMENT - 1) / VISUAL_VIDEO_ALIGNMENT * VISUAL_VIDEO_ALIGNMENT;
+  }
+
 } // LV namespace
 
 #endif // _LV_VIDEO_PRIVATE_HPP
@@ -76,7 +76,7 @@ namespace LV {
 
   void VideoTransform::rotate_270 (Video& dst, Video const& src)
   {
-      auto tsbuf = static_cast<uint8_t*> (src.get_pixels ()) + src.m_impl->pitch - src.m_impl->bpp;
+      auto tsbuf = static_cast<uint8_t*> (src.m_impl->pixel_rows[0]) + (src.m_impl->width - 1) * src.m_impl->bpp;
       auto sbuf = tsbuf;
 
       visual_return_if_fail (dst.m_impl->width == src.m_impl->height);
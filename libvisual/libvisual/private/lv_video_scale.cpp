@@ -24,8 +24,12 @@
 #include "config.h"
 #include "lv_video_transform.hpp"
 #include "lv_video_private.hpp"
+#include "lv_aligned_allocator.hpp"
 #include "lv_common.h"
 #include "lv_cpu.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 #pragma pack(1)
 
@@ -48,15 +52,132 @@ struct color24_t {
 
 namespace LV {
 
-  void VideoTransform::scale_nearest_color8 (Video& dst, Video const& src)
+  namespace {
+
+    struct ScalerEntry
+    {
+        int                       (*is_supported) ();
+        VisVideoDepth             depth;
+        VisVideoScaleMethod       method;
+        VideoTransform::ScaleFunc scale;
+    };
+
+    // Scalers in order of preference. Entries without an is_supported() check run on any processor.
+    ScalerEntry const scalers[] = {
+        { visual_cpu_has_avx2, VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color24_avx2 },
+        { visual_cpu_has_sse2, VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color24_sse2 },
+        { visual_cpu_has_avx2, VISUAL_VIDEO_DEPTH_32BIT, VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color32_avx2 },
+        { visual_cpu_has_sse2, VISUAL_VIDEO_DEPTH_32BIT, VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color32_sse2 },
+
+        { nullptr, VISUAL_VIDEO_DEPTH_8BIT,  VISUAL_VIDEO_SCALE_NEAREST,  VideoTransform::scale_nearest_color8   },
+        { nullptr, VISUAL_VIDEO_DEPTH_16BIT, VISUAL_VIDEO_SCALE_NEAREST,  VideoTransform::scale_nearest_color16  },
+        { nullptr, VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_SCALE_NEAREST,  VideoTransform::scale_nearest_color24  },
+        { nullptr, VISUAL_VIDEO_DEPTH_32BIT, VISUAL_VIDEO_SCALE_NEAREST,  VideoTransform::scale_nearest_color32  },
+        { nullptr, VISUAL_VIDEO_DEPTH_8BIT,  VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color8  },
+        { nullptr, VISUAL_VIDEO_DEPTH_16BIT, VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color16 },
+        { nullptr, VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color24 },
+        { nullptr, VISUAL_VIDEO_DEPTH_32BIT, VISUAL_VIDEO_SCALE_BILINEAR, VideoTransform::scale_bilinear_color32 }
+    };
+
+    // Number of destination rows scaled from each strip of converted source rows
+    int const scale_depth_strip_rows = 64;
+
+  } // anonymous namespace
+
+  VideoTransform::ScaleFunc VideoTransform::get_scaler (VisVideoDepth depth, VisVideoScaleMethod method)
+  {
+      for (auto const& entry : scalers) {
+          if (entry.depth == depth && entry.method == method && (!entry.is_supported || entry.is_supported ())) {
+              return entry.scale;
+          }
+      }
+
+      return nullptr;
+  }
+
+  void VideoTransform::scale_depth (Video& dst, Video const& src, ScaleFunc scale, int row_begin, int row_end)
+  {
+      thread_local std::vector<uint8_t, AlignedAllocator<uint8_t, VISUAL_VIDEO_ALIGNMENT>> strip_pixels;
+
+      int src_width  = src.m_impl->width;
+      int src_height = src.m_impl->height;
+      int dst_height = dst.m_impl->height;
+
+      // Bounds on the source row steps of the scalers. Nearest neighbour scalers step further than bilinear ones, which
+      // also read the row below.
+      uint32_t dv_min = ((src_height - 1) << 16) / dst_height;
+      uint32_t dv_max = std::max<uint32_t> (dv_min, dst_height > 1 ? ((src_height - 1) << 16) / (dst_height - 1) : 0);
+
+      // A strip spans at most strip_rows steps, plus the difference between the two step bounds accumulated over
+      // the destination, which is at most one step.
+      int strip_pitch    = aligned_pitch (src_width * dst.m_impl->bpp);
+      int max_strip_rows = std::min<int> (src_height, ((uint64_t (scale_depth_strip_rows + 1) * dv_max) >> 16) + 3);
+
+      strip_pixels.resize (std::size_t (max_strip_rows) * strip_pitch);
+
+      // Views of the source rows of a strip, the same rows converted, and the source as seen by the scaler. The
+      // latter has the source dimensions, with the converted rows at their place in the source. The scaler never
+      // reads its rows outside the strip.
+      auto src_rows  = Video::create ();
+      auto strip     = Video::create ();
+      auto strip_src = Video::create ();
+
+      src_rows->set_depth (src.m_impl->depth);
+      src_rows->m_impl->palette = src.m_impl->palette;
+
+      strip->set_depth (dst.m_impl->depth);
+      strip_src->set_depth (dst.m_impl->depth);
+
+      // Source rows currently converted in the strip buffer
+      int converted_begin = 0;
+      int converted_end   = 0;
+
+      for (int strip_begin = row_begin; strip_begin < row_end; strip_begin += scale_depth_strip_rows) {
+          int strip_end = std::min (strip_begin + scale_depth_strip_rows, row_end);
+
+          int first_row = std::max (0, std::min<int> ((uint64_t (strip_begin) * dv_min) >> 16, src_height - 2));
+          int end_row   = std::min<int> (((uint64_t (strip_end - 1) * dv_max) >> 16) + 2, src_height);
+
+          // Rows shared with the previous strip are moved to the front of the buffer instead of being converted again
+          int kept_rows = std::max (0, converted_end - first_row);
+
+          if (kept_rows > 0) {
+              std::memmove (strip_pixels.data (),
+                            strip_pixels.data () + std::size_t (first_row - converted_begin) * strip_pitch,
+                            std::size_t (kept_rows) * strip_pitch);
+          }
+
+          int convert_begin = first_row + kept_rows;
+
+          if (convert_begin < end_row) {
+              src_rows->set_dimension (src_width, end_row - convert_begin, src.m_impl->pitch);
+              src_rows->m_impl->set_buffer (src.m_impl->pixel_rows[convert_begin]);
+
+              strip->set_dimension (src_width, end_row - convert_begin, strip_pitch);
+              strip->m_impl->set_buffer (strip_pixels.data () + std::size_t (kept_rows) * strip_pitch);
+
+              strip->convert_depth (src_rows);
+          }
+
+          converted_begin = first_row;
+          converted_end   = end_row;
+
+          strip_src->set_dimension (src_width, src_height, strip_pitch);
+          strip_src->m_impl->set_buffer (strip_pixels.data () - std::ptrdiff_t (first_row) * strip_pitch);
+
+          scale (dst, *strip_src, strip_begin, strip_end);
+      }
+  }
+
+  void VideoTransform::scale_nearest_color8 (Video& dst, Video const& src, int row_begin, int row_end)
   {
       uint32_t du = dst.m_impl->width  > 1 ? ((src.m_impl->width  - 1) << 16) / (dst.m_impl->width  - 1) : 0;
       uint32_t dv = dst.m_impl->height > 1 ? ((src.m_impl->height - 1) << 16) / (dst.m_impl->height - 1) : 0;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           auto src_pixel_row = static_cast<uint8_t const*> (src.m_impl->pixel_rows[v >> 16]);
@@ -76,15 +197,15 @@ namespace LV {
       }
   }
 
-  void VideoTransform::scale_nearest_color16 (Video& dst, Video const& src)
+  void VideoTransform::scale_nearest_color16 (Video& dst, Video const& src, int row_begin, int row_end)
   {
       uint32_t du = dst.m_impl->width  > 1 ? ((src.m_impl->width  - 1) << 16) / (dst.m_impl->width  - 1) : 0;
       uint32_t dv = dst.m_impl->height > 1 ? ((src.m_impl->height - 1) << 16) / (dst.m_impl->height - 1) : 0;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           auto src_pixel_row = static_cast<uint16_t const*> (src.m_impl->pixel_rows[v >> 16]);
@@ -104,15 +225,15 @@ namespace LV {
       }
   }
 
-  void VideoTransform::scale_nearest_color24 (Video& dst, Video const& src)
+  void VideoTransform::scale_nearest_color24 (Video& dst, Video const& src, int row_begin, int row_end)
   {
       uint32_t du = dst.m_impl->width  > 1 ? ((src.m_impl->width  - 1) << 16) / (dst.m_impl->width  - 1) : 0;
       uint32_t dv = dst.m_impl->height > 1 ? ((src.m_impl->height - 1) << 16) / (dst.m_impl->height - 1) : 0;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           auto src_pixel_row = static_cast<color24_t const*> (src.m_impl->pixel_rows[v >> 16]);
@@ -132,15 +253,15 @@ namespace LV {
       }
   }
 
-  void VideoTransform::scale_nearest_color32 (Video& dst, Video const& src)
+  void VideoTransform::scale_nearest_color32 (Video& dst, Video const& src, int row_begin, int row_end)
   {
       uint32_t du = dst.m_impl->width  > 1 ? ((src.m_impl->width  - 1) << 16) / (dst.m_impl->width  - 1) : 0;
       uint32_t dv = dst.m_impl->height > 1 ? ((src.m_impl->height - 1) << 16) / (dst.m_impl->height - 1) : 0;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           auto src_pixel_row = static_cast<uint32_t const*> (src.m_impl->pixel_rows[v >> 16]);
@@ -163,15 +284,15 @@ namespace LV {
       }
   }
 
-  void VideoTransform::scale_bilinear_color8 (Video& dst, Video const& src)
+  void VideoTransform::scale_bilinear_color8 (Video& dst, Video const& src, int row_begin, int row_end)
   {
       uint32_t du = ((src.m_impl->width  - 1) << 16) / dst.m_impl->width;
       uint32_t dv = ((src.m_impl->height - 1) << 16) / dst.m_impl->height;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           if (v >> 16 >= (unsigned int) (src.m_impl->height - 1))
@@ -218,15 +339,15 @@ namespace LV {
       }
   }
 
-  void VideoTransform::scale_bilinear_color16 (Video& dst, Video const& src)
+  void VideoTransform::scale_bilinear_color16 (Video& dst, Video const& src, int row_begin, int row_end)
   {
       uint32_t du = ((src.m_impl->width - 1)  << 16) / dst.m_impl->width;
       uint32_t dv = ((src.m_impl->height - 1) << 16) / dst.m_impl->height;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           if (v >> 16 >= (unsigned int) (src.m_impl->height - 1))
@@ -289,15 +410,15 @@ namespace LV {
       }
   }
 
-  void VideoTransform::scale_bilinear_color24 (Video& dst, Video const& src)
+  void VideoTransform::scale_bilinear_color24 (Video& dst, Video const& src, int row_begin, int row_end)
   {
       uint32_t du = ((src.m_impl->width  - 1) << 16) / dst.m_impl->width;
       uint32_t dv = ((src.m_impl->height - 1) << 16) / dst.m_impl->height;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           if (v >> 16 >= (unsigned int) (src.m_impl->height - 1))
@@ -360,20 +481,15 @@ namespace LV {
       }
   }
 
-  void VideoTransform::scale_bilinear_color32 (Video& dst, Video const& src)
+  void VideoTransform::scale_bilinear_color32 (Video& dst, Video const& src, int row_begin, int row_end)
   {
-      if (visual_cpu_has_mmx ()) {
-          scale_bilinear_color32_mmx (dst, src);
-          return;
-      }
-
       uint32_t du = ((src.m_impl->width  - 1) << 16) / dst.m_impl->width;
       uint32_t dv = ((src.m_impl->height - 1) << 16) / dst.m_impl->height;
 
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * dst.m_impl->height;
+      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_begin;
+      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + dst.m_impl->pitch * row_end;
 
-      uint32_t v = 0;
+      uint32_t v = row_begin * dv;
 
       while (dst_pixel_row != dst_pixel_row_end) {
           if (v >> 16 >= (unsigned int) (src.m_impl->height - 1))
@@ -23,143 +23,359 @@
 
 #include "config.h"
 #include "lv_video_transform.hpp"
-#include "lv_video_private.hpp"
+#include "lv_aligned_allocator.hpp"
 #include "lv_common.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
-namespace LV {
-
-  void VideoTransform::scale_bilinear_color32_mmx (Video& dst, Video const& src)
-  {
 #if defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)
-      auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ());
-      auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ());
-
-      uint32_t du = ((src.m_impl->width  - 1) << 16) / dst.m_impl->width;
-      uint32_t dv = ((src.m_impl->height - 1) << 16) / dst.m_impl->height;
-
-      uint32_t v = 0;
-
-      while (dst_pixel_row != dst_pixel_row_end) {
-          if (v >> 16 >= (unsigned int) (src.m_impl->height - 1))
-              v -= 0x10000;
-
-          auto dst_pixel     = reinterpret_cast<uint32_t*> (dst_pixel_row);
-          auto dst_pixel_end = reinterpret_cast<uint32_t*> (dst_pixel_row) + dst.m_impl->width;
-
-          auto src_pixel_rowu = static_cast<uint32_t const*> (src.m_impl->pixel_rows[v >> 16]);
-          auto src_pixel_rowl = static_cast<uint32_t const*> (src.m_impl->pixel_rows[(v >> 16) + 1]);
+#include <immintrin.h>
+#endif
 
-          /* fracV = frac(v) = v & 0xffff */
-          /* fixed point format convertion: fracV >>= 8) */
-          uint32_t fracV = ((v & 0xffff) >> 12) | 0x100000;
-          uint32_t u = 0;
+#if (defined(VISUAL_ARCH_X86) || defined(VISUAL_ARCH_X86_64)) && defined(LV_HAVE_ATTR_TARGET)
+#define LV_HAVE_X86_SIMD 1
+#endif
 
-          while (dst_pixel != dst_pixel_end) {
-              /* fracU = frac(u) = u & 0xffff */
-              /* fixed point format convertion: fracU >>= 8) */
-              uint32_t fracU  = ((u & 0xffff) >> 12) | 0x100000;
+// The SIMD bilinear scalers split the weighted sum of the portable scalers into a vertical and a horizontal pass:
+//
+//   ((0x100 - fracU) * ((0x100 - fracV) * ul + fracV * ll) + fracU * ((0x100 - fracV) * ur + fracV * lr)) >> 16
+//
+// The vertical sums fit in 16 bits and the horizontal sums in 32 bits, so the result is exact.
 
-              __asm__ __volatile__
-                  ("\n\t pxor %%mm7, %%mm7"
-                   /* Prefetching does not show improvement on my Duron (maybe due to its small cache?) */
-                   /*"\n\t prefetch  64%[pixel_l]" / * only work on 3dnow!/SSE cpu */
-                   /*"\n\t prefetchw 64%[output]"  / * only work on 3dnow!/SSE cpu */
+namespace LV {
 
-                   /* Computing coefs values (Thread #1 and #2) => ends on #C
-                    *
-                    * notice 0x10 = 1.0 (fixed point 28.4 - like fracU and fracV)
-                    *
-                    * coef[0] = (0x10 - fracU) * (0x10 - fracV); * UL=0 *
-                    * coef[1] = (0x10 - fracU) * fracV;          * LL=1 *
-                    * coef[2] = fracU * (0x10 - fracV);          * UR=2 *
-                    * coef[3] = fracU * fracV;                   * LR=3 *
-                    */
+#if defined(LV_HAVE_X86_SIMD)
+  namespace {
 
-                   /*
-                    * Unpacking colors (Thread #3 and #4)
-                    */
-                   /*
-                    * Multiplying colors by coefs (Threads #5 and #6)
-                    */
-                   /*
-                    * Adding colors together. (Thread #7)
-                    */
+    // Source pixels and weights of each destination column, shared by all rows
+    class BilinearColumns
+    {
+    public:
 
-                   "#1\n\t movd %[fracu], %%mm4"   /* mm4 = [ 0 | 0 | 0x10 | fracU ] */
-                   "#2\n\t movd %[fracv], %%mm6"   /* mm6 = [ 0 | 0 | 0x10 | fracV ] */
+        // Byte offset of the left source pixel
+        std::vector<uint32_t> offsets;
 
-                   "#1\n\t punpcklwd %%mm4, %%mm4" /* mm4 = [ 0x10 | 0x10 | fracU | fracU ] */
-                   "#2\n\t movq      %%mm6, %%mm3"
+        // Horizontal weights laid out as 4 x (0x100 - fracU) followed by 4 x fracU
+        std::vector<uint16_t, AlignedAllocator<uint16_t, 16>> weights;
 
-                   "#1\n\t pxor      %%mm5, %%mm5"
-                   "#2\n\t punpckldq %%mm6, %%mm6" /* mm6 = [ 0x10 | fracv | 0x10 | fracV ] */
-                   "#3\n\t movq %[pixel_u], %%mm0" /* mm0 = [ col[0] | col[2] ] */
+        // Number of leading columns whose source pixel pairs can be loaded as 8 bytes without reading past the row
+        int vector_width = 0;
 
-                   "#1\n\t punpckldq %%mm4, %%mm5" /* mm5 = [ fracU | fracU | 0 | 0 ] */
-                   "#2\n\t punpcklwd %%mm7, %%mm3" /* mm3 = [ 0    | 0x10  | 0    | fracV ] */
-                   "#3\n\t movq      %%mm0, %%mm2"
+        void compute (int width, uint32_t du, int bpp, int src_width)
+        {
+            if (width == m_width && du == m_du && bpp == m_bpp && src_width == m_src_width) {
+                return;
+            }
 
-                   "#1\n\t psubusw   %%mm5, %%mm4" /* mm4 = [ 0x10-fracU | 0x10-fracU | fracU | fracU ] */
-                   "#2\n\t punpckldq %%mm3, %%mm3" /* mm3 = [ 0    | fracV | 0    | fracV ] */
-                   "#4\n\t movq %[pixel_l], %%mm1" /* mm1 = [ col[1] | col[3] ] */
+            offsets.resize (width);
+            weights.resize (8 * width);
 
-                   "#2\n\t pslld     $16,   %%mm3" /* mm3 = [ fracV | 0 | fracV | 0 ] */
-                   "#3\n\t punpcklbw %%mm7, %%mm0" /* mm0 = [ col[0] unpacked ] */
+            uint32_t u = 0;
 
-                   "#2\n\t psubusw   %%mm3, %%mm6" /* mm6 = [ 0x10-fracV | fracV | 0x10-fracV | fracV ] */
-                   "#4\n\t movq      %%mm1, %%mm3"
+            for (int x = 0; x < width; x++) {
+                uint16_t frac_u = (u & 0xffff) >> 8;
 
-                   "#C\n\t pmullw    %%mm6, %%mm4" /* mm4 = [ coef[0]|coef[1]|coef[2]|coef[3] ] */
-                   "#5\n\t movq      %%mm4, %%mm5"
+                offsets[x] = (u >> 16) * bpp;
+                std::fill_n (&weights[8 * x],     4, 0x100 - frac_u);
+                std::fill_n (&weights[8 * x + 4], 4, frac_u);
 
-                   "#4\n\t punpcklbw %%mm7, %%mm1" /* mm1 = [ col[1] unpacked ] */
-                   "#6\n\t punpckhwd %%mm4, %%mm4" /* mm4 = [ coef[1]|coef[1]|coef[0]|coef[0] ] */
+                u += du;
+            }
 
-                   "#3\n\t punpckhbw %%mm7, %%mm2" /* mm2 = [ col[2] unpacked ] */
-                   "#5\n\t punpcklwd %%mm5, %%mm5" /* mm5 = [ coef[2]|coef[2]|coef[3]|coef[3] ] */
+            vector_width = width;
 
-                   "#4\n\t punpckhbw %%mm7, %%mm3" /* mm3 = [ col[3] unpacked ] */
-                   "#5\n\t movq      %%mm5, %%mm6"
+            while (vector_width > 0 && offsets[vector_width - 1] + 8 > uint32_t (src_width * bpp)) {
+                vector_width--;
+            }
 
-                   "#6\n\t movq      %%mm4, %%mm7"
-                   "#5\n\t punpcklwd %%mm6, %%mm6" /* mm6 = [ coef[3]|coef[3]|coef[3]|coef[3] ] */
+            m_width     = width;
+            m_du        = du;
+            m_bpp       = bpp;
+            m_src_width = src_width;
+        }
 
-                   "#6\n\t punpcklwd %%mm7, %%mm7" /* mm6 = [ coef[1]|coef[1]|coef[1]|coef[1] ] */
-                   "#5\n\t pmullw    %%mm6, %%mm3" /* mm3 = [ coef[3] * col[3] unpacked ] */
+    private:
 
-                   "#5\n\t punpckhwd %%mm5, %%mm5" /* mm5 = [ coef[2]|coef[2]|coef[2]|coef[2] ] */
-                   "#6\n\t pmullw    %%mm7, %%mm1" /* mm1 = [ coef[1] * col[1] unpacked ] */
+        int      m_width     = 0;
+        uint32_t m_du        = 0;
+        int      m_bpp       = 0;
+        int      m_src_width = 0;
+    };
 
-                   "#5\n\t pmullw    %%mm5, %%mm2" /* mm2 = [ coef[2] * col[2] unpacked ] */
-                   "#6\n\t punpckhwd %%mm4, %%mm4" /* mm4 = [ coef[0]|coef[0]|coef[0]|coef[0] ] */
+    typedef void (*BilinearRowFunc) (uint8_t* dst, uint8_t const* upper, uint8_t const* lower, uint16_t frac_v,
+                                     BilinearColumns const& columns, int width);
 
-                   "#6\n\t pmullw    %%mm4, %%mm0" /* mm0 = [ coef[0] * col[0] unpacked ] */
-                   "#7\n\t paddw     %%mm2, %%mm3"
-                   "#7\n\t paddw     %%mm1, %%mm0"
+    // Computes one pixel exactly like the portable scalers
+    template <int bpp>
+    inline void bilinear_pixel (uint8_t* dst, uint8_t const* upper, uint8_t const* lower, uint32_t frac_u, uint32_t frac_v)
+    {
+        for (int c = 0; c < bpp; c++) {
+            uint32_t left  = (0x100 - frac_v) * upper[c]       + frac_v * lower[c];
+            uint32_t right = (0x100 - frac_v) * upper[c + bpp] + frac_v * lower[c + bpp];
+
+            dst[c] = ((0x100 - frac_u) * left + frac_u * right) >> 16;
+        }
+    }
+
+    template <int bpp>
+    inline void bilinear_pixels (uint8_t* dst, uint8_t const* upper, uint8_t const* lower, uint16_t frac_v,
+                                 BilinearColumns const& columns, int begin, int end)
+    {
+        for (int x = begin; x < end; x++) {
+            auto offset = columns.offsets[x];
+            bilinear_pixel<bpp> (dst + x * bpp, upper + offset, lower + offset, columns.weights[8 * x + 4], frac_v);
+        }
+    }
+
+    void scale_bilinear_rows (Video& dst, Video const& src, int row_begin, int row_end, BilinearRowFunc scale_row)
+    {
+        thread_local BilinearColumns columns;
+
+        int width  = dst.get_width ();
+        int height = dst.get_height ();
+        int pitch  = dst.get_pitch ();
+
+        uint32_t du = ((src.get_width ()  - 1) << 16) / width;
+        uint32_t dv = ((src.get_height () - 1) << 16) / height;
+
+        columns.compute (width, du, dst.get_bpp (), src.get_width ());
+
+        auto dst_pixel_row     = static_cast<uint8_t*> (dst.get_pixels ()) + pitch * row_begin;
+        auto dst_pixel_row_end = static_cast<uint8_t*> (dst.get_pixels ()) + pitch * row_end;
+
+        uint32_t v = row_begin * dv;
+
+        while (dst_pixel_row != dst_pixel_row_end) {
+            if (v >> 16 >= (unsigned int) (src.get_height () - 1))
+                v -= 0x10000;
+
+            auto src_pixel_rowu = static_cast<uint8_t const*> (src.get_pixel_ptr (0, v >> 16));
+            auto src_pixel_rowl = static_cast<uint8_t const*> (src.get_pixel_ptr (0, (v >> 16) + 1));
+
+            scale_row (dst_pixel_row, src_pixel_rowu, src_pixel_rowl, (v & 0xffff) >> 8, columns, width);
+
+            dst_pixel_row += pitch;
+            v += dv;
+        }
+    }
+
+#if defined(LV_HAVE_X86_SIMD)
+
+    // Loads the source pixel pairs of 2 columns into the two halves of a vector. 24-bit pixels are laid out like
+    // 32-bit pixels.
+    template <int bpp>
+    LV_ATTR_TARGET ("sse2")
+    inline __m128i load_pairs_sse2 (uint8_t const* pixels, uint32_t offset0, uint32_t offset1)
+    {
+        __m128i pairs = _mm_unpacklo_epi64 (_mm_loadl_epi64 (reinterpret_cast<__m128i const*> (pixels + offset0)),
+                                            _mm_loadl_epi64 (reinterpret_cast<__m128i const*> (pixels + offset1)));
+
+        if (bpp == 3) {
+            pairs = _mm_or_si128 (_mm_and_si128 (pairs, _mm_set1_epi64x (0xffffff)),
+                                  _mm_and_si128 (_mm_slli_epi64 (pairs, 8), _mm_set1_epi64x (0xffffff00000000LL)));
+        }
+
+        return pairs;
+    }
+
+    // Stores 4 pixels laid out as 32-bit pixels into 12 bytes
+    LV_ATTR_TARGET ("sse2")
+    inline void store_quad24_sse2 (uint8_t* dst, __m128i pixels)
+    {
+        // Pack each pair of pixels into 6 bytes, then move the second pair next to the first
+        __m128i pairs = _mm_or_si128 (_mm_and_si128 (pixels, _mm_set1_epi64x (0xffffff)),
+                                      _mm_and_si128 (_mm_srli_epi64 (pixels, 8), _mm_set1_epi64x (0xffffff000000LL)));
+
+        __m128i quad = _mm_or_si128 (_mm_and_si128 (pairs, _mm_set_epi64x (0, 0xffffffffffffLL)),
+                                     _mm_and_si128 (_mm_srli_si128 (pairs, 2), _mm_set_epi64x (0xffffffffLL, 0xffff000000000000LL)));
+
+        uint32_t high = _mm_cvtsi128_si32 (_mm_srli_si128 (quad, 8));
+
+        _mm_storel_epi64 (reinterpret_cast<__m128i*> (dst), quad);
+        std::memcpy (dst + 8, &high, 4);
+    }
+
+    // Computes 2 pixels from their upper and lower source pixel pairs, one pair in each 64-bit half. The result
+    // holds the 4 channels of both pixels as 16-bit integers.
+    LV_ATTR_TARGET ("sse2")
+    inline __m128i bilinear_pair_sse2 (__m128i upper, __m128i lower, __m128i weight_u, __m128i weight_l,
+                                       __m128i weights0, __m128i weights1)
+    {
+        __m128i zero = _mm_setzero_si128 ();
+
+        // Vertical pass
+        __m128i t0 = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (upper, zero), weight_u),
+                                    _mm_mullo_epi16 (_mm_unpacklo_epi8 (lower, zero), weight_l));
+        __m128i t1 = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (upper, zero), weight_u),
+                                    _mm_mullo_epi16 (_mm_unpackhi_epi8 (lower, zero), weight_l));
+
+        // Horizontal pass, with 32-bit products assembled from their low and high halves
+        __m128i lo0 = _mm_mullo_epi16 (t0, weights0);
+        __m128i hi0 = _mm_mulhi_epu16 (t0, weights0);
+        __m128i lo1 = _mm_mullo_epi16 (t1, weights1);
+        __m128i hi1 = _mm_mulhi_epu16 (t1, weights1);
+
+        __m128i s0 = _mm_add_epi32 (_mm_unpacklo_epi16 (lo0, hi0), _mm_unpackhi_epi16 (lo0, hi0));
+        __m128i s1 = _mm_add_epi32 (_mm_unpacklo_epi16 (lo1, hi1), _mm_unpackhi_epi16 (lo1, hi1));
+
+        return _mm_packs_epi32 (_mm_srli_epi32 (s0, 16), _mm_srli_epi32 (s1, 16));
+    }
+
+    LV_ATTR_TARGET ("avx2")
+    inline __m256i bilinear_pair_avx2 (__m256i upper, __m256i lower, __m256i weight_u, __m256i weight_l,
+                                       __m256i weights0, __m256i weights1)
+    {
+        __m256i zero = _mm256_setzero_si256 ();
+
+        __m256i t0 = _mm256_add_epi16 (_mm256_mullo_epi16 (_mm256_unpacklo_epi8 (upper, zero), weight_u),
+                                       _mm256_mullo_epi16 (_mm256_unpacklo_epi8 (lower, zero), weight_l));
+        __m256i t1 = _mm256_add_epi16 (_mm256_mullo_epi16 (_mm256_unpackhi_epi8 (upper, zero), weight_u),
+                                       _mm256_mullo_epi16 (_mm256_unpackhi_epi8 (lower, zero), weight_l));
+
+        __m256i lo0 = _mm256_mullo_epi16 (t0, weights0);
+        __m256i hi0 = _mm256_mulhi_epu16 (t0, weights0);
+        __m256i lo1 = _mm256_mullo_epi16 (t1, weights1);
+        __m256i hi1 = _mm256_mulhi_epu16 (t1, weights1);
+
+        __m256i s0 = _mm256_add_epi32 (_mm256_unpacklo_epi16 (lo0, hi0), _mm256_unpackhi_epi16 (lo0, hi0));
+        __m256i s1 = _mm256_add_epi32 (_mm256_unpacklo_epi16 (lo1, hi1), _mm256_unpackhi_epi16 (lo1, hi1));
+
+        return _mm256_packs_epi32 (_mm256_srli_epi32 (s0, 16), _mm256_srli_epi32 (s1, 16));
+    }
+
+    // Loads the horizontal weights of columns x and x + 4 into the two halves of a vector
+    LV_ATTR_TARGET ("avx2")
+    inline __m256i load_weights_avx2 (uint16_t const* weights, int x)
+    {
+        auto w = reinterpret_cast<__m128i const*> (weights);
+        return _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_load_si128 (w + x)), _mm_load_si128 (w + x + 4), 1);
+    }
+
+    // SSE2 rows, 4 pixels at a time
+
+    template <int bpp>
+    LV_ATTR_TARGET ("sse2")
+    void bilinear_row_sse2 (uint8_t* dst, uint8_t const* upper, uint8_t const* lower, uint16_t frac_v,
+                            BilinearColumns const& columns, int width)
+    {
+        auto offsets = columns.offsets.data ();
+        auto weights = reinterpret_cast<__m128i const*> (columns.weights.data ());
+
+        __m128i weight_u = _mm_set1_epi16 (0x100 - frac_v);
+        __m128i weight_l = _mm_set1_epi16 (frac_v);
+
+        int x = 0;
+
+        for (; x + 4 <= columns.vector_width; x += 4) {
+            auto o = offsets + x;
+
+            __m128i p01 = bilinear_pair_sse2 (load_pairs_sse2<bpp> (upper, o[0], o[1]),
+                                              load_pairs_sse2<bpp> (lower, o[0], o[1]),
+                                              weight_u, weight_l,
+                                              _mm_load_si128 (weights + x), _mm_load_si128 (weights + x + 1));
+            __m128i p23 = bilinear_pair_sse2 (load_pairs_sse2<bpp> (upper, o[2], o[3]),
+                                              load_pairs_sse2<bpp> (lower, o[2], o[3]),
+                                              weight_u, weight_l,
+                                              _mm_load_si128 (weights + x + 2), _mm_load_si128 (weights + x + 3));
+
+            __m128i pixels = _mm_packus_epi16 (p01, p23);
+
+            if (bpp == 3) {
+                store_quad24_sse2 (dst + x * bpp, pixels);
+            } else {
+                _mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x * bpp), pixels);
+            }
+        }
+
+        bilinear_pixels<bpp> (dst, upper, lower, frac_v, columns, x, width);
+    }
+
+    // AVX2 rows, 8 pixels at a time. Each 128-bit lane computes 4 of them, as the SSE2 rows do.
+
+    template <int bpp>
+    LV_ATTR_TARGET ("avx2")
+    inline __m256i load_pairs_avx2 (uint8_t const* pixels, uint32_t const* offsets)
+    {
+        return _mm256_inserti128_si256 (_mm256_castsi128_si256 (load_pairs_sse2<bpp> (pixels, offsets[0], offsets[1])),
+                                        load_pairs_sse2<bpp> (pixels, offsets[4], offsets[5]), 1);
+    }
+
+    template <int bpp>
+    LV_ATTR_TARGET ("avx2")
+    void bilinear_row_avx2 (uint8_t* dst, uint8_t const* upper, uint8_t const* lower, uint16_t frac_v,
+                            BilinearColumns const& columns, int width)
+    {
+        auto offsets = columns.offsets.data ();
+        auto weights = columns.weights.data ();
+
+        __m256i weight_u = _mm256_set1_epi16 (0x100 - frac_v);
+        __m256i weight_l = _mm256_set1_epi16 (frac_v);
+
+        int x = 0;
+
+        for (; x + 8 <= columns.vector_width; x += 8) {
+            auto o = offsets + x;
+
+            __m256i p01 = bilinear_pair_avx2 (load_pairs_avx2<bpp> (upper, o), load_pairs_avx2<bpp> (lower, o),
+                                              weight_u, weight_l,
+                                              load_weights_avx2 (weights, x), load_weights_avx2 (weights, x + 1));
+            __m256i p23 = bilinear_pair_avx2 (load_pairs_avx2<bpp> (upper, o + 2), load_pairs_avx2<bpp> (lower, o + 2),
+                                              weight_u, weight_l,
+                                              load_weights_avx2 (weights, x + 2), load_weights_avx2 (weights, x + 3));
+
+            __m256i pixels = _mm256_packus_epi16 (p01, p23);
+
+            if (bpp == 3) {
+                store_quad24_sse2 (dst + x * bpp,      _mm256_castsi256_si128 (pixels));
+                store_quad24_sse2 (dst + x * bpp + 12, _mm256_extracti128_si256 (pixels, 1));
+            } else {
+                _mm256_storeu_si256 (reinterpret_cast<__m256i*> (dst + x * bpp), pixels);
+            }
+        }
+
+        bilinear_pixels<bpp> (dst, upper, lower, frac_v, columns, x, width);
+    }
+
+#endif /* LV_HAVE_X86_SIMD */
+
+  } // anonymous namespace
+#endif
+
+  void VideoTransform::scale_bilinear_color24_sse2 (Video& dst, Video const& src, int row_begin, int row_end)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      scale_bilinear_rows (dst, src, row_begin, row_end, bilinear_row_sse2<3>);
+#else
+      scale_bilinear_color24 (dst, src, row_begin, row_end);
+#endif
+  }
 
-                   "#7\n\t paddw     %%mm3, %%mm0"
-                   "#7\n\t psrlw     $8,    %%mm0"
-
-                   /* Unpacking the resulting pixel */
-                   "\n\t packuswb  %%mm7, %%mm0"
-                   "\n\t movd    %%mm0, %[output]"
-
-                   : [output]  "=m"(*dst_pixel)
-                   : [pixel_u] "m"(src_pixel_rowu[u>>16])
-                     , [pixel_l] "m"(src_pixel_rowl[u>>16])
-                     , [fracu]   "m"(fracU)
-                     , [fracv]   "m"(fracV));
-
-              dst_pixel++;
-              u += du;
-          }
+  void VideoTransform::scale_bilinear_color24_avx2 (Video& dst, Video const& src, int row_begin, int row_end)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      scale_bilinear_rows (dst, src, row_begin, row_end, bilinear_row_avx2<3>);
+#else
+      scale_bilinear_color24 (dst, src, row_begin, row_end);
+#endif
+  }
 
-          dst_pixel_row += dst.m_impl->pitch;
-          v += dv;
-      }
+  void VideoTransform::scale_bilinear_color32_sse2 (Video& dst, Video const& src, int row_begin, int row_end)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      scale_bilinear_rows (dst, src, row_begin, row_end, bilinear_row_sse2<4>);
+#else
+      scale_bilinear_color32 (dst, src, row_begin, row_end);
+#endif
+  }
 
-      __asm__ __volatile__ ("\n\t emms");
-#endif /* !VISUAL_ARCH_X86 */
+  void VideoTransform::scale_bilinear_color32_avx2 (Video& dst, Video const& src, int row_begin, int row_end)
+  {
+#if defined(LV_HAVE_X86_SIMD)
+      scale_bilinear_rows (dst, src, row_begin, row_end, bilinear_row_avx2<4>);
+#else
+      scale_bilinear_color32 (dst, src, row_begin, row_end);
+#endif
   }
 
 } // LV namespace
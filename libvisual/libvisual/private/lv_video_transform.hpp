@@ -30,6 +30,8 @@ namespace LV {
   {
   public:
 
+      typedef void (*ScaleFunc) (Video& dst, Video const& src, int row_begin, int row_end);
+
       static void rotate_90  (Video& dst, Video const& src);
       static void rotate_180 (Video& dst, Video const& src);
       static void rotate_270 (Video& dst, Video const& src);
@@ -37,17 +39,38 @@ namespace LV {
       static void mirror_x (Video& dst, Video const& src);
       static void mirror_y (Video& dst, Video const& src);
 
-      static void scale_nearest_color8  (Video& dst, Video const& src);
-      static void scale_nearest_color16 (Video& dst, Video const& src);
-      static void scale_nearest_color24 (Video& dst, Video const& src);
-      static void scale_nearest_color32 (Video& dst, Video const& src);
+      // Scalers write destination rows [row_begin, row_end), so that a destination may be split into bands that are
+      // scaled independently. The output does not depend on how it is split.
+
+      /**
+       * Returns the fastest scaler for a depth and method supported by the processor, or nullptr if there is none.
+       */
+      static ScaleFunc get_scaler (VisVideoDepth depth, VisVideoScaleMethod method);
+
+      /**
+       * Scales from a source of another depth with a scaler of the destination depth. Source rows are converted a strip
+       * at a time just before they are read, so there is no intermediate of the full source size. The output is
+       * identical to converting the whole source first.
+       */
+      static void scale_depth (Video& dst, Video const& src, ScaleFunc scale, int row_begin, int row_end);
+
+      static void scale_nearest_color8  (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_nearest_color16 (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_nearest_color24 (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_nearest_color32 (Video& dst, Video const& src, int row_begin, int row_end);
+
+      static void scale_bilinear_color8  (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_bilinear_color16 (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_bilinear_color24 (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_bilinear_color32 (Video& dst, Video const& src, int row_begin, int row_end);
+
+      // SIMD bilinear scalers. Their output is identical to that of the portable versions.
 
-      static void scale_bilinear_color8  (Video& dst, Video const& src);
-      static void scale_bilinear_color16 (Video& dst, Video const& src);
-      static void scale_bilinear_color24 (Video& dst, Video const& src);
-      static void scale_bilinear_color32 (Video& dst, Video const& src);
+      static void scale_bilinear_color24_sse2 (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_bilinear_color24_avx2 (Video& dst, Video const& src, int row_begin, int row_end);
 
-      static void scale_bilinear_color32_mmx (Video& dst, Video const& src);
+      static void scale_bilinear_color32_sse2 (Video& dst, Video const& src, int row_begin, int row_end);
+      static void scale_bilinear_color32_avx2 (Video& dst, Video const& src, int row_begin, int row_end);
   };
 
 } // LV namespace
@@ -0,0 +1,257 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "config.h"
+#include "lv_worker_pool.hpp"
+#include "lv_common.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LV {
+
+  namespace {
+
+    // Upper bound on threads taking part in a job, including the caller
+    unsigned int const max_thread_count = 8;
+
+    // Thread count set with WorkerPool::set_thread_count(), or 0 for the default
+    std::atomic<unsigned int> thread_count_override {0};
+
+    class Pool
+    {
+    public:
+
+        Pool ()
+            : task (nullptr)
+            , task_count (0)
+            , next_task (0)
+            , tasks_left (0)
+            , active_workers (0)
+            , job_id (0)
+            , stopping (false)
+        {
+            // empty
+        }
+
+        ~Pool ()
+        {
+            stop ();
+        }
+
+        void run (unsigned int count, WorkerPool::Task const& task);
+
+        void stop ();
+
+    private:
+
+        // Serialises jobs
+        std::mutex job_mutex;
+
+        std::mutex              mutex;
+        std::condition_variable work_cond;
+        std::condition_variable done_cond;
+
+        std::vector<std::thread> workers;
+
+        // Current job, with task set to nullptr once complete
+        WorkerPool::Task const*   task;
+        unsigned int              task_count;
+        std::atomic<unsigned int> next_task;
+        unsigned int              tasks_left;
+        unsigned int              active_workers;
+        uint64_t                  job_id;
+
+        bool stopping;
+
+        void start ();
+
+        void work ();
+
+        unsigned int run_tasks (WorkerPool::Task const& task, unsigned int count);
+    };
+
+    Pool& get_pool ()
+    {
+        static Pool pool;
+        return pool;
+    }
+
+    void Pool::start ()
+    {
+        unsigned int thread_count = WorkerPool::get_thread_count ();
+
+        for (unsigned int i = 1; i < thread_count; i++) {
+            workers.emplace_back (&Pool::work, this);
+        }
+    }
+
+    void Pool::stop ()
+    {
+        std::lock_guard<std::mutex> job_lock (job_mutex);
+
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            stopping = true;
+        }
+
+        work_cond.notify_all ();
+
+        for (auto& worker : workers) {
+            worker.join ();
+        }
+
+        workers.clear ();
+        stopping = false;
+    }
+
+    unsigned int Pool::run_tasks (WorkerPool::Task const& task, unsigned int count)
+    {
+        unsigned int done = 0;
+
+        for (;;) {
+            auto index = next_task.fetch_add (1, std::memory_order_relaxed);
+
+            if (index >= count)
+                return done;
+
+            task (index);
+            done++;
+        }
+    }
+
+    void Pool::work ()
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+
+        uint64_t last_job_id = job_id;
+
+        for (;;) {
+            work_cond.wait (lock, [&] { return stopping || job_id != last_job_id; });
+
+            if (stopping)
+                return;
+
+            last_job_id = job_id;
+
+            // Skip jobs completed before this worker got to them
+            if (!task)
+                continue;
+
+            // Join the job. The caller does not return until active_workers drops back to zero, so task stays valid.
+            auto current_task = task;
+            auto count = task_count;
+
+            active_workers++;
+
+            lock.unlock ();
+            auto done = run_tasks (*current_task, count);
+            lock.lock ();
+
+            tasks_left -= done;
+            active_workers--;
+
+            if (tasks_left == 0 && active_workers == 0) {
+                done_cond.notify_one ();
+            }
+        }
+    }
+
+    void Pool::run (unsigned int count, WorkerPool::Task const& task_)
+    {
+        std::unique_lock<std::mutex> job_lock (job_mutex, std::try_to_lock);
+
+        // Already running a job, possibly from within one of its tasks
+        if (!job_lock.owns_lock ()) {
+            for (unsigned int i = 0; i < count; i++) {
+                task_ (i);
+            }
+            return;
+        }
+
+        if (workers.empty ()) {
+            start ();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+
+            task       = &task_;
+            task_count = count;
+            tasks_left = count;
+            next_task.store (0, std::memory_order_relaxed);
+            job_id++;
+        }
+
+        work_cond.notify_all ();
+
+        auto done = run_tasks (task_, count);
+
+        std::unique_lock<std::mutex> lock (mutex);
+
+        tasks_left -= done;
+
+        done_cond.wait (lock, [&] { return tasks_left == 0 && active_workers == 0; });
+
+        task = nullptr;
+    }
+
+  } // anonymous namespace
+
+  unsigned int WorkerPool::get_thread_count ()
+  {
+      static unsigned int const default_thread_count =
+          std::max (1u, std::min (max_thread_count, std::thread::hardware_concurrency ()));
+
+      auto thread_count = thread_count_override.load (std::memory_order_relaxed);
+
+      return thread_count ? thread_count : default_thread_count;
+  }
+
+  void WorkerPool::set_thread_count (unsigned int count)
+  {
+      thread_count_override.store (std::min (count, max_thread_count), std::memory_order_relaxed);
+
+      get_pool ().stop ();
+  }
+
+  void WorkerPool::run (unsigned int count, Task const& task)
+  {
+      if (count == 0)
+          return;
+
+      if (count == 1 || get_thread_count () == 1) {
+          for (unsigned int i = 0; i < count; i++) {
+              task (i);
+          }
+          return;
+      }
+
+      get_pool ().run (count, task);
+  }
+
+  void WorkerPool::shutdown ()
+  {
+      get_pool ().stop ();
+  }
+
+} // LV namespace
@@ -0,0 +1,71 @@
+/* Libvisual - The audio visualisation framework.
+ *
+ * Copyright (C) 2012 Libvisual team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _LV_WORKER_POOL_HPP
+#define _LV_WORKER_POOL_HPP
+
+#include "lvconfig.h"
+#include "lv_defines.h"
+
+#include <functional>
+
+namespace LV {
+
+  //! Process-wide pool of worker threads for splitting up data-parallel work, such as the rows of an image.
+  //!
+  //! Threads are started on first use, one fewer than the number of hardware threads, and joined by shutdown(). The
+  //! calling thread takes part in the work. One job runs at a time: callers that find the pool busy, including
+  //! workers themselves, run their tasks on their own.
+  //!
+  class WorkerPool
+  {
+  public:
+
+      typedef std::function<void (unsigned int)> Task;
+
+      /**
+       * Returns the number of threads that would take part in a job, including the caller.
+       */
+      static unsigned int get_thread_count ();
+
+      /**
+       * Sets the number of threads that take part in a job, including the caller. Running workers are stopped, and
+       * restarted at the new count on next use.
+       *
+       * @param count thread count, or 0 for one per hardware thread
+       */
+      static void set_thread_count (unsigned int count);
+
+      /**
+       * Runs a task for each index in [0, count), returning when all are done.
+       *
+       * @param count number of tasks
+       * @param task  task, called with the task index
+       */
+      static void run (unsigned int count, Task const& task);
+
+      /**
+       * Stops and joins all worker threads. They are restarted if the pool is used again.
+       */
+      static void shutdown ();
+  };
+
+} // LV namespace
+
+#endif // _LV_WORKER_POOL_HPP
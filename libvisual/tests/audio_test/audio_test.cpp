@@ -4,9 +4,81 @@
 #include <cstring>
 #include <cstdint>
 #include <limits>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 const unsigned int sample_count = 256;
 
+// Counts calls to the global operator new, to check that steady state spectrum requests do not allocate
+std::atomic<unsigned long> allocation_count {0};
+
+void* operator new (std::size_t size)
+{
+    allocation_count.fetch_add (1, std::memory_order_relaxed);
+
+    if (auto ptr = std::malloc (size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc ();
+}
+
+void operator delete (void* ptr) noexcept
+{
+    std::free (ptr);
+}
+
+namespace {
+
+  void set_simd_enabled (bool enabled)
+  {
+      visual_cpu_set_sse2 (enabled);
+      visual_cpu_set_avx2 (enabled);
+      visual_cpu_set_neon (enabled);
+  }
+
+  LV::BufferPtr make_random_samples (VisAudioSampleFormatType format, std::size_t count)
+  {
+      auto sample_size = visual_audio_sample_format_get_size (format);
+
+      auto buffer = LV::Buffer::create (count * sample_size);
+      auto bytes  = static_cast<uint8_t*> (buffer->get_data ());
+
+      if (format == VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT) {
+          auto samples = static_cast<float*> (buffer->get_data ());
+
+          for (std::size_t i = 0; i < count; i++) {
+              samples[i] = (LV::rand () & 0xffff) / 32768.0f - 1.0f;
+          }
+      } else {
+          for (std::size_t i = 0; i < count * sample_size; i++) {
+              bytes[i] = LV::rand () & 0xff;
+          }
+      }
+
+      return buffer;
+  }
+
+  // Uploads stereo input to a new Audio and returns the left and right channel samples, one after the other
+  std::vector<float> deinterleave_stereo (LV::BufferPtr const& input, VisAudioSampleFormatType format, std::size_t frame_count)
+  {
+      LV::Audio audio;
+      audio.input (input, VISUAL_AUDIO_SAMPLE_RATE_44100, format, VISUAL_AUDIO_SAMPLE_CHANNEL_STEREO);
+
+      std::vector<float> samples (frame_count * 2);
+
+      audio.get_sample (LV::Buffer::wrap (samples.data (), frame_count * sizeof (float), false), VISUAL_AUDIO_CHANNEL_LEFT);
+      audio.get_sample (LV::Buffer::wrap (samples.data () + frame_count, frame_count * sizeof (float), false), VISUAL_AUDIO_CHANNEL_RIGHT);
+
+      return samples;
+  }
+
+} // anonymous namespace
+
 int main (int argc, char** argv)
 {
     LV::System::init (argc, argv);
@@ -49,6 +121,410 @@ int main (int argc, char** argv)
         LV_TEST_ASSERT (output_data[i] == float (i*2+0.5) / int_max);
     }
 
+    // Check that SIMD deinterleaving matches the portable converters on lengths that leave a remainder, and that
+    // mono input converts to the same samples as the left channel
+
+    VisAudioSampleFormatType const deinterleave_formats[] = {
+        VISUAL_AUDIO_SAMPLE_FORMAT_U8,
+        VISUAL_AUDIO_SAMPLE_FORMAT_S16,
+        VISUAL_AUDIO_SAMPLE_FORMAT_S32,
+        VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT
+    };
+
+    std::size_t const deinterleave_lengths[] = { 1, 3, 13, 1001 };
+
+    for (auto format : deinterleave_formats) {
+        for (auto frame_count : deinterleave_lengths) {
+            auto input = make_random_samples (format, frame_count * 2);
+
+            set_simd_enabled (false);
+            auto expected = deinterleave_stereo (input, format, frame_count);
+
+            for (auto use_avx2 : { false, true }) {
+                set_simd_enabled (true);
+                visual_cpu_set_avx2 (use_avx2);
+
+                LV_TEST_ASSERT (deinterleave_stereo (input, format, frame_count) == expected);
+            }
+
+            auto sample_size = visual_audio_sample_format_get_size (format);
+            auto left_input  = LV::Buffer::create (frame_count * sample_size);
+
+            for (std::size_t i = 0; i < frame_count; i++) {
+                std::memcpy (static_cast<uint8_t*> (left_input->get_data ()) + i * sample_size,
+                             static_cast<uint8_t const*> (input->get_data ()) + i * 2 * sample_size,
+                             sample_size);
+            }
+
+            LV::Audio mono_audio;
+            mono_audio.input (left_input, VISUAL_AUDIO_SAMPLE_RATE_44100, format, "mono");
+
+            std::vector<float> mono (frame_count);
+            mono_audio.get_sample (LV::Buffer::wrap (mono.data (), frame_count * sizeof (float), false), "mono");
+
+            LV_TEST_ASSERT (std::equal (mono.begin (), mono.end (), expected.begin ()));
+        }
+    }
+
+    // Check that mixing by channel handle matches mixing by channel name
+
+    LV_TEST_ASSERT (LV::Audio::get_channel_id (VISUAL_AUDIO_CHANNEL_LEFT)  == VISUAL_AUDIO_CHANNEL_ID_LEFT);
+    LV_TEST_ASSERT (LV::Audio::get_channel_id (VISUAL_AUDIO_CHANNEL_RIGHT) == VISUAL_AUDIO_CHANNEL_ID_RIGHT);
+
+    VisAudioChannelId const channel_ids[] = { VISUAL_AUDIO_CHANNEL_ID_LEFT, VISUAL_AUDIO_CHANNEL_ID_RIGHT };
+    float const channel_gains[] = { 1.0f, -2.0f };
+
+    audio.get_sample_mixed (output_buffer, channel_ids, nullptr, 2, true);
+    for (unsigned int i = 0; i < sample_count; i++) {
+        LV_TEST_ASSERT (output_data[i] == float (i*2+0.5) / int_max);
+    }
+
+    audio.get_sample_mixed (output_buffer, channel_ids, channel_gains, 2, false);
+    for (unsigned int i = 0; i < sample_count; i++) {
+        LV_TEST_ASSERT (output_data[i] == -float (i*2+2) / int_max);
+    }
+
+    // Check that spectra are reused within an input generation, and recomputed after the next input
+
+    const unsigned int spectrum_size = 128;
+
+    auto spectrum1 = LV::Buffer::create (spectrum_size * sizeof (float));
+    auto spectrum2 = LV::Buffer::create (spectrum_size * sizeof (float));
+
+    audio.get_spectrum (spectrum1, sample_count * sizeof (float), VISUAL_AUDIO_CHANNEL_LEFT, true);
+    audio.get_spectrum (spectrum2, sample_count * sizeof (float), VISUAL_AUDIO_CHANNEL_LEFT, true);
+    LV_TEST_ASSERT (std::memcmp (spectrum1->get_data (), spectrum2->get_data (), spectrum_size * sizeof (float)) == 0);
+
+    auto silence = LV::Buffer::create (sample_count * 2 * sizeof (int16_t));
+    silence->fill (0);
+    audio.input (silence, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_S16, VISUAL_AUDIO_SAMPLE_CHANNEL_STEREO);
+
+    audio.get_spectrum (spectrum2, sample_count * sizeof (float), VISUAL_AUDIO_CHANNEL_LEFT, true);
+    for (unsigned int i = 0; i < spectrum_size; i++) {
+        LV_TEST_ASSERT (static_cast<float*> (spectrum2->get_data ())[i] == 0.0f);
+    }
+
+    // Check that spectra requested from several threads at once match those computed on one
+
+    audio.input (input_buffer, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_S16, VISUAL_AUDIO_SAMPLE_CHANNEL_STEREO);
+    audio.get_spectrum (spectrum1, sample_count * sizeof (float), VISUAL_AUDIO_CHANNEL_LEFT, true);
+
+    audio.input (input_buffer, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_S16, VISUAL_AUDIO_SAMPLE_CHANNEL_STEREO);
+
+    const unsigned int spectrum_thread_count = 4;
+
+    std::vector<LV::BufferPtr> thread_spectra;
+    std::vector<std::thread>   spectrum_threads;
+
+    for (unsigned int i = 0; i < spectrum_thread_count; i++) {
+        thread_spectra.push_back (LV::Buffer::create (spectrum_size * sizeof (float)));
+    }
+
+    for (unsigned int i = 0; i < spectrum_thread_count; i++) {
+        spectrum_threads.emplace_back ([&, i] {
+            for (unsigned int j = 0; j < 100; j++) {
+                audio.get_spectrum (thread_spectra[i], sample_count * sizeof (float), VISUAL_AUDIO_CHANNEL_LEFT, true);
+            }
+        });
+    }
+
+    for (auto& thread : spectrum_threads) {
+        thread.join ();
+    }
+
+    for (auto const& spectrum : thread_spectra) {
+        LV_TEST_ASSERT (std::memcmp (spectrum1->get_data (), spectrum->get_data (), spectrum_size * sizeof (float)) == 0);
+    }
+
+    // Check that channels can be created while another thread mixes them
+
+    const unsigned int created_channel_count = 64;
+
+    std::vector<VisAudioChannelId> created_channel_ids;
+
+    for (unsigned int i = 0; i < created_channel_count; i++) {
+        created_channel_ids.push_back (LV::Audio::get_channel_id ("created" + std::to_string (i)));
+    }
+
+    auto created_input = LV::Buffer::create (sample_count * sizeof (float));
+    created_input->fill (0);
+
+    std::atomic<bool>         creating {true};
+    std::atomic<unsigned int> mix_count {0};
+
+    std::thread mix_thread ([&] {
+        auto mixed = LV::Buffer::create (sample_count * sizeof (float));
+
+        while (creating.load ()) {
+            audio.get_sample_mixed (mixed, created_channel_ids.data (), nullptr, created_channel_count, true);
+            mix_count++;
+        }
+    });
+
+    for (unsigned int i = 0; i < created_channel_count; i++) {
+        audio.input (created_input, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT,
+                     "created" + std::to_string (i));
+
+        // Wait for the mixing thread to see the new channel, even on a single processor
+        for (auto count = mix_count.load (); mix_count.load () == count; ) {
+            std::this_thread::yield ();
+        }
+    }
+
+    creating.store (false);
+    mix_thread.join ();
+
+    // Check that spectra are computed without allocating once their workspaces are set up
+
+    std::string const spectrum_channel {VISUAL_AUDIO_CHANNEL_LEFT};
+
+    auto spectrum_samples = LV::Buffer::create (sample_count * sizeof (float));
+    spectrum_samples->fill (0);
+
+    LV::DFT spectrum_dft {spectrum_size, sample_count};
+
+    for (unsigned int i = 0; i < 4; i++) {
+        audio.input (input_buffer, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_S16, VISUAL_AUDIO_SAMPLE_CHANNEL_STEREO);
+
+        auto allocations_before = allocation_count.load ();
+
+        audio.get_spectrum (spectrum1, sample_count * sizeof (float), spectrum_channel, true);
+        LV::Audio::get_spectrum_for_sample (spectrum2, spectrum_samples, true);
+        spectrum_dft.perform (static_cast<float*> (spectrum1->get_data ()),
+                              static_cast<float const*> (spectrum_samples->get_data ()));
+
+        // The first round sets up the workspaces
+        if (i == 0) {
+            LV_TEST_ASSERT (allocation_count.load () > allocations_before);
+        } else {
+            LV_TEST_ASSERT (allocation_count.load () == allocations_before);
+        }
+    }
+
+    // Check that the most recent samples are returned after the stream wraps around
+
+    const unsigned int block_count = 64;
+    const unsigned int block_size  = 4096;
+
+    auto block_buffer = LV::Buffer::create (block_size * sizeof (float));
+    auto block_data = static_cast<float*> (block_buffer->get_data ());
+
+    for (unsigned int i = 0; i < block_count; i++) {
+        for (unsigned int j = 0; j < block_size; j++) {
+            block_data[j] = float (i * block_size + j);
+        }
+
+        audio.input (block_buffer, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT, "mono");
+    }
+
+    audio.get_sample (output_buffer, "mono");
+    for (unsigned int i = 0; i < sample_count; i++) {
+        LV_TEST_ASSERT (output_data[i] == float (block_count * block_size - sample_count + i));
+    }
+
+    // Check that samples are retrieved by capture time
+
+    for (unsigned int j = 0; j < block_size; j++) {
+        block_data[j] = float (j);
+    }
+
+    auto input_start_time = LV::Time::now ();
+    audio.input (block_buffer, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT, "timed");
+    auto input_end_time = LV::Time::now ();
+
+    const unsigned int window_offset = 1000;
+
+    audio.get_sample (output_buffer, "timed", input_end_time - LV::Time::from_secs (window_offset / 44100.0));
+
+    // The input is timestamped somewhere between input_start_time and input_end_time
+    auto window_end = output_data[sample_count - 1] + 1;
+    auto window_end_max = block_size - window_offset + (input_end_time - input_start_time).to_secs () * 44100.0 + 1;
+    LV_TEST_ASSERT (window_end >= block_size - window_offset && window_end <= window_end_max);
+
+    for (unsigned int i = 0; i < sample_count; i++) {
+        LV_TEST_ASSERT (output_data[i] == window_end - sample_count + i);
+    }
+
+    // Check that samples are retrieved by capture time after the stream has recorded more blocks than it keeps track
+    // of, up to the oldest block still tracked
+
+    const unsigned int small_block_count = 1500;
+    const unsigned int small_block_size  = 16;
+
+    // Blocks tracked by a stream, less the one the producer overwrites next
+    const unsigned int tracked_block_count = 1023;
+
+    auto small_block_buffer = LV::Buffer::create (small_block_size * sizeof (float));
+    auto small_block_data = static_cast<float*> (small_block_buffer->get_data ());
+
+    std::vector<LV::Time> small_block_input_times;
+
+    for (unsigned int i = 0; i < small_block_count; i++) {
+        for (unsigned int j = 0; j < small_block_size; j++) {
+            small_block_data[j] = float (i * small_block_size + j);
+        }
+
+        audio.input (small_block_buffer, VISUAL_AUDIO_SAMPLE_RATE_44100, VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT, "blocks");
+        small_block_input_times.push_back (LV::Time::now ());
+    }
+
+    auto window_buffer = LV::Buffer::create (small_block_size * sizeof (float));
+    auto window_data = static_cast<float*> (window_buffer->get_data ());
+
+    for (unsigned int i = small_block_count - tracked_block_count; i < small_block_count - 1; i += 7) {
+        LV_TEST_ASSERT (audio.get_sample (window_buffer, "blocks", small_block_input_times[i]));
+
+        // Block i was timestamped before its input returned, and block i + 1 after. Block i + 1 may end up to the
+        // time between the two inputs returning after the requested time.
+        auto input_gap = (small_block_input_times[i + 1] - small_block_input_times[i]).to_secs () * 44100;
+
+        auto block_window_end = window_data[small_block_size - 1] + 1;
+        LV_TEST_ASSERT (block_window_end >= std::min<double> ((i + 1) * small_block_size, (i + 2) * small_block_size - input_gap - 1));
+        LV_TEST_ASSERT (block_window_end <= (i + 2) * small_block_size);
+
+        for (unsigned int j = 0; j < small_block_size; j++) {
+            LV_TEST_ASSERT (window_data[j] == block_window_end - small_block_size + j);
+        }
+    }
+
+    // Check that the most recent samples are retrieved for times in the future
+
+    audio.get_sample (output_buffer, "timed", LV::Time (input_end_time.sec + 1, input_end_time.nsec));
+    for (unsigned int i = 0; i < sample_count; i++) {
+        LV_TEST_ASSERT (output_data[i] == float (block_size - sample_count + i));
+    }
+
+    // Check that input is resampled to the stream's sampling rate. A 1kHz tone at 48kHz should come out with a
+    // period of 44.1 samples, i.e. repeat every 441 samples.
+
+    const unsigned int tone_size = 4800;
+
+    auto tone_buffer = LV::Buffer::create (tone_size * sizeof (float));
+    auto tone_data = static_cast<float*> (tone_buffer->get_data ());
+
+    for (unsigned int i = 0; i < tone_size; i++) {
+        tone_data[i] = std::sin (2 * 3.14159265358979 * 1000 * i / 48000);
+    }
+
+    audio.input (tone_buffer, VISUAL_AUDIO_SAMPLE_RATE_48000, VISUAL_AUDIO_SAMPLE_FORMAT_FLOAT, "tone");
+
+    const unsigned int tone_period = 441;
+
+    auto resampled_buffer = LV::Buffer::create (tone_period * 4 * sizeof (float));
+    auto resampled_data = static_cast<float*> (resampled_buffer->get_data ());
+
+    audio.get_sample (resampled_buffer, "tone");
+
+    float peak = 0.0f;
+    for (unsigned int i = 0; i < tone_period * 3; i++) {
+        LV_TEST_ASSERT (std::abs (resampled_data[i] - resampled_data[i + tone_period]) < 1e-4f);
+        peak = std::max (peak, std::abs (resampled_data[i]));
+    }
+
+    LV_TEST_ASSERT (peak > 0.99f && peak < 1.01f);
+
+    // Check that onsets and tempo are detected in a click track at 120 BPM
+
+    const unsigned int click_rate     = 44100;
+    const unsigned int click_interval = click_rate / 2;
+    const unsigned int click_count    = 16;
+    const unsigned int click_block    = 1024;
+
+    std::vector<float> clicks (click_interval * click_count, 0.0f);
+
+    // Clicks fall midway through each interval, as there is no onset without prior silence
+    for (unsigned int i = 0; i < click_count; i++) {
+        for (unsigned int j = 0; j < 64; j++) {
+            clicks[i * click_interval + click_interval / 2 + j] = std::sin (2 * 3.14159265358979 * 2000 * j / click_rate) * (1.0f - j / 64.0f);
+        }
+    }
+
+    LV::AudioAnalysis analysis {click_rate};
+
+    unsigned int onset_count = 0;
+
+    for (unsigned int i = 0; i < clicks.size (); i += click_block) {
+        analysis.process (&clicks[i], std::min<std::size_t> (click_block, clicks.size () - i));
+
+        if (analysis.is_onset ())
+            onset_count++;
+    }
+
+    LV_TEST_ASSERT (onset_count == click_count);
+    LV_TEST_ASSERT (std::abs (analysis.get_tempo () - 120.0f) < 2.0f);
+    LV_TEST_ASSERT (analysis.get_tempo_confidence () > 0.5f);
+
+    // Check that STFT spectra match DFTs over the same windows, however the input is split up
+
+    const unsigned int stft_window  = 512;
+    const unsigned int stft_hop     = 128;
+    const unsigned int stft_history = 6;
+    const unsigned int stft_size    = stft_window / 2 + 1;
+
+    LV::STFT stft {stft_size, stft_window, stft_hop, VISUAL_DFT_WINDOW_HANN, stft_history};
+    LV::DFT  stft_dft {stft_size, stft_window, VISUAL_DFT_WINDOW_HANN};
+
+    // A rising tone, so that every window has a different spectrum
+    std::vector<float> stft_input (10000);
+
+    for (unsigned int i = 0; i < stft_input.size (); i++) {
+        stft_input[i] = std::sin (2 * 3.14159265358979 * 1000 * i / 44100) * i / stft_input.size ();
+    }
+
+    unsigned int stft_count = 0;
+
+    for (std::size_t i = 0, chunk = 1; i < stft_input.size (); i += chunk, chunk = chunk * 3 % 1000 + 1) {
+        stft_count += stft.process (&stft_input[i], std::min (chunk, stft_input.size () - i));
+    }
+
+    LV_TEST_ASSERT (stft_count == (stft_input.size () - stft_window) / stft_hop + 1);
+    LV_TEST_ASSERT (stft.get_spectrum_count () == stft_count);
+
+    std::vector<float> spectrogram (stft_history * stft_size);
+    std::vector<float> expected_spectrum (stft_size);
+
+    LV_TEST_ASSERT (stft.get_spectrogram (spectrogram.data (), stft_history) == stft_history);
+
+    for (unsigned int i = 0; i < stft_history; i++) {
+        stft_dft.perform (expected_spectrum.data (), &stft_input[(stft_count - stft_history + i) * stft_hop]);
+
+        for (unsigned int j = 0; j < stft_size; j++) {
+            LV_TEST_ASSERT (std::abs (spectrogram[i * stft_size + j] - expected_spectrum[j]) < 1e-6f);
+        }
+    }
+
+    // Check band reduction over linear and logarithmic scales
+
+    const unsigned int ramp_size = 100;
+
+    std::vector<float> ramp (ramp_size);
+    for (unsigned int i = 0; i < ramp_size; i++) {
+        ramp[i] = i;
+    }
+
+    float linear_bands[4];
+
+    LV::DFT::reduce_bands (linear_bands, 4, ramp.data (), ramp_size, VISUAL_DFT_BAND_SCALE_LINEAR, VISUAL_DFT_BAND_REDUCTION_MEAN);
+    for (unsigned int i = 0; i < 4; i++) {
+        LV_TEST_ASSERT (linear_bands[i] == i * 25 + 12);
+    }
+
+    LV::DFT::reduce_bands (linear_bands, 4, ramp.data (), ramp_size, VISUAL_DFT_BAND_SCALE_LINEAR, VISUAL_DFT_BAND_REDUCTION_MAX);
+    for (unsigned int i = 0; i < 4; i++) {
+        LV_TEST_ASSERT (linear_bands[i] == i * 25 + 24);
+    }
+
+    // Log bands exclude DC, end at the last bin, and never decrease on a rising spectrum
+    float log_bands[32];
+
+    LV::DFT::reduce_bands (log_bands, 32, ramp.data (), ramp_size, VISUAL_DFT_BAND_SCALE_LOG, VISUAL_DFT_BAND_REDUCTION_MAX);
+
+    LV_TEST_ASSERT (log_bands[0] == 1);
+    LV_TEST_ASSERT (log_bands[31] == ramp_size - 1);
+    for (unsigned int i = 1; i < 32; i++) {
+        LV_TEST_ASSERT (log_bands[i] >= log_bands[i - 1]);
+    }
+
     LV::System::destroy ();
 
     return EXIT_SUCCESS;
@@ -0,0 +1,276 @@
+#include "test.h"
+#include <libvisual/libvisual.h>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+  // Code paths of the FFT kernels. "c" is the portable code.
+  char const* const simd_paths[] = { "c", "sse", "avx2" };
+
+  // Restricts the FFT kernels to a code path. Returns false if the processor does not support it.
+  bool select_simd_path (std::string const& path)
+  {
+      visual_cpu_set_sse (FALSE);
+      visual_cpu_set_avx2 (FALSE);
+
+      if (path == "sse") {
+          return visual_cpu_set_sse (TRUE);
+      }
+
+      if (path == "avx2") {
+          return visual_cpu_set_sse (TRUE) && visual_cpu_set_avx2 (TRUE);
+      }
+
+      return true;
+  }
+
+  std::vector<float> make_random_samples (unsigned int count)
+  {
+      std::vector<float> samples (count);
+
+      for (auto& sample : samples) {
+          sample = (LV::rand () & 0xffff) / 32768.0f - 1.0f;
+      }
+
+      return samples;
+  }
+
+  // Computes the first spectrum_size bins of the amplitude spectrum as DFT::perform() does, by definition and in
+  // double precision
+  std::vector<double> reference_spectrum (float const* input, unsigned int sample_count, unsigned int spectrum_size)
+  {
+      std::vector<double> cos_table (sample_count);
+      std::vector<double> sin_table (sample_count);
+
+      for (unsigned int i = 0; i < sample_count; i++) {
+          cos_table[i] = std::cos (2.0 * M_PI * i / sample_count);
+          sin_table[i] = std::sin (2.0 * M_PI * i / sample_count);
+      }
+
+      std::vector<double> spectrum (spectrum_size);
+
+      for (unsigned int k = 0; k < spectrum_size; k++) {
+          double xr = 0.0;
+          double xi = 0.0;
+
+          for (unsigned int n = 0; n < sample_count; n++) {
+              auto index = std::size_t (k) * n % sample_count;
+
+              xr += input[n] * cos_table[index];
+              xi -= input[n] * sin_table[index];
+          }
+
+          spectrum[k] = std::sqrt (xr * xr + xi * xi) / sample_count;
+      }
+
+      return spectrum;
+  }
+
+  // Returns the largest error in a spectrum, relative to the largest expected bin. The expected spectrum may extend
+  // past the computed one, so that few computed bins are not measured against a tiny peak.
+  double spectrum_error (std::vector<float> const& spectrum, std::vector<double> const& expected)
+  {
+      double peak  = 0.0;
+      double error = 0.0;
+
+      for (auto bin : expected) {
+          peak = std::max (peak, bin);
+      }
+
+      for (std::size_t i = 0; i < spectrum.size (); i++) {
+          error = std::max (error, std::abs (spectrum[i] - expected[i]));
+      }
+
+      return error / peak;
+  }
+
+  // Checks that a DFT of samples_out bins matches the definition on every code path, to within a maximum error
+  // relative to the peak bin of the whole spectrum
+  bool dft_matches_reference (unsigned int sample_count, unsigned int samples_out, double max_error)
+  {
+      auto input    = make_random_samples (sample_count);
+      auto expected = reference_spectrum (input.data (), sample_count, std::max (samples_out, sample_count / 2 + 1));
+
+      for (auto path : simd_paths) {
+          if (!select_simd_path (path)) {
+              continue;
+          }
+
+          LV::DFT dft {samples_out, sample_count};
+
+          std::vector<float> spectrum (samples_out);
+          dft.perform (spectrum.data (), input.data ());
+
+          if (spectrum_error (spectrum, expected) >= max_error) {
+              return false;
+          }
+      }
+
+      return true;
+  }
+
+  // Coefficients of a periodic generalized cosine window, scaled to unit mean, as documented for VisDFTWindow
+  std::vector<float> make_cosine_window (unsigned int size, double a0, double a1, double a2)
+  {
+      std::vector<float> window (size);
+
+      for (unsigned int n = 0; n < size; n++) {
+          double theta = 2.0 * M_PI * n / size;
+          window[n] = (a0 - a1 * std::cos (theta) + a2 * std::cos (2.0 * theta)) / a0;
+      }
+
+      return window;
+  }
+
+} // anonymous namespace
+
+int main (int argc, char** argv)
+{
+    LV::System::init (argc, argv);
+
+    // Check that power-of-2 DFTs match the definition on every code path. Sizes cover the plain radix-4 passes, a
+    // leading radix-2 pass, and complex FFTs too small to fill a vector.
+
+    unsigned int const pow2_sizes[] = { 2, 4, 8, 16, 32, 128, 512, 2048, 4096 };
+
+    for (auto sample_count : pow2_sizes) {
+        LV_TEST_ASSERT (dft_matches_reference (sample_count, sample_count / 2 + 1, 2e-6));
+    }
+
+    // Check that DFTs of sizes with no prime factors other than 2, 3 and 5 match the definition. Even sizes pack
+    // samples in pairs, odd sizes take them as is.
+
+    unsigned int const mixed_radix_sizes[] = { 6, 12, 60, 480, 15, 45, 375 };
+
+    for (auto sample_count : mixed_radix_sizes) {
+        LV_TEST_ASSERT (dft_matches_reference (sample_count, sample_count / 2 + 1, 2e-6));
+    }
+
+    // Check that DFTs of other sizes match the definition. 14 and 194 pack samples into Bluestein FFTs of 7 and 97
+    // points.
+
+    unsigned int const bluestein_sizes[] = { 7, 97, 1021, 14, 194 };
+
+    for (auto sample_count : bluestein_sizes) {
+        LV_TEST_ASSERT (dft_matches_reference (sample_count, sample_count / 2 + 1, 2e-6));
+    }
+
+    // Check that spectra smaller than sample_count / 2 + 1 bins hold the first bins
+
+    unsigned int const truncated_sizes[][2] = {
+        { 1024, 100 },
+        {  480,  33 },
+        {  375,  64 },
+        { 1021, 200 },
+        {   14,   1 }
+    };
+
+    for (auto const& size : truncated_sizes) {
+        LV_TEST_ASSERT (dft_matches_reference (size[0], size[1], 2e-6));
+    }
+
+    // Check that batches give the same spectra as DFTs performed one at a time, for each FFT method
+
+    unsigned int const batch_sizes[] = { 1024, 480, 375, 1021 };
+
+    unsigned int const batch_count = 3;
+
+    for (auto sample_count : batch_sizes) {
+        auto spectrum_size = sample_count / 2 + 1;
+
+        std::vector<std::vector<float>> inputs;
+
+        for (unsigned int i = 0; i < batch_count; i++) {
+            inputs.push_back (make_random_samples (sample_count));
+        }
+
+        for (auto path : simd_paths) {
+            if (!select_simd_path (path)) {
+                continue;
+            }
+
+            LV::DFT dft {spectrum_size, sample_count};
+
+            std::vector<std::vector<float>> expected (batch_count, std::vector<float> (spectrum_size));
+
+            for (unsigned int i = 0; i < batch_count; i++) {
+                dft.perform (expected[i].data (), inputs[i].data ());
+            }
+
+            std::vector<std::vector<float>> spectra (batch_count, std::vector<float> (spectrum_size));
+
+            float*       outputs[batch_count];
+            float const* batch_inputs[batch_count];
+
+            for (unsigned int i = 0; i < batch_count; i++) {
+                outputs[i]      = spectra[i].data ();
+                batch_inputs[i] = inputs[i].data ();
+            }
+
+            dft.perform_batch (outputs, batch_inputs, batch_count);
+
+            LV_TEST_ASSERT (spectra == expected);
+        }
+    }
+
+    // Check that windowed DFTs match rectangular DFTs of windowed input, for sizes whose samples are and are not
+    // packed in pairs
+
+    struct WindowParams
+    {
+        VisDFTWindow window;
+        double       a0, a1, a2;
+    };
+
+    WindowParams const windows[] = {
+        { VISUAL_DFT_WINDOW_HANN,     0.5,  0.5,  0.0  },
+        { VISUAL_DFT_WINDOW_HAMMING,  0.54, 0.46, 0.0  },
+        { VISUAL_DFT_WINDOW_BLACKMAN, 0.42, 0.5,  0.08 }
+    };
+
+    unsigned int const window_sizes[] = { 1024, 480, 14, 375, 1021 };
+
+    for (auto sample_count : window_sizes) {
+        auto spectrum_size = sample_count / 2 + 1;
+        auto input         = make_random_samples (sample_count);
+
+        for (auto const& params : windows) {
+            auto coeffs = make_cosine_window (sample_count, params.a0, params.a1, params.a2);
+
+            std::vector<float> windowed_input (sample_count);
+
+            for (unsigned int i = 0; i < sample_count; i++) {
+                windowed_input[i] = input[i] * coeffs[i];
+            }
+
+            for (auto path : simd_paths) {
+                if (!select_simd_path (path)) {
+                    continue;
+                }
+
+                LV::DFT rectangular_dft {spectrum_size, sample_count};
+
+                std::vector<float> expected (spectrum_size);
+                rectangular_dft.perform (expected.data (), windowed_input.data ());
+
+                LV::DFT windowed_dft {spectrum_size, sample_count, params.window};
+
+                std::vector<float> spectrum (spectrum_size);
+                windowed_dft.perform (spectrum.data (), input.data ());
+
+                LV_TEST_ASSERT (spectrum_error (spectrum, std::vector<double> (expected.begin (), expected.end ())) < 1e-6);
+            }
+        }
+    }
+
+    select_simd_path ("c");
+    visual_cpu_set_sse (TRUE);
+    visual_cpu_set_avx2 (TRUE);
+
+    LV::System::destroy ();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+#include "test.h"
+#include <libvisual/libvisual.h>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+  // Code paths of the vectorized math functions. "c" is the portable code.
+  char const* const simd_paths[] = { "c", "sse2", "avx2" };
+
+  // Restricts vectorized math functions to a code path. Returns false if the processor does not support it.
+  bool select_simd_path (std::string const& path)
+  {
+      visual_cpu_set_sse2 (FALSE);
+      visual_cpu_set_avx2 (FALSE);
+
+      if (path == "sse2") {
+          return visual_cpu_set_sse2 (TRUE);
+      }
+
+      if (path == "avx2") {
+          return visual_cpu_set_sse2 (TRUE) && visual_cpu_set_avx2 (TRUE);
+      }
+
+      return true;
+  }
+
+  // As std::clamp() in C++17
+  float clamp (float x, float min, float max)
+  {
+      return x < min ? min : (max < x ? max : x);
+  }
+
+  // Checks a logarithm approximation against its documented error bounds
+  bool log_within_bounds (float approx, float x)
+  {
+      double exact = std::log (double (x));
+      double error = std::abs (approx - exact);
+
+      if (x >= 1e-3f && x <= 1e3f) {
+          return error < 2e-6;
+      }
+
+      return error < 1e-6 * std::abs (exact);
+  }
+
+  // Positive normal floats from the smallest to the largest, spaced evenly on a log scale, with 1.0 and the bounds
+  // of the absolute error range
+  std::vector<float> make_log_inputs ()
+  {
+      std::vector<float> inputs;
+
+      float const min = std::numeric_limits<float>::min ();
+      float const max = std::numeric_limits<float>::max ();
+
+      for (double x = min; x < max; x *= 1.0173) {
+          inputs.push_back (float (x));
+      }
+
+      inputs.push_back (max);
+
+      inputs.push_back (1.0f);
+      inputs.push_back (std::nextafter (1.0f, 0.0f));
+      inputs.push_back (std::nextafter (1.0f, 2.0f));
+      inputs.push_back (1e-3f);
+      inputs.push_back (1e3f);
+
+      return inputs;
+  }
+
+} // anonymous namespace
+
+int main (int argc, char** argv)
+{
+    LV::System::init (argc, argv);
+
+    // Check that logarithms are within their error bounds on every code path, on lengths that leave a remainder
+
+    auto log_inputs = make_log_inputs ();
+
+    for (auto path : simd_paths) {
+        if (!select_simd_path (path)) {
+            continue;
+        }
+
+        std::vector<float> logs (log_inputs.size ());
+        visual_math_simd_log_floats (logs.data (), log_inputs.data (), log_inputs.size ());
+
+        for (std::size_t i = 0; i < log_inputs.size (); i++) {
+            LV_TEST_ASSERT (log_within_bounds (logs[i], log_inputs[i]));
+        }
+
+        for (std::size_t count = 1; count < 40; count++) {
+            auto src = log_inputs.data () + log_inputs.size () / 2;
+
+            std::vector<float> partial_logs (count + 1, -1.0f);
+            visual_math_simd_log_floats (partial_logs.data (), src, count);
+
+            for (std::size_t i = 0; i < count; i++) {
+                LV_TEST_ASSERT (log_within_bounds (partial_logs[i], src[i]));
+            }
+
+            LV_TEST_ASSERT (partial_logs[count] == -1.0f);
+        }
+    }
+
+    // Check log scaling on every code path. Values at or below the threshold, including zero, denormals and
+    // negative values, map to 0.
+
+    float const threshold = 0.001f;
+    float const k         = 1.0f / 6.908f;
+
+    std::vector<float> scale_inputs = {
+        threshold,
+        std::nextafter (threshold, 1.0f),
+        std::nextafter (threshold, 0.0f),
+        1.0f,
+        0.5f,
+        0.0f,
+        -0.0f,
+        -1.0f,
+        std::numeric_limits<float>::denorm_min (),
+        std::numeric_limits<float>::min () / 2,
+        std::numeric_limits<float>::min ()
+    };
+
+    for (float x = 0.0001f; x < 2.0f; x *= 1.01f) {
+        scale_inputs.push_back (x);
+    }
+
+    for (auto path : simd_paths) {
+        if (!select_simd_path (path)) {
+            continue;
+        }
+
+        for (std::size_t count = 1; count <= scale_inputs.size (); count += (count < 40 ? 1 : 37)) {
+            std::vector<float> scaled (count + 1, -1.0f);
+            visual_math_simd_log_scale_floats (scaled.data (), scale_inputs.data (), threshold, k, count);
+
+            for (std::size_t i = 0; i < count; i++) {
+                float x = scale_inputs[i];
+
+                if (x > threshold) {
+                    LV_TEST_ASSERT (std::abs (scaled[i] - (1.0 + k * std::log (double (x)))) < 2e-6 * k + 1e-7);
+                } else {
+                    LV_TEST_ASSERT (scaled[i] == 0.0f);
+                }
+            }
+
+            LV_TEST_ASSERT (scaled[count] == -1.0f);
+        }
+    }
+
+    // Check that clamping matches std::clamp() on every code path
+
+    std::vector<float> clamp_inputs = {
+        -2.0f, -1.0f, -0.0f, 0.0f, 0.5f, 1.0f, 2.0f,
+        std::nextafter (0.0f, -1.0f),
+        std::nextafter (1.0f, 2.0f),
+        std::numeric_limits<float>::denorm_min (),
+        -std::numeric_limits<float>::denorm_min (),
+        std::numeric_limits<float>::infinity (),
+        -std::numeric_limits<float>::infinity ()
+    };
+
+    for (unsigned int i = 0; i < 100; i++) {
+        clamp_inputs.push_back ((LV::rand () & 0xffff) / 16384.0f - 2.0f);
+    }
+
+    for (auto path : simd_paths) {
+        if (!select_simd_path (path)) {
+            continue;
+        }
+
+        for (std::size_t count = 1; count <= clamp_inputs.size (); count++) {
+            std::vector<float> clamped (count + 1, -1.0f);
+            visual_math_simd_clamp_floats (clamped.data (), clamp_inputs.data (), 0.0f, 1.0f, count);
+
+            for (std::size_t i = 0; i < count; i++) {
+                LV_TEST_ASSERT (clamped[i] == clamp (clamp_inputs[i], 0.0f, 1.0f));
+            }
+
+            LV_TEST_ASSERT (clamped[count] == -1.0f);
+        }
+    }
+
+    visual_cpu_set_sse2 (TRUE);
+    visual_cpu_set_avx2 (TRUE);
+
+    LV::System::destroy ();
+
+    return EXIT_SUCCESS;
+}
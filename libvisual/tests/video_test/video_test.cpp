@@ -0,0 +1,458 @@
+#include "test.h"
+#include <libvisual/libvisual.h>
+#include <cstring>
+
+namespace {
+
+  LV::VideoPtr make_pattern_video (int width, int height, VisVideoDepth depth)
+  {
+      auto video = LV::Video::create (width, height, depth);
+
+      for (int y = 0; y < height; y++) {
+          auto pixels = static_cast<uint8_t*> (video->get_pixel_ptr (0, y));
+
+          for (int i = 0; i < width * video->get_bpp (); i++) {
+              pixels[i] = LV::rand () & 0xff;
+          }
+      }
+
+      if (depth == VISUAL_VIDEO_DEPTH_8BIT) {
+          LV::Palette palette {256};
+
+          for (auto& color : palette.colors) {
+              color.set (LV::rand () & 0xff, LV::rand () & 0xff, LV::rand () & 0xff);
+          }
+
+          video->set_palette (palette);
+      }
+
+      return video;
+  }
+
+  bool videos_equal (LV::VideoConstPtr const& a, LV::VideoConstPtr const& b)
+  {
+      if (a->get_width () != b->get_width () || a->get_height () != b->get_height () || a->get_bpp () != b->get_bpp ()) {
+          return false;
+      }
+
+      for (int y = 0; y < a->get_height (); y++) {
+          if (std::memcmp (a->get_pixel_ptr (0, y), b->get_pixel_ptr (0, y), a->get_width () * a->get_bpp ()) != 0) {
+              return false;
+          }
+      }
+
+      return true;
+  }
+
+  bool rects_equal (LV::Rect const& a, LV::Rect const& b)
+  {
+      return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+  }
+
+  // Checks that an operation gives the same result on aligned videos as on unpadded ones
+  template <typename Op>
+  bool matches_aligned (LV::VideoConstPtr const& src,
+                        LV::VideoConstPtr const& aligned_src,
+                        int                      width,
+                        int                      height,
+                        VisVideoDepth            depth,
+                        Op const&                op)
+  {
+      auto expected = LV::Video::create (width, height, depth);
+      op (expected, src);
+
+      auto actual = LV::Video::create_aligned (width, height, depth);
+      op (actual, aligned_src);
+
+      return actual->is_aligned () && videos_equal (expected, actual);
+  }
+
+  void set_simd_enabled (bool enabled)
+  {
+      visual_cpu_set_sse2 (enabled);
+      visual_cpu_set_ssse3 (enabled);
+      visual_cpu_set_avx2 (enabled);
+      visual_cpu_set_avx512f (enabled);
+      visual_cpu_set_neon (enabled);
+  }
+
+} // anonymous namespace
+
+int main (int argc, char** argv)
+{
+    LV::System::init (argc, argv);
+
+    // Check that SIMD bilinear scaling matches the portable scalers, including in row bands and on odd widths
+
+    int const scale_sizes[][4] = {
+        { 320,  180, 1920, 1080 },
+        { 333,  177,  801,  603 },
+        { 640,  480,  317,  239 },
+        {   2,    2,    7,    5 }
+    };
+
+    VisVideoDepth const scale_depths[] = { VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_DEPTH_32BIT };
+
+    for (auto const& size : scale_sizes) {
+        for (auto depth : scale_depths) {
+            auto src = make_pattern_video (size[0], size[1], depth);
+
+            auto expected = LV::Video::create (size[2], size[3], depth);
+            set_simd_enabled (false);
+            expected->scale (src, VISUAL_VIDEO_SCALE_BILINEAR);
+
+            for (auto use_avx2 : { false, true }) {
+                auto actual = LV::Video::create (size[2], size[3], depth);
+                set_simd_enabled (true);
+                visual_cpu_set_avx2 (use_avx2);
+                actual->scale (src, VISUAL_VIDEO_SCALE_BILINEAR);
+
+                LV_TEST_ASSERT (videos_equal (expected, actual));
+            }
+        }
+    }
+
+    // Check that scaling in row bands on the worker pool matches scaling in one pass, including on odd heights, uneven
+    // bands and fewer bands than threads
+
+    int const band_scale_sizes[][4] = {
+        { 333,  177,  1921, 1081 },
+        { 640,  480,  4001,  233 },
+        { 100,   50, 12001,   97 }
+    };
+
+    VisVideoDepth const band_scale_depths[] = {
+        VISUAL_VIDEO_DEPTH_8BIT,
+        VISUAL_VIDEO_DEPTH_16BIT,
+        VISUAL_VIDEO_DEPTH_24BIT,
+        VISUAL_VIDEO_DEPTH_32BIT
+    };
+
+    VisVideoScaleMethod const band_scale_methods[] = { VISUAL_VIDEO_SCALE_NEAREST, VISUAL_VIDEO_SCALE_BILINEAR };
+
+    for (auto const& size : band_scale_sizes) {
+        for (auto depth : band_scale_depths) {
+            auto src = make_pattern_video (size[0], size[1], depth);
+
+            for (auto method : band_scale_methods) {
+                auto expected = LV::Video::create (size[2], size[3], depth);
+                LV::System::instance()->set_thread_count (1);
+                expected->scale (src, method);
+
+                for (unsigned int thread_count : { 2, 3, 8 }) {
+                    auto actual = LV::Video::create (size[2], size[3], depth);
+                    LV::System::instance()->set_thread_count (thread_count);
+                    actual->scale (src, method);
+
+                    LV_TEST_ASSERT (videos_equal (expected, actual));
+                }
+            }
+        }
+    }
+
+    LV::System::instance()->set_thread_count (0);
+
+    // Check that SIMD depth conversion matches the portable converters on widths that leave a remainder
+
+    VisVideoDepth const convert_depths[][2] = {
+        { VISUAL_VIDEO_DEPTH_8BIT,  VISUAL_VIDEO_DEPTH_32BIT },
+        { VISUAL_VIDEO_DEPTH_16BIT, VISUAL_VIDEO_DEPTH_32BIT },
+        { VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_DEPTH_32BIT },
+        { VISUAL_VIDEO_DEPTH_32BIT, VISUAL_VIDEO_DEPTH_16BIT },
+        { VISUAL_VIDEO_DEPTH_32BIT, VISUAL_VIDEO_DEPTH_24BIT }
+    };
+
+    int const convert_sizes[][2] = {
+        { 640, 480 },
+        { 333, 177 },
+        {   7,   5 }
+    };
+
+    for (auto const& depths : convert_depths) {
+        for (auto const& size : convert_sizes) {
+            auto src = make_pattern_video (size[0], size[1], depths[0]);
+
+            auto expected = LV::Video::create (size[0], size[1], depths[1]);
+            set_simd_enabled (false);
+            expected->convert_depth (src);
+
+            for (auto use_avx2 : { false, true }) {
+                auto actual = LV::Video::create (size[0], size[1], depths[1]);
+                set_simd_enabled (true);
+                visual_cpu_set_avx2 (use_avx2);
+                actual->convert_depth (src);
+
+                LV_TEST_ASSERT (videos_equal (expected, actual));
+            }
+        }
+    }
+
+    // Check that scaling with depth conversion in one pass matches converting first, then scaling
+
+    VisVideoDepth const scale_convert_depths[][2] = {
+        { VISUAL_VIDEO_DEPTH_8BIT,  VISUAL_VIDEO_DEPTH_32BIT },
+        { VISUAL_VIDEO_DEPTH_16BIT, VISUAL_VIDEO_DEPTH_24BIT },
+        { VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_DEPTH_32BIT },
+        { VISUAL_VIDEO_DEPTH_32BIT, VISUAL_VIDEO_DEPTH_16BIT }
+    };
+
+    int const scale_convert_sizes[][4] = {
+        { 320,  240,  800,  600 },
+        { 333,  177, 1920, 1080 },
+        { 640,  480,  317,  239 },
+        {   7,    5,   13,   11 }
+    };
+
+    VisVideoScaleMethod const scale_methods[] = { VISUAL_VIDEO_SCALE_NEAREST, VISUAL_VIDEO_SCALE_BILINEAR };
+
+    for (auto const& depths : scale_convert_depths) {
+        for (auto const& size : scale_convert_sizes) {
+            auto src = make_pattern_video (size[0], size[1], depths[0]);
+
+            auto converted = LV::Video::create (size[0], size[1], depths[1]);
+            converted->convert_depth (src);
+
+            for (auto method : scale_methods) {
+                auto expected = LV::Video::create (size[2], size[3], depths[1]);
+                expected->scale (converted, method);
+
+                auto actual = LV::Video::create (size[2], size[3], depths[1]);
+                actual->scale_depth (src, method);
+
+                LV_TEST_ASSERT (videos_equal (expected, actual));
+            }
+        }
+    }
+
+    // Check that SIMD fills and blits match the portable code. Frame-sized ones use streaming stores.
+
+    VisVideoDepth const fill_blit_depths[] = { VISUAL_VIDEO_DEPTH_8BIT, VISUAL_VIDEO_DEPTH_16BIT, VISUAL_VIDEO_DEPTH_32BIT };
+
+    for (auto depth : fill_blit_depths) {
+        auto frame   = make_pattern_video (1280, 1024, depth);
+        auto overlay = make_pattern_video (1001,  600, depth);
+
+        auto fill_blit = [&] (LV::VideoPtr const& video) {
+            video->fill_color (LV::Color {0x12, 0x34, 0x56});
+            video->fill_color (LV::Color {0xab, 0xcd, 0xef}, LV::Rect {5, 7, 601, 403});
+            video->blit (overlay, 211, 401, false);
+        };
+
+        set_simd_enabled (false);
+
+        auto expected = LV::Video::create (1280, 1024, depth);
+        fill_blit (expected);
+
+        for (auto use_avx : { 0, 1, 2 }) {
+            set_simd_enabled (true);
+            visual_cpu_set_avx2 (use_avx >= 1);
+            visual_cpu_set_avx512f (use_avx >= 2);
+
+            auto actual = LV::Video::create (1280, 1024, depth);
+            fill_blit (actual);
+
+            LV_TEST_ASSERT (videos_equal (expected, actual));
+
+            actual->blit (frame, 0, 0, false);
+
+            LV_TEST_ASSERT (videos_equal (frame, actual));
+        }
+    }
+
+    // Check that SIMD colour keyed and surface alpha blits match the portable code on widths that leave a remainder
+
+    VisVideoDepth const overlay_depths[] = { VISUAL_VIDEO_DEPTH_16BIT, VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_DEPTH_32BIT };
+
+    VisVideoComposeType const overlay_types[] = {
+        VISUAL_VIDEO_COMPOSE_TYPE_COLORKEY,
+        VISUAL_VIDEO_COMPOSE_TYPE_SURFACE,
+        VISUAL_VIDEO_COMPOSE_TYPE_SURFACECOLORKEY
+    };
+
+    int const overlay_widths[] = { 333, 37, 7 };
+
+    LV::Color const colorkey {0x12, 0x34, 0x56};
+
+    for (auto depth : overlay_depths) {
+        auto frame = make_pattern_video (400, 200, depth);
+
+        // A pixel in the colour key, copied into the overlay at random
+        auto key_pixel = LV::Video::create (1, 1, depth);
+        key_pixel->fill_color (colorkey);
+
+        for (auto width : overlay_widths) {
+            auto overlay = make_pattern_video (width, 101, depth);
+            int  bpp     = overlay->get_bpp ();
+
+            for (int y = 0; y < overlay->get_height (); y++) {
+                auto pixels = static_cast<uint8_t*> (overlay->get_pixel_ptr (0, y));
+
+                for (int x = 0; x < width; x++) {
+                    if (LV::rand () % 3 == 0) {
+                        std::memcpy (pixels + x * bpp, key_pixel->get_pixels (), bpp);
+                    }
+                }
+            }
+
+            overlay->set_compose_colorkey (colorkey);
+            overlay->set_compose_surface (0x9c);
+
+            for (auto type : overlay_types) {
+                overlay->set_compose_type (type);
+
+                set_simd_enabled (false);
+
+                auto expected = LV::Video::create (400, 200, depth);
+                expected->blit (frame, 0, 0, false);
+                expected->blit (overlay, 31, 17, true);
+
+                for (auto use_avx2 : { false, true }) {
+                    set_simd_enabled (true);
+                    visual_cpu_set_avx2 (use_avx2);
+
+                    auto actual = LV::Video::create (400, 200, depth);
+                    actual->blit (frame, 0, 0, false);
+                    actual->blit (overlay, 31, 17, true);
+
+                    LV_TEST_ASSERT (videos_equal (expected, actual));
+                }
+            }
+        }
+    }
+
+    // Check that rows of aligned videos are padded to the alignment, and that operations on them match those on
+    // unpadded videos
+
+    VisVideoDepth const aligned_depths[] = {
+        VISUAL_VIDEO_DEPTH_8BIT, VISUAL_VIDEO_DEPTH_16BIT, VISUAL_VIDEO_DEPTH_24BIT, VISUAL_VIDEO_DEPTH_32BIT
+    };
+
+    set_simd_enabled (true);
+
+    for (auto depth : aligned_depths) {
+        for (int width : { 333, 64, 7 }) {
+            int height = 177;
+
+            auto src = make_pattern_video (width, height, depth);
+
+            auto aligned_src = LV::Video::create_aligned (width, height, depth);
+            aligned_src->set_palette (src->get_palette ());
+            aligned_src->blit (src, 0, 0, false);
+
+            LV_TEST_ASSERT (aligned_src->is_aligned ());
+            LV_TEST_ASSERT (aligned_src->get_pitch () % VISUAL_VIDEO_ALIGNMENT == 0);
+            LV_TEST_ASSERT (aligned_src->get_pitch () - width * aligned_src->get_bpp () < VISUAL_VIDEO_ALIGNMENT);
+            LV_TEST_ASSERT (videos_equal (src, aligned_src));
+
+            auto other_depth = depth == VISUAL_VIDEO_DEPTH_32BIT ? VISUAL_VIDEO_DEPTH_24BIT : VISUAL_VIDEO_DEPTH_32BIT;
+
+            LV_TEST_ASSERT (matches_aligned (src, aligned_src, width, height, other_depth,
+                [] (LV::VideoPtr const& dst, LV::VideoConstPtr const& src) {
+                    dst->convert_depth (src);
+                }));
+
+            for (auto method : scale_methods) {
+                LV_TEST_ASSERT (matches_aligned (src, aligned_src, 801, 603, depth,
+                    [method] (LV::VideoPtr const& dst, LV::VideoConstPtr const& src) {
+                        dst->scale (src, method);
+                    }));
+
+                LV_TEST_ASSERT (matches_aligned (src, aligned_src, 317, 239, other_depth,
+                    [method] (LV::VideoPtr const& dst, LV::VideoConstPtr const& src) {
+                        dst->scale_depth (src, method);
+                    }));
+            }
+
+            for (auto degrees : { VISUAL_VIDEO_ROTATE_90, VISUAL_VIDEO_ROTATE_270 }) {
+                LV_TEST_ASSERT (matches_aligned (src, aligned_src, height, width, depth,
+                    [degrees] (LV::VideoPtr const& dst, LV::VideoConstPtr const& src) {
+                        dst->rotate (src, degrees);
+                    }));
+            }
+
+            LV_TEST_ASSERT (matches_aligned (src, aligned_src, width, height, depth,
+                [] (LV::VideoPtr const& dst, LV::VideoConstPtr const& src) {
+                    dst->mirror (src, VISUAL_VIDEO_MIRROR_X);
+                }));
+
+            LV_TEST_ASSERT (matches_aligned (src, aligned_src, 1280, 720, depth,
+                [] (LV::VideoPtr const& dst, LV::VideoConstPtr const& src) {
+                    dst->fill_color (LV::Color {0x12, 0x34, 0x56});
+                    dst->blit (src, 101, 53, false);
+                }));
+        }
+    }
+
+    // Check that drawing operations mark the areas they change, clipped and without duplicates
+
+    {
+        auto video   = LV::Video::create (640, 480, VISUAL_VIDEO_DEPTH_32BIT);
+        auto overlay = make_pattern_video (50, 40, VISUAL_VIDEO_DEPTH_32BIT);
+
+        LV_TEST_ASSERT (video->get_dirty_rects ().empty ());
+
+        video->fill_color (LV::Color {0x12, 0x34, 0x56}, LV::Rect {10, 10, 100, 50});
+        video->fill_color (LV::Color {0x12, 0x34, 0x56}, LV::Rect {20, 20, 10, 10});
+        video->blit (overlay, 600, 460, false);
+
+        auto const& dirty_rects = video->get_dirty_rects ();
+        LV_TEST_ASSERT (dirty_rects.size () == 2);
+        LV_TEST_ASSERT (rects_equal (dirty_rects[0], LV::Rect {10, 10, 100, 50}));
+        LV_TEST_ASSERT (rects_equal (dirty_rects[1], LV::Rect {600, 460, 40, 20}));
+
+        // The area fill is drawn
+        LV_TEST_ASSERT (*static_cast<uint32_t*> (video->get_pixel_ptr (10, 10)) != 0);
+        LV_TEST_ASSERT (*static_cast<uint32_t*> (video->get_pixel_ptr (9, 10)) == 0);
+
+        video->clear_dirty ();
+        LV_TEST_ASSERT (video->get_dirty_rects ().empty ());
+
+        // Long lists are merged into their bounding rectangle
+        for (int i = 0; i < 17; i++) {
+            video->mark_dirty (LV::Rect {i * 20, i * 10, 10, 10});
+        }
+
+        LV_TEST_ASSERT (video->get_dirty_rects ().size () == 1);
+        LV_TEST_ASSERT (rects_equal (video->get_dirty_rects ()[0], LV::Rect {0, 0, 330, 170}));
+
+        video->fill_color (LV::Color {0, 0, 0});
+        LV_TEST_ASSERT (video->get_dirty_rects ().size () == 1);
+        LV_TEST_ASSERT (rects_equal (video->get_dirty_rects ()[0], LV::Rect {640, 480}));
+    }
+
+    // Check that pixel buffers are recycled zeroed through the pool, and trimmed down to its size limit
+
+    LV::VideoPool::trim ();
+    LV::VideoPool::reset_stats ();
+
+    {
+        auto video = make_pattern_video (640, 480, VISUAL_VIDEO_DEPTH_32BIT);
+        auto other = LV::Video::create (320, 240, VISUAL_VIDEO_DEPTH_32BIT);
+    }
+
+    LV_TEST_ASSERT (LV::VideoPool::get_stats ().misses == 2);
+    LV_TEST_ASSERT (LV::VideoPool::get_stats ().cached_count == 2);
+
+    {
+        auto video = LV::Video::create (640, 480, VISUAL_VIDEO_DEPTH_32BIT);
+        auto blank = LV::Video::create (640, 480, VISUAL_VIDEO_DEPTH_32BIT);
+        blank->fill_color (LV::Color {0, 0, 0, 0});
+
+        LV_TEST_ASSERT (LV::VideoPool::get_stats ().hits == 1);
+        LV_TEST_ASSERT (videos_equal (video, blank));
+    }
+
+    // The 320x240 buffer was released first
+    LV::VideoPool::trim (2 * 640 * 480 * 4);
+
+    auto stats = LV::VideoPool::get_stats ();
+    LV_TEST_ASSERT (stats.trimmed == 1);
+    LV_TEST_ASSERT (stats.cached_count == 2);
+    LV_TEST_ASSERT (stats.cached_size == 2 * 640 * 480 * 4);
+
+    set_simd_enabled (true);
+
+    LV::System::destroy ();
+
+    return EXIT_SUCCESS;
+}
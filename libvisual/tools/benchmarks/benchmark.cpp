@@ -1,4 +1,5 @@
 #include "benchmark.hpp"
+#include <libvisual/libvisual.h>
 #include <chrono>
 #include <iostream>
 
@@ -9,6 +10,29 @@ namespace LV {
     typedef std::chrono::high_resolution_clock Clock;
     typedef std::chrono::duration<double, std::micro> Duration;
 
+    namespace {
+
+      // Instruction set toggle
+      struct InstructionSet
+      {
+          char const* name;
+          int (*has) ();
+          int (*set) (int enabled);
+      };
+
+      // Instruction sets with toggles, from widest to narrowest
+      InstructionSet const instruction_sets[] = {
+          { "avx512f", visual_cpu_has_avx512f, visual_cpu_set_avx512f },
+          { "avx2",    visual_cpu_has_avx2,    visual_cpu_set_avx2    },
+          { "avx",     visual_cpu_has_avx,     visual_cpu_set_avx     },
+          { "ssse3",   visual_cpu_has_ssse3,   visual_cpu_set_ssse3   },
+          { "sse2",    visual_cpu_has_sse2,    visual_cpu_set_sse2    },
+          { "sse",     visual_cpu_has_sse,     visual_cpu_set_sse     },
+          { "mmx",     visual_cpu_has_mmx,     visual_cpu_set_mmx     }
+      };
+
+    } // anonymous namespace
+
     void run_benchmark (LV::Tools::Benchmark& test, unsigned int max_runs)
     {
         auto start_time = Clock::now ();
@@ -22,5 +46,23 @@ namespace LV {
                   << "Time / run: " << duration.count () / max_runs << "us\n\n";
     }
 
+    bool select_variant (std::string const& variant)
+    {
+        for (auto const& isa : instruction_sets) {
+            isa.set (TRUE);
+        }
+
+        // Turn off instruction sets wider than the variant's
+        for (auto const& isa : instruction_sets) {
+            if (variant == isa.name) {
+                return isa.has ();
+            }
+
+            isa.set (FALSE);
+        }
+
+        return variant == "c";
+    }
+
   } // Tools namespace
 } // LV namespace
@@ -33,6 +33,10 @@ namespace LV {
 
     void run_benchmark (Benchmark& benchmark, unsigned int max_runs);
 
+    // Restricts SIMD code paths to those of a variant, named after the widest instruction set to use (e.g. "avx2"),
+    // or "c" for portable code only. Returns false if the processor does not support it.
+    bool select_variant (std::string const& variant);
+
   } // Tools namespace
 } // LV namespace
 
@@ -3,6 +3,7 @@
 #include "benchmark.hpp"
 #include "random.hpp"
 #include <vector>
+#include <algorithm>
 #include <cstdlib>
 
 namespace {
@@ -24,17 +25,28 @@ namespace {
       typedef typename Vector<float>::type Input;
       typedef typename Vector<float>::type Output;
 
-      explicit DFTBench (unsigned int data_size)
+      DFTBench (unsigned int data_size, unsigned int channels)
           : Benchmark ("DFTTest")
           , m_dft     (data_size, data_size)
-          , m_input   (LV::Tools::make_random<Input> (0.0, 1.0, data_size))
-          , m_output  (data_size)
-      {}
+          , m_input   (LV::Tools::make_random<Input> (0.0, 1.0, data_size * channels))
+          , m_output  (data_size * channels)
+      {
+          for (unsigned int i = 0; i < channels; i++) {
+              m_inputs.push_back (m_input.data () + i * data_size);
+              m_outputs.push_back (m_output.data () + i * data_size);
+          }
+      }
 
       virtual void operator() (unsigned int max_runs)
       {
-          for (unsigned int i = 0; i < max_runs; i++) {
-              m_dft.perform (m_output.data (), m_input.data ());
+          if (m_inputs.size () == 1) {
+              for (unsigned int i = 0; i < max_runs; i++) {
+                  m_dft.perform (m_outputs[0], m_inputs[0]);
+              }
+          } else {
+              for (unsigned int i = 0; i < max_runs; i++) {
+                  m_dft.perform_batch (m_outputs.data (), m_inputs.data (), m_inputs.size ());
+              }
           }
       }
 
@@ -46,6 +58,9 @@ namespace {
       LV::DFT m_dft;
       Input   m_input;
       Output  m_output;
+
+      std::vector<float const*> m_inputs;
+      std::vector<float*>       m_outputs;
   };
 
 } // anonymous
@@ -56,13 +71,18 @@ int main (int argc, char** argv)
 
     unsigned int data_size = 1024;
     unsigned int max_runs  = 1000;
+    unsigned int channels  = 1;
 
     if (argc > 2) {
         data_size = std::atoi (argv[1]);
         max_runs  = std::atoi (argv[2]);
     }
 
-    DFTBench bench (data_size);
+    if (argc > 3) {
+        channels = std::max (1, std::atoi (argv[3]));
+    }
+
+    DFTBench bench (data_size, channels);
     LV::Tools::run_benchmark (bench, max_runs);
 
     return EXIT_SUCCESS;
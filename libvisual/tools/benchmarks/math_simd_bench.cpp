@@ -148,6 +148,37 @@ namespace {
       Output m_output;
   };
 
+  // Bench class for visual_math_simd_log_scale_floats()
+  class LogScaleFloatsBench
+      : public LV::Tools::Benchmark
+  {
+  public:
+
+      typedef typename Vector<float>::type Input;
+      typedef typename Vector<float>::type Output;
+
+      explicit LogScaleFloatsBench (unsigned int data_size)
+          : Benchmark ("LogScaleFloatsBench")
+          , m_input   (LV::Tools::make_random<Input> (0.0, 1.0, data_size))
+          , m_output  (data_size)
+      {}
+
+      virtual void operator() (unsigned int max_runs)
+      {
+          for (unsigned int i = 0; i < max_runs; i++) {
+              visual_math_simd_log_scale_floats (m_output.data (), m_input.data (), 0.001f, 1.0f / 6.908f, m_output.size ());
+          }
+      }
+
+      virtual ~LogScaleFloatsBench ()
+      {}
+
+  private:
+
+      Input  m_input;
+      Output m_output;
+  };
+
 } // anonymous
 
 int main (int argc, char** argv)
@@ -174,5 +205,8 @@ int main (int argc, char** argv)
     ComplexScaledNormBench test4 (data_size);
     LV::Tools::run_benchmark (test4, max_runs);
 
+    LogScaleFloatsBench test5 (data_size);
+    LV::Tools::run_benchmark (test5, max_runs);
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,171 @@
+#include "benchmark.hpp"
+#include <libvisual/libvisual.h>
+#include <libvisual/lv_util.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+namespace {
+
+  enum class MemOp
+  {
+      COPY,
+      COPY_PITCH,
+      SET8,
+      SET16,
+      SET32
+  };
+
+  // Row size and destination row padding of COPY_PITCH, as in blitting a 640 pixel wide 32-bit video
+  unsigned int const pitch_row_bytes = 640 * 4;
+  unsigned int const pitch_padding   = 256;
+
+  class MemBench
+      : public LV::Tools::Benchmark
+  {
+  public:
+
+      MemBench (std::string const& variant, std::string const& op_name, MemOp op, std::size_t size)
+          : Benchmark ("MemBench (" + op_name + ", " + variant + ")")
+          , m_op   { op }
+          , m_size { size }
+          , m_rows { int (size / pitch_row_bytes) }
+          , m_src  (size, 0x5a)
+          , m_dest (op == MemOp::COPY_PITCH ? m_rows * (pitch_row_bytes + pitch_padding) : size)
+      {}
+
+      virtual void operator() (unsigned int max_runs)
+      {
+          auto dest = m_dest.data ();
+          auto src  = m_src.data ();
+
+          for (unsigned int i = 0; i < max_runs; i++) {
+              switch (m_op) {
+                  case MemOp::COPY:
+                      visual_mem_copy (dest, src, m_size);
+                      break;
+                  case MemOp::COPY_PITCH:
+                      visual_mem_copy_pitch (dest, src, pitch_row_bytes + pitch_padding, pitch_row_bytes,
+                                             pitch_row_bytes, m_rows);
+                      break;
+                  case MemOp::SET8:
+                      visual_mem_set (dest, i, m_size);
+                      break;
+                  case MemOp::SET16:
+                      visual_mem_set16 (dest, i, m_size / 2);
+                      break;
+                  case MemOp::SET32:
+                      visual_mem_set32 (dest, i, m_size / 4);
+                      break;
+              }
+          }
+      };
+
+      virtual ~MemBench ()
+      {}
+
+  private:
+
+      MemOp                m_op;
+      std::size_t          m_size;
+      int                  m_rows;
+      std::vector<uint8_t> m_src;
+      std::vector<uint8_t> m_dest;
+  };
+
+  // Code paths to compare, from fastest to slowest. "c" is the C library or portable code.
+  char const* const variants[] = { "avx512f", "avx2", "sse2", "c" };
+
+  std::unique_ptr<MemBench> make_benchmark (std::string const& variant, int argc, char** argv)
+  {
+      std::size_t size    = 640 * 480 * 4;
+      std::string op_name = "copy";
+      MemOp       op      = MemOp::COPY;
+
+      if (argc > 1) {
+          long value = std::atol (argv[1]);
+          if (value < 64) {
+              throw std::invalid_argument ("Size must be at least 64 bytes");
+          }
+
+          size = value;
+
+          argc--; argv++;
+      }
+
+      if (argc > 1) {
+          op_name = argv[1];
+
+          if (op_name == "copy") {
+              op = MemOp::COPY;
+          }
+          else if (op_name == "copy_pitch") {
+              op = MemOp::COPY_PITCH;
+          }
+          else if (op_name == "set") {
+              op = MemOp::SET8;
+          }
+          else if (op_name == "set16") {
+              op = MemOp::SET16;
+          }
+          else if (op_name == "set32") {
+              op = MemOp::SET32;
+          }
+          else {
+              throw std::invalid_argument ("Invalid operation specified");
+          }
+
+          argc--; argv++;
+      }
+
+      if (op == MemOp::COPY_PITCH && size < pitch_row_bytes) {
+          throw std::invalid_argument ("Size must be at least one row for copy_pitch");
+      }
+
+      return LV::make_unique<MemBench> (variant, op_name, op, size);
+  }
+
+} // anonymous
+
+int main (int argc, char **argv)
+{
+    try {
+        LV::System::init (argc, argv);
+
+        unsigned int max_runs = 1000;
+
+        if (argc > 1) {
+            int value = std::atoi (argv[1]);
+            if (value <= 0) {
+                throw std::invalid_argument ("Number of runs is non-positive");
+            }
+
+            max_runs = value;
+
+            argc--; argv++;
+        }
+
+        for (auto variant : variants) {
+            if (!LV::Tools::select_variant (variant)) {
+                continue;
+            }
+
+            auto bench = make_benchmark (variant, argc, argv);
+            LV::Tools::run_benchmark (*bench, max_runs);
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch (std::exception& error) {
+        std::cerr << "Exception caught: " << error.what () << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (...) {
+        std::cerr << "Unknown exception caught\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,135 @@
+#include "benchmark.hpp"
+#include <libvisual/libvisual.h>
+#include <libvisual/lv_util.hpp>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <cstdlib>
+
+namespace {
+
+  class VideoBlitBench
+      : public LV::Tools::Benchmark
+  {
+  public:
+
+      VideoBlitBench (std::string const&  variant,
+                      std::string const&  type_name,
+                      VisVideoComposeType type,
+                      VisVideoDepth       depth)
+          : Benchmark ("VideoBlitBench (" + type_name + ", " + variant + ")")
+          , m_frame   { LV::Video::create (1920, 1080, depth) }
+          , m_overlay { LV::Video::create (1920, 1080, depth) }
+      {
+          LV::Color const colorkey {0x00, 0xff, 0x00};
+
+          m_frame->fill_color (LV::Color {0x20, 0x40, 0x80});
+
+          // Key out every other band of 64 rows, so that keyed and blitted pixels alternate
+          m_overlay->fill_color (LV::Color {0xc0, 0x80, 0x40});
+
+          for (int y = 0; y < 1080; y += 128) {
+              m_overlay->fill_color (colorkey, LV::Rect {0, y, 1920, 64});
+          }
+
+          m_overlay->set_compose_type (type);
+          m_overlay->set_compose_colorkey (colorkey);
+          m_overlay->set_compose_surface (0x80);
+      }
+
+      virtual void operator() (unsigned int max_runs)
+      {
+          for (unsigned int i = 0; i < max_runs; i++)
+              m_frame->blit (m_overlay, 0, 0, true);
+      }
+
+      virtual ~VideoBlitBench ()
+      {}
+
+  private:
+
+      LV::VideoPtr m_frame;
+      LV::VideoPtr m_overlay;
+  };
+
+  // Code paths to compare, from fastest to slowest
+  char const* const variants[] = { "avx2", "sse2", "c" };
+
+  std::unique_ptr<VideoBlitBench> make_benchmark (std::string const& variant, int argc, char** argv)
+  {
+      std::string         type_name = "surfacecolorkey";
+      VisVideoComposeType type      = VISUAL_VIDEO_COMPOSE_TYPE_SURFACECOLORKEY;
+      VisVideoDepth       depth     = VISUAL_VIDEO_DEPTH_32BIT;
+
+      if (argc > 1) {
+          type_name = argv[1];
+
+          if (type_name == "colorkey") {
+              type = VISUAL_VIDEO_COMPOSE_TYPE_COLORKEY;
+          }
+          else if (type_name == "surface") {
+              type = VISUAL_VIDEO_COMPOSE_TYPE_SURFACE;
+          }
+          else if (type_name == "surfacecolorkey") {
+              type = VISUAL_VIDEO_COMPOSE_TYPE_SURFACECOLORKEY;
+          }
+          else {
+              throw std::invalid_argument ("Invalid compose type specified");
+          }
+
+          argc--; argv++;
+      }
+
+      if (argc > 1) {
+          depth = visual_video_depth_from_bpp (std::atoi (argv[1]));
+
+          if (depth == VISUAL_VIDEO_DEPTH_NONE || depth == VISUAL_VIDEO_DEPTH_GL) {
+              throw std::invalid_argument ("Invalid bit depth specified");
+          }
+
+          argc--; argv++;
+      }
+
+      return LV::make_unique<VideoBlitBench> (variant, type_name, type, depth);
+  }
+
+} // anonymous
+
+int main (int argc, char **argv)
+{
+    try {
+        LV::System::init (argc, argv);
+
+        unsigned int max_runs = 100;
+
+        if (argc > 1) {
+            int value = std::atoi (argv[1]);
+            if (value <= 0) {
+                throw std::invalid_argument ("Number of runs is non-positive");
+            }
+
+            max_runs = value;
+
+            argc--; argv++;
+        }
+
+        for (auto variant : variants) {
+            if (!LV::Tools::select_variant (variant)) {
+                continue;
+            }
+
+            auto benchmark = make_benchmark (variant, argc, argv);
+            LV::Tools::run_benchmark (*benchmark, max_runs);
+        }
+    }
+    catch (std::exception& error) {
+        std::cerr << "Exception caught: " << error.what () << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (...) {
+        std::cerr << "Unknown exception caught\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
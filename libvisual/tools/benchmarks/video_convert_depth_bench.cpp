@@ -2,6 +2,7 @@
 #include <libvisual/libvisual.h>
 #include <libvisual/lv_util.hpp>
 #include <iostream>
+#include <string>
 #include <stdexcept>
 #include <cstdlib>
 
@@ -12,8 +13,12 @@ namespace {
   {
   public:
 
-      VideoConvertDepthBench (unsigned int width, unsigned int height, VisVideoDepth src_depth, VisVideoDepth dst_depth)
-          : Benchmark { "VideoConvertDepthBench" }
+      VideoConvertDepthBench (std::string const& variant,
+                              unsigned int       width,
+                              unsigned int       height,
+                              VisVideoDepth      src_depth,
+                              VisVideoDepth      dst_depth)
+          : Benchmark ("VideoConvertDepthBench (" + variant + ")")
           , m_src { LV::Video::create (width, height, src_depth) }
           , m_dst { LV::Video::create (width, height, dst_depth) }
       {
@@ -39,7 +44,10 @@ namespace {
       LV::VideoPtr m_dst;
   };
 
-  std::unique_ptr<VideoConvertDepthBench> make_benchmark (int& argc, char**& argv)
+  // Code paths to compare, from fastest to slowest
+  char const* const variants[] = { "avx2", "ssse3", "sse2", "c" };
+
+  std::unique_ptr<VideoConvertDepthBench> make_benchmark (std::string const& variant, int argc, char** argv)
   {
       unsigned int  width     = 640;
       unsigned int  height    = 480;
@@ -75,7 +83,7 @@ namespace {
           argc -= 2; argv += 2;
       }
 
-      return LV::make_unique<VideoConvertDepthBench> (width, height, src_depth, dst_depth);
+      return LV::make_unique<VideoConvertDepthBench> (variant, width, height, src_depth, dst_depth);
   }
 
 } // anonymous
@@ -98,8 +106,14 @@ int main (int argc, char **argv)
             argc--; argv++;
         }
 
-        auto benchmark = make_benchmark (argc, argv);
-        LV::Tools::run_benchmark (*benchmark, max_runs);
+        for (auto variant : variants) {
+            if (!LV::Tools::select_variant (variant)) {
+                continue;
+            }
+
+            auto benchmark = make_benchmark (variant, argc, argv);
+            LV::Tools::run_benchmark (*benchmark, max_runs);
+        }
     }
     catch (std::exception& error) {
         std::cerr << "Exception caught: " << error.what () << std::endl;
@@ -2,6 +2,7 @@
 #include <libvisual/libvisual.h>
 #include <libvisual/lv_util.hpp>
 #include <iostream>
+#include <string>
 #include <stdexcept>
 #include <cstdlib>
 #include <cstring>
@@ -13,15 +14,16 @@ namespace {
   {
   public:
 
-      VideoScaleBench (unsigned int        src_width,
+      VideoScaleBench (std::string const&  variant,
+                       unsigned int        src_width,
                        unsigned int        src_height,
                        unsigned int        dst_width,
                        unsigned int        dst_height,
                        VisVideoDepth       depth,
                        VisVideoScaleMethod method)
-          : Benchmark ("VideoScaleBench")
-          , m_src    { LV::Video::create (dst_width, dst_height, depth) }
-          , m_dst    { LV::Video::create (src_width, src_height, depth) }
+          : Benchmark ("VideoScaleBench (" + variant + ")")
+          , m_src    { LV::Video::create (src_width, src_height, depth) }
+          , m_dst    { LV::Video::create (dst_width, dst_height, depth) }
           , m_method { method }
       {}
 
@@ -41,7 +43,10 @@ namespace {
       VisVideoScaleMethod m_method;
   };
 
-  std::unique_ptr<VideoScaleBench> make_benchmark (int& argc, char**& argv)
+  // Code paths to compare, from fastest to slowest
+  char const* const variants[] = { "avx2", "sse2", "c" };
+
+  std::unique_ptr<VideoScaleBench> make_benchmark (std::string const& variant, int argc, char** argv)
   {
       unsigned int        src_width  = 320;
       unsigned int        src_height = 240;
@@ -101,7 +106,7 @@ namespace {
           argc--; argv++;
       }
 
-      return LV::make_unique<VideoScaleBench> (src_width, src_height, dst_width, dst_height, depth, method);
+      return LV::make_unique<VideoScaleBench> (variant, src_width, src_height, dst_width, dst_height, depth, method);
   }
 
 } // anonymous
@@ -124,8 +129,14 @@ int main (int argc, char **argv)
             argc--; argv++;
         }
 
-        auto bench = make_benchmark (argc, argv);
-        LV::Tools::run_benchmark (*bench, max_runs);
+        for (auto variant : variants) {
+            if (!LV::Tools::select_variant (variant)) {
+                continue;
+            }
+
+            auto bench = make_benchmark (variant, argc, argv);
+            LV::Tools::run_benchmark (*bench, max_runs);
+        }
 
         return EXIT_SUCCESS;
     }
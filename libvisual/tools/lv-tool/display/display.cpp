@@ -100,12 +100,23 @@ void Display::update_all ()
     LV::VideoPtr video = get_video ();
     LV::Rect rect (video->get_width (), video->get_height ());
 
-    m_impl->driver->update_rect (rect);
+    m_impl->driver->update_rects ({ rect });
+
+    video->clear_dirty ();
 }
 
 void Display::update_rect (LV::Rect const& rect)
 {
-    m_impl->driver->update_rect (rect);
+    m_impl->driver->update_rects ({ rect });
+}
+
+void Display::update_dirty ()
+{
+    LV::VideoPtr video = get_video ();
+
+    m_impl->driver->update_rects (video->get_dirty_rects ());
+
+    video->clear_dirty ();
 }
 
 void Display::set_fullscreen (bool fullscreen, bool autoscale)
@@ -58,6 +58,8 @@ public:
 
     void update_rect (LV::Rect const& rect);
 
+    void update_dirty ();
+
     LV::VideoPtr get_video () const;
 
     void set_title(std::string const& title);
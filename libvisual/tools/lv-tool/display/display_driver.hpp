@@ -26,6 +26,7 @@
 #define _LV_TOOL_DISPLAY_DRIVER_HPP
 
 #include <string>
+#include <vector>
 #include <libvisual/libvisual.h>
 
 class Display;
@@ -47,7 +48,7 @@ public:
 
     virtual void set_fullscreen (bool fullscreen, bool autoscale) = 0;
 
-    virtual void update_rect (LV::Rect const& rect) = 0;
+    virtual void update_rects (std::vector<LV::Rect> const& rects) = 0;
 
     virtual void drain_events (VisEventQueue& eventqueue) = 0;
 
@@ -23,12 +23,14 @@
 // along with lv-tool.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "sdl_driver.hpp"
+#include "sdl_util.hpp"
 #include "display.hpp"
 #include "display_driver.hpp"
 #include <libvisual/libvisual.h>
 
 #include <SDL/SDL.h>
 #include <array>
+#include <vector>
 
 namespace {
 
@@ -219,7 +221,7 @@ namespace {
           SDL_WM_SetCaption (title.c_str(), nullptr);
       }
 
-      virtual void update_rect (LV::Rect const& rect)
+      virtual void update_rects (std::vector<LV::Rect> const& rects)
       {
           if (m_screen->format->BitsPerPixel == 8) {
               auto const& pal = m_display.get_video ()->get_palette ();
@@ -241,7 +243,7 @@ namespace {
           if (m_requested_depth == VISUAL_VIDEO_DEPTH_GL)
               SDL_GL_SwapBuffers ();
           else
-              SDL_UpdateRect (m_screen, rect.x, rect.y, rect.width, rect.height);
+              sdl_update_screen_rects (m_screen, rects);
       }
 
       virtual void drain_events (VisEventQueue& eventqueue)
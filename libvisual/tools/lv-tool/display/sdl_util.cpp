@@ -0,0 +1,37 @@
+// lv-tool - Libvisual commandline tool
+//
+// Copyright (C) 2012-2013 Libvisual team
+//               2004-2006 Dennis Smit
+//
+// Authors: Daniel Hiepler <daniel@niftylight.de>
+//          Chong Kai Xiong <kaixiong@codeleft.sg>
+//          Dennis Smit <ds@nerds-incorporated.org>
+//
+// This file is part of lv-tool.
+//
+// lv-tool is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// lv-tool is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lv-tool.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sdl_util.hpp"
+
+void sdl_update_screen_rects (SDL_Surface* screen, std::vector<LV::Rect> const& rects)
+{
+    std::vector<SDL_Rect> sdl_rects;
+    sdl_rects.reserve (rects.size ());
+
+    for (auto const& rect : rects) {
+        sdl_rects.push_back ({ Sint16 (rect.x), Sint16 (rect.y), Uint16 (rect.width), Uint16 (rect.height) });
+    }
+
+    SDL_UpdateRects (screen, sdl_rects.size (), sdl_rects.data ());
+}
@@ -0,0 +1,35 @@
+// lv-tool - Libvisual commandline tool
+//
+// Copyright (C) 2012-2013 Libvisual team
+//               2004-2006 Dennis Smit
+//
+// Authors: Daniel Hiepler <daniel@niftylight.de>
+//          Chong Kai Xiong <kaixiong@codeleft.sg>
+//          Dennis Smit <ds@nerds-incorporated.org>
+//
+// This file is part of lv-tool.
+//
+// lv-tool is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// lv-tool is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lv-tool.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _LV_TOOL_SDL_UTIL_HPP
+#define _LV_TOOL_SDL_UTIL_HPP
+
+#include <libvisual/libvisual.h>
+#include <SDL/SDL.h>
+#include <vector>
+
+// Updates the given areas of an SDL screen surface
+void sdl_update_screen_rects (SDL_Surface* screen, std::vector<LV::Rect> const& rects);
+
+#endif // _LV_TOOL_SDL_UTIL_HPP
@@ -96,8 +96,9 @@ namespace {
           // nothing to do
       }
 
-      virtual void update_rect (LV::Rect const& rect)
+      virtual void update_rects (std::vector<LV::Rect> const& rects)
       {
+          // The output is a stream of whole frames
           if (write (STDOUT_FILENO, m_screen_video->get_pixels (), m_screen_video->get_size ()) == -1)
               visual_log (VISUAL_LOG_ERROR, "Failed to write pixels to stdout");
       }
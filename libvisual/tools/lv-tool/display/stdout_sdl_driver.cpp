@@ -23,6 +23,7 @@
 // along with lv-tool.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "sdl_driver.hpp"
+#include "sdl_util.hpp"
 #include "display.hpp"
 #include "display_driver.hpp"
 #include "gettext.h"
@@ -235,7 +236,7 @@ namespace {
           SDL_WM_SetCaption (title.c_str(), nullptr);
       }
 
-      virtual void update_rect (LV::Rect const& rect)
+      virtual void update_rects (std::vector<LV::Rect> const& rects)
       {
           if (m_screen->format->BitsPerPixel == 8) {
               auto const& pal = m_display.get_video ()->get_palette ();
@@ -259,7 +260,8 @@ namespace {
               // Complete all GL commands
               SDL_GL_SwapBuffers ();
 
-              // Read pixels
+              // Read pixels of the whole frame
+              LV::Rect rect (m_screen->w, m_screen->h);
               glReadPixels (rect.x, rect.y, rect.width, rect.height, GL_BGR, GL_UNSIGNED_BYTE, raw_buffer1.data ());
 
               // Manually flip image on the CPU
@@ -279,9 +281,9 @@ namespace {
           }
           else
           {
-              SDL_UpdateRect (m_screen, rect.x, rect.y, rect.width, rect.height);
+              sdl_update_screen_rects (m_screen, rects);
 
-              // Write to stdout
+              // Write to stdout, which takes whole frames
               if (write (STDOUT_FILENO, m_screen_video->get_pixels (), m_screen_video->get_size ()) == -1) {
                   visual_log (VISUAL_LOG_ERROR, "Failed to write pixels to stdout");
               }
@@ -537,8 +537,8 @@ int main (int argc, char **argv)
                 // Draw audio data and render
                 bin.run();
 
-                // Display rendering
-                display.update_all ();
+                // Display the areas rendered
+                display.update_dirty ();
 
                 // Record frame time
                 last_frame_time = LV::Time::now ();